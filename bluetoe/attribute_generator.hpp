@@ -2,6 +2,7 @@
 #define BLUETOE_ATTRIBUTE_GENERATOR_HPP
 
 #include <tuple>
+#include <cassert>
 #include <bluetoe/meta_tools.hpp>
 
 namespace bluetoe {
@@ -52,6 +53,73 @@ namespace details {
         generate_attribute< Attributes, std::tuple< CCCDIndices... >, ClientCharacteristicIndex, Service, Server, Options... >::attr...
     };
 
+    /**
+     * maps a list of tuples, containing the parameters to generate an attribute, to a list of the generate_attribute<> types
+     * that generate the attributes.
+     */
+    template < typename Attributes, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename OptionsList >
+    struct attribute_generator_types;
+
+    template < typename ... Attributes, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
+    struct attribute_generator_types< std::tuple< Attributes... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, std::tuple< Options... > >
+    {
+        using type = std::tuple< generate_attribute< Attributes, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >... >;
+    };
+
+    /**
+     * Given that List is a tuple with elements that implement attribute_generators<> and number_of_client_configs, the type
+     * concatenates the generators of all elements, while keeping track of the ClientCharacteristicIndex.
+     *
+     * This works for a list of characteristics (Parent is the service), as well as for a list of services (Parent is the list of all services).
+     */
+    template < typename List, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Parent, typename Server >
+    struct attribute_generators_of_list;
+
+    template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Parent, typename Server >
+    struct attribute_generators_of_list< std::tuple<>, CCCDIndices, ClientCharacteristicIndex, Parent, Server >
+    {
+        using type = std::tuple<>;
+    };
+
+    template < typename T, typename ... Ts, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Parent, typename Server >
+    struct attribute_generators_of_list< std::tuple< T, Ts... >, CCCDIndices, ClientCharacteristicIndex, Parent, Server >
+    {
+        using type = typename add_type<
+            typename T::template attribute_generators< CCCDIndices, ClientCharacteristicIndex, Parent, Server >,
+            typename attribute_generators_of_list<
+                std::tuple< Ts... >, CCCDIndices, ClientCharacteristicIndex + T::number_of_client_configs, Parent, Server >::type
+        >::type;
+    };
+
+    /**
+     * A flat table of all attributes, generated by a list of generate_attribute<> types.
+     *
+     * The table is a constant expression and thus can be placed in read only memory. Accessing an attribute
+     * by its index is a single table lookup.
+     */
+    template < typename Generators >
+    struct attribute_table;
+
+    template < typename ... Generators >
+    struct attribute_table< std::tuple< Generators... > >
+    {
+        static constexpr std::size_t number_of_attributes = sizeof ...(Generators);
+
+        static attribute attribute_at( std::size_t index )
+        {
+            assert( index < number_of_attributes );
+
+            return attributes[ index ];
+        }
+
+        static constexpr attribute attributes[ sizeof ...(Generators) ] = {
+            Generators::attr...
+        };
+    };
+
+    template < typename ... Generators >
+    constexpr attribute attribute_table< std::tuple< Generators... > >::attributes[ sizeof ...(Generators) ];
+
     template < typename OptionsList, typename MetaTypeList, typename OptionsDefault = std::tuple<> >
     struct count_attributes;
 
@@ -80,6 +148,16 @@ namespace details {
 
         attribute_generation_parameters get_attribute_generation_parameters() { return attribute_generation_parameters(); }
 
+        template < std::size_t ClientCharacteristicIndex, typename Service, typename Server >
+        using attribute_generators = typename attribute_generator_types<
+            attribute_generation_parameters,
+            CCCDIndices,
+            ClientCharacteristicIndex,
+            Service,
+            Server,
+            OptionsList
+        >::type;
+
         template < std::size_t ClientCharacteristicIndex, typename Service, typename Server >
         static const attribute attribute_at( std::size_t index )
         {
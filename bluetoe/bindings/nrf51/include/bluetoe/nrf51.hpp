@@ -79,6 +79,12 @@ namespace bluetoe
 
             static constexpr bool hardware_supports_encryption = false;
 
+            // the nRF51 radio supports only the LE 1M PHY
+            static constexpr bool hardware_supports_2mbit = false;
+
+            // the binding keeps the state of a single connection only
+            static constexpr bool hardware_supports_multiple_connections = false;
+
             void increment_receive_packet_counter()
             {
             }
@@ -277,8 +283,15 @@ namespace bluetoe
                 unsigned                                    channel,
                 bluetoe::link_layer::delta_time             start_receive,
                 bluetoe::link_layer::delta_time             end_receive,
-                bluetoe::link_layer::delta_time             /* connection_interval */ )
+                bluetoe::link_layer::delta_time             /* connection_interval */,
+                link_layer::details::phy_ll_encoding::phy_ll_encoding_t receive_phy,
+                link_layer::details::phy_ll_encoding::phy_ll_encoding_t transmit_phy )
             {
+                static_cast< void >( receive_phy );
+                static_cast< void >( transmit_phy );
+                assert( receive_phy == link_layer::details::phy_ll_encoding::le_1m_phy );
+                assert( transmit_phy == link_layer::details::phy_ll_encoding::le_1m_phy );
+
                 link_layer::read_buffer read;
                 {
                     class Base::lock_guard lock;
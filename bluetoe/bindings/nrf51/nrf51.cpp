@@ -594,8 +594,12 @@ namespace nrf51_details {
 
         nrf_radio->INTENSET    = RADIO_INTENSET_DISABLED_Msk;
 
+        // a PDU that starts at the end of the receive window, must not be cut off
+        const std::uint32_t max_receive_time = link_layer::details::air_time(
+            link_layer::details::phy_ll_encoding::le_1m_phy, receive_buffer_.size + encryption_mic_size );
+
         nrf_timer->CC[ 0 ] = start_receive.usec() + anchor_offset_.usec() - us_radio_rx_startup_time;
-        nrf_timer->CC[ 1 ] = end_receive.usec() + anchor_offset_.usec() + 1000; // TODO: 1000: must depend on transmit size.
+        nrf_timer->CC[ 1 ] = end_receive.usec() + anchor_offset_.usec() + std::max< std::uint32_t >( 1000, max_receive_time );
 
         nrf_timer->TASKS_CAPTURE[ 3 ] = 1;
 
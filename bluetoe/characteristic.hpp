@@ -179,6 +179,12 @@ namespace bluetoe {
         template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server >
         static details::attribute attribute_at( std::size_t index );
 
+        /**
+         * @brief list of the generate_attribute<> types of all attributes of the characteristic
+         */
+        template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server >
+        using attribute_generators = typename details::generate_characteristic_attributes< CCCDIndices, Options... >::template attribute_generators< ClientCharacteristicIndex, Service, Server >;
+
         typedef typename details::find_by_meta_type< details::characteristic_value_meta_type, Options... >::type    base_value_type;
 
         static_assert( !std::is_same< base_value_type, details::no_such_type >::value,
@@ -263,6 +269,13 @@ namespace bluetoe {
             typedef typename characteristic_or_service_uuid< typename Service::uuid, Options... >::uuid                             uuid;
             typedef typename characteristic< Options... >::value_type                                       value_type;
 
+            static constexpr std::uint8_t properties =
+                ( value_type::has_read_access  ? bits( details::gatt_characteristic_properties::read ) : 0 ) |
+                ( value_type::has_write_access ? bits( details::gatt_characteristic_properties::write ) : 0 ) |
+                ( value_type::has_write_without_response ? bits( details::gatt_characteristic_properties::write_without_response ) : 0 ) |
+                ( value_type::has_notification ? bits( details::gatt_characteristic_properties::notify ) : 0 ) |
+                ( value_type::has_indication   ? bits( details::gatt_characteristic_properties::indicate ) : 0 );
+
             static void fixup_auto_uuid( details::attribute_access_arguments& args )
             {
                 // needs a 16 bit characteristic index!!!
@@ -288,14 +301,7 @@ namespace bluetoe {
                 if ( args.type != details::attribute_access_type::read )
                     return details::attribute_access_result::write_not_permitted;
 
-                const std::uint8_t properties[] = {
-                    static_cast< std::uint8_t >(
-                        ( value_type::has_read_access  ? bits( details::gatt_characteristic_properties::read ) : 0 ) |
-                        ( value_type::has_write_access ? bits( details::gatt_characteristic_properties::write ) : 0 ) |
-                        ( value_type::has_write_without_response ? bits( details::gatt_characteristic_properties::write_without_response ) : 0 ) |
-                        ( value_type::has_notification ? bits( details::gatt_characteristic_properties::notify ) : 0 ) |
-                        ( value_type::has_indication   ? bits( details::gatt_characteristic_properties::indicate ) : 0 ) )
-                };
+                const std::uint8_t properties[] = { generate_attribute::properties };
 
                 // the Characteristic Value Declaration must follow directly behind this attribute and has, thus the next handle
                 const std::uint8_t value_handle[] = {
@@ -318,14 +324,14 @@ namespace bluetoe {
                 return details::attribute_access_result::success;
             }
 
-            static const attribute attr;
+            static constexpr attribute attr {
+                bits( details::gatt_uuids::characteristic ),
+                &char_declaration_access
+            };
         };
 
         template < typename ... AttrOptions, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
-        const attribute generate_attribute< std::tuple< characteristic_declaration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr {
-            bits( details::gatt_uuids::characteristic ),
-            &generate_attribute< std::tuple< characteristic_declaration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::char_declaration_access
-        };
+        constexpr attribute generate_attribute< std::tuple< characteristic_declaration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr;
 
         /*
          * Characteristic Value
@@ -338,16 +344,16 @@ namespace bluetoe {
             using char_t = characteristic< Options... >;
             static constexpr bool requires_encryption = characteristic_requires_encryption< char_t, Service, Server >::value;
 
-            static const attribute attr;
+            static constexpr attribute attr {
+                uuid::is_128bit
+                    ? bits( details::gatt_uuids::internal_128bit_uuid )
+                    : uuid::as_16bit(),
+                &char_t::value_type::template characteristic_value_access< Server, ClientCharacteristicIndex, requires_encryption >
+            };
         };
 
         template < typename ... AttrOptions, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
-        const attribute generate_attribute< std::tuple< characteristic_value_declaration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr {
-            uuid::is_128bit
-                ? bits( details::gatt_uuids::internal_128bit_uuid )
-                : uuid::as_16bit(),
-            &characteristic< Options... >::value_type::template characteristic_value_access< Server, ClientCharacteristicIndex, requires_encryption >
-        };
+        constexpr attribute generate_attribute< std::tuple< characteristic_value_declaration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr;
 
         /*
          * Characteristic User Description
@@ -355,8 +361,6 @@ namespace bluetoe {
         template < const char* const Name, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
         struct generate_attribute< std::tuple< characteristic_user_description_parameter, characteristic_name< Name > >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >
         {
-            static const attribute attr;
-
             static details::attribute_access_result access( attribute_access_arguments& args, std::uint16_t )
             {
                 const std::size_t str_len   = std::strlen( Name );
@@ -380,13 +384,14 @@ namespace bluetoe {
                 return result;
             }
 
+            static constexpr attribute attr {
+                bits( gatt_uuids::characteristic_user_description ),
+                &access
+            };
         };
 
         template < const char* const Name, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
-        const attribute generate_attribute< std::tuple< characteristic_user_description_parameter, characteristic_name< Name > >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr {
-            bits( gatt_uuids::characteristic_user_description ),
-            &generate_attribute< std::tuple< characteristic_user_description_parameter, characteristic_name< Name > >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::access
-        };
+        constexpr attribute generate_attribute< std::tuple< characteristic_user_description_parameter, characteristic_name< Name > >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr;
 
         /*
          * Client Characteristic Configuration Descriptor (CCCD)
@@ -394,7 +399,6 @@ namespace bluetoe {
         template < typename ... AttrOptions, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
         struct generate_attribute< std::tuple< client_characteristic_configuration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >
         {
-            static const attribute attr;
             using uuid   = typename characteristic_or_service_uuid< typename Service::uuid, Options... >::uuid;
 
             static details::attribute_access_result access( attribute_access_arguments& args, std::uint16_t )
@@ -455,13 +459,15 @@ namespace bluetoe {
 
                 return result;
             }
+
+            static constexpr attribute attr {
+                bits( gatt_uuids::client_characteristic_configuration ),
+                &access
+            };
         };
 
         template < typename ... AttrOptions, typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename Service, typename Server, typename ... Options >
-        constexpr attribute generate_attribute< std::tuple< client_characteristic_configuration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr {
-            bits( gatt_uuids::client_characteristic_configuration ),
-            &generate_attribute< std::tuple< client_characteristic_configuration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::access
-        };
+        constexpr attribute generate_attribute< std::tuple< client_characteristic_configuration_parameter, AttrOptions... >, CCCDIndices, ClientCharacteristicIndex, Service, Server, Options... >::attr;
 
         template < typename Parmeters >
         struct are_client_characteristic_configuration_parameter : std::false_type {};
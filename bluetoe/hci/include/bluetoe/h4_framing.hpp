@@ -0,0 +1,267 @@
+#ifndef BLUETOE_HCI_H4_FRAMING_HPP
+#define BLUETOE_HCI_H4_FRAMING_HPP
+
+#include <bluetoe/bits.hpp>
+#include <bluetoe/buffer.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace bluetoe {
+namespace hci {
+
+    /**
+     * @brief structure, able to split a byte stream of H4 packets into packets and to store them in a fixed size ring.
+     *
+     * The framing is the receiving counterpart of the H4 byte stream: bytes read from the controller are written
+     * directly into the ring (receive_buffer() / received()), as many at once as there is contiguous room in the ring.
+     * The packet indicators and the event and ACL data headers are parsed in place and once a packet is complete,
+     * it can be read through the ring as a view into the ring (next_packet() / pop_packet()). Received bytes are not
+     * copied, with the exception of a partially received packet, that has to be moved to the beginning of the ring,
+     * to keep the packet contiguous, and of dropped bytes, that are followed by already received bytes.
+     *
+     * Like the bluetoe::link_layer::pdu_ring_buffer, packets are added at the front and removed from the end.
+     * When the ring buffer is empty, it is guarantied that the buffer can store a packet of Size bytes. Larger
+     * packets and bytes with an unknown packet indicator are dropped.
+     */
+    template < std::size_t Size >
+    class h4_framing
+    {
+    public:
+        /**
+         * @brief the size of the buffer in bytes
+         */
+        static constexpr std::size_t size = Size;
+
+        /**
+         * @brief sets up the ring to be empty
+         */
+        h4_framing();
+
+        /**
+         * @brief resets the ring to be empty and discards a partially received packet
+         */
+        void reset();
+
+        /**
+         * @brief returns the location and the number of bytes, that can be received next from the byte stream
+         *
+         * The returned buffer has room for at least the remaining bytes of the current packet, or, if the packet
+         * header is not complete, of the current packet header and for all following bytes, that fit contiguously
+         * into the ring. If there is not enough room in the ring to store the current packet, the
+         * function returns an empty buffer.
+         */
+        bluetoe::link_layer::read_buffer receive_buffer();
+
+        /**
+         * @brief signals, that size bytes where written into the buffer, returned by receive_buffer().
+         *
+         * @pre size <= receive_buffer().size
+         */
+        void received( std::size_t size );
+
+        /**
+         * @brief returns the next complete H4 packet, including the packet indicator, from the ring.
+         *
+         * If no packet is stored in the ring, the function will return an empty write_buffer.
+         */
+        bluetoe::link_layer::write_buffer next_packet() const;
+
+        /**
+         * @brief frees the packet at the end of the ring
+         *
+         * @pre next_packet().size != 0
+         */
+        void pop_packet();
+
+    private:
+        static constexpr std::uint8_t   event_indicator     = 0x04;
+        static constexpr std::uint8_t   acl_data_indicator  = 0x02;
+        static constexpr std::size_t    event_header_size   = 1 + 2;
+        static constexpr std::size_t    acl_header_size     = 1 + 4;
+
+        // not a valid packet indicator
+        static constexpr std::uint8_t   wrap_mark           = 0;
+
+        static_assert( Size >= acl_header_size, "the ring has to be large enough to store at least an ACL data header" );
+
+        static std::size_t packet_length( const std::uint8_t* packet );
+        static std::size_t header_size( const std::uint8_t* packet );
+
+        std::size_t free_at_front() const;
+        bool wrap_front( std::size_t size );
+        void drop_received( std::size_t size );
+
+        std::uint8_t    buffer_[ Size ];
+
+        // complete packets are stored from end_ to front_; if front_ < end_, the packets between end_ and the
+        // end of the buffer, or a wrap mark, are followed by the packets from the beginning of the buffer till front_.
+        std::uint8_t*   end_;
+        std::uint8_t*   front_;
+
+        // the bytes of the packet currently received are stored at front_; expected_ is the size of the
+        // current packet, or, as long as the packet indicator or the header is not complete, the size of them
+        std::size_t     received_;
+        std::size_t     expected_;
+        std::size_t     discard_;
+    };
+
+    // implementation
+    /** @cond HIDDEN_SYMBOLS */
+    template < std::size_t Size >
+    h4_framing< Size >::h4_framing()
+    {
+        reset();
+    }
+
+    template < std::size_t Size >
+    void h4_framing< Size >::reset()
+    {
+        end_      = buffer_;
+        front_    = buffer_;
+        received_ = 0;
+        expected_ = 1;
+        discard_  = 0;
+    }
+
+    template < std::size_t Size >
+    bluetoe::link_layer::read_buffer h4_framing< Size >::receive_buffer()
+    {
+        // an empty ring starts at the beginning of the buffer again
+        if ( end_ == front_ && received_ == 0 )
+        {
+            end_   = buffer_;
+            front_ = buffer_;
+        }
+
+        if ( free_at_front() < expected_ && !wrap_front( expected_ ) )
+            return bluetoe::link_layer::read_buffer{ nullptr, 0 };
+
+        return bluetoe::link_layer::read_buffer{ front_ + received_, free_at_front() - received_ };
+    }
+
+    template < std::size_t Size >
+    void h4_framing< Size >::received( std::size_t size )
+    {
+        received_ += size;
+
+        for ( ;; )
+        {
+            // bytes of a dropped packet
+            if ( discard_ )
+            {
+                const std::size_t drop = std::min( discard_, received_ );
+                drop_received( drop );
+                discard_ -= drop;
+
+                if ( discard_ )
+                    return;
+            }
+
+            if ( received_ < expected_ )
+                return;
+
+            if ( expected_ == 1 )
+            {
+                // unknown packet indicator: drop the byte and resynchronize
+                if ( front_[ 0 ] == event_indicator || front_[ 0 ] == acl_data_indicator )
+                    expected_ = header_size( front_ );
+                else
+                    drop_received( 1 );
+            }
+            else if ( expected_ == header_size( front_ ) && packet_length( front_ ) != expected_ )
+            {
+                expected_ = packet_length( front_ );
+
+                // packets that do not fit into the ring are dropped
+                if ( expected_ > Size )
+                {
+                    discard_  = expected_;
+                    expected_ = 1;
+                }
+            }
+            else
+            {
+                front_    += expected_;
+                received_ -= expected_;
+                expected_ = 1;
+            }
+        }
+    }
+
+    template < std::size_t Size >
+    bluetoe::link_layer::write_buffer h4_framing< Size >::next_packet() const
+    {
+        return front_ == end_
+            ? bluetoe::link_layer::write_buffer()
+            : bluetoe::link_layer::write_buffer( end_, packet_length( end_ ) );
+    }
+
+    template < std::size_t Size >
+    void h4_framing< Size >::pop_packet()
+    {
+        end_ += packet_length( end_ );
+
+        // wrap the end_ pointer to the beginning, if the buffer is not empty
+        if ( end_ != front_ && ( end_ == buffer_ + Size || *end_ == wrap_mark ) )
+            end_ = buffer_;
+    }
+
+    template < std::size_t Size >
+    std::size_t h4_framing< Size >::packet_length( const std::uint8_t* packet )
+    {
+        return packet[ 0 ] == event_indicator
+            ? event_header_size + packet[ 2 ]
+            : acl_header_size + bluetoe::details::read_16bit( &packet[ 3 ] );
+    }
+
+    template < std::size_t Size >
+    std::size_t h4_framing< Size >::header_size( const std::uint8_t* packet )
+    {
+        return packet[ 0 ] == event_indicator ? event_header_size : acl_header_size;
+    }
+
+    template < std::size_t Size >
+    std::size_t h4_framing< Size >::free_at_front() const
+    {
+        // buffer splited? There must be one byte left to not overflow the ring.
+        return front_ < end_
+            ? static_cast< std::size_t >( end_ - front_ - 1 )
+            : static_cast< std::size_t >( buffer_ + Size - front_ );
+    }
+
+    template < std::size_t Size >
+    bool h4_framing< Size >::wrap_front( std::size_t size )
+    {
+        const bool empty = end_ == front_;
+
+        // move to the beginning? Again, there must be one byte left between front_ and end_
+        if ( front_ < end_ || ( !empty && static_cast< std::ptrdiff_t >( size ) >= end_ - buffer_ ) )
+            return false;
+
+        std::copy( front_, front_ + received_, buffer_ );
+
+        // mark the position, where the end_ pointer has to wrap
+        if ( !empty && front_ != buffer_ + Size )
+            *front_ = wrap_mark;
+
+        if ( empty )
+            end_ = buffer_;
+
+        front_ = buffer_;
+
+        return true;
+    }
+
+    template < std::size_t Size >
+    void h4_framing< Size >::drop_received( std::size_t size )
+    {
+        std::copy( front_ + size, front_ + received_, front_ );
+        received_ -= size;
+    }
+    /** @endcond */
+}
+}
+
+#endif
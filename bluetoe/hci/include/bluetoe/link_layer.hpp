@@ -1,13 +1,196 @@
 #ifndef BLUETOE_HCI_LINK_LAYER_HPP
 #define BLUETOE_HCI_LINK_LAYER_HPP
 
+#include <bluetoe/h4_framing.hpp>
 #include <bluetoe/address.hpp>
+#include <bluetoe/bits.hpp>
+#include <bluetoe/codes.hpp>
+#include <bluetoe/notification_queue.hpp>
+#include <bluetoe/ll_options.hpp>
+#include <bluetoe/meta_types.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
 
 namespace bluetoe {
 namespace hci {
 
+    namespace details {
+        /*
+         * H4 packet indicators, that precede every HCI packet on a byte stream
+         */
+        enum class packet_indicator : std::uint8_t {
+            command     = 0x01,
+            acl_data    = 0x02,
+            event       = 0x04
+        };
+
+        enum class opcode : std::uint16_t {
+            no_operation                = 0x0000,
+            disconnect                  = 0x0406,
+            set_event_mask              = 0x0C01,
+            reset                       = 0x0C03,
+            read_buffer_size            = 0x1005,
+            read_bd_addr                = 0x1009,
+            le_set_event_mask           = 0x2001,
+            le_read_buffer_size         = 0x2002,
+            le_set_advertising_params   = 0x2006,
+            le_set_advertising_data     = 0x2008,
+            le_set_advertise_enable     = 0x200A,
+            le_connection_update        = 0x2013
+        };
+
+        enum class event_code : std::uint8_t {
+            disconnection_complete      = 0x05,
+            command_complete            = 0x0E,
+            command_status              = 0x0F,
+            number_of_completed_packets = 0x13,
+            le_meta                     = 0x3E
+        };
+
+        enum class le_subevent_code : std::uint8_t {
+            connection_complete         = 0x01,
+            connection_update_complete  = 0x03
+        };
+
+        static constexpr std::size_t    event_header_size       = 2;
+        static constexpr std::size_t    acl_header_size         = 4;
+        static constexpr std::size_t    l2cap_header_size       = 4;
+        static constexpr std::size_t    max_event_size          = 255;
+        static constexpr std::size_t    max_advertising_data    = 31;
+
+        static constexpr std::uint16_t  acl_handle_mask         = 0x0fff;
+        // LE-U links do not support automatically flushable packets, but controllers may send them to the host
+        static constexpr std::uint16_t  acl_first_non_flushable = 0x0000;
+        static constexpr std::uint16_t  acl_continuation        = 0x1000;
+        static constexpr std::uint16_t  acl_packet_boundary     = 0x3000;
+
+        static constexpr std::uint16_t  l2cap_att_channel       = 0x0004;
+        static constexpr std::uint16_t  l2cap_sm_channel        = 0x0006;
+
+        static constexpr std::uint8_t   remote_user_terminated  = 0x13;
+        static constexpr std::uint8_t   status_success          = 0x00;
+
+        // number of times, a failing command is send during the setup of the controller
+        static constexpr unsigned       max_setup_attempts      = 3;
+
+        // the minimum LE ACL data packet length, a controller has to support
+        static constexpr std::size_t    min_acl_data_length     = 27;
+
+        struct transmit_queue_size_meta_type {};
+
+        template < typename ... Options >
+        struct mtu_size {
+            static constexpr std::size_t mtu = ::bluetoe::details::find_by_meta_type<
+                bluetoe::link_layer::details::mtu_size_meta_type,
+                Options...,
+                bluetoe::link_layer::max_mtu_size< bluetoe::details::default_att_mtu_size > >::type::mtu;
+        };
+
+        /*
+         * space required in the transmit queue, for a single L2CAP PDU with up to mtu bytes of payload, fragmented
+         * into ACL data packets of the smallest possible size.
+         */
+        template < std::size_t MTU >
+        struct queued_pdu_size {
+            static constexpr std::size_t l2cap_size = l2cap_header_size + MTU;
+            static constexpr std::size_t fragments  = ( l2cap_size + min_acl_data_length - 1 ) / min_acl_data_length;
+            static constexpr std::size_t size       = l2cap_size + fragments * ( 1 + acl_header_size );
+        };
+    }
+
+    /**
+     * @brief size of the queue in bytes, that holds ACL data packets, until the controller has free buffers
+     *
+     * ACL data packets are stored with their H4 and ACL headers. The queue must be large enough to store at least
+     * two L2CAP PDUs of the maximum MTU size (one for a response and one for notifications or indications).
+     * The default is large enough to store four L2CAP PDUs.
+     *
+     * @sa link_layer
+     * @sa bluetoe::link_layer::max_mtu_size
+     */
+    template < std::size_t Size >
+    struct transmit_queue_size
+    {
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::transmit_queue_size_meta_type,
+            bluetoe::link_layer::details::valid_link_layer_option_meta_type {};
+
+        static constexpr std::size_t size = Size;
+        /** @endcond */
+    };
+
+    namespace details {
+        template < typename ... Options >
+        struct transmit_queue_size {
+            static constexpr std::size_t size = ::bluetoe::details::find_by_meta_type<
+                transmit_queue_size_meta_type,
+                Options...,
+                ::bluetoe::hci::transmit_queue_size< 4 * queued_pdu_size< mtu_size< Options... >::mtu >::size > >::type::size;
+        };
+    }
+
+    /**
+     * @brief current fill level of the queue of ACL data packets, waiting for free controller buffers
+     *
+     * @sa link_layer::acl_statistics
+     */
+    struct acl_queue_statistics
+    {
+        /**
+         * ACL data packets in the transmit queue
+         */
+        std::size_t queued_packets;
+
+        /**
+         * maximum number of ACL data packets, that where in the transmit queue at the same time
+         */
+        std::size_t max_queued_packets;
+
+        /**
+         * number of ACL data packets, the controller can currently accept
+         */
+        std::size_t free_controller_buffers;
+
+        /**
+         * total number of LE ACL data buffers of the controller
+         */
+        std::size_t controller_buffers;
+    };
+
     /**
      * @brief link layer implementation based on HCI
+     *
+     * Implements the host side of the Host Controller Interface and runs a bluetoe::server on an off-the-shelf
+     * controller. The link layer resets the controller, enables the LE Meta and Disconnection Complete events,
+     * reads the controllers public device address and starts connectable, undirected advertising with the
+     * advertising data of the server. Once a central connects,
+     * ATT PDUs received over HCI ACL data packets are passed to the server and notifications and indications
+     * are send over HCI ACL data packets. After the connection was closed, advertising is restarted.
+     *
+     * The link layer supports a single connection and only the ATT channel. Pairing requests are rejected.
+     *
+     * Outgoing L2CAP PDUs are fragmented to the LE ACL data packet length of the controller and queued. Queued ACL data
+     * packets are passed to the controller, as long as the controller has free ACL data buffers, as reported by the
+     * HCI_LE_Read_Buffer_Size command and replenished by the Number Of Completed Packets event. All ACL data packets,
+     * that can be send at once, are passed to the transport with a single write.
+     *
+     * Received bytes are read from the transport directly into a ring of HCI packets (h4_framing) and events and
+     * ACL data packets are handled in place. L2CAP PDUs, that are not fragmented, are passed to the server without
+     * being copied.
+     *
+     * Supported options:
+     * - bluetoe::link_layer::max_mtu_size
+     * - transmit_queue_size
+     *
+     * Transport is a CRTP base class, that implements a byte stream to the controller, that transports HCI packets
+     * with the H4 packet indicators.
+     *
+     * @sa transport
      */
     template <
         class Server,
@@ -15,14 +198,16 @@ namespace hci {
         class Transport,
         typename ... Options
     >
-    class link_layer : Transport< link_layer< Server, Transport, Options... > >
+    class link_layer : public Transport< link_layer< Server, Transport, Options... > >
     {
     public:
+        link_layer();
+
         /**
          * @brief this function passes the CPU to the link layer implementation
          *
-         * This function should return on certain events to alow user code to do
-         * usefull things. Details depend on the ScheduleRadio implemention.
+         * The function sends pending HCI commands, handles all HCI packets that are available from the transport and
+         * sends pending notifications and indications. It returns, when no more input is available.
          */
         void run( Server& );
 
@@ -50,14 +235,764 @@ namespace hci {
          * @brief returns the own local device address
          */
         const bluetoe::link_layer::device_address& local_address() const;
+
+        /**
+         * @brief returns the current state of the ACL transmit queue
+         */
+        acl_queue_statistics acl_statistics() const;
+
+        /**
+         * @brief returns true, if the controller could not be set up
+         *
+         * A setup command, that is answered with an error status, is repeated. If it still fails, the setup is
+         * stopped and the link layer will not start advertising.
+         */
+        bool setup_failed() const;
+
     private:
+        using connection_data_t = bluetoe::link_layer::notification_queue<
+            typename Server::notification_priority::template numbers< typename Server::services >::type,
+            typename Server::connection_data >;
+
+        static constexpr std::size_t mtu                = details::mtu_size< Options... >::mtu;
+        static constexpr std::size_t max_l2cap_size     = details::l2cap_header_size + mtu;
+        static constexpr std::size_t queued_pdu_size    = details::queued_pdu_size< mtu >::size;
+        static constexpr std::size_t queue_size         = details::transmit_queue_size< Options... >::size;
+
+        static_assert( queue_size >= 2 * queued_pdu_size, "the transmit queue has to be large enough for at least two L2CAP PDUs" );
+        // large enough for every event and for ACL data packets with up to 255 bytes of payload
+        static constexpr std::size_t max_packet_size    = 1 + details::acl_header_size + details::max_event_size;
+
+        // steps to set up the controller, after the link layer was started
+        enum class setup_step {
+            reset,
+            event_mask,
+            le_event_mask,
+            read_address,
+            read_le_buffer_size,
+            read_buffer_size,
+            advertising_parameters,
+            advertising_data,
+            advertise_enable,
+            done,
+            failed
+        };
+
+        void send_pending_commands();
+        void send_setup_command();
+        static details::opcode setup_opcode( setup_step step );
+        void send_command( details::opcode, std::initializer_list< std::uint8_t > parameters );
+        void send_command( details::opcode, const std::uint8_t* parameters, std::size_t size );
+        void send_l2cap( std::uint16_t channel, const std::uint8_t* payload, std::size_t size );
+        void queue_acl_packet( std::uint16_t flags, const std::uint8_t* header, std::size_t header_size, const std::uint8_t* payload, std::size_t size );
+        void transmit_queued_packets();
+        std::size_t free_queue_size() const;
+
+        bool receive();
+        void handle_packet( const std::uint8_t* packet, std::size_t size );
+        void handle_event( const std::uint8_t* event, std::size_t size );
+        void handle_command_complete( const std::uint8_t* parameters, std::size_t size );
+        void handle_command_status( const std::uint8_t* parameters, std::size_t size );
+        void handle_setup_failure();
+        void handle_buffer_size( std::uint16_t acl_length, std::uint16_t acl_buffers );
+        void handle_number_of_completed_packets( const std::uint8_t* parameters, std::size_t size );
+        void handle_le_meta_event( const std::uint8_t* parameters, std::size_t size );
+        void handle_connection_complete( const std::uint8_t* parameters, std::size_t size );
+        void handle_disconnection_complete( const std::uint8_t* parameters, std::size_t size );
+        void handle_acl_data( const std::uint8_t* packet, std::size_t size );
+        void handle_l2cap( const std::uint8_t* pdu, std::size_t size );
+
+        void transmit_notifications();
+
+        static bool lcap_notification_callback( const ::bluetoe::details::notification_data& item, void* usr_arg, typename Server::notification_type type );
+
+        Server*                                 server_;
+        bluetoe::link_layer::public_device_address
+                                                address_;
+
+        setup_step                              setup_;
+        unsigned                                setup_attempts_;
+        // setup command, that was send and not answered yet; no_operation, if there is none
+        details::opcode                         setup_command_pending_;
+        unsigned                                command_credits_;
+        bool                                    advertise_enable_pending_;
+        bool                                    disconnect_pending_;
+        bool                                    update_pending_;
+        std::uint16_t                           update_parameters_[ 4 ];
+
+        // H4 packets are received directly into the ring and handled in place
+        h4_framing< max_packet_size >           receive_buffer_;
+
+        bool                                    connected_;
+        std::uint16_t                           connection_handle_;
+        connection_data_t                       connection_;
+
+        // LE ACL data buffers of the controller
+        std::uint16_t                           acl_length_;
+        std::uint16_t                           acl_buffers_;
+        std::uint16_t                           acl_credits_;
+
+        // ACL data packets, including H4 and ACL header, waiting for free controller buffers
+        std::uint8_t                            queue_[ queue_size ];
+        std::size_t                             queue_used_;
+        std::size_t                             queued_packets_;
+        std::size_t                             max_queued_packets_;
+
+        // L2CAP PDU reassembled from ACL fragments
+        std::uint8_t                            l2cap_[ max_l2cap_size ];
+        std::size_t                             l2cap_size_;
+        bool                                    l2cap_discard_;
     };
 
     // implementation
+    /** @cond HIDDEN_SYMBOLS */
     template < class Server, template < typename > class Transport, typename ... Options >
-    void link_layer< Server, Transport, Options... >::run( Server& )
+    link_layer< Server, Transport, Options... >::link_layer()
+        : server_( nullptr )
+        , setup_( setup_step::reset )
+        , setup_attempts_( 0 )
+        , setup_command_pending_( details::opcode::no_operation )
+        , command_credits_( 1 )
+        , advertise_enable_pending_( false )
+        , disconnect_pending_( false )
+        , update_pending_( false )
+        , connected_( false )
+        , connection_handle_( 0 )
+        , connection_( std::size_t{ mtu } )
+        , acl_length_( details::min_acl_data_length )
+        , acl_buffers_( 0 )
+        , acl_credits_( 0 )
+        , queue_used_( 0 )
+        , queued_packets_( 0 )
+        , max_queued_packets_( 0 )
+        , l2cap_size_( 0 )
+        , l2cap_discard_( false )
     {
     }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::run( Server& server )
+    {
+        if ( server_ == nullptr )
+        {
+            server_ = &server;
+            server.notification_callback( lcap_notification_callback, this );
+        }
+
+        do
+        {
+            send_pending_commands();
+            transmit_notifications();
+            transmit_queued_packets();
+        }
+        while ( receive() );
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    bool link_layer< Server, Transport, Options... >::connection_parameter_update_request( std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout )
+    {
+        if ( !connected_ || update_pending_ )
+            return false;
+
+        update_parameters_[ 0 ] = interval_min;
+        update_parameters_[ 1 ] = interval_max;
+        update_parameters_[ 2 ] = latency;
+        update_parameters_[ 3 ] = timeout;
+        update_pending_         = true;
+
+        return true;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::disconnect()
+    {
+        if ( connected_ )
+            disconnect_pending_ = true;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    std::size_t link_layer< Server, Transport, Options... >::fill_l2cap_advertising_data( std::uint8_t* buffer, std::size_t buffer_size ) const
+    {
+        return server_ ? server_->advertising_data( buffer, buffer_size ) : 0;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    const bluetoe::link_layer::device_address& link_layer< Server, Transport, Options... >::local_address() const
+    {
+        return address_;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    acl_queue_statistics link_layer< Server, Transport, Options... >::acl_statistics() const
+    {
+        return acl_queue_statistics{ queued_packets_, max_queued_packets_, acl_credits_, acl_buffers_ };
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    bool link_layer< Server, Transport, Options... >::setup_failed() const
+    {
+        return setup_ == setup_step::failed;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::send_pending_commands()
+    {
+        // the controller signals, how many commands it accepts, with every command complete or command status event
+        if ( command_credits_ == 0 )
+            return;
+
+        if ( setup_ == setup_step::failed )
+        {
+            return;
+        }
+        else if ( setup_ != setup_step::done )
+        {
+            // the setup continues only, after the controller answered the command of the current step
+            if ( setup_command_pending_ == details::opcode::no_operation )
+                send_setup_command();
+        }
+        else if ( disconnect_pending_ )
+        {
+            disconnect_pending_ = false;
+
+            send_command( details::opcode::disconnect, {
+                static_cast< std::uint8_t >( connection_handle_ & 0xff ),
+                static_cast< std::uint8_t >( connection_handle_ >> 8 ),
+                details::remote_user_terminated } );
+        }
+        else if ( update_pending_ )
+        {
+            update_pending_ = false;
+
+            std::uint8_t parameters[ 14 ] = { 0 };
+            bluetoe::details::write_16bit( &parameters[ 0 ], connection_handle_ );
+
+            for ( std::size_t param = 0; param != 4; ++param )
+                bluetoe::details::write_16bit( &parameters[ 2 + 2 * param ], update_parameters_[ param ] );
+
+            send_command( details::opcode::le_connection_update, parameters, sizeof( parameters ) );
+        }
+        else if ( advertise_enable_pending_ )
+        {
+            advertise_enable_pending_ = false;
+
+            send_command( details::opcode::le_set_advertise_enable, { 0x01 } );
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::send_setup_command()
+    {
+        // advertising interval of 100ms in units of 0.625ms
+        static constexpr std::uint8_t advertising_interval = 160;
+
+        setup_command_pending_ = setup_opcode( setup_ );
+
+        switch ( setup_ )
+        {
+        case setup_step::reset:
+            send_command( details::opcode::reset, {} );
+            break;
+        case setup_step::event_mask:
+            // the default event mask, plus the LE Meta Event (bit 61); includes Disconnection Complete (bit 4)
+            send_command( details::opcode::set_event_mask, { 0xff, 0xff, 0xff, 0xff, 0xff, 0x1f, 0x00, 0x20 } );
+            break;
+        case setup_step::le_event_mask:
+            // LE Connection Complete (bit 0) and LE Connection Update Complete (bit 2), plus the remaining defaults
+            send_command( details::opcode::le_set_event_mask, { 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } );
+            break;
+        case setup_step::read_address:
+            send_command( details::opcode::read_bd_addr, {} );
+            break;
+        case setup_step::read_le_buffer_size:
+            send_command( details::opcode::le_read_buffer_size, {} );
+            break;
+        case setup_step::read_buffer_size:
+            send_command( details::opcode::read_buffer_size, {} );
+            break;
+        case setup_step::advertising_parameters:
+            send_command( details::opcode::le_set_advertising_params, {
+                advertising_interval, 0x00,         // Advertising_Interval_Min
+                advertising_interval, 0x00,         // Advertising_Interval_Max
+                0x00,                               // ADV_IND
+                0x00,                               // public Own_Address_Type
+                0x00,                               // Peer_Address_Type
+                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Peer_Address
+                0x07,                               // all channels
+                0x00                                // no filter policy
+            } );
+            break;
+        case setup_step::advertising_data:
+            {
+                std::uint8_t parameters[ 1 + details::max_advertising_data ] = { 0 };
+                parameters[ 0 ] = static_cast< std::uint8_t >( fill_l2cap_advertising_data( &parameters[ 1 ], details::max_advertising_data ) );
+
+                send_command( details::opcode::le_set_advertising_data, parameters, sizeof( parameters ) );
+            }
+            break;
+        case setup_step::advertise_enable:
+            send_command( details::opcode::le_set_advertise_enable, { 0x01 } );
+            break;
+        case setup_step::done:
+        case setup_step::failed:
+            break;
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    details::opcode link_layer< Server, Transport, Options... >::setup_opcode( setup_step step )
+    {
+        static const details::opcode setup_opcodes[] = {
+            details::opcode::reset,
+            details::opcode::set_event_mask,
+            details::opcode::le_set_event_mask,
+            details::opcode::read_bd_addr,
+            details::opcode::le_read_buffer_size,
+            details::opcode::read_buffer_size,
+            details::opcode::le_set_advertising_params,
+            details::opcode::le_set_advertising_data,
+            details::opcode::le_set_advertise_enable
+        };
+
+        return step < setup_step::done
+            ? setup_opcodes[ static_cast< unsigned >( step ) ]
+            : details::opcode::no_operation;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::send_command( details::opcode code, std::initializer_list< std::uint8_t > parameters )
+    {
+        send_command( code, parameters.begin(), parameters.size() );
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::send_command( details::opcode code, const std::uint8_t* parameters, std::size_t size )
+    {
+        const std::uint8_t header[] = {
+            static_cast< std::uint8_t >( details::packet_indicator::command ),
+            static_cast< std::uint8_t >( static_cast< std::uint16_t >( code ) & 0xff ),
+            static_cast< std::uint8_t >( static_cast< std::uint16_t >( code ) >> 8 ),
+            static_cast< std::uint8_t >( size )
+        };
+
+        --command_credits_;
+
+        this->write( header, sizeof( header ) );
+        this->write( parameters, size );
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::send_l2cap( std::uint16_t channel, const std::uint8_t* payload, std::size_t size )
+    {
+        // only possible, if a peer sends requests without waiting for the responses
+        if ( free_queue_size() < queued_pdu_size )
+            return;
+
+        std::uint8_t header[ details::l2cap_header_size ];
+        bluetoe::details::write_16bit( &header[ 0 ], static_cast< std::uint16_t >( size ) );
+        bluetoe::details::write_16bit( &header[ 2 ], channel );
+
+        // the first fragment contains the L2CAP header
+        const std::size_t first = std::min< std::size_t >( size, acl_length_ - details::l2cap_header_size );
+        queue_acl_packet( details::acl_first_non_flushable, header, sizeof( header ), payload, first );
+
+        for ( std::size_t pos = first; pos != size; )
+        {
+            const std::size_t fragment = std::min< std::size_t >( size - pos, acl_length_ );
+            queue_acl_packet( details::acl_continuation, nullptr, 0, payload + pos, fragment );
+
+            pos += fragment;
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::queue_acl_packet( std::uint16_t flags, const std::uint8_t* header, std::size_t header_size, const std::uint8_t* payload, std::size_t size )
+    {
+        std::uint8_t* const packet = &queue_[ queue_used_ ];
+
+        packet[ 0 ] = static_cast< std::uint8_t >( details::packet_indicator::acl_data );
+        bluetoe::details::write_16bit( &packet[ 1 ], connection_handle_ | flags );
+        bluetoe::details::write_16bit( &packet[ 3 ], static_cast< std::uint16_t >( header_size + size ) );
+        std::copy( header, header + header_size, &packet[ 1 + details::acl_header_size ] );
+        std::copy( payload, payload + size, &packet[ 1 + details::acl_header_size + header_size ] );
+
+        queue_used_ += 1 + details::acl_header_size + header_size + size;
+        ++queued_packets_;
+        max_queued_packets_ = std::max( max_queued_packets_, queued_packets_ );
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::transmit_queued_packets()
+    {
+        // all packets, for which the controller has buffers, are written at once
+        std::size_t size    = 0;
+        std::size_t packets = 0;
+
+        for ( ; packets != queued_packets_ && packets != acl_credits_; ++packets )
+            size += 1 + details::acl_header_size + bluetoe::details::read_16bit( &queue_[ size + 3 ] );
+
+        if ( packets == 0 )
+            return;
+
+        this->write( queue_, size );
+
+        std::copy( &queue_[ size ], &queue_[ queue_used_ ], &queue_[ 0 ] );
+        queue_used_     -= size;
+        queued_packets_ -= packets;
+        acl_credits_    -= static_cast< std::uint16_t >( packets );
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    std::size_t link_layer< Server, Transport, Options... >::free_queue_size() const
+    {
+        return queue_size - queue_used_;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    bool link_layer< Server, Transport, Options... >::receive()
+    {
+        for ( bool received = false; ; received = true )
+        {
+            const bluetoe::link_layer::read_buffer space = receive_buffer_.receive_buffer();
+            const std::size_t size = space.size ? this->read( space.buffer, space.size ) : 0;
+
+            receive_buffer_.received( size );
+
+            for ( auto packet = receive_buffer_.next_packet(); packet.size; packet = receive_buffer_.next_packet() )
+            {
+                handle_packet( packet.buffer, packet.size );
+                receive_buffer_.pop_packet();
+            }
+
+            if ( size == 0 )
+                return received;
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_packet( const std::uint8_t* packet, std::size_t size )
+    {
+        const auto indicator = static_cast< details::packet_indicator >( packet[ 0 ] );
+
+        if ( indicator == details::packet_indicator::event )
+        {
+            handle_event( &packet[ 1 ], size - 1 );
+        }
+        else if ( indicator == details::packet_indicator::acl_data )
+        {
+            handle_acl_data( &packet[ 1 ], size - 1 );
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_event( const std::uint8_t* event, std::size_t size )
+    {
+        const std::uint8_t* const parameters = event + details::event_header_size;
+        const std::size_t         param_size = size - details::event_header_size;
+
+        switch ( static_cast< details::event_code >( event[ 0 ] ) )
+        {
+        case details::event_code::command_complete:
+            handle_command_complete( parameters, param_size );
+            break;
+        case details::event_code::command_status:
+            handle_command_status( parameters, param_size );
+            break;
+        case details::event_code::disconnection_complete:
+            handle_disconnection_complete( parameters, param_size );
+            break;
+        case details::event_code::number_of_completed_packets:
+            handle_number_of_completed_packets( parameters, param_size );
+            break;
+        case details::event_code::le_meta:
+            handle_le_meta_event( parameters, param_size );
+            break;
+        default:
+            break;
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_command_complete( const std::uint8_t* parameters, std::size_t size )
+    {
+        if ( size < 3 )
+            return;
+
+        command_credits_ = parameters[ 0 ];
+
+        const auto code = static_cast< details::opcode >( bluetoe::details::read_16bit( &parameters[ 1 ] ) );
+
+        // the setup continues with the next step, when the current step was completed
+        if ( setup_command_pending_ == details::opcode::no_operation || setup_command_pending_ != code )
+            return;
+
+        setup_command_pending_ = details::opcode::no_operation;
+
+        // the return parameters of a failed command are not valid
+        if ( size < 4 || parameters[ 3 ] != details::status_success )
+            return handle_setup_failure();
+
+        if ( setup_ == setup_step::read_address )
+        {
+            if ( size < 4 + 6 )
+                return handle_setup_failure();
+
+            address_ = bluetoe::link_layer::public_device_address( &parameters[ 4 ] );
+        }
+
+        if ( setup_ == setup_step::read_le_buffer_size )
+        {
+            if ( size < 4 + 3 )
+                return handle_setup_failure();
+
+            handle_buffer_size( bluetoe::details::read_16bit( &parameters[ 4 ] ), parameters[ 6 ] );
+        }
+
+        if ( setup_ == setup_step::read_buffer_size )
+        {
+            if ( size < 4 + 7 )
+                return handle_setup_failure();
+
+            handle_buffer_size( bluetoe::details::read_16bit( &parameters[ 4 ] ), bluetoe::details::read_16bit( &parameters[ 7 ] ) );
+        }
+
+        // a controller without dedicated LE buffers, shares the ACL buffers with BR/EDR
+        const bool dedicated_le_buffers = setup_ == setup_step::read_le_buffer_size && acl_buffers_ != 0;
+
+        setup_          = dedicated_le_buffers
+            ? setup_step::advertising_parameters
+            : static_cast< setup_step >( static_cast< unsigned >( setup_ ) + 1 );
+        setup_attempts_ = 0;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_command_status( const std::uint8_t* parameters, std::size_t size )
+    {
+        if ( size < 4 )
+            return;
+
+        command_credits_ = parameters[ 1 ];
+
+        const auto code = static_cast< details::opcode >( bluetoe::details::read_16bit( &parameters[ 2 ] ) );
+
+        // setup commands are answered with a command complete event, unless the controller rejects the command
+        if ( setup_command_pending_ == details::opcode::no_operation || setup_command_pending_ != code
+          || parameters[ 0 ] == details::status_success )
+            return;
+
+        setup_command_pending_ = details::opcode::no_operation;
+        handle_setup_failure();
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_setup_failure()
+    {
+        // the command of the current step is send again, until it was attempted max_setup_attempts times
+        if ( ++setup_attempts_ == details::max_setup_attempts )
+            setup_ = setup_step::failed;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_buffer_size( std::uint16_t acl_length, std::uint16_t acl_buffers )
+    {
+        acl_length_  = std::max< std::uint16_t >( acl_length, details::min_acl_data_length );
+        acl_buffers_ = acl_buffers;
+        acl_credits_ = acl_buffers;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_number_of_completed_packets( const std::uint8_t* parameters, std::size_t size )
+    {
+        static constexpr std::size_t entry_size = 4;
+
+        if ( size == 0 || size < 1 + parameters[ 0 ] * entry_size )
+            return;
+
+        for ( const std::uint8_t* entry = &parameters[ 1 ]; entry != &parameters[ 1 + parameters[ 0 ] * entry_size ]; entry += entry_size )
+        {
+            if ( connected_ && ( bluetoe::details::read_16bit( entry ) & details::acl_handle_mask ) == connection_handle_ )
+                acl_credits_ = static_cast< std::uint16_t >( std::min< std::size_t >( acl_credits_ + bluetoe::details::read_16bit( entry + 2 ), acl_buffers_ ) );
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_le_meta_event( const std::uint8_t* parameters, std::size_t size )
+    {
+        if ( size == 0 )
+            return;
+
+        if ( static_cast< details::le_subevent_code >( parameters[ 0 ] ) == details::le_subevent_code::connection_complete )
+            handle_connection_complete( parameters + 1, size - 1 );
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_connection_complete( const std::uint8_t* parameters, std::size_t size )
+    {
+        static constexpr std::size_t connection_complete_size = 18;
+
+        if ( size < connection_complete_size || parameters[ 0 ] != 0 )
+            return;
+
+        connected_          = true;
+        connection_handle_  = bluetoe::details::read_16bit( &parameters[ 1 ] ) & details::acl_handle_mask;
+        connection_         = connection_data_t( std::size_t{ mtu } );
+        l2cap_size_         = 0;
+        l2cap_discard_      = false;
+        disconnect_pending_ = false;
+        update_pending_     = false;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_disconnection_complete( const std::uint8_t* parameters, std::size_t size )
+    {
+        if ( size < 4 || parameters[ 0 ] != 0 || !connected_ )
+            return;
+
+        if ( ( bluetoe::details::read_16bit( &parameters[ 1 ] ) & details::acl_handle_mask ) != connection_handle_ )
+            return;
+
+        connected_ = false;
+        server_->client_disconnected( connection_ );
+
+        // the controller flushes all packets of the connection and the buffers are free again
+        acl_credits_    = acl_buffers_;
+        queue_used_     = 0;
+        queued_packets_ = 0;
+
+        // the controller stops advertising, when a connection is established
+        advertise_enable_pending_ = true;
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_acl_data( const std::uint8_t* packet, std::size_t size )
+    {
+        const std::uint16_t handle_flags = bluetoe::details::read_16bit( &packet[ 0 ] );
+        const std::uint16_t length       = bluetoe::details::read_16bit( &packet[ 2 ] );
+        const std::uint8_t* data         = &packet[ details::acl_header_size ];
+        const std::size_t   data_size    = size - details::acl_header_size;
+
+        if ( !connected_ || ( handle_flags & details::acl_handle_mask ) != connection_handle_ )
+            return;
+
+        if ( ( handle_flags & details::acl_packet_boundary ) != details::acl_continuation )
+        {
+            l2cap_size_    = 0;
+            l2cap_discard_ = false;
+
+            // a PDU, that is not fragmented, is handled in place
+            if ( length == data_size && data_size >= details::l2cap_header_size && data_size <= max_l2cap_size
+              && data_size == details::l2cap_header_size + bluetoe::details::read_16bit( &data[ 0 ] ) )
+            {
+                handle_l2cap( data, data_size );
+                return;
+            }
+        }
+
+        // PDUs that do not fit into the MTU are dropped
+        if ( length != data_size || l2cap_discard_ || l2cap_size_ + data_size > max_l2cap_size )
+        {
+            l2cap_discard_ = true;
+            return;
+        }
+
+        std::copy( data, data + data_size, &l2cap_[ l2cap_size_ ] );
+        l2cap_size_ += data_size;
+
+        if ( l2cap_size_ >= details::l2cap_header_size
+          && l2cap_size_ == details::l2cap_header_size + bluetoe::details::read_16bit( &l2cap_[ 0 ] ) )
+        {
+            handle_l2cap( l2cap_, l2cap_size_ );
+            l2cap_size_ = 0;
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::handle_l2cap( const std::uint8_t* pdu, std::size_t size )
+    {
+        static constexpr std::uint8_t pairing_request         = 0x01;
+        static constexpr std::uint8_t pairing_failed          = 0x05;
+        static constexpr std::uint8_t pairing_not_supported   = 0x05;
+
+        const std::uint16_t       channel   = bluetoe::details::read_16bit( &pdu[ 2 ] );
+        const std::uint8_t* const body      = &pdu[ details::l2cap_header_size ];
+        const std::size_t         body_size = size - details::l2cap_header_size;
+
+        if ( body_size == 0 )
+            return;
+
+        // a response has always room in the queue, as notifications leave room for one PDU
+        if ( channel == details::l2cap_att_channel )
+        {
+            std::uint8_t output[ mtu ];
+            std::size_t  out_size = mtu;
+
+            server_->l2cap_input( body, body_size, output, out_size, connection_ );
+
+            if ( out_size )
+                send_l2cap( channel, output, out_size );
+        }
+        else if ( channel == details::l2cap_sm_channel && body[ 0 ] == pairing_request )
+        {
+            const std::uint8_t output[] = { pairing_failed, pairing_not_supported };
+
+            send_l2cap( channel, output, sizeof( output ) );
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    void link_layer< Server, Transport, Options... >::transmit_notifications()
+    {
+        if ( !connected_ )
+            return;
+
+        // keep room for the response to an ATT request
+        while ( free_queue_size() >= 2 * queued_pdu_size )
+        {
+            const auto entry = connection_.dequeue_indication_or_confirmation();
+
+            if ( entry.first == connection_data_t::entry_type::empty )
+                return;
+
+            std::uint8_t output[ mtu ];
+            std::size_t  out_size = connection_.negotiated_mtu();
+
+            if ( entry.first == connection_data_t::entry_type::notification )
+            {
+                server_->notification_output( output, out_size, connection_, entry.second );
+            }
+            else
+            {
+                server_->indication_output( output, out_size, connection_, entry.second );
+
+                // if no output is generate, confirm the indication, or we will wait for ever
+                if ( out_size == 0 )
+                    connection_.indication_confirmed();
+            }
+
+            if ( out_size )
+                send_l2cap( details::l2cap_att_channel, output, out_size );
+        }
+    }
+
+    template < class Server, template < typename > class Transport, typename ... Options >
+    bool link_layer< Server, Transport, Options... >::lcap_notification_callback( const ::bluetoe::details::notification_data& item, void* usr_arg, typename Server::notification_type type )
+    {
+        auto& self = *static_cast< link_layer< Server, Transport, Options... >* >( usr_arg );
+
+        if ( type == Server::confirmation )
+        {
+            self.connection_.indication_confirmed();
+            return true;
+        }
+
+        if ( !self.connected_ )
+            return false;
+
+        return type == Server::indication
+            ? self.connection_.queue_indication( item.client_characteristic_configuration_index() )
+            : self.connection_.queue_notification( item.client_characteristic_configuration_index() );
+    }
+    /** @endcond */
 }
 }
 
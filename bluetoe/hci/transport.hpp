@@ -0,0 +1,44 @@
+#ifndef BLUETOE_HCI_TRANSPORT_HPP
+#define BLUETOE_HCI_TRANSPORT_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace bluetoe {
+namespace hci {
+
+    /*
+     * @brief Type responsible for the byte stream between the HCI link layer and the controller
+     *
+     * The transport carries HCI packets, each preceded by its H4 packet indicator (0x01 command, 0x02 ACL data,
+     * 0x04 event), as used by UART based controllers. The transport is a CRTP base of the link layer and LinkLayer
+     * is the type of the link layer.
+     *
+     * All functions are called from the context of link_layer::run().
+     */
+    template < typename LinkLayer >
+    class transport
+    {
+    public:
+        /**
+         * @brief sends the given bytes to the controller
+         *
+         * The function returns, once all bytes are accepted by the transport. An HCI packet might be passed to
+         * the transport with more than one call to write().
+         */
+        void write( const std::uint8_t* buffer, std::size_t size );
+
+        /**
+         * @brief copies up to size bytes, that where received from the controller, into buffer
+         *
+         * Returns the number of bytes copied. The function must not block and returns 0, if no bytes are
+         * available. link_layer::run() returns, when read() returns 0. The link layer passes the free space of
+         * its receive ring and received bytes are not required to end at a packet boundary.
+         */
+        std::size_t read( std::uint8_t* buffer, std::size_t size );
+    };
+
+}
+}
+
+#endif
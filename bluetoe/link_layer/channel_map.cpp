@@ -6,6 +6,10 @@ namespace link_layer {
 
     channel_map::channel_map()
         : hop_( 0 )
+        , algorithm_2_( false )
+        , used_channels_count_( 0 )
+        , channel_identifier_( 0 )
+        , used_channels_( 0 )
     {
     }
 
@@ -37,7 +41,8 @@ namespace link_layer {
         if ( hop < 5 || hop > 16 )
             return false;
 
-        hop_ = hop;
+        hop_         = hop;
+        algorithm_2_ = false;
 
         std::uint8_t   used_channels[ max_number_of_data_channels ];
         const unsigned used_channels_count = build_used_channel_map( map, used_channels );
@@ -62,17 +67,93 @@ namespace link_layer {
         return true;
     }
 
+    bool channel_map::reset_algorithm_2( const std::uint8_t* map, std::uint32_t access_address )
+    {
+        channel_identifier_ = static_cast< std::uint16_t >( ( access_address >> 16 ) ^ ( access_address & 0xffff ) );
+
+        return reset_used_channels( map );
+    }
+
+    bool channel_map::reset_used_channels( const std::uint8_t* map )
+    {
+        assert( map );
+
+        std::uint8_t   used_channels[ max_number_of_data_channels ];
+        const unsigned used_channels_count = build_used_channel_map( map, used_channels );
+
+        if ( used_channels_count < 2 )
+            return false;
+
+        algorithm_2_         = true;
+        used_channels_count_ = used_channels_count;
+        used_channels_       = 0;
+
+        for ( unsigned index = 0; index != used_channels_count; ++index )
+        {
+            map_[ index ]   = used_channels[ index ];
+            used_channels_ |= std::uint64_t{ 1 } << used_channels[ index ];
+        }
+
+        return true;
+    }
+
     bool channel_map::reset( const std::uint8_t* map )
     {
-        return reset( map, hop_ );
+        return algorithm_2_
+            ? reset_used_channels( map )
+            : reset( map, hop_ );
     }
 
     unsigned channel_map::data_channel( unsigned index ) const
     {
         assert( index < max_number_of_data_channels );
+        assert( !algorithm_2_ );
         return map_[ index ];
     }
 
+    unsigned channel_map::data_channel( unsigned index, std::uint16_t event_counter ) const
+    {
+        return algorithm_2_
+            ? algorithm_2_channel( event_counter )
+            : data_channel( index );
+    }
+
+    bool channel_map::algorithm_2() const
+    {
+        return algorithm_2_;
+    }
+
+    // reverses the bits in both bytes of the given value
+    static std::uint16_t permutate( std::uint16_t v )
+    {
+        v = static_cast< std::uint16_t >( ( ( v >> 1 ) & 0x5555 ) | ( ( v & 0x5555 ) << 1 ) );
+        v = static_cast< std::uint16_t >( ( ( v >> 2 ) & 0x3333 ) | ( ( v & 0x3333 ) << 2 ) );
+
+        return static_cast< std::uint16_t >( ( ( v >> 4 ) & 0x0f0f ) | ( ( v & 0x0f0f ) << 4 ) );
+    }
+
+    // multiply, add, modulo
+    static std::uint16_t mam( std::uint16_t a, std::uint16_t b )
+    {
+        return static_cast< std::uint16_t >( 17 * a + b );
+    }
+
+    unsigned channel_map::algorithm_2_channel( std::uint16_t event_counter ) const
+    {
+        std::uint16_t prn = event_counter ^ channel_identifier_;
+
+        prn = mam( permutate( prn ), channel_identifier_ );
+        prn = mam( permutate( prn ), channel_identifier_ );
+        prn = mam( permutate( prn ), channel_identifier_ );
+        prn = prn ^ channel_identifier_;
+
+        const unsigned unmapped_channel = prn % max_number_of_data_channels;
+
+        return ( used_channels_ >> unmapped_channel ) & 1
+            ? unmapped_channel
+            : map_[ ( used_channels_count_ * prn ) >> 16 ];
+    }
+
 
 }
 }
@@ -35,6 +35,7 @@ namespace link_layer {
         };
 
         struct advertising_type_base {
+            static constexpr std::uint8_t   header_chsel_field          = 0x20;
             static constexpr std::uint8_t   header_txaddr_field         = 0x40;
             static constexpr std::uint8_t   header_rxaddr_field         = 0x80;
             static constexpr std::size_t    advertising_pdu_header_size = 2;
@@ -45,6 +46,7 @@ namespace link_layer {
             static constexpr std::uint8_t   scan_response_pdu_type_code = 4;
             static constexpr std::size_t    address_length              = 6;
             static constexpr std::size_t    maximum_adv_request_size    = 34;
+            static constexpr std::size_t    max_advertising_data_size   = 31;
 
             template < typename Layout >
             static bool is_valid_scan_request( const read_buffer& receive, const device_address& addr )
@@ -159,6 +161,17 @@ namespace link_layer {
             details::advertising_type_meta_type,
             details::valid_link_layer_option_meta_type {};
 
+        template < typename Layout >
+        static constexpr std::size_t maximum_required_advertising_buffer()
+        {
+            using base = details::advertising_type_base;
+
+            // 2 times maximum_adv_send_size, for the advertising data and the advertising response
+            // plus enough memory to store any received request
+            return 2 * Layout::data_channel_pdu_memory_size( base::max_advertising_data_size + base::address_length )
+                     + Layout::data_channel_pdu_memory_size( base::maximum_adv_request_size );
+        }
+
         template < typename LinkLayer, typename >
         class impl : protected details::advertising_type_base
         {
@@ -171,7 +184,8 @@ namespace link_layer {
                 // prevent assert() in layout_t::body
                 adv_size_ = address_length;
 
-                std::uint16_t header = adv_ind_pdu_type_code;
+                // support for channel selection algorithm #2
+                std::uint16_t header = adv_ind_pdu_type_code | header_chsel_field;
                 std::uint8_t* body   = layout_t::body( advertising_buffer() ).first;
 
                 if ( addr.is_random() )
@@ -224,17 +238,12 @@ namespace link_layer {
 
             static constexpr std::size_t maximum_required_advertising_buffer()
             {
-                using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
-
-                // 2 times maximum_adv_send_size, for the advertising data and the advertising response
-                // plus enough memory to store any received request
-                return 2 * layout_t::data_channel_pdu_memory_size( maximum_adv_send_size )
-                         + layout_t::data_channel_pdu_memory_size( maximum_adv_request_size );
+                return connectable_undirected_advertising::maximum_required_advertising_buffer<
+                    typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout >();
             }
 
         private:
 
-            static constexpr std::size_t    max_advertising_data_size   = 31;
             static constexpr std::size_t    maximum_adv_send_size       = max_advertising_data_size + address_length;
 
             void fill_advertising_response_data()
@@ -318,6 +327,16 @@ namespace link_layer {
             details::advertising_type_meta_type,
             details::valid_link_layer_option_meta_type {};
 
+        template < typename Layout >
+        static constexpr std::size_t maximum_required_advertising_buffer()
+        {
+            using base = details::advertising_type_base;
+
+            // the advertising PDU contains the advertiser's and the initiator's address
+            return Layout::data_channel_pdu_memory_size( 2 * base::address_length )
+                 + Layout::data_channel_pdu_memory_size( base::maximum_adv_request_size );
+        }
+
         template < typename LinkLayer, typename Advertising >
         class impl : protected details::advertising_type_base
         {
@@ -362,7 +381,7 @@ namespace link_layer {
                 using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
 
                 std::uint8_t* const adv_data = advertising_buffer().buffer;
-                std::uint16_t header = adv_direct_ind_pdu_type_code;
+                std::uint16_t header = adv_direct_ind_pdu_type_code | header_chsel_field;
 
                 if ( addr.is_random() )
                     header |= header_txaddr_field;
@@ -412,10 +431,8 @@ namespace link_layer {
 
             static constexpr std::size_t maximum_required_advertising_buffer()
             {
-                using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
-
-                return layout_t::data_channel_pdu_memory_size( max_advertising_data_size )
-                     + layout_t::data_channel_pdu_memory_size( maximum_adv_request_size );
+                return connectable_directed_advertising::maximum_required_advertising_buffer<
+                    typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout >();
             }
 
         private:
@@ -474,6 +491,15 @@ namespace link_layer {
             details::advertising_type_meta_type,
             details::valid_link_layer_option_meta_type {};
 
+        template < typename Layout >
+        static constexpr std::size_t maximum_required_advertising_buffer()
+        {
+            using base = details::advertising_type_base;
+
+            return 2 * Layout::data_channel_pdu_memory_size( base::max_advertising_data_size + base::address_length )
+                     + Layout::data_channel_pdu_memory_size( base::maximum_adv_request_size );
+        }
+
         template < typename LinkLayer, typename >
         class impl : protected details::advertising_type_base
         {
@@ -536,14 +562,11 @@ namespace link_layer {
 
             static constexpr std::size_t maximum_required_advertising_buffer()
             {
-                using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
-
-                return 2 * layout_t::data_channel_pdu_memory_size( maximum_adv_send_size )
-                         + layout_t::data_channel_pdu_memory_size( maximum_adv_request_size );
+                return scannable_undirected_advertising::maximum_required_advertising_buffer<
+                    typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout >();
             }
 
         private:
-            static constexpr std::size_t    max_advertising_data_size   = 31;
             static constexpr std::size_t    maximum_adv_send_size       = max_advertising_data_size + address_length;
 
             void fill_advertising_response_data()
@@ -613,6 +636,14 @@ namespace link_layer {
             details::advertising_type_meta_type,
             details::valid_link_layer_option_meta_type {};
 
+        template < typename Layout >
+        static constexpr std::size_t maximum_required_advertising_buffer()
+        {
+            using base = details::advertising_type_base;
+
+            return Layout::data_channel_pdu_memory_size( base::max_advertising_data_size + base::address_length );
+        }
+
         template < typename LinkLayer, typename >
         class impl : protected details::advertising_type_base
         {
@@ -669,14 +700,11 @@ namespace link_layer {
 
             static constexpr std::size_t maximum_required_advertising_buffer()
             {
-                using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
-
-                return layout_t::data_channel_pdu_memory_size( max_advertising_data_size + address_length );
+                return non_connectable_undirected_advertising::maximum_required_advertising_buffer<
+                    typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout >();
             }
 
         private:
-            static constexpr std::size_t    max_advertising_data_size   = 31;
-
             read_buffer advertising_buffer()
             {
                 return read_buffer{ link_layer().raw(), adv_size_ };
@@ -1312,6 +1340,41 @@ namespace link_layer {
             unsigned proposal_;
         };
 
+        /*
+         * Buffer required by the given advertising types, for the given PDU layout. In contrast to
+         * advertiser::maximum_required_advertising_buffer(), this does not depend on the link layer.
+         */
+        template < typename Layout, typename Types >
+        struct max_required_advertising_buffer;
+
+        template < typename Layout >
+        struct max_required_advertising_buffer< Layout, std::tuple<> >
+        {
+            static constexpr std::size_t value = 0;
+        };
+
+        template < typename Layout, typename Type, typename ... Types >
+        struct max_required_advertising_buffer< Layout, std::tuple< Type, Types... > >
+        {
+            static constexpr std::size_t own  = Type::template maximum_required_advertising_buffer< Layout >();
+            static constexpr std::size_t next = max_required_advertising_buffer< Layout, std::tuple< Types... > >::value;
+
+            static constexpr std::size_t value = own > next ? own : next;
+        };
+
+        template < typename Layout, typename ... Options >
+        struct required_advertising_buffer
+        {
+            using types = typename bluetoe::details::find_all_by_meta_type< advertising_type_meta_type, Options... >::type;
+
+            static constexpr std::size_t value = max_required_advertising_buffer<
+                Layout,
+                typename bluetoe::details::select_type<
+                    std::tuple_size< types >::value == 0,
+                    std::tuple< connectable_undirected_advertising >,
+                    types >::type >::value;
+        };
+
         /** @cond HIDDEN_SYMBOLS */
         template < typename LinkLayer, typename ... Options >
         using select_advertiser_implementation =
@@ -8,6 +8,11 @@ namespace link_layer {
 
     /**
      * @brief map that keeps track of the list of used channels and calculates the next channel based on the last used channel
+     *
+     * Two channel selection algorithms are supported: the hop increment based algorithm #1 (Vol 6, Part B, 4.5.8.2)
+     * and the event counter based algorithm #2 (Vol 6, Part B, 4.5.8.3), that was introduced with Bluetooth 5.0.
+     * For algorithm #1, the hop sequence is precomputed. For algorithm #2, the list of used channels is precomputed
+     * so that calculating a channel takes constant time.
      */
     class channel_map
     {
@@ -24,9 +29,17 @@ namespace link_layer {
         bool reset( const std::uint8_t* map, const unsigned hop );
 
         /**
-         * @brief sets a new list of used channels and keeps the old hop value.
+         * @brief sets a new list of used channels and selects channel selection algorithm #2
          *
-         * @pre reset( const std::uint8_t* map, const unsigned hop ) must have been called before, to have an old hop value
+         * The channel identifier is derived from the access address of the connection.
+         * The function returns true, if the given map contains at least 2 channels.
+         */
+        bool reset_algorithm_2( const std::uint8_t* map, std::uint32_t access_address );
+
+        /**
+         * @brief sets a new list of used channels and keeps the selected algorithm and the old hop value / channel identifier.
+         *
+         * @pre reset( const std::uint8_t* map, const unsigned hop ) or reset_algorithm_2() must have been called before
          */
         bool reset( const std::uint8_t* map );
 
@@ -34,18 +47,38 @@ namespace link_layer {
          * the BLE channel hop sequence is 37 entries long, after 37 hops, the sequence starts again.
          * This function returns the entries in this sequence. The channel for the first entry is given
          * by calling the function with index = 0, the last entry with index = max_number_of_data_channels -1
+         *
+         * @pre channel selection algorithm #1 is selected
          */
         unsigned data_channel( unsigned index ) const;
 
+        /**
+         * @brief returns the channel for the connection event with the given index in the hop sequence
+         *        and the given connection event counter, using the selected algorithm.
+         */
+        unsigned data_channel( unsigned index, std::uint16_t event_counter ) const;
+
+        /**
+         * @brief returns true, if channel selection algorithm #2 is selected
+         */
+        bool algorithm_2() const;
+
         /**
          * the number of channels, used as data channel.
          */
         static constexpr unsigned max_number_of_data_channels = 37;
     private:
         unsigned build_used_channel_map( const std::uint8_t* map, std::uint8_t* used ) const;
+        bool reset_used_channels( const std::uint8_t* map );
+        unsigned algorithm_2_channel( std::uint16_t event_counter ) const;
 
-        std::uint8_t map_[ max_number_of_data_channels ];
-        std::uint8_t hop_;
+        // algorithm #1: the hop sequence; algorithm #2: the used channels in ascending order
+        std::uint8_t  map_[ max_number_of_data_channels ];
+        std::uint8_t  hop_;
+        bool          algorithm_2_;
+        std::uint8_t  used_channels_count_;
+        std::uint16_t channel_identifier_;
+        std::uint64_t used_channels_;
     };
 }
 }
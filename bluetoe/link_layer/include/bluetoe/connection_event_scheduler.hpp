@@ -0,0 +1,493 @@
+#ifndef BLUETOE_LINK_LAYER_CONNECTION_EVENT_SCHEDULER_HPP
+#define BLUETOE_LINK_LAYER_CONNECTION_EVENT_SCHEDULER_HPP
+
+#include <bluetoe/delta_time.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+namespace bluetoe {
+namespace link_layer {
+
+    /**
+     * @brief radio usage of a single connection of a link layer with more than one connection
+     *
+     * @sa link_layer::connection_utilisation
+     */
+    struct link_utilisation
+    {
+        /**
+         * number of connection events that where handed to the radio since the connection was established
+         */
+        std::uint32_t   scheduled_events;
+
+        /**
+         * number of connection events that where skipped, because they collided with the connection events
+         * of other connections or with advertising
+         */
+        std::uint32_t   skipped_events;
+
+        /**
+         * share of the radio time in 1/1000, that is reserved for the connection with the current connection interval
+         */
+        std::uint32_t   reserved_per_mille;
+    };
+
+namespace details {
+
+    /*
+     * Arbitrates the radio between the connections and the advertising of a link layer with more than one connection.
+     *
+     * The radio executes one activity at a time and all times passed to the radio are relative to the radio's
+     * anchor T0, that moves with every advertising event and with every connection event, in which a PDU was
+     * received. The link layer calculates the connection event windows of a connection relative to the
+     * connection's last anchor. The scheduler keeps track of the time, that elapsed since the last anchor of every
+     * connection and converts the windows to times relative to T0.
+     *
+     * The next activity is the connection event with the earliest window. Advertising is scheduled, when it fits
+     * in before that window. A connection event, whose window starts before the radio is available again, is
+     * missed and has to be handled like a connection event without any received PDU.
+     *
+     * If the earliest connection event collides with the connection event of an other connection, one of both is
+     * skipped: Connections that can skip an event within their slave latency are skipped first. If both can, the
+     * connection, whose latest anchor within its slave latency is predicted later, is skipped. Otherwise the
+     * connection with the most time left until its supervision timeout is skipped. As every skipped event brings
+     * a connection closer to its supervision timeout, connections with permanently colliding anchors take turns.
+     */
+    template < std::size_t Connections >
+    class connection_event_scheduler
+    {
+    public:
+        static constexpr std::size_t    no_connection            = Connections;
+
+        // time reserved for a single advertising PDU and a possible response
+        static constexpr std::uint32_t  advertising_slot_us      = 1250;
+
+        // minimum time reserved for a connection event, starting at the anchor
+        static constexpr std::uint32_t  connection_event_slot_us = 1250;
+
+        enum class activity_type {
+            idle,
+            advertising,
+            connection_event,
+            missed_connection_event
+        };
+
+        struct activity {
+            activity_type   type;
+            std::size_t     connection;
+            // start and end of the activity relative to T0
+            delta_time      start;
+            delta_time      end;
+        };
+
+        connection_event_scheduler();
+
+        /*
+         * a new connection was established; the connection's anchor is the current T0
+         */
+        void add_connection( std::size_t connection );
+
+        /*
+         * the connection was closed; a pending connection event of the connection is removed
+         */
+        void remove_connection( std::size_t connection );
+
+        /*
+         * the next connection event window of the given connection, relative to the connection's last anchor
+         */
+        void connection_event( std::size_t connection, delta_time window_start, delta_time window_end );
+
+        /*
+         * the current timing parameters of the given connection. Without parameters, a connection has the
+         * lowest priority and can not skip events within a slave latency.
+         */
+        void connection_parameters( std::size_t connection, delta_time interval, std::uint16_t slave_latency, delta_time supervision_timeout );
+
+        /*
+         * time it takes the given connection to exchange a pair of PDUs of the currently negotiated size on the
+         * currently used PHYs. The time reserved for a connection event is at least connection_event_slot_us.
+         */
+        void connection_event_length( std::size_t connection, delta_time length );
+
+        /*
+         * predicted anchor of the given connection, `events` connection events after its pending connection event,
+         * relative to T0.
+         *
+         * @pre the connection has a pending connection event
+         */
+        delta_time predicted_anchor( std::size_t connection, unsigned events ) const;
+
+        /*
+         * predicted anchor of the last connection event of the given connection, up to which the connection can
+         * skip events within its slave latency, relative to T0.
+         *
+         * @pre the connection has a pending connection event
+         */
+        delta_time latest_anchor( std::size_t connection ) const;
+
+        /*
+         * radio usage of the given connection
+         */
+        link_utilisation utilisation( std::size_t connection ) const;
+
+        /*
+         * the connection event handed to the radio last was closed and anchor_offset is the offset
+         * from the start of the receive window to the new anchor.
+         */
+        void connection_event_closed( delta_time anchor_offset );
+
+        /*
+         * the connection event handed to the radio last timed out without receiving a PDU
+         */
+        void connection_event_timeout();
+
+        /*
+         * advertising was requested, `when` after the last advertising event
+         */
+        void request_advertising( delta_time when );
+        void cancel_advertising();
+        bool advertising_requested() const;
+
+        /*
+         * returns the activity that is due next. A result of type missed_connection_event has to be
+         * handled before the next call to next_activity().
+         */
+        activity next_activity() const;
+
+        /*
+         * to be called, with the result of next_activity(), when the activity was handed to the radio or
+         * when the missed connection event was handled.
+         */
+        void activity_scheduled( const activity& );
+
+        /*
+         * connection of the last connection event handed to the radio
+         */
+        std::size_t scheduled_connection() const;
+
+    private:
+        void move_anchor( delta_time offset );
+        bool collides( std::size_t first, std::size_t second ) const;
+        bool skip_first( std::size_t first, std::size_t second ) const;
+        bool can_skip( std::size_t connection ) const;
+        delta_time supervision_margin( std::size_t connection ) const;
+
+        bool            pending_[ Connections ];
+        delta_time      elapsed_[ Connections ];
+        delta_time      window_start_[ Connections ];
+        delta_time      window_end_[ Connections ];
+
+        delta_time      interval_[ Connections ];
+        std::uint16_t   slave_latency_[ Connections ];
+        delta_time      supervision_timeout_[ Connections ];
+        delta_time      event_length_[ Connections ];
+        std::uint16_t   skipped_in_row_[ Connections ];
+
+        std::uint32_t   scheduled_events_[ Connections ];
+        std::uint32_t   skipped_events_[ Connections ];
+
+        bool            advertising_requested_;
+        delta_time      advertising_when_;
+        delta_time      since_advertising_;
+
+        // radio is busy until this time, relative to T0
+        delta_time      busy_until_;
+
+        std::size_t     scheduled_;
+        delta_time      scheduled_start_;
+        delta_time      scheduled_end_;
+    };
+
+    // implementation
+    template < std::size_t Connections >
+    connection_event_scheduler< Connections >::connection_event_scheduler()
+        : advertising_requested_( false )
+        , scheduled_( no_connection )
+    {
+        for ( auto& pending : pending_ )
+            pending = false;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::add_connection( std::size_t connection )
+    {
+        assert( connection < Connections );
+
+        pending_[ connection ]             = false;
+        elapsed_[ connection ]             = delta_time();
+        interval_[ connection ]            = delta_time();
+        slave_latency_[ connection ]       = 0;
+        supervision_timeout_[ connection ] = delta_time();
+        event_length_[ connection ]        = delta_time( connection_event_slot_us );
+        skipped_in_row_[ connection ]      = 0;
+        scheduled_events_[ connection ]    = 0;
+        skipped_events_[ connection ]      = 0;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::remove_connection( std::size_t connection )
+    {
+        assert( connection < Connections );
+
+        pending_[ connection ] = false;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::connection_event( std::size_t connection, delta_time window_start, delta_time window_end )
+    {
+        assert( connection < Connections );
+        assert( window_start <= window_end );
+
+        pending_[ connection ]      = true;
+        window_start_[ connection ] = window_start;
+        window_end_[ connection ]   = window_end;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::connection_parameters( std::size_t connection, delta_time interval, std::uint16_t slave_latency, delta_time supervision_timeout )
+    {
+        assert( connection < Connections );
+
+        interval_[ connection ]            = interval;
+        slave_latency_[ connection ]       = slave_latency;
+        supervision_timeout_[ connection ] = supervision_timeout;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::connection_event_length( std::size_t connection, delta_time length )
+    {
+        assert( connection < Connections );
+
+        event_length_[ connection ] = length < delta_time( connection_event_slot_us )
+            ? delta_time( connection_event_slot_us )
+            : length;
+    }
+
+    template < std::size_t Connections >
+    delta_time connection_event_scheduler< Connections >::predicted_anchor( std::size_t connection, unsigned events ) const
+    {
+        assert( connection < Connections );
+        assert( pending_[ connection ] );
+
+        const delta_time window_start = window_start_[ connection ] + interval_[ connection ] * events;
+
+        return window_start > elapsed_[ connection ]
+            ? window_start - elapsed_[ connection ]
+            : delta_time();
+    }
+
+    template < std::size_t Connections >
+    delta_time connection_event_scheduler< Connections >::latest_anchor( std::size_t connection ) const
+    {
+        assert( connection < Connections );
+
+        const unsigned skippable = can_skip( connection )
+            ? slave_latency_[ connection ] - skipped_in_row_[ connection ]
+            : 0;
+
+        return predicted_anchor( connection, skippable );
+    }
+
+    template < std::size_t Connections >
+    link_utilisation connection_event_scheduler< Connections >::utilisation( std::size_t connection ) const
+    {
+        assert( connection < Connections );
+
+        const std::uint32_t interval = interval_[ connection ].usec();
+
+        return link_utilisation{
+            scheduled_events_[ connection ],
+            skipped_events_[ connection ],
+            interval == 0 ? 0 : ( event_length_[ connection ].usec() * 1000 + interval - 1 ) / interval
+        };
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::connection_event_closed( delta_time anchor_offset )
+    {
+        assert( scheduled_ != no_connection );
+
+        move_anchor( scheduled_start_ + anchor_offset );
+
+        elapsed_[ scheduled_ ] = delta_time();
+        busy_until_            = event_length_[ scheduled_ ];
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::connection_event_timeout()
+    {
+        assert( scheduled_ != no_connection );
+
+        // T0 stays where it was, but the radio was busy until the end of the receive window
+        busy_until_ = scheduled_end_;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::request_advertising( delta_time when )
+    {
+        advertising_requested_ = true;
+        advertising_when_      = when;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::cancel_advertising()
+    {
+        advertising_requested_ = false;
+    }
+
+    template < std::size_t Connections >
+    bool connection_event_scheduler< Connections >::advertising_requested() const
+    {
+        return advertising_requested_;
+    }
+
+    template < std::size_t Connections >
+    typename connection_event_scheduler< Connections >::activity connection_event_scheduler< Connections >::next_activity() const
+    {
+        activity next{ activity_type::idle, no_connection, delta_time(), delta_time() };
+
+        for ( std::size_t connection = 0; connection != Connections; ++connection )
+        {
+            if ( !pending_[ connection ] )
+                continue;
+
+            if ( window_start_[ connection ] < elapsed_[ connection ] + busy_until_ )
+                return activity{ activity_type::missed_connection_event, connection, delta_time(), delta_time() };
+
+            const delta_time start = window_start_[ connection ] - elapsed_[ connection ];
+
+            if ( next.type == activity_type::idle || start < next.start )
+                next = activity{ activity_type::connection_event, connection, start, window_end_[ connection ] - elapsed_[ connection ] };
+        }
+
+        if ( next.type == activity_type::connection_event )
+        {
+            for ( std::size_t connection = 0; connection != Connections; ++connection )
+            {
+                if ( connection != next.connection && pending_[ connection ]
+                  && collides( next.connection, connection ) && skip_first( next.connection, connection ) )
+                {
+                    return activity{ activity_type::missed_connection_event, next.connection, delta_time(), delta_time() };
+                }
+            }
+        }
+
+        if ( advertising_requested_ )
+        {
+            delta_time start = advertising_when_ > since_advertising_
+                ? advertising_when_ - since_advertising_
+                : delta_time();
+
+            if ( start < busy_until_ )
+                start = busy_until_;
+
+            const delta_time end = start + delta_time( advertising_slot_us );
+
+            if ( next.type == activity_type::idle || end <= next.start )
+                next = activity{ activity_type::advertising, no_connection, start, end };
+        }
+
+        return next;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::activity_scheduled( const activity& scheduled )
+    {
+        if ( scheduled.type == activity_type::advertising )
+        {
+            move_anchor( scheduled.start );
+
+            advertising_requested_ = false;
+            since_advertising_     = delta_time();
+            busy_until_            = delta_time( advertising_slot_us );
+            scheduled_             = no_connection;
+        }
+        else if ( scheduled.type == activity_type::connection_event )
+        {
+            pending_[ scheduled.connection ] = false;
+            scheduled_       = scheduled.connection;
+            scheduled_start_ = scheduled.start;
+            scheduled_end_   = scheduled.end;
+
+            skipped_in_row_[ scheduled.connection ] = 0;
+            ++scheduled_events_[ scheduled.connection ];
+        }
+        else if ( scheduled.type == activity_type::missed_connection_event )
+        {
+            pending_[ scheduled.connection ] = false;
+
+            ++skipped_in_row_[ scheduled.connection ];
+            ++skipped_events_[ scheduled.connection ];
+        }
+    }
+
+    template < std::size_t Connections >
+    std::size_t connection_event_scheduler< Connections >::scheduled_connection() const
+    {
+        return scheduled_;
+    }
+
+    template < std::size_t Connections >
+    void connection_event_scheduler< Connections >::move_anchor( delta_time offset )
+    {
+        for ( auto& elapsed : elapsed_ )
+            elapsed += offset;
+
+        // saturate, so that a long time without advertising does not wrap around
+        since_advertising_ = since_advertising_ + offset < since_advertising_
+            ? delta_time( ~std::uint32_t( 0 ) )
+            : since_advertising_ + offset;
+
+        busy_until_ = busy_until_ > offset
+            ? busy_until_ - offset
+            : delta_time();
+    }
+
+    template < std::size_t Connections >
+    bool connection_event_scheduler< Connections >::collides( std::size_t first, std::size_t second ) const
+    {
+        // the anchor of the first connection can be anywhere in its window, so the connection event occupies the
+        // radio until a whole event length after the end of the window
+        return window_start_[ second ] - elapsed_[ second ] < window_end_[ first ] - elapsed_[ first ] + event_length_[ first ];
+    }
+
+    template < std::size_t Connections >
+    bool connection_event_scheduler< Connections >::skip_first( std::size_t first, std::size_t second ) const
+    {
+        if ( can_skip( first ) != can_skip( second ) )
+            return can_skip( first );
+
+        // both can skip: the connection, that can wait longer for the next event, it has to take part in, is skipped
+        if ( can_skip( first ) && latest_anchor( first ) != latest_anchor( second ) )
+            return latest_anchor( second ) < latest_anchor( first );
+
+        return supervision_margin( second ) < supervision_margin( first );
+    }
+
+    template < std::size_t Connections >
+    bool connection_event_scheduler< Connections >::can_skip( std::size_t connection ) const
+    {
+        return skipped_in_row_[ connection ] < slave_latency_[ connection ];
+    }
+
+    template < std::size_t Connections >
+    delta_time connection_event_scheduler< Connections >::supervision_margin( std::size_t connection ) const
+    {
+        // without timing parameters, there is no known timeout
+        if ( supervision_timeout_[ connection ].zero() )
+            return delta_time( ~std::uint32_t( 0 ) );
+
+        const delta_time since_anchor = elapsed_[ connection ] + window_end_[ connection ];
+
+        return supervision_timeout_[ connection ] > since_anchor
+            ? supervision_timeout_[ connection ] - since_anchor
+            : delta_time();
+    }
+
+}
+}
+}
+
+#endif
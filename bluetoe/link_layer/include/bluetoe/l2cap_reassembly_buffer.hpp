@@ -0,0 +1,143 @@
+#ifndef BLUETOE_LINK_LAYER_L2CAP_REASSEMBLY_BUFFER_HPP
+#define BLUETOE_LINK_LAYER_L2CAP_REASSEMBLY_BUFFER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace bluetoe {
+namespace link_layer {
+namespace details {
+
+    /**
+     * @brief buffer to reassemble an L2CAP PDU, that was fragmented over more than one LL data PDU
+     *
+     * The first fragment (LLID 0b10) contains the L2CAP header and thus, the size of the whole L2CAP PDU.
+     * All following fragments (LLID 0b01) are appended, until the L2CAP PDU is complete.
+     *
+     * @param Size the maximum size of an L2CAP PDU (including the L2CAP header) that can be reassembled.
+     */
+    template < std::size_t Size >
+    class l2cap_reassembly_buffer
+    {
+    public:
+        static constexpr std::size_t header_size = 4;
+
+        static_assert( Size >= header_size, "buffer must at least hold the L2CAP header" );
+
+        /**
+         * @brief constructs an empty buffer
+         *
+         * @post !complete()
+         */
+        l2cap_reassembly_buffer();
+
+        /**
+         * @brief starts a new L2CAP PDU with the given start fragment
+         *
+         * A partly reassembled PDU gets discarded. If the L2CAP PDU does not fit into the buffer, it is dropped
+         * and all following continuation fragments are ignored.
+         *
+         * @pre end - begin >= header_size
+         */
+        void start( const std::uint8_t* begin, const std::uint8_t* end );
+
+        /**
+         * @brief appends the given continuation fragment
+         *
+         * Returns false, if the fragment exceeds the size of the L2CAP PDU given in the start fragment.
+         * Fragments without a preceding start fragment are ignored.
+         */
+        bool add( const std::uint8_t* begin, const std::uint8_t* end );
+
+        /**
+         * @brief returns true, if all fragments of the L2CAP PDU were received
+         */
+        bool complete() const;
+
+        /**
+         * @brief the reassembled L2CAP PDU, starting with the L2CAP header
+         *
+         * @pre complete()
+         */
+        const std::uint8_t* pdu() const;
+
+        /**
+         * @brief discard the current content
+         *
+         * @post !complete()
+         */
+        void reset();
+
+    private:
+        std::uint8_t    buffer_[ Size ];
+        std::size_t     expected_;
+        std::size_t     received_;
+    };
+
+    // implementation
+    template < std::size_t Size >
+    l2cap_reassembly_buffer< Size >::l2cap_reassembly_buffer()
+    {
+        reset();
+    }
+
+    template < std::size_t Size >
+    void l2cap_reassembly_buffer< Size >::start( const std::uint8_t* begin, const std::uint8_t* end )
+    {
+        const std::size_t expected = header_size + ( begin[ 0 ] | ( begin[ 1 ] << 8 ) );
+        const std::size_t size     = end - begin;
+
+        if ( expected > Size || size > expected )
+            return reset();
+
+        std::copy( begin, end, &buffer_[ 0 ] );
+        expected_ = expected;
+        received_ = size;
+    }
+
+    template < std::size_t Size >
+    bool l2cap_reassembly_buffer< Size >::add( const std::uint8_t* begin, const std::uint8_t* end )
+    {
+        // nothing to reassemble
+        if ( received_ == expected_ )
+            return true;
+
+        const std::size_t size = end - begin;
+
+        if ( size > expected_ - received_ )
+        {
+            reset();
+            return false;
+        }
+
+        std::copy( begin, end, &buffer_[ received_ ] );
+        received_ += size;
+
+        return true;
+    }
+
+    template < std::size_t Size >
+    bool l2cap_reassembly_buffer< Size >::complete() const
+    {
+        return expected_ != 0 && received_ == expected_;
+    }
+
+    template < std::size_t Size >
+    const std::uint8_t* l2cap_reassembly_buffer< Size >::pdu() const
+    {
+        return &buffer_[ 0 ];
+    }
+
+    template < std::size_t Size >
+    void l2cap_reassembly_buffer< Size >::reset()
+    {
+        expected_ = 0;
+        received_ = 0;
+    }
+
+}
+}
+}
+
+#endif
@@ -7,9 +7,15 @@
 #include <bluetoe/address.hpp>
 #include <bluetoe/channel_map.hpp>
 #include <bluetoe/notification_queue.hpp>
+#include <bluetoe/notification_snapshots.hpp>
 #include <bluetoe/connection_callbacks.hpp>
 #include <bluetoe/connection_event_callback.hpp>
+#include <bluetoe/connection_event_scheduler.hpp>
 #include <bluetoe/l2cap_signaling_channel.hpp>
+#include <bluetoe/l2cap_reassembly_buffer.hpp>
+#include <bluetoe/pending_procedures.hpp>
+#include <bluetoe/ll_data_pdu_buffer.hpp>
+#include <bluetoe/phy_encodings.hpp>
 #include <bluetoe/white_list.hpp>
 #include <bluetoe/advertising.hpp>
 #include <bluetoe/attribute.hpp>
@@ -30,19 +36,6 @@ namespace bluetoe {
 namespace link_layer {
 
     namespace details {
-        template < typename ... Options >
-        struct buffer_sizes
-        {
-            typedef typename ::bluetoe::details::find_by_meta_type<
-                buffer_sizes_meta_type,
-                Options...,
-                ::bluetoe::link_layer::buffer_sizes<>  // default
-            >::type s_type;
-
-            static constexpr std::size_t tx_size = s_type::transmit_buffer_size;
-            static constexpr std::size_t rx_size = s_type::receive_buffer_size;
-        };
-
         template < typename Server, typename ... Options >
         struct security_manager {
             using default_sm = typename bluetoe::details::select_type<
@@ -57,6 +50,14 @@ namespace link_layer {
                 default_sm >::type;
         };
 
+        /*
+         * Security managers are defined independently of the link layer, but are valid link layer options.
+         */
+        template < class Option >
+        struct invalid_link_layer_option : std::integral_constant< bool,
+            !std::is_convertible< typename bluetoe::details::extract_meta_type< Option >::type*, valid_link_layer_option_meta_type* >::value
+         && !std::is_convertible< typename bluetoe::details::extract_meta_type< Option >::type*, bluetoe::details::security_manager_meta_type* >::value > {};
+
         template < typename ... Options >
         struct signaling_channel {
             typedef typename bluetoe::details::find_by_meta_type<
@@ -75,6 +76,102 @@ namespace link_layer {
             static constexpr std::size_t mtu = type::mtu;
         };
 
+        template < typename ... Options >
+        struct notifications_per_event {
+            typedef typename bluetoe::details::find_by_meta_type<
+                notifications_per_event_meta_type,
+                Options...,
+                max_notifications_per_event< ~0u > >::type type;
+
+            static constexpr unsigned max_notifications = type::max_notifications;
+        };
+
+        template < typename ... Options >
+        struct number_of_connections {
+            typedef typename bluetoe::details::find_by_meta_type<
+                max_connections_meta_type,
+                Options...,
+                max_connections< 1 > >::type type;
+
+            static constexpr unsigned connections = type::connections;
+        };
+
+        /*
+         * Minimum and recommended buffer sizes, derived from the server, the PDU layout of the radio and the
+         * link layer options (see auto_buffer_sizes)
+         */
+        template < typename Layout, typename Server, typename ... Options >
+        struct buffer_requirements
+        {
+            static constexpr std::size_t l2cap_header_size = 4;
+            static constexpr std::size_t min_payload_size  = 27;
+            // the link layer supports PDUs of up to 251 bytes, including the LL header
+            static constexpr std::size_t max_payload_size  = 249;
+
+            static constexpr std::size_t mtu           = mtu_size< Options... >::mtu;
+            static constexpr std::size_t l2cap_size    = mtu + l2cap_header_size;
+            static constexpr std::size_t payload_size  = l2cap_size < max_payload_size ? l2cap_size : max_payload_size;
+
+            /*
+             * memory to transmit an L2CAP PDU of MTU size. Without an extended data length, the PDU is fragmented
+             * into PDUs of min_payload_size; larger fragments never need more memory, as the last fragment is
+             * only allocated with the size it actually uses.
+             */
+            static constexpr std::size_t l2cap_memory  =
+                ( l2cap_size + min_payload_size - 1 ) / min_payload_size * Layout::data_channel_pdu_memory_size( min_payload_size );
+
+            // number of notifications and indications, that can be queued at the same time
+            static constexpr std::size_t client_configs      = Server::number_of_client_configs;
+            static constexpr std::size_t max_notifications   = notifications_per_event< Options... >::max_notifications;
+            static constexpr std::size_t notification_fan_in =
+                client_configs < max_notifications ? client_configs : max_notifications;
+
+            // the advertising uses the memory of both buffers
+            static constexpr std::size_t advertising_size = required_advertising_buffer< Layout, Options... >::value;
+
+            /*
+             * A single PDU can always be allocated. An L2CAP PDU, that has to be fragmented or that requires an
+             * extended data length, is limited to half of the transmit buffer, as an empty ring buffer can be
+             * split anywhere (and there must be one byte left to not overflow the ring). With less memory, an
+             * L2CAP PDU of MTU size can not be transmitted, unless the data length was extended.
+             */
+            static constexpr std::size_t minimum_transmit_size = l2cap_size <= min_payload_size
+                ? Layout::data_channel_pdu_memory_size( min_payload_size )
+                : 2 * l2cap_memory + 1;
+
+            static constexpr std::size_t minimum_receive_size  = Layout::data_channel_pdu_memory_size( min_payload_size );
+
+            /*
+             * Room for a notification or indication of MTU size per characteristic (but at least for two PDUs) and
+             * for two received PDUs of the maximum useful data length.
+             */
+            static constexpr std::size_t recommended_transmit_size =
+                ( notification_fan_in > 2 ? notification_fan_in : 2 ) * l2cap_memory + 1;
+
+            static constexpr std::size_t recommended_receive_size  =
+                recommended_transmit_size + 2 * Layout::data_channel_pdu_memory_size( payload_size ) + 1 < advertising_size
+                    ? advertising_size - recommended_transmit_size
+                    : 2 * Layout::data_channel_pdu_memory_size( payload_size ) + 1;
+        };
+
+        template < typename Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename LinkLayer, typename ... Options >
+        struct buffer_sizes
+        {
+            typedef typename ::bluetoe::details::find_by_meta_type<
+                buffer_sizes_meta_type,
+                Options...,
+                ::bluetoe::link_layer::buffer_sizes<>  // default
+            >::type s_type;
+
+            // the PDU layout of a radio does not depend on the buffer sizes
+            using layout = typename pdu_layout_by_radio< ScheduledRadio< 0, 0, LinkLayer > >::pdu_layout;
+            using requirements = buffer_requirements< layout, Server, Options... >;
+            using sizes = typename s_type::template impl< requirements >;
+
+            static constexpr std::size_t tx_size = sizes::transmit_buffer_size;
+            static constexpr std::size_t rx_size = sizes::receive_buffer_size;
+        };
+
         template < typename Server, typename ... Options >
         struct connection_callbacks
         {
@@ -137,7 +234,7 @@ namespace link_layer {
                               std::uint32_t ivs  = 0;
 
                         bluetoe::details::uint128_t key;
-                        std::tie( has_key_, key ) = that().connection_details_.find_key( ediv, rand );
+                        std::tie( has_key_, key ) = static_cast< typename LinkLayer::security_manager_t& >( that() ).find_key( ediv, rand, that().connection().connection_details_, that() );
 
                         // setup encryption
                         std::tie( skds, ivs ) = that().setup_encryption( key, skdm, ivm );
@@ -150,18 +247,21 @@ namespace link_layer {
                     {
                         fill< layout_t >( write, { LinkLayer::ll_control_pdu_code, 1, LinkLayer::LL_START_ENC_RSP } );
                         that().start_transmit_encrypted();
-                        that().connection_details_.is_encrypted( true );
+                        that().connection().connection_details_.is_encrypted( true );
+
+                        // in case, the link was encrypted with the key of a bond
+                        that().connection().connection_details_.pairing_status( that().connection().connection_details_.local_device_pairing_status() );
                     }
                     else if ( opcode == LinkLayer::LL_PAUSE_ENC_REQ && size == 1 )
                     {
                         fill< layout_t >( write, { LinkLayer::ll_control_pdu_code, 1, LinkLayer::LL_PAUSE_ENC_RSP } );
                         that().stop_receive_encrypted();
-                        that().connection_details_.is_encrypted( false );
+                        that().connection().connection_details_.is_encrypted( false );
                     }
                     else if ( opcode == LinkLayer::LL_PAUSE_ENC_RSP && size == 1 )
                     {
                         that().stop_transmit_encrypted();
-                        that().connection_details_.is_encrypted( false );
+                        that().connection().connection_details_.is_encrypted( false );
 
                         return false;
                     }
@@ -177,10 +277,12 @@ namespace link_layer {
                 {
                     using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
 
+                    transmit_key_distribution();
+
                     if ( !encryption_in_progress_ )
                         return;
 
-                    auto out_buffer = that().allocate_transmit_buffer();
+                    auto out_buffer = that().buffer().allocate_transmit_buffer();
                     if ( out_buffer.empty() )
                         return;
 
@@ -190,14 +292,14 @@ namespace link_layer {
                             LinkLayer::ll_control_pdu_code, 1, LinkLayer::LL_START_ENC_REQ } );
 
                         that().start_receive_encrypted();
-                        that().commit_transmit_buffer( out_buffer );
+                        that().buffer().commit_transmit_buffer( out_buffer );
                     }
                     else
                     {
                         fill< layout_t >( out_buffer, {
                             LinkLayer::ll_control_pdu_code, 2, LinkLayer::LL_REJECT_IND, LinkLayer::err_pin_or_key_missing } );
 
-                        that().commit_transmit_buffer( out_buffer );
+                        that().buffer().commit_transmit_buffer( out_buffer );
                     }
 
                     encryption_in_progress_ = false;
@@ -205,12 +307,48 @@ namespace link_layer {
 
                 void reset_encryption()
                 {
-                    that().connection_details_.is_encrypted( false );
+                    that().connection().connection_details_.is_encrypted( false );
                     that().stop_receive_encrypted();
                     that().stop_transmit_encrypted();
                 }
 
+                void security_connection_closed()
+                {
+                    static_cast< typename LinkLayer::security_manager_t& >( that() ).remote_connection_closed( that().connection().connection_details_, that() );
+                }
+
             private:
+                // keys, that the security manager distributes over the encrypted link
+                void transmit_key_distribution()
+                {
+                    using layout_t = typename pdu_layout_by_radio< typename LinkLayer::radio_t >::pdu_layout;
+
+                    auto& details = that().connection().connection_details_;
+
+                    while ( details.outgoing_security_manager_data_available( details ) )
+                    {
+                        auto out_buffer = that().buffer().allocate_transmit_buffer();
+
+                        if ( out_buffer.empty() )
+                            return;
+
+                        std::size_t   out_size = out_buffer.size - LinkLayer::all_header_size - layout_t::data_channel_pdu_memory_size( 0 );
+                        std::uint8_t* out_body = layout_t::body( out_buffer ).first;
+
+                        static_cast< typename LinkLayer::security_manager_t& >( that() ).l2cap_output( &out_body[ LinkLayer::l2cap_header_size ], out_size, details, that() );
+
+                        fill< layout_t >( out_buffer, {
+                            LinkLayer::lld_data_pdu_code,
+                            static_cast< std::uint8_t >( out_size + LinkLayer::l2cap_header_size ),
+                            static_cast< std::uint8_t >( out_size ),
+                            0,
+                            static_cast< std::uint8_t >( LinkLayer::l2cap_sm_channel ),
+                            static_cast< std::uint8_t >( LinkLayer::l2cap_sm_channel >> 8 ) } );
+
+                        that().buffer().commit_transmit_buffer( out_buffer );
+                    }
+                }
+
                 bool has_key_;
                 bool encryption_in_progress_;
             };
@@ -233,6 +371,10 @@ namespace link_layer {
                 void reset_encryption()
                 {
                 }
+
+                void security_connection_closed()
+                {
+                }
             };
         };
 
@@ -243,6 +385,260 @@ namespace link_layer {
                 link_layer_security_impl,
                 link_layer_no_security_impl
             >::type::template impl< LinkLayer >;
+
+        /*
+         * With a single connection, the link layer passes all scheduling requests directly to the radio.
+         */
+        struct link_layer_single_connection_impl
+        {
+            template < class LinkLayer >
+            struct impl
+            {
+                LinkLayer& that()
+                {
+                    return static_cast< LinkLayer& >( *this );
+                }
+
+                void schedule_advertising_activity( unsigned channel, const write_buffer& advertising_data, const write_buffer& response_data, delta_time when, const read_buffer& receive )
+                {
+                    static_cast< typename LinkLayer::radio_t& >( that() ).schedule_advertisment( channel, advertising_data, response_data, when, receive );
+                }
+
+                void advertising_access_address_and_crc_init( std::uint32_t access_address, std::uint32_t crc_init )
+                {
+                    static_cast< typename LinkLayer::radio_t& >( that() ).set_access_address_and_crc_init( access_address, crc_init );
+                }
+
+                void open_connection( std::uint32_t access_address, std::uint32_t crc_init, delta_time window_start, delta_time window_end )
+                {
+                    static_cast< typename LinkLayer::radio_t& >( that() ).set_access_address_and_crc_init( access_address, crc_init );
+                    that().schedule_radio_connection_event( window_start, window_end );
+                }
+
+                void schedule_connection_event_window( delta_time window_start, delta_time window_end )
+                {
+                    LinkLayer::connection_event_callback::call_connection_event_callback(
+                        that().schedule_radio_connection_event( window_start, window_end ) );
+                }
+
+                void close_connection()
+                {
+                    that().handle_start_advertising();
+                }
+
+                void select_advertising_connection()
+                {
+                }
+
+                void scheduled_connection_event_closed()
+                {
+                }
+
+                void scheduled_connection_event_timed_out()
+                {
+                }
+
+                void schedule_next_activity()
+                {
+                }
+            };
+        };
+
+        /*
+         * With more than one connection, the radio is shared by the advertising and all connections. All scheduling
+         * requests are collected by a connection_event_scheduler and the next activity is passed to the radio, when the
+         * previous activity is over.
+         */
+        template < std::size_t Connections >
+        struct link_layer_multiple_connections_impl
+        {
+            template < class LinkLayer >
+            class impl
+            {
+            public:
+                impl()
+                    : advertising_channel_( 0 )
+                    , advertising_data_{ nullptr, 0 }
+                    , response_data_{ nullptr, 0 }
+                    , advertising_receive_{ nullptr, 0 }
+                    , advertising_access_address_( 0 )
+                    , advertising_crc_init_( 0 )
+                    , radio_busy_( false )
+                    , advertising_scheduled_( false )
+                {
+                }
+
+                LinkLayer& that()
+                {
+                    return static_cast< LinkLayer& >( *this );
+                }
+
+                void schedule_advertising_activity( unsigned channel, const write_buffer& advertising_data, const write_buffer& response_data, delta_time when, const read_buffer& receive )
+                {
+                    // without a free connection, a connection request could not be accepted
+                    if ( that().free_connection() == Connections )
+                        return;
+
+                    advertising_channel_ = channel;
+                    advertising_data_    = advertising_data;
+                    response_data_       = response_data;
+                    advertising_receive_ = receive;
+
+                    scheduler_.request_advertising( when );
+
+                    if ( !radio_busy_ )
+                    {
+                        radio_busy_ = true;
+                        schedule_next_activity();
+                    }
+                }
+
+                void advertising_access_address_and_crc_init( std::uint32_t access_address, std::uint32_t crc_init )
+                {
+                    advertising_access_address_ = access_address;
+                    advertising_crc_init_       = crc_init;
+                }
+
+                void open_connection( std::uint32_t access_address, std::uint32_t crc_init, delta_time window_start, delta_time window_end )
+                {
+                    that().connection().access_address_ = access_address;
+                    that().connection().crc_init_       = crc_init;
+
+                    scheduler_.cancel_advertising();
+                    scheduler_.add_connection( that().current_connection_ );
+                    schedule_connection_event_window( window_start, window_end );
+
+                    // continue to advertise, as long as there are free connections
+                    if ( that().free_connection() != Connections )
+                        that().handle_start_advertising();
+                }
+
+                void schedule_connection_event_window( delta_time window_start, delta_time window_end )
+                {
+                    const auto& connection = that().connection();
+
+                    // parameters are updated with every event, to follow connection updates
+                    scheduler_.connection_parameters(
+                        that().current_connection_,
+                        connection.connection_interval_,
+                        connection.slave_latency_,
+                        delta_time( connection.timeout_value_ * 10000 ) );
+
+                    // follows data length and PHY updates
+                    scheduler_.connection_event_length( that().current_connection_, that().connection_event_length() );
+
+                    scheduler_.connection_event( that().current_connection_, window_start, window_end );
+                }
+
+                link_utilisation utilisation( std::size_t connection ) const
+                {
+                    return scheduler_.utilisation( connection );
+                }
+
+                void close_connection()
+                {
+                    scheduler_.remove_connection( that().current_connection_ );
+
+                    if ( !scheduler_.advertising_requested() && !advertising_scheduled_ )
+                        that().handle_start_advertising();
+                }
+
+                void select_advertising_connection()
+                {
+                    advertising_scheduled_     = false;
+                    that().current_connection_ = that().free_connection();
+                }
+
+                void scheduled_connection_event_closed()
+                {
+                    that().current_connection_ = scheduler_.scheduled_connection();
+                    scheduler_.connection_event_closed( static_cast< typename LinkLayer::radio_t& >( that() ).connection_event_anchor() );
+                }
+
+                void scheduled_connection_event_timed_out()
+                {
+                    that().current_connection_ = scheduler_.scheduled_connection();
+                    scheduler_.connection_event_timeout();
+                }
+
+                /*
+                 * Called at the end of every radio callback: hands the next activity to the radio. Connection events
+                 * that are missed, because the radio is not available in time, are handled like timeouts.
+                 */
+                void schedule_next_activity()
+                {
+                    using scheduler_t = connection_event_scheduler< Connections >;
+
+                    auto& radio = static_cast< typename LinkLayer::radio_t& >( that() );
+
+                    for ( ;; )
+                    {
+                        const typename scheduler_t::activity next = scheduler_.next_activity();
+
+                        if ( next.type == scheduler_t::activity_type::missed_connection_event )
+                        {
+                            scheduler_.activity_scheduled( next );
+
+                            that().current_connection_ = next.connection;
+                            that().connection_event_missed();
+                        }
+                        else if ( next.type == scheduler_t::activity_type::advertising )
+                        {
+                            scheduler_.activity_scheduled( next );
+                            advertising_scheduled_ = true;
+
+                            radio.set_access_address_and_crc_init( advertising_access_address_, advertising_crc_init_ );
+                            radio.schedule_advertisment( advertising_channel_, advertising_data_, response_data_, next.start, advertising_receive_ );
+
+                            return;
+                        }
+                        else if ( next.type == scheduler_t::activity_type::connection_event )
+                        {
+                            scheduler_.activity_scheduled( next );
+
+                            that().current_connection_ = next.connection;
+                            auto& connection = that().connection();
+
+                            radio.set_access_address_and_crc_init( connection.access_address_, connection.crc_init_ );
+                            radio.select_connection_buffer( connection.pdu_buffer_ );
+
+                            LinkLayer::connection_event_callback::call_connection_event_callback(
+                                that().schedule_radio_connection_event( next.start, next.end ) );
+
+                            return;
+                        }
+                        else
+                        {
+                            radio_busy_ = false;
+
+                            return;
+                        }
+                    }
+                }
+
+            private:
+                connection_event_scheduler< Connections >   scheduler_;
+
+                unsigned                                    advertising_channel_;
+                write_buffer                                advertising_data_;
+                write_buffer                                response_data_;
+                read_buffer                                 advertising_receive_;
+                std::uint32_t                               advertising_access_address_;
+                std::uint32_t                               advertising_crc_init_;
+
+                // an activity was passed to the radio, or a radio callback is running
+                bool                                        radio_busy_;
+                bool                                        advertising_scheduled_;
+            };
+        };
+
+        template < class LinkLayer, typename ... Options >
+        using select_link_layer_connections_impl =
+            typename bluetoe::details::select_type<
+                ( number_of_connections< Options... >::connections > 1 ),
+                link_layer_multiple_connections_impl< number_of_connections< Options... >::connections >,
+                link_layer_single_connection_impl
+            >::type::template impl< LinkLayer >;
     }
 
     /**
@@ -269,15 +665,15 @@ namespace link_layer {
     >
     class link_layer :
         public ScheduledRadio<
-            details::buffer_sizes< Options... >::tx_size,
-            details::buffer_sizes< Options... >::rx_size,
+            details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::tx_size,
+            details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::rx_size,
             link_layer< Server, ScheduledRadio, Options... >
         >,
         public details::security_manager< Server, Options... >::type,
         public details::white_list<
             ScheduledRadio<
-                details::buffer_sizes< Options... >::tx_size,
-                details::buffer_sizes< Options... >::rx_size,
+                details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::tx_size,
+                details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::rx_size,
                 link_layer< Server, ScheduledRadio, Options... >
             >,
             link_layer< Server, ScheduledRadio, Options... >,
@@ -287,7 +683,8 @@ namespace link_layer {
             Options... >,
         private details::connection_callbacks< Server, Options... >::type,
         private details::signaling_channel< Options... >::type,
-        private details::select_link_layer_security_impl< Server, link_layer< Server, ScheduledRadio, Options... > >
+        private details::select_link_layer_security_impl< Server, link_layer< Server, ScheduledRadio, Options... > >,
+        private details::select_link_layer_connections_impl< link_layer< Server, ScheduledRadio, Options... >, Options... >
     {
     public:
         link_layer();
@@ -328,17 +725,40 @@ namespace link_layer {
          * @brief initiating the change of communication parameters of an established connection
          *
          * If it was not possible to initiate the connection parameter update, the function returns false.
-         * @todo Add parameter that identifies the connection.
+         * This overload is only available, if the link layer supports a single connection.
          */
         bool connection_parameter_update_request( std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout );
 
         /**
-         * @brief terminates the give connection
+         * @brief initiating the change of communication parameters of the given connection
          *
-         * @todo Add parameter that identifies the connection.
+         * @sa connection_parameter_update_request( std::uint16_t, std::uint16_t, std::uint16_t, std::uint16_t )
+         */
+        bool connection_parameter_update_request( const typename Server::connection_data& connection, std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout );
+
+        /**
+         * @brief terminates all established connections
          */
         void disconnect();
 
+        /**
+         * @brief terminates the given connection
+         */
+        void disconnect( const typename Server::connection_data& connection );
+
+        /**
+         * @brief radio usage of the given connection
+         *
+         * Reports, how many connection events of the connection where served and how many had to be skipped, because
+         * they collided with other connections, and the share of radio time, the connection reserves. This can be used
+         * to size connection intervals for a larger number of connections.
+         *
+         * This function is only available, if the link layer supports more than one connection.
+         *
+         * @sa max_connections
+         */
+        link_utilisation connection_utilisation( const typename Server::connection_data& connection ) const;
+
         /**
          * @brief fills the given buffer with l2cap advertising payload
          */
@@ -349,23 +769,47 @@ namespace link_layer {
          */
         const device_address& local_address() const;
 
+        /** @cond HIDDEN_SYMBOLS */
+        // GATT Database Hash of the server, used by the security manager to store it with a bond
+        bluetoe::details::uint128_t database_hash() const;
+
+        // scheduling functions used by the advertising implementation
+        void schedule_advertisment(
+            unsigned            channel,
+            const write_buffer& advertising_data,
+            const write_buffer& response_data,
+            delta_time          when,
+            const read_buffer&  receive );
+
+        void set_access_address_and_crc_init( std::uint32_t access_address, std::uint32_t crc_init );
+        /** @endcond */
+
         using radio_t = ScheduledRadio<
-            details::buffer_sizes< Options... >::tx_size,
-            details::buffer_sizes< Options... >::rx_size,
+            details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::tx_size,
+            details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::rx_size,
             link_layer< Server, ScheduledRadio, Options... > >;
 
         using layout_t = typename pdu_layout_by_radio< radio_t >::pdu_layout;
 
+        /**
+         * @brief minimum and recommended transmit and receive buffer sizes of this link layer
+         *
+         * The sizes are available as the constexpr members minimum_transmit_size, minimum_receive_size,
+         * recommended_transmit_size and recommended_receive_size. The recommended sizes are used, when
+         * the link layer is configured with auto_buffer_sizes. A transmit buffer smaller than minimum_transmit_size
+         * can not transmit an L2CAP PDU of max_mtu_size with the default data length and is rejected at compile time.
+         *
+         * @sa auto_buffer_sizes
+         */
+        using buffer_requirements = typename details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::requirements;
+
     private:
 
         friend details::select_link_layer_security_impl< Server, link_layer< Server, ScheduledRadio, Options... > >;
+        friend details::select_link_layer_connections_impl< link_layer< Server, ScheduledRadio, Options... >, Options... >;
 
         static_assert(
-            std::is_same<
-                typename ::bluetoe::details::find_by_not_meta_type<
-                    details::valid_link_layer_option_meta_type,
-                    Options...
-                >::type, ::bluetoe::details::no_such_type >::value,
+            ::bluetoe::details::count_if< std::tuple< Options... >, details::invalid_link_layer_option >::value == 0,
             "Option passed to the link layer, that is not a valid link_layer option." );
 
         // make sure, that the hardware supports encryption
@@ -377,7 +821,11 @@ namespace link_layer {
 
         typedef notification_queue<
             typename Server::notification_priority::template numbers< typename Server::services >::type,
-            typename Server::connection_data > notification_queue_t;
+            typename Server::connection_data,
+            typename radio_t::lock_guard > notification_queue_t;
+
+        typedef typename Server::template notification_snapshot_buffer<
+            typename radio_t::lock_guard > notification_snapshot_buffer_t;
 
         typedef typename security_manager_t::template connection_data< notification_queue_t > connection_details_t;
 
@@ -386,16 +834,28 @@ namespace link_layer {
         typedef details::select_advertiser_implementation<
             link_layer< Server, ScheduledRadio, Options... >, Options... > advertising_t;
 
+        struct connection_state;
+
         unsigned sleep_clock_accuracy( const std::uint8_t* received_body ) const;
         bool check_timing_paremeters( std::uint16_t slave_latency, delta_time timeout ) const;
         bool parse_timing_parameters_from_connect_request( const std::uint8_t* valid_connect_request_body );
         bool parse_timing_parameters_from_connection_update_request( const std::uint8_t* valid_connect_request );
         void force_disconnect();
-        void start_advertising_impl();
+        void connection_event_missed();
         void wait_for_connection_event();
-        void transmit_notifications();
-        void transmit_signaling_channel_output();
-        void transmit_pending_control_pdus();
+        delta_time schedule_radio_connection_event( delta_time window_start, delta_time window_end );
+        bool request_connection_parameter_update( connection_state& connection, std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout );
+        void disconnect( connection_state& connection );
+        // called from run(), outside of the radio callbacks, for the given connection
+        void transmit_notifications( connection_state& link );
+        bool multiple_notifications_output( connection_state& link, std::uint8_t* output, std::size_t& out_size, std::size_t first_index );
+        std::pair< typename connection_details_t::entry_type, std::size_t > next_notification( connection_state& link );
+        bool transmit_notification_snapshot( connection_state& link, const read_buffer& out_buffer );
+        bool queue_notification( connection_state& connection, const ::bluetoe::details::notification_data& item, typename Server::notification_type type );
+        bool queue_notification_snapshot( connection_state& connection, const ::bluetoe::details::notification_data& item );
+        void publish_snapshot_size( connection_state& link );
+        void transmit_signaling_channel_output( connection_state& link );
+        void transmit_pending_control_pdus( connection_state& link );
 
         static bool lcap_notification_callback( const ::bluetoe::details::notification_data& item, void* usr_arg, typename Server::notification_type type );
 
@@ -408,8 +868,25 @@ namespace link_layer {
         ll_result send_control_pdus();
         ll_result handle_ll_control_data( const write_buffer& pdu, read_buffer output );
         ll_result handle_l2cap( const write_buffer& pdu, const read_buffer& output );
+        ll_result handle_l2cap_continuation( const write_buffer& pdu, const read_buffer& output );
+        void l2cap_input( const std::uint8_t* l2cap_pdu, const read_buffer& output );
         ll_result handle_pending_ll_control();
 
+        using phy_t = details::phy_ll_encoding::phy_ll_encoding_t;
+
+        std::uint16_t local_max_rx_octets() const;
+        std::uint16_t local_max_tx_octets() const;
+        void update_data_length( const std::uint8_t* remote_parameters );
+        void calculate_effective_data_length();
+        delta_time connection_event_length();
+        bool larger_data_length_useful() const;
+        void fill_data_length_pdu( const read_buffer& output, std::uint8_t opcode, const connection_state& link ) const;
+
+        static std::uint16_t max_data_octets( std::size_t max_max_size );
+        static constexpr std::uint16_t octets_to_time( std::uint16_t octets, phy_t phy );
+        static constexpr std::uint16_t time_to_octets( std::uint16_t time, phy_t phy );
+        static constexpr bool valid_phy_update( std::uint8_t phy );
+
         connection_details details() const;
 
         static std::uint16_t read_16( const std::uint8_t* );
@@ -420,8 +897,12 @@ namespace link_layer {
         static constexpr unsigned       first_advertising_channel   = 37;
         static constexpr unsigned       num_windows_til_timeout     = 5;
 
+        // the master selected channel selection algorithm #2
+        static constexpr std::uint16_t  connect_request_chsel_field = 0x20;
+
         static constexpr std::uint8_t   ll_control_pdu_code         = 3;
         static constexpr std::uint8_t   lld_data_pdu_code           = 2;
+        static constexpr std::uint8_t   lld_continuation_pdu_code   = 1;
 
         static constexpr std::uint8_t   LL_CONNECTION_UPDATE_REQ    = 0x00;
         static constexpr std::uint8_t   LL_CHANNEL_MAP_REQ          = 0x01;
@@ -441,6 +922,11 @@ namespace link_layer {
         static constexpr std::uint8_t   LL_CONNECTION_PARAM_RSP     = 0x10;
         static constexpr std::uint8_t   LL_PING_REQ                 = 0x12;
         static constexpr std::uint8_t   LL_PING_RSP                 = 0x13;
+        static constexpr std::uint8_t   LL_LENGTH_REQ               = 0x14;
+        static constexpr std::uint8_t   LL_LENGTH_RSP               = 0x15;
+        static constexpr std::uint8_t   LL_PHY_REQ                  = 0x16;
+        static constexpr std::uint8_t   LL_PHY_RSP                  = 0x17;
+        static constexpr std::uint8_t   LL_PHY_UPDATE_IND           = 0x18;
 
         static constexpr std::uint8_t   LL_VERSION_NR               = 0x08;
         static constexpr std::uint8_t   LL_VERSION_40               = 0x06;
@@ -450,12 +936,21 @@ namespace link_layer {
         static constexpr std::uint16_t  l2cap_sm_channel            = 6;
 
         static constexpr std::size_t    l2cap_header_size           = 4;
+        static constexpr std::size_t    no_carried_notification     = ~std::size_t{ 0 };
         static constexpr std::size_t    all_header_size             = 6;
+        static constexpr std::size_t    ll_header_size              = 2;
+
+        // minimum values for the data length update procedure (octets and µs on the LE 1M PHY)
+        static constexpr std::uint16_t  min_data_octets             = 27;
+        static constexpr std::uint16_t  min_data_time               = 328;
+
+        // inter frame space in µs
+        static constexpr std::uint32_t  t_ifs                       = 150;
 
         static constexpr std::uint8_t   err_pin_or_key_missing      = 0x06;
 
         struct link_layer_feature {
-            enum : std::uint8_t {
+            enum : std::uint16_t {
                 le_encryption                           = 0x01,
                 connection_parameters_request_procedure = 0x02,
                 extended_reject_indication              = 0x04,
@@ -463,39 +958,62 @@ namespace link_layer {
                 le_ping                                 = 0x10,
                 le_data_packet_length_extension         = 0x20,
                 ll_privacy                              = 0x40,
-                extended_scanner_filter_policies        = 0x80
+                extended_scanner_filter_policies        = 0x80,
+                le_2m_phy                               = 0x0100,
+                channel_selection_algorithm_2           = 0x4000
             };
         };
 
-        static constexpr std::uint8_t   supported_features =
+        static constexpr std::uint16_t  supported_features =
             link_layer_feature::connection_parameters_request_procedure |
             link_layer_feature::le_ping |
+            link_layer_feature::le_data_packet_length_extension |
+            link_layer_feature::channel_selection_algorithm_2 |
             ( bluetoe::details::requires_encryption_support_t< Server >::value
                 ? link_layer_feature::le_encryption
+                : 0 ) |
+            ( radio_t::hardware_supports_2mbit
+                ? link_layer_feature::le_2m_phy
                 : 0 );
 
-        // TODO: calculate the actual needed buffer size for advertising, not the maximum
-        static_assert( radio_t::size >= advertising_t::maximum_required_advertising_buffer(), "buffer to small" );
+        static constexpr std::uint8_t   supported_phys =
+            details::phy_ll_encoding::le_1m_phy |
+            ( radio_t::hardware_supports_2mbit
+                ? details::phy_ll_encoding::le_2m_phy
+                : 0 );
 
-        const device_address            address_;
-        unsigned                        current_channel_index_;
-        channel_map                     channels_;
-        unsigned                        cumulated_sleep_clock_accuracy_;
-        delta_time                      transmit_window_offset_;
-        delta_time                      transmit_window_size_;
-        delta_time                      connection_interval_;
-        std::uint16_t                   slave_latency_;
-        std::uint16_t                   timeout_value_;
-        delta_time                      connection_interval_old_;
-        std::uint16_t                   conn_event_counter_;
-        std::uint16_t                   defered_conn_event_counter_;
-        write_buffer                    defered_ll_control_pdu_;
-        unsigned                        timeouts_til_connection_lost_;
-        unsigned                        max_timeouts_til_connection_lost_;
-        Server*                         server_;
-        connection_details_t            connection_details_;
-        bool                            termination_send_;
-        std::uint8_t                    used_features_;
+        // the advertising data is created at runtime, so every advertising PDU in use is sized for its maximum payload
+        static_assert( radio_t::size >= buffer_requirements::advertising_size,
+            "The buffers are too small for the advertising types in use; use larger buffers or auto_buffer_sizes!" );
+
+        static_assert( details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::tx_size >= buffer_requirements::minimum_transmit_size,
+            "The transmit buffer is too small to transmit an L2CAP PDU of max_mtu_size; use a larger buffer or auto_buffer_sizes!" );
+
+        static constexpr std::size_t    max_connections      = details::number_of_connections< Options... >::connections;
+        static constexpr bool           multiple_connections = max_connections > 1;
+
+        static_assert( !multiple_connections || radio_t::hardware_supports_multiple_connections,
+            "The selected hardware binding doesn't support more than one connection!" );
+
+        static_assert( !multiple_connections || !encryption_required,
+            "Encryption is only supported with a single connection!" );
+
+        static_assert( !multiple_connections || std::is_same< signaling_channel_t, bluetoe::l2cap::no_signaling_channel >::value,
+            "The L2CAP signaling channel is only supported with a single connection!" );
+
+        using connection_buffer_t = connection_pdu_buffer<
+            radio_t,
+            details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::tx_size,
+            details::buffer_sizes< Server, ScheduledRadio, link_layer< Server, ScheduledRadio, Options... >, Options... >::rx_size >;
+
+        using buffer_t = typename bluetoe::details::select_type<
+            multiple_connections,
+            connection_buffer_t,
+            radio_t >::type;
+
+        // notify() renders a snapshot before it knows the buffer, that will transmit it
+        static_assert( !notification_snapshot_buffer_t::enabled || buffer_t::guaranteed_l2cap_transmit_size >= details::mtu_size< Options... >::mtu + 4,
+            "With notification_snapshots, the transmit buffer has to be large enough, to transmit a notification of max_mtu_size with the default data length; use a larger buffer or auto_buffer_sizes!" );
 
         enum class state
         {
@@ -505,14 +1023,85 @@ namespace link_layer {
             connection_update,
             connected,
             disconnecting
-        }                               state_;
+        };
+
+        struct single_connection_data {};
+
+        // with more than one connection, the radio is shared and every connection needs its own PDU buffers
+        struct multiple_connection_data
+        {
+            std::uint32_t                   access_address_;
+            std::uint32_t                   crc_init_;
+            connection_buffer_t             pdu_buffer_;
+        };
 
-        std::uint16_t                   proposed_interval_min_;
-        std::uint16_t                   proposed_interval_max_;
-        std::uint16_t                   proposed_latency_;
-        std::uint16_t                   proposed_timeout_;
-        bool                            connection_parameters_request_pending_;
-        bool                            connection_parameters_request_running_;
+        struct connection_state : bluetoe::details::select_type<
+            multiple_connections, multiple_connection_data, single_connection_data >::type
+        {
+            connection_state();
+
+            unsigned                        current_channel_index_;
+            channel_map                     channels_;
+            unsigned                        cumulated_sleep_clock_accuracy_;
+            delta_time                      transmit_window_offset_;
+            delta_time                      transmit_window_size_;
+            delta_time                      connection_interval_;
+            std::uint16_t                   slave_latency_;
+            std::uint16_t                   timeout_value_;
+            delta_time                      connection_interval_old_;
+            std::uint16_t                   conn_event_counter_;
+            // connection update, channel map and PHY update procedures
+            details::pending_procedures< 3 >
+                                            pending_procedures_;
+            unsigned                        timeouts_til_connection_lost_;
+            unsigned                        max_timeouts_til_connection_lost_;
+            connection_details_t            connection_details_;
+            notification_snapshot_buffer_t  snapshots_;
+            // a notification, that was already dequeued, but did not fit into the last Multiple Handle Value Notification
+            std::size_t                     carried_notification_;
+            // maximum size of a snapshot; 0, while the link does not accept notifications. Written by the
+            // link layer, read by notify()
+            ::bluetoe::details::atomic_word< std::size_t, typename radio_t::lock_guard >
+                                            snapshot_size_;
+            details::l2cap_reassembly_buffer< details::mtu_size< Options... >::mtu + l2cap_header_size >
+                                            reassembly_buffer_;
+            bool                            termination_send_;
+            std::uint16_t                   used_features_;
+            phy_t                           receive_phy_;
+            phy_t                           transmit_phy_;
+            std::uint16_t                   remote_max_rx_octets_;
+            std::uint16_t                   remote_max_rx_time_;
+            std::uint16_t                   remote_max_tx_octets_;
+            std::uint16_t                   remote_max_tx_time_;
+            state                           state_;
+
+            std::uint16_t                   proposed_interval_min_;
+            std::uint16_t                   proposed_interval_max_;
+            std::uint16_t                   proposed_latency_;
+            std::uint16_t                   proposed_timeout_;
+            bool                            connection_parameters_request_pending_;
+            bool                            data_length_request_pending_;
+            bool                            connection_parameters_request_running_;
+        };
+
+        connection_state& connection();
+        const connection_state& connection() const;
+
+        void commit_l2cap_output( buffer_t& out, const read_buffer& output, std::size_t out_size, std::uint16_t l2cap_channel );
+
+        buffer_t& buffer();
+        const buffer_t& buffer() const;
+        buffer_t& buffer( connection_state& link );
+        radio_t& buffer( connection_state& link, std::false_type );
+        connection_buffer_t& buffer( connection_state& link, std::true_type );
+
+        std::size_t free_connection() const;
+
+        const device_address            address_;
+        Server*                         server_;
+        connection_state                connections_[ max_connections ];
+        // the connection, the link layer is currently working on
+        std::size_t                     current_connection_;
 
         // default configuration parameters
         typedef                         advertising_interval< 100 >         default_advertising_interval;
@@ -537,13 +1126,27 @@ namespace link_layer {
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     link_layer< Server, ScheduledRadio, Options... >::link_layer()
         : address_( local_device_address::address( *this ) )
-        , current_channel_index_( first_advertising_channel )
-        , defered_ll_control_pdu_{ nullptr, 0 }
         , server_( nullptr )
+        , current_connection_( 0 )
+    {
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    link_layer< Server, ScheduledRadio, Options... >::connection_state::connection_state()
+        : current_channel_index_( first_advertising_channel )
         , connection_details_( std::size_t{ details::mtu_size< Options... >::mtu } )
+        , carried_notification_( no_carried_notification )
+        , snapshot_size_( 0 )
         , used_features_( supported_features )
+        , receive_phy_( details::phy_ll_encoding::le_1m_phy )
+        , transmit_phy_( details::phy_ll_encoding::le_1m_phy )
+        , remote_max_rx_octets_( min_data_octets )
+        , remote_max_rx_time_( min_data_time )
+        , remote_max_tx_octets_( min_data_octets )
+        , remote_max_tx_time_( min_data_time )
         , state_( state::initial )
         , connection_parameters_request_pending_( false )
+        , data_length_request_pending_( false )
         , connection_parameters_request_running_( false )
     {
     }
@@ -552,21 +1155,29 @@ namespace link_layer {
     void link_layer< Server, ScheduledRadio, Options... >::run( Server& server )
     {
         // after the initial scheduling, the timeout and receive callback will setup the next scheduling
-        if ( state_ == state::initial )
+        if ( connection().state_ == state::initial )
         {
             server_ = &server;
-            start_advertising_impl();
+
+            for ( auto& link : connections_ )
+                link.state_ = state::advertising;
+
+            this->handle_start_advertising();
 
             server.notification_callback( lcap_notification_callback, this );
         }
 
         radio_t::run();
 
-        if ( state_ == state::connected )
+        // current_connection_ belongs to the radio callbacks, that can interrupt this loop at any time
+        for ( auto& link : connections_ )
         {
-            transmit_notifications();
-            transmit_signaling_channel_output();
-            transmit_pending_control_pdus();
+            if ( link.state_ == state::connected )
+            {
+                transmit_notifications( link );
+                transmit_signaling_channel_output( link );
+                transmit_pending_control_pdus( link );
+            }
         }
 
         this->handle_connection_events();
@@ -575,69 +1186,94 @@ namespace link_layer {
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     void link_layer< Server, ScheduledRadio, Options... >::adv_received( const read_buffer& receive )
     {
-        assert( state_ == state::advertising );
+        this->select_advertising_connection();
+
+        assert( connection().state_ == state::advertising );
 
         device_address remote_address;
         const bool connection_request_received = this->handle_adv_receive( receive, remote_address );
 
         if ( connection_request_received )
         {
-            const std::uint8_t* const body = layout_t::body( receive ).first;
-
-            if ( channels_.reset( &body[ 28 ], body[ 33 ] & 0x1f )
-              && parse_timing_parameters_from_connect_request( body ) )
-            {
-                state_                    = state::connecting;
-                current_channel_index_    = 0;
-                conn_event_counter_       = 0;
-                cumulated_sleep_clock_accuracy_ = sleep_clock_accuracy( body ) + device_sleep_clock_accuracy::accuracy_ppm;
-                timeouts_til_connection_lost_   = num_windows_til_timeout - 1;
-                used_features_            = supported_features;
-                connection_parameters_request_pending_ = false;
-                connection_parameters_request_running_ = false;
+            const std::uint8_t* const body       = layout_t::body( receive ).first;
+            const bool                use_csa_2  = layout_t::header( receive ) & connect_request_chsel_field;
 
-                this->set_access_address_and_crc_init( read_32( &body[ 12 ] ), read_24( &body[ 16 ] ) );
+            const bool channels_valid = use_csa_2
+                ? connection().channels_.reset_algorithm_2( &body[ 28 ], read_32( &body[ 12 ] ) )
+                : connection().channels_.reset( &body[ 28 ], body[ 33 ] & 0x1f );
 
-                const delta_time window_start = transmit_window_offset_ - transmit_window_offset_.ppm( cumulated_sleep_clock_accuracy_ );
-                      delta_time window_end   = transmit_window_offset_ + transmit_window_size_;
-
-                window_end += window_end.ppm( cumulated_sleep_clock_accuracy_ );
-
-                this->reset();
-                this->schedule_connection_event(
-                    channels_.data_channel( current_channel_index_ ),
-                    window_start,
-                    window_end,
-                    connection_interval_ );
+            if ( channels_valid && parse_timing_parameters_from_connect_request( body ) )
+            {
+                connection().state_                    = state::connecting;
+                connection().current_channel_index_    = 0;
+                connection().conn_event_counter_       = 0;
+                connection().cumulated_sleep_clock_accuracy_ = sleep_clock_accuracy( body ) + device_sleep_clock_accuracy::accuracy_ppm;
+                connection().timeouts_til_connection_lost_   = num_windows_til_timeout - 1;
+                connection().used_features_            = supported_features;
+                connection().receive_phy_              = details::phy_ll_encoding::le_1m_phy;
+                connection().transmit_phy_             = details::phy_ll_encoding::le_1m_phy;
+                connection().remote_max_rx_octets_     = min_data_octets;
+                connection().remote_max_rx_time_       = min_data_time;
+                connection().remote_max_tx_octets_     = min_data_octets;
+                connection().remote_max_tx_time_       = min_data_time;
+                connection().connection_parameters_request_pending_ = false;
+                connection().connection_parameters_request_running_ = false;
+                connection().data_length_request_pending_           = false;
+
+                const delta_time window_start = connection().transmit_window_offset_ - connection().transmit_window_offset_.ppm( connection().cumulated_sleep_clock_accuracy_ );
+                      delta_time window_end   = connection().transmit_window_offset_ + connection().transmit_window_size_;
+
+                window_end += window_end.ppm( connection().cumulated_sleep_clock_accuracy_ );
+
+                buffer().reset();
+
+                connection().connection_details_ = connection_details_t( std::size_t{ details::mtu_size< Options... >::mtu } );
+                connection().snapshots_.clear_snapshots();
+                connection().carried_notification_ = no_carried_notification;
+                connection().connection_details_.remote_connection_created( remote_address );
+                connection().reassembly_buffer_.reset();
 
                 this->connection_request( connection_addresses( address_, remote_address ) );
                 this->handle_stop_advertising();
-
-                connection_details_ = connection_details_t( std::size_t{ details::mtu_size< Options... >::mtu } );
-                connection_details_.remote_connection_created( remote_address );
+                this->open_connection( read_32( &body[ 12 ] ), read_24( &body[ 16 ] ), window_start, window_end );
             }
         }
+
+        this->schedule_next_activity();
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     void link_layer< Server, ScheduledRadio, Options... >::adv_timeout()
     {
-        assert( state_ == state::advertising );
+        this->select_advertising_connection();
+
+        assert( connection().state_ == state::advertising );
 
         this->handle_adv_timeout();
+        this->schedule_next_activity();
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     void link_layer< Server, ScheduledRadio, Options... >::timeout()
     {
-        assert( state_ == state::connecting || state_ == state::connected || state_ == state::connection_update || state_ == state::disconnecting );
+        this->scheduled_connection_event_timed_out();
+
+        connection_event_missed();
+
+        this->schedule_next_activity();
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::connection_event_missed()
+    {
+        assert( connection().state_ == state::connecting || connection().state_ == state::connected || connection().state_ == state::connection_update || connection().state_ == state::disconnecting );
 
-        if ( timeouts_til_connection_lost_ )
+        if ( connection().timeouts_til_connection_lost_ )
         {
-            current_channel_index_ = ( current_channel_index_ + 1 ) % first_advertising_channel;
+            connection().current_channel_index_ = ( connection().current_channel_index_ + 1 ) % first_advertising_channel;
 
-            --timeouts_til_connection_lost_;
-            ++conn_event_counter_;
+            --connection().timeouts_til_connection_lost_;
+            ++connection().conn_event_counter_;
 
             if ( handle_pending_ll_control() == ll_result::disconnect )
             {
@@ -657,21 +1293,26 @@ namespace link_layer {
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     void link_layer< Server, ScheduledRadio, Options... >::end_event()
     {
-        assert( state_ == state::connecting || state_ == state::connected || state_ == state::connection_update || state_ == state::disconnecting );
+        this->scheduled_connection_event_closed();
 
-        if ( state_ == state::connecting )
+        assert( connection().state_ == state::connecting || connection().state_ == state::connected || connection().state_ == state::connection_update || connection().state_ == state::disconnecting );
+
+        if ( connection().state_ == state::connecting )
         {
-            this->connection_established( details(), connection_details_, static_cast< radio_t& >( *this ) );
+            this->connection_established( details(), connection().connection_details_, static_cast< radio_t& >( *this ) );
+
+            // start a data length update, if the MTU and the buffers allow for longer PDUs
+            connection().data_length_request_pending_ = larger_data_length_useful();
         }
 
-        if ( state_ != state::disconnecting )
+        if ( connection().state_ != state::disconnecting )
         {
-            state_                        = state::connected;
-            timeouts_til_connection_lost_ = max_timeouts_til_connection_lost_;
+            connection().state_                        = state::connected;
+            connection().timeouts_til_connection_lost_ = connection().max_timeouts_til_connection_lost_;
         }
 
-        current_channel_index_        = ( current_channel_index_ + 1 ) % first_advertising_channel;
-        ++conn_event_counter_;
+        connection().current_channel_index_        = ( connection().current_channel_index_ + 1 ) % first_advertising_channel;
+        ++connection().conn_event_counter_;
 
         if ( handle_received_data() == ll_result::disconnect || send_control_pdus() == ll_result::disconnect )
         {
@@ -682,23 +1323,48 @@ namespace link_layer {
             this->transmit_pending_security_pdus();
             wait_for_connection_event();
         }
+
+        // the state and the negotiated MTU might have changed
+        publish_snapshot_size( connection() );
+
+        this->schedule_next_activity();
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     bool link_layer< Server, ScheduledRadio, Options... >::connection_parameter_update_request( std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout )
     {
-        if ( used_features_ & link_layer_feature::connection_parameters_request_procedure )
-        {
-            if ( connection_parameters_request_pending_ )
-                return false;
+        static_assert( !multiple_connections, "with more than one connection, the connection has to be given" );
 
-            proposed_interval_min_  = interval_min;
-            proposed_interval_max_  = interval_max;
-            proposed_latency_       = latency;
-            proposed_timeout_       = timeout;
-            connection_parameters_request_pending_ = true;
+        return request_connection_parameter_update( connection(), interval_min, interval_max, latency, timeout );
+    }
 
-            this->wake_up();
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bool link_layer< Server, ScheduledRadio, Options... >::connection_parameter_update_request( const typename Server::connection_data& con, std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout )
+    {
+        for ( auto& link : connections_ )
+        {
+            if ( &static_cast< const typename Server::connection_data& >( link.connection_details_ ) == &con )
+                return request_connection_parameter_update( link, interval_min, interval_max, latency, timeout );
+        }
+
+        return false;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bool link_layer< Server, ScheduledRadio, Options... >::request_connection_parameter_update( connection_state& link, std::uint16_t interval_min, std::uint16_t interval_max, std::uint16_t latency, std::uint16_t timeout )
+    {
+        if ( link.used_features_ & link_layer_feature::connection_parameters_request_procedure )
+        {
+            if ( link.connection_parameters_request_pending_ )
+                return false;
+
+            link.proposed_interval_min_  = interval_min;
+            link.proposed_interval_max_  = interval_max;
+            link.proposed_latency_       = latency;
+            link.proposed_timeout_       = timeout;
+            link.connection_parameters_request_pending_ = true;
+
+            this->wake_up();
 
             return true;
         }
@@ -711,11 +1377,46 @@ namespace link_layer {
         return result;
     }
 
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    link_utilisation link_layer< Server, ScheduledRadio, Options... >::connection_utilisation( const typename Server::connection_data& con ) const
+    {
+        static_assert( multiple_connections, "utilisation is only reported with more than one connection" );
+
+        for ( std::size_t link = 0; link != max_connections; ++link )
+        {
+            if ( &static_cast< const typename Server::connection_data& >( connections_[ link ].connection_details_ ) == &con )
+                return this->utilisation( link );
+        }
+
+        return link_utilisation{ 0, 0, 0 };
+    }
+
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     void link_layer< Server, ScheduledRadio, Options... >::disconnect()
     {
-        state_            = state::disconnecting;
-        termination_send_ = false;
+        for ( auto& link : connections_ )
+        {
+            if ( !multiple_connections || ( link.state_ != state::initial && link.state_ != state::advertising ) )
+                disconnect( link );
+        }
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::disconnect( const typename Server::connection_data& con )
+    {
+        for ( auto& link : connections_ )
+        {
+            if ( &static_cast< const typename Server::connection_data& >( link.connection_details_ ) == &con )
+                disconnect( link );
+        }
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::disconnect( connection_state& link )
+    {
+        link.state_            = state::disconnecting;
+        link.termination_send_ = false;
+        publish_snapshot_size( link );
 
         this->reset_encryption();
     }
@@ -726,102 +1427,221 @@ namespace link_layer {
         delta_time window_start;
         delta_time window_end;
 
-        if ( state_ == state::connecting )
+        if ( connection().state_ == state::connecting )
         {
-            const delta_time window_target = connection_interval_ * ( num_windows_til_timeout - timeouts_til_connection_lost_ - 1 );
+            const delta_time window_target = connection().connection_interval_ * ( num_windows_til_timeout - connection().timeouts_til_connection_lost_ - 1 );
 
-            window_start = transmit_window_offset_ + window_target;
-            window_end   = window_start + transmit_window_size_;
+            window_start = connection().transmit_window_offset_ + window_target;
+            window_end   = window_start + connection().transmit_window_size_;
 
-            window_start -= window_start.ppm( cumulated_sleep_clock_accuracy_ );
-            window_end   += window_end.ppm( cumulated_sleep_clock_accuracy_ );
+            window_start -= window_start.ppm( connection().cumulated_sleep_clock_accuracy_ );
+            window_end   += window_end.ppm( connection().cumulated_sleep_clock_accuracy_ );
         }
-        else if ( state_ == state::connection_update )
+        else if ( connection().state_ == state::connection_update )
         {
-            window_start = connection_interval_old_ + transmit_window_offset_;
-            window_end   = window_start + transmit_window_size_;
+            window_start = connection().connection_interval_old_ + connection().transmit_window_offset_;
+            window_end   = window_start + connection().transmit_window_size_;
 
-            window_start -= window_start.ppm( cumulated_sleep_clock_accuracy_ );
-            window_end   += window_end.ppm( cumulated_sleep_clock_accuracy_ );
+            window_start -= window_start.ppm( connection().cumulated_sleep_clock_accuracy_ );
+            window_end   += window_end.ppm( connection().cumulated_sleep_clock_accuracy_ );
         }
         else
         {
-            const delta_time window_target = connection_interval_ * ( max_timeouts_til_connection_lost_ - timeouts_til_connection_lost_ + 1 );
-            const delta_time window_size   = window_target.ppm( cumulated_sleep_clock_accuracy_ );
+            const delta_time window_target = connection().connection_interval_ * ( connection().max_timeouts_til_connection_lost_ - connection().timeouts_til_connection_lost_ + 1 );
+            const delta_time window_size   = window_target.ppm( connection().cumulated_sleep_clock_accuracy_ );
 
             window_start  = window_target - window_size;
             window_end    = window_target + window_size;
         }
 
-        const delta_time time_till_next_event = this->schedule_connection_event(
-                channels_.data_channel( current_channel_index_ ),
+        this->schedule_connection_event_window( window_start, window_end );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    delta_time link_layer< Server, ScheduledRadio, Options... >::schedule_radio_connection_event( delta_time window_start, delta_time window_end )
+    {
+        return this->schedule_connection_event(
+                connection().channels_.data_channel( connection().current_channel_index_, connection().conn_event_counter_ ),
                 window_start,
                 window_end,
-                connection_interval_ );
-
-        connection_event_callback::call_connection_event_callback( time_till_next_event );
+                connection().connection_interval_,
+                connection().receive_phy_,
+                connection().transmit_phy_ );
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
-    void link_layer< Server, ScheduledRadio, Options... >::transmit_notifications()
+    void link_layer< Server, ScheduledRadio, Options... >::transmit_notifications( connection_state& link )
     {
-        // first check if we have memory to transmit the message, or otherwise notifications would get lost
-        auto out_buffer = this->allocate_transmit_buffer();
+        for ( unsigned count = 0; count != details::notifications_per_event< Options... >::max_notifications; ++count )
+        {
+            // first check if we have memory to transmit the message, or otherwise notifications would get lost
+            auto out_buffer = buffer( link ).allocate_l2cap_transmit_buffer( link.connection_details_.negotiated_mtu() + l2cap_header_size );
 
-        if ( out_buffer.empty() )
-            return;
+            if ( out_buffer.empty() )
+                return;
 
-        const auto notification = connection_details_.dequeue_indication_or_confirmation();
+            if ( transmit_notification_snapshot( link, out_buffer ) )
+                continue;
 
-        if ( notification.first != connection_details_t::entry_type::empty )
-        {
-            std::size_t   out_size = out_buffer.size - all_header_size - layout_t::data_channel_pdu_memory_size( 0 );
+            const auto notification = next_notification( link );
+
+            if ( notification.first == connection_details_t::entry_type::empty )
+                return;
+
+            std::size_t   out_size = buffer( link ).l2cap_transmit_size( out_buffer ) - l2cap_header_size;
             std::uint8_t* out_body = layout_t::body( out_buffer ).first;
 
             if ( notification.first == connection_details_t::entry_type::notification )
             {
-                server_->notification_output(
-                    &out_body[ l2cap_header_size ],
-                    out_size,
-                    connection_details_,
-                    notification.second
-                );
+                if ( !multiple_notifications_output( link, &out_body[ l2cap_header_size ], out_size, notification.second ) )
+                {
+                    server_->notification_output(
+                        &out_body[ l2cap_header_size ],
+                        out_size,
+                        link.connection_details_,
+                        notification.second
+                    );
+                }
             }
             else
             {
                 server_->indication_output(
                     &out_body[ l2cap_header_size ],
                     out_size,
-                    connection_details_,
+                    link.connection_details_,
                     notification.second
                 );
 
                 // if no output is generate, confirm the indication, or we will wait for ever
                 if ( out_size == 0 )
-                    connection_details_.indication_confirmed();
+                    link.connection_details_.indication_confirmed();
 
             }
 
             if ( out_size )
+                commit_l2cap_output( buffer( link ), out_buffer, out_size, l2cap_att_channel );
+        }
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bool link_layer< Server, ScheduledRadio, Options... >::multiple_notifications_output( connection_state& link, std::uint8_t* output, std::size_t& out_size, std::size_t first_index )
+    {
+        std::size_t pdu_size = 0;
+
+        if ( !server_->multiple_notification_output( output, pdu_size, out_size, link.connection_details_, first_index ) )
+            return false;
+
+        bool more_than_one = false;
+
+        for ( auto next = link.connection_details_.dequeue_notification(); next.first != connection_details_t::entry_type::empty;
+            next = link.connection_details_.dequeue_notification() )
+        {
+            if ( !server_->multiple_notification_output( output, pdu_size, out_size, link.connection_details_, next.second ) )
             {
-                fill< layout_t >( out_buffer, {
-                    lld_data_pdu_code,
-                    static_cast< std::uint8_t >( out_size + l2cap_header_size ),
-                    static_cast< std::uint8_t >( out_size ),
-                    0,
-                    static_cast< std::uint8_t >( l2cap_att_channel ),
-                    static_cast< std::uint8_t >( l2cap_att_channel >> 8 ) } );
-
-                this->commit_transmit_buffer( out_buffer );
+                // does not fit into this PDU; start the next one with it, so it keeps its round robin position
+                link.carried_notification_ = next.second;
+                break;
             }
+
+            more_than_one = true;
         }
+
+        if ( more_than_one )
+            out_size = pdu_size;
+
+        return more_than_one;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    std::pair< typename link_layer< Server, ScheduledRadio, Options... >::connection_details_t::entry_type, std::size_t >
+        link_layer< Server, ScheduledRadio, Options... >::next_notification( connection_state& link )
+    {
+        const std::size_t carried = link.carried_notification_;
+
+        if ( carried == no_carried_notification )
+            return link.connection_details_.dequeue_indication_or_confirmation();
+
+        link.carried_notification_ = no_carried_notification;
+
+        return { connection_details_t::entry_type::notification, carried };
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
-    void link_layer< Server, ScheduledRadio, Options... >::transmit_signaling_channel_output()
+    bool link_layer< Server, ScheduledRadio, Options... >::transmit_notification_snapshot( connection_state& link, const read_buffer& out_buffer )
+    {
+        const std::size_t size = link.snapshots_.next_snapshot_size();
+
+        if ( size == 0 )
+            return false;
+
+        // keep the snapshot, until there is a large enough buffer
+        if ( size > buffer( link ).l2cap_transmit_size( out_buffer ) - l2cap_header_size )
+            return false;
+
+        std::uint8_t* const out_body = layout_t::body( out_buffer ).first;
+        link.snapshots_.pop_snapshot( &out_body[ l2cap_header_size ] );
+        commit_l2cap_output( buffer( link ), out_buffer, size, l2cap_att_channel );
+
+        return true;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bool link_layer< Server, ScheduledRadio, Options... >::queue_notification( connection_state& link, const ::bluetoe::details::notification_data& item, typename Server::notification_type type )
+    {
+        if ( type == Server::indication )
+            return link.connection_details_.queue_indication( item.client_characteristic_configuration_index() );
+
+        return notification_snapshot_buffer_t::enabled
+            ? queue_notification_snapshot( link, item )
+            : link.connection_details_.queue_notification( item.client_characteristic_configuration_index() );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bool link_layer< Server, ScheduledRadio, Options... >::queue_notification_snapshot( connection_state& link, const ::bluetoe::details::notification_data& item )
+    {
+        // this runs in the context of notify(); the state of the link and the negotiated MTU are only
+        // available through snapshot_size_. The client configurations are single bytes, written by the link
+        // layer; a concurrent change of a configuration decides only, whether this notification is taken.
+        const std::size_t max_size = link.snapshot_size_.load();
+
+        if ( max_size == 0 )
+            return false;
+
+        // the value is read now and not, when the notification is send
+        std::size_t         size     = max_size;
+        std::uint8_t* const snapshot = link.snapshots_.reserve_snapshot( size );
+
+        if ( snapshot == nullptr )
+            return false;
+
+        // with less room left in the ring than requested, the value must not be truncated
+        server_->notification_output( snapshot, size, link.connection_details_, item, size == max_size );
+        link.snapshots_.commit_snapshot( snapshot, size );
+
+        return size != 0;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::publish_snapshot_size( connection_state& link )
+    {
+        if ( !notification_snapshot_buffer_t::enabled )
+            return;
+
+        // the snapshot has to fit into every buffer that allocate_l2cap_transmit_buffer() returns
+        const bool accepted = link.state_ == state::connected || link.state_ == state::connection_update;
+
+        link.snapshot_size_.store( accepted
+            ? std::min(
+                std::size_t{ link.connection_details_.negotiated_mtu() },
+                std::size_t{ buffer_t::guaranteed_l2cap_transmit_size - l2cap_header_size } )
+            : 0 );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::transmit_signaling_channel_output( connection_state& link )
     {
         // first check if we have memory to transmit the message, or otherwise notifications would get lost
-        auto out_buffer = this->allocate_transmit_buffer();
+        auto out_buffer = buffer( link ).allocate_transmit_buffer();
 
         if ( out_buffer.empty() )
             return;
@@ -841,18 +1661,18 @@ namespace link_layer {
                 static_cast< std::uint8_t >( l2cap_signaling_channel ),
                 static_cast< std::uint8_t >( l2cap_signaling_channel >> 8 ) } );
 
-            this->commit_transmit_buffer( out_buffer );
+            buffer( link ).commit_transmit_buffer( out_buffer );
         }
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
-    void link_layer< Server, ScheduledRadio, Options... >::transmit_pending_control_pdus()
+    void link_layer< Server, ScheduledRadio, Options... >::transmit_pending_control_pdus( connection_state& link )
     {
-        if ( !connection_parameters_request_pending_ )
+        if ( !link.connection_parameters_request_pending_ )
             return;
 
         // first check if we have memory to transmit the message, or otherwise notifications would get lost
-        auto out_buffer = this->allocate_transmit_buffer();
+        auto out_buffer = buffer( link ).allocate_transmit_buffer();
 
         if ( out_buffer.empty() )
         {
@@ -860,46 +1680,45 @@ namespace link_layer {
             return;
         }
 
-        connection_parameters_request_pending_ = false;
-        connection_parameters_request_running_ = true;
+        link.connection_parameters_request_pending_ = false;
+        link.connection_parameters_request_running_ = true;
 
         fill< layout_t >( out_buffer, {
             ll_control_pdu_code, 24, LL_CONNECTION_PARAM_REQ,
-            static_cast< std::uint8_t >( proposed_interval_min_ ),
-            static_cast< std::uint8_t >( proposed_interval_min_ >> 8 ),
-            static_cast< std::uint8_t >( proposed_interval_max_ ),
-            static_cast< std::uint8_t >( proposed_interval_max_ >> 8 ),
-            static_cast< std::uint8_t >( proposed_latency_ ),
-            static_cast< std::uint8_t >( proposed_latency_ >> 8 ),
-            static_cast< std::uint8_t >( proposed_timeout_ ),
-            static_cast< std::uint8_t >( proposed_timeout_ >> 8 ),
+            static_cast< std::uint8_t >( link.proposed_interval_min_ ),
+            static_cast< std::uint8_t >( link.proposed_interval_min_ >> 8 ),
+            static_cast< std::uint8_t >( link.proposed_interval_max_ ),
+            static_cast< std::uint8_t >( link.proposed_interval_max_ >> 8 ),
+            static_cast< std::uint8_t >( link.proposed_latency_ ),
+            static_cast< std::uint8_t >( link.proposed_latency_ >> 8 ),
+            static_cast< std::uint8_t >( link.proposed_timeout_ ),
+            static_cast< std::uint8_t >( link.proposed_timeout_ >> 8 ),
             0x00,                                   // PreferredPeriodicity (none)
             0x00, 0x00,                             // ReferenceConnEventCount
             0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
             0xff, 0xff, 0xff, 0xff, 0xff, 0xff } );
 
-        this->commit_transmit_buffer( out_buffer );
+        buffer( link ).commit_transmit_buffer( out_buffer );
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     bool link_layer< Server, ScheduledRadio, Options... >::lcap_notification_callback( const ::bluetoe::details::notification_data& item, void* usr_arg, typename Server::notification_type type )
     {
-        auto& confirmation_queue = static_cast< link_layer< Server, ScheduledRadio, Options... >* >( usr_arg )->connection_details_;
-        switch ( type )
+        auto& self = *static_cast< link_layer< Server, ScheduledRadio, Options... >* >( usr_arg );
+
+        // a confirmation is received over the connection, the link layer is currently working on
+        if ( type == Server::confirmation )
         {
-            case Server::notification:
-                return confirmation_queue.queue_notification( item.client_characteristic_configuration_index() );
-                break;
-            case Server::indication:
-                return confirmation_queue.queue_indication( item.client_characteristic_configuration_index() );
-                break;
-            case Server::confirmation:
-                confirmation_queue.indication_confirmed();
-                return true;
-                break;
+            self.connection().connection_details_.indication_confirmed();
+            return true;
         }
 
-        return true;
+        bool queued = false;
+
+        for ( auto& link : self.connections_ )
+            queued = self.queue_notification( link, item, type ) || queued;
+
+        return queued;
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
@@ -921,12 +1740,12 @@ namespace link_layer {
         static constexpr delta_time minimum_connection_timeout( 100 * 1000 );
         static constexpr auto       max_slave_latency = 499;
 
-        return transmit_window_size_ <= maximum_transmit_window_offset
-            && transmit_window_size_ <= connection_interval_
-            && ( transmit_window_offset_ - delta_time( us_per_digits ) ) <= connection_interval_
+        return connection().transmit_window_size_ <= maximum_transmit_window_offset
+            && connection().transmit_window_size_ <= connection().connection_interval_
+            && ( connection().transmit_window_offset_ - delta_time( us_per_digits ) ) <= connection().connection_interval_
             && timeout >= minimum_connection_timeout
             && timeout <= maximum_connection_timeout
-            && timeout >= ( slave_latency + 1 ) * 2 * connection_interval_
+            && timeout >= ( slave_latency + 1 ) * 2 * connection().connection_interval_
             && slave_latency <= max_slave_latency;
     }
 
@@ -935,16 +1754,16 @@ namespace link_layer {
     {
         static constexpr auto       us_per_digits = 1250;
 
-        transmit_window_size_   = delta_time( valid_connect_request_body[ 19 ] * us_per_digits );
-        transmit_window_offset_ = delta_time( read_16( &valid_connect_request_body[ 20 ] ) * us_per_digits + us_per_digits );
-        connection_interval_    = delta_time( read_16( &valid_connect_request_body[ 22 ] ) * us_per_digits );
-        slave_latency_          = read_16( &valid_connect_request_body[ 24 ] );
-        timeout_value_          = read_16( &valid_connect_request_body[ 26 ] );
-        delta_time timeout      = delta_time( timeout_value_ * 10000 );
+        connection().transmit_window_size_   = delta_time( valid_connect_request_body[ 19 ] * us_per_digits );
+        connection().transmit_window_offset_ = delta_time( read_16( &valid_connect_request_body[ 20 ] ) * us_per_digits + us_per_digits );
+        connection().connection_interval_    = delta_time( read_16( &valid_connect_request_body[ 22 ] ) * us_per_digits );
+        connection().slave_latency_          = read_16( &valid_connect_request_body[ 24 ] );
+        connection().timeout_value_          = read_16( &valid_connect_request_body[ 26 ] );
+        delta_time timeout      = delta_time( connection().timeout_value_ * 10000 );
 
-        max_timeouts_til_connection_lost_ = timeout / connection_interval_;
+        connection().max_timeouts_til_connection_lost_ = timeout / connection().connection_interval_;
 
-        return check_timing_paremeters( slave_latency_, timeout );
+        return check_timing_paremeters( connection().slave_latency_, timeout );
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
@@ -952,34 +1771,31 @@ namespace link_layer {
     {
         static constexpr auto       us_per_digits = 1250;
 
-        transmit_window_size_   = delta_time( valid_update_request[ 1 ] * us_per_digits );
-        transmit_window_offset_ = delta_time( read_16( &valid_update_request[ 2 ] ) * us_per_digits );
-        connection_interval_    = delta_time( read_16( &valid_update_request[ 4 ] ) * us_per_digits );
-        slave_latency_          = read_16( &valid_update_request[ 6 ] );
-        timeout_value_          = read_16( &valid_update_request[ 8 ] );
-        delta_time timeout      = delta_time( timeout_value_ * 10000 );
+        connection().transmit_window_size_   = delta_time( valid_update_request[ 1 ] * us_per_digits );
+        connection().transmit_window_offset_ = delta_time( read_16( &valid_update_request[ 2 ] ) * us_per_digits );
+        connection().connection_interval_    = delta_time( read_16( &valid_update_request[ 4 ] ) * us_per_digits );
+        connection().slave_latency_          = read_16( &valid_update_request[ 6 ] );
+        connection().timeout_value_          = read_16( &valid_update_request[ 8 ] );
+        delta_time timeout      = delta_time( connection().timeout_value_ * 10000 );
 
-        max_timeouts_til_connection_lost_ = timeout / connection_interval_;
+        connection().max_timeouts_til_connection_lost_ = timeout / connection().connection_interval_;
 
-        return check_timing_paremeters( slave_latency_, timeout );
+        return check_timing_paremeters( connection().slave_latency_, timeout );
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
     void link_layer< Server, ScheduledRadio, Options... >::force_disconnect()
     {
         this->reset_encryption();
-        this->connection_closed( connection_details_, static_cast< radio_t& >( *this ) );
-        start_advertising_impl();
-    }
+        this->security_connection_closed();
+        server_->client_disconnected( connection().connection_details_ );
+        this->connection_closed( connection().connection_details_, static_cast< radio_t& >( *this ) );
 
-    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
-    void link_layer< Server, ScheduledRadio, Options... >::start_advertising_impl()
-    {
-        state_ = state::advertising;
+        connection().state_ = state::advertising;
+        connection().pending_procedures_.reset();
+        publish_snapshot_size( connection() );
 
-        defered_ll_control_pdu_ = write_buffer{ nullptr, 0 };
-
-        this->handle_start_advertising();
+        this->close_connection();
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
@@ -987,28 +1803,34 @@ namespace link_layer {
     {
         ll_result result = handle_pending_ll_control();
 
-        if ( result != ll_result::go_ahead || !defered_ll_control_pdu_.empty() )
+        // procedures with an instant do not block the data path, while they are pending
+        if ( result != ll_result::go_ahead )
             return result;
 
-        for ( auto pdu = this->next_received(); pdu.size != 0; )
+        for ( auto pdu = buffer().next_received(); pdu.size != 0; )
         {
-            auto output = this->allocate_transmit_buffer();
+            const auto llid   = layout_t::header( pdu ) & 0x03;
+            auto       output = llid == ll_control_pdu_code
+                ? buffer().allocate_transmit_buffer()
+                : buffer().allocate_l2cap_transmit_buffer( connection().connection_details_.negotiated_mtu() + l2cap_header_size );
 
             if ( output.size )
             {
-                const auto llid = layout_t::header( pdu ) & 0x03;
-
                 if ( llid == ll_control_pdu_code )
                 {
                     result = handle_ll_control_data( pdu, output );
                 }
-                else if ( llid == lld_data_pdu_code && state_ != state::disconnecting )
+                else if ( llid == lld_data_pdu_code && connection().state_ != state::disconnecting )
                 {
                     result = handle_l2cap( pdu, output );
                 }
+                else if ( llid == lld_continuation_pdu_code && connection().state_ != state::disconnecting )
+                {
+                    result = handle_l2cap_continuation( pdu, output );
+                }
 
-                this->free_received();
-                pdu = this->next_received();
+                buffer().free_received();
+                pdu = buffer().next_received();
             }
             else
             {
@@ -1024,9 +1846,9 @@ namespace link_layer {
     {
         static constexpr std::uint8_t connection_terminated_by_local_host = 0x16;
 
-        if ( state_ == state::disconnecting && !termination_send_ )
+        if ( connection().state_ == state::disconnecting && !connection().termination_send_ )
         {
-            auto output = this->allocate_transmit_buffer();
+            auto output = buffer().allocate_transmit_buffer();
 
             if ( output.size )
             {
@@ -1035,8 +1857,20 @@ namespace link_layer {
                     LL_TERMINATE_IND, connection_terminated_by_local_host
                 } );
 
-                this->commit_transmit_buffer( output );
-                termination_send_ = true;
+                buffer().commit_transmit_buffer( output );
+                connection().termination_send_ = true;
+            }
+        }
+        else if ( connection().state_ == state::connected && connection().data_length_request_pending_ )
+        {
+            auto output = buffer().allocate_transmit_buffer();
+
+            if ( output.size )
+            {
+                fill_data_length_pdu( output, LL_LENGTH_REQ, connection() );
+
+                buffer().commit_transmit_buffer( output );
+                connection().data_length_request_pending_ = false;
             }
         }
 
@@ -1063,18 +1897,15 @@ namespace link_layer {
 
             if ( opcode == LL_CONNECTION_UPDATE_REQ && size == 12 )
             {
-                defered_conn_event_counter_ = read_16( &body[ 10 ] );
+                const std::uint16_t instant = read_16( &body[ 10 ] );
                 commit = false;
 
-                if ( static_cast< std::uint16_t >( defered_conn_event_counter_ - conn_event_counter_ ) & 0x8000
-                    || defered_conn_event_counter_ == conn_event_counter_ )
+                if ( static_cast< std::uint16_t >( instant - connection().conn_event_counter_ ) & 0x8000
+                    || instant == connection().conn_event_counter_
+                    || !connection().pending_procedures_.add( instant, body, size ) )
                 {
                     result = ll_result::disconnect;
                 }
-                else
-                {
-                    defered_ll_control_pdu_ = pdu;
-                }
             }
             else if ( opcode == LL_TERMINATE_IND && size == 2 )
             {
@@ -1084,7 +1915,7 @@ namespace link_layer {
             else if ( opcode == LL_VERSION_IND && size == 6 )
             {
                 if ( body[ 1 ] <= LL_VERSION_40 )
-                    used_features_ = used_features_ & ~link_layer_feature::connection_parameters_request_procedure;
+                    connection().used_features_ = connection().used_features_ & ~link_layer_feature::connection_parameters_request_procedure;
 
                 fill< layout_t >( write, {
                     ll_control_pdu_code, 6, LL_VERSION_IND,
@@ -1093,17 +1924,14 @@ namespace link_layer {
             }
             else if ( opcode == LL_CHANNEL_MAP_REQ && size == 8 )
             {
-                defered_conn_event_counter_ = read_16( &body[ 6 ] );
+                const std::uint16_t instant = read_16( &body[ 6 ] );
                 commit = false;
 
-                if ( static_cast< std::uint16_t >( defered_conn_event_counter_ - conn_event_counter_ ) & 0x8000 )
+                if ( static_cast< std::uint16_t >( instant - connection().conn_event_counter_ ) & 0x8000
+                    || !connection().pending_procedures_.add( instant, body, size ) )
                 {
                     result = ll_result::disconnect;
                 }
-                else
-                {
-                    defered_ll_control_pdu_ = pdu;
-                }
             }
             else if ( opcode == LL_PING_REQ && size == 1 )
             {
@@ -1111,33 +1939,67 @@ namespace link_layer {
             }
             else if ( opcode == LL_FEATURE_REQ && size == 9 )
             {
-                used_features_ = used_features_ & body[ 1 ];
+                connection().used_features_ = connection().used_features_ & read_16( &body[ 1 ] );
 
                 fill< layout_t >( write, {
                     ll_control_pdu_code, 9,
                     LL_FEATURE_RSP,
-                    used_features_,
-                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+                    static_cast< std::uint8_t >( connection().used_features_ ),
+                    static_cast< std::uint8_t >( connection().used_features_ >> 8 ),
+                    0x00, 0x00, 0x00, 0x00, 0x00, 0x00
                 } );
             }
             else if ( opcode == LL_UNKNOWN_RSP && size == 2 && body[ 1 ] == LL_CONNECTION_PARAM_REQ )
             {
-                if ( connection_parameters_request_running_ )
+                if ( connection().connection_parameters_request_running_ )
                 {
-                    connection_parameters_request_running_ = false;
+                    connection().connection_parameters_request_running_ = false;
 
                     if ( signaling_channel_t::connection_parameter_update_request(
-                        proposed_interval_min_,
-                        proposed_interval_max_,
-                        proposed_latency_,
-                        proposed_timeout_ ) )
+                        connection().proposed_interval_min_,
+                        connection().proposed_interval_max_,
+                        connection().proposed_latency_,
+                        connection().proposed_timeout_ ) )
                     {
                         this->wake_up();
                     }
                 }
 
-                used_features_ = used_features_ & ~link_layer_feature::connection_parameters_request_procedure;
+                connection().used_features_ = connection().used_features_ & ~link_layer_feature::connection_parameters_request_procedure;
+                commit = false;
+            }
+            else if ( ( opcode == LL_LENGTH_REQ || opcode == LL_LENGTH_RSP ) && size == 9 )
+            {
+                update_data_length( &body[ 1 ] );
+
+                if ( opcode == LL_LENGTH_REQ )
+                {
+                    fill_data_length_pdu( write, LL_LENGTH_RSP, connection() );
+                }
+                else
+                {
+                    commit = false;
+                }
+            }
+            else if ( opcode == LL_PHY_REQ && size == 3 && radio_t::hardware_supports_2mbit )
+            {
+                fill< layout_t >( write, { ll_control_pdu_code, 3, LL_PHY_RSP, supported_phys, supported_phys } );
+            }
+            else if ( opcode == LL_PHY_UPDATE_IND && size == 5 && valid_phy_update( body[ 1 ] ) && valid_phy_update( body[ 2 ] ) )
+            {
                 commit = false;
+
+                // no change, no instant
+                if ( body[ 1 ] != details::phy_ll_encoding::le_unchanged_coding || body[ 2 ] != details::phy_ll_encoding::le_unchanged_coding )
+                {
+                    const std::uint16_t instant = read_16( &body[ 3 ] );
+
+                    if ( static_cast< std::uint16_t >( instant - connection().conn_event_counter_ ) & 0x8000
+                        || !connection().pending_procedures_.add( instant, body, size ) )
+                    {
+                        result = ll_result::disconnect;
+                    }
+                }
             }
             else if ( opcode == LL_CONNECTION_PARAM_REQ && size == 24 )
             {
@@ -1159,7 +2021,7 @@ namespace link_layer {
             }
 
             if ( commit )
-                this->commit_transmit_buffer( write );
+                buffer().commit_transmit_buffer( write );
         }
 
         return result;
@@ -1172,34 +2034,70 @@ namespace link_layer {
         const std::uint8_t* const input_body= layout_t::body( input ).first;
         const std::uint8_t  pdu_size        = input_header >> 8;
 
+        if ( pdu_size < l2cap_header_size )
+            return ll_result::disconnect;
+
         const std::uint16_t l2cap_size      = read_16( &input_body[ 0 ] );
-        const std::uint16_t l2cap_channel   = read_16( &input_body[ 2 ] );
 
+        if ( pdu_size - l2cap_header_size > l2cap_size )
+            return ll_result::disconnect;
+
+        // start of a fragmented L2CAP PDU
         if ( pdu_size - l2cap_header_size != l2cap_size )
+        {
+            connection().reassembly_buffer_.start( input_body, input_body + pdu_size );
+            return ll_result::go_ahead;
+        }
+
+        connection().reassembly_buffer_.reset();
+        l2cap_input( input_body, output );
+
+        return ll_result::go_ahead;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    typename link_layer< Server, ScheduledRadio, Options... >::ll_result link_layer< Server, ScheduledRadio, Options... >::handle_l2cap_continuation( const write_buffer& input, const read_buffer& output )
+    {
+        const std::uint16_t input_header    = layout_t::header( input );
+        const std::uint8_t* const input_body= layout_t::body( input ).first;
+        const std::uint8_t  pdu_size        = input_header >> 8;
+
+        if ( !connection().reassembly_buffer_.add( input_body, input_body + pdu_size ) )
             return ll_result::disconnect;
 
-        std::size_t   out_size   = output.size - l2cap_header_size - layout_t::data_channel_pdu_memory_size( 0 );
+        if ( connection().reassembly_buffer_.complete() )
+        {
+            l2cap_input( connection().reassembly_buffer_.pdu(), output );
+            connection().reassembly_buffer_.reset();
+        }
+
+        return ll_result::go_ahead;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::l2cap_input( const std::uint8_t* l2cap_pdu, const read_buffer& output )
+    {
+        const std::uint16_t l2cap_size      = read_16( &l2cap_pdu[ 0 ] );
+        const std::uint16_t l2cap_channel   = read_16( &l2cap_pdu[ 2 ] );
+
+        std::size_t   out_size   = buffer().l2cap_transmit_size( output ) - l2cap_header_size;
         std::uint8_t* out_body   = layout_t::body( output ).first;
 
         if ( l2cap_channel == l2cap_att_channel )
         {
-            server_->l2cap_input( &input_body[ l2cap_header_size ], l2cap_size, &out_body[ l2cap_header_size ], out_size, connection_details_ );
-
-            // in case the ATT input changed the MTU size:
-            this->max_rx_size( connection_details_.negotiated_mtu() + all_header_size );
-            this->max_tx_size( connection_details_.negotiated_mtu() + all_header_size );
+            server_->l2cap_input( &l2cap_pdu[ l2cap_header_size ], l2cap_size, &out_body[ l2cap_header_size ], out_size, connection().connection_details_ );
         }
         else if ( l2cap_channel == l2cap_sm_channel )
         {
-            static_cast< security_manager_t& >( *this ).l2cap_input( &input_body[ l2cap_header_size ], l2cap_size, &out_body[ l2cap_header_size ], out_size, connection_details_, *this );
+            static_cast< security_manager_t& >( *this ).l2cap_input( &l2cap_pdu[ l2cap_header_size ], l2cap_size, &out_body[ l2cap_header_size ], out_size, connection().connection_details_, *this );
 
             // in case the pairing status changed
-            connection_details_.pairing_status( connection_details_.local_device_pairing_status() );
+            connection().connection_details_.pairing_status( connection().connection_details_.local_device_pairing_status() );
         }
         else if ( l2cap_channel == l2cap_signaling_channel )
         {
             this->signaling_channel_input(
-                &input_body[ l2cap_header_size ], l2cap_size, &out_body[ l2cap_header_size ], out_size );
+                &l2cap_pdu[ l2cap_header_size ], l2cap_size, &out_body[ l2cap_header_size ], out_size );
         }
         else
         {
@@ -1207,19 +2105,138 @@ namespace link_layer {
         }
 
         if ( out_size )
-        {
-            fill< layout_t >( output, {
-                lld_data_pdu_code,
-                static_cast< std::uint8_t >( out_size + l2cap_header_size ),
-                static_cast< std::uint8_t >( out_size ),
-                0,
-                static_cast< std::uint8_t >( l2cap_channel ),
-                static_cast< std::uint8_t >( l2cap_channel >> 8 ) } );
+            commit_l2cap_output( buffer(), output, out_size, l2cap_channel );
+    }
 
-            this->commit_transmit_buffer( output );
-        }
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::commit_l2cap_output( buffer_t& out, const read_buffer& output, std::size_t out_size, std::uint16_t l2cap_channel )
+    {
+        std::uint8_t* const out_body = layout_t::body( output ).first;
 
-        return ll_result::go_ahead;
+        out_body[ 0 ] = static_cast< std::uint8_t >( out_size );
+        out_body[ 1 ] = static_cast< std::uint8_t >( out_size >> 8 );
+        out_body[ 2 ] = static_cast< std::uint8_t >( l2cap_channel );
+        out_body[ 3 ] = static_cast< std::uint8_t >( l2cap_channel >> 8 );
+
+        out.commit_l2cap_transmit_buffer( output, out_size + l2cap_header_size );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    std::uint16_t link_layer< Server, ScheduledRadio, Options... >::local_max_rx_octets() const
+    {
+        return max_data_octets( buffer().max_max_rx_size() );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    std::uint16_t link_layer< Server, ScheduledRadio, Options... >::local_max_tx_octets() const
+    {
+        return max_data_octets( buffer().max_max_tx_size() );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    std::uint16_t link_layer< Server, ScheduledRadio, Options... >::max_data_octets( std::size_t max_max_size )
+    {
+        // An empty ring buffer can be split anywhere, so only half of the buffer is guarantied to be allocatable.
+        return static_cast< std::uint16_t >( std::max( std::size_t{ min_data_octets }, std::min< std::size_t >( {
+            max_max_size,
+            radio_t::max_buffer_size,
+            ( max_max_size + radio_t::layout_overhead - 1 ) / 2 - radio_t::layout_overhead } ) - ll_header_size ) );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::update_data_length( const std::uint8_t* remote_parameters )
+    {
+        // values below the minimum are not valid and are treated as the minimum
+        connection().remote_max_rx_octets_ = std::max( read_16( &remote_parameters[ 0 ] ), std::uint16_t{ min_data_octets } );
+        connection().remote_max_rx_time_   = std::max( read_16( &remote_parameters[ 2 ] ), std::uint16_t{ min_data_time } );
+        connection().remote_max_tx_octets_ = std::max( read_16( &remote_parameters[ 4 ] ), std::uint16_t{ min_data_octets } );
+        connection().remote_max_tx_time_   = std::max( read_16( &remote_parameters[ 6 ] ), std::uint16_t{ min_data_time } );
+
+        calculate_effective_data_length();
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::calculate_effective_data_length()
+    {
+        // the effective size in each direction is limited by the octets and by the air time, both sides support
+        // on the PHY that is currently used in that direction
+        const std::uint16_t rx_octets = std::min( {
+            local_max_rx_octets(), connection().remote_max_tx_octets_,
+            time_to_octets( std::min( octets_to_time( local_max_rx_octets(), connection().receive_phy_ ), connection().remote_max_tx_time_ ), connection().receive_phy_ ) } );
+
+        const std::uint16_t tx_octets = std::min( {
+            local_max_tx_octets(), connection().remote_max_rx_octets_,
+            time_to_octets( std::min( octets_to_time( local_max_tx_octets(), connection().transmit_phy_ ), connection().remote_max_rx_time_ ), connection().transmit_phy_ ) } );
+
+        buffer().max_rx_size( rx_octets + ll_header_size );
+        buffer().max_tx_size( tx_octets + ll_header_size );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    delta_time link_layer< Server, ScheduledRadio, Options... >::connection_event_length()
+    {
+        // a received and a transmitted PDU of the effective sizes (with MIC) on the current PHYs, each followed by T_IFS
+        return delta_time(
+            details::air_time( connection().receive_phy_, buffer().max_rx_size() + 4 ) + t_ifs
+          + details::air_time( connection().transmit_phy_, buffer().max_tx_size() + 4 ) + t_ifs );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bool link_layer< Server, ScheduledRadio, Options... >::larger_data_length_useful() const
+    {
+        // L2CAP PDUs are limited by the MTU; if they fit into the default data length, there is no need for a larger one
+        const std::size_t useful_octets = std::min< std::size_t >(
+            std::max( local_max_rx_octets(), local_max_tx_octets() ),
+            details::mtu_size< Options... >::mtu + l2cap_header_size );
+
+        return useful_octets > min_data_octets;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::fill_data_length_pdu( const read_buffer& output, std::uint8_t opcode, const connection_state& link ) const
+    {
+        // the maximum times are reported for the PHYs currently in use, but not below the minimum
+        const std::uint16_t min_time      = min_data_time;
+        const std::uint16_t max_rx_octets = local_max_rx_octets();
+        const std::uint16_t max_tx_octets = local_max_tx_octets();
+        const std::uint16_t max_rx_time   = std::max( octets_to_time( max_rx_octets, link.receive_phy_ ), min_time );
+        const std::uint16_t max_tx_time   = std::max( octets_to_time( max_tx_octets, link.transmit_phy_ ), min_time );
+
+        fill< layout_t >( output, {
+            ll_control_pdu_code, 9, opcode,
+            static_cast< std::uint8_t >( max_rx_octets ),
+            static_cast< std::uint8_t >( max_rx_octets >> 8 ),
+            static_cast< std::uint8_t >( max_rx_time ),
+            static_cast< std::uint8_t >( max_rx_time >> 8 ),
+            static_cast< std::uint8_t >( max_tx_octets ),
+            static_cast< std::uint8_t >( max_tx_octets >> 8 ),
+            static_cast< std::uint8_t >( max_tx_time ),
+            static_cast< std::uint8_t >( max_tx_time >> 8 )
+        } );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    constexpr std::uint16_t link_layer< Server, ScheduledRadio, Options... >::octets_to_time( std::uint16_t octets, phy_t phy )
+    {
+        // the octets are the payload without MIC
+        return static_cast< std::uint16_t >( details::air_time( phy, octets + ll_header_size + 4 ) );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    constexpr std::uint16_t link_layer< Server, ScheduledRadio, Options... >::time_to_octets( std::uint16_t time, phy_t phy )
+    {
+        // preamble, access address, header, MIC and CRC add 14 octets on the LE 1M PHY and 15 octets on the LE 2M PHY
+        return phy == details::phy_ll_encoding::le_2m_phy
+            ? static_cast< std::uint16_t >( time / 4 - 15 )
+            : static_cast< std::uint16_t >( time / 8 - 14 );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    constexpr bool link_layer< Server, ScheduledRadio, Options... >::valid_phy_update( std::uint8_t phy )
+    {
+        // at maximum, one PHY must be given and it has to be supported
+        return phy == details::phy_ll_encoding::le_unchanged_coding
+            || ( ( phy & ( phy - 1 ) ) == 0 && ( phy & supported_phys ) != 0 );
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
@@ -1227,24 +2244,41 @@ namespace link_layer {
     {
         ll_result result = ll_result::go_ahead;
 
-        if ( !defered_ll_control_pdu_.empty() && defered_conn_event_counter_ == conn_event_counter_ )
+        // more than one procedure can be due at the same instant
+        for ( const std::uint8_t* body = connection().pending_procedures_.take_due( connection().conn_event_counter_ );
+              body != nullptr && result == ll_result::go_ahead;
+              body = connection().pending_procedures_.take_due( connection().conn_event_counter_ ) )
         {
-            const std::uint8_t* body   = layout_t::body( defered_ll_control_pdu_ ).first;
             const std::uint8_t  opcode = body[ 0 ];
 
             if ( opcode == LL_CHANNEL_MAP_REQ )
             {
-                channels_.reset( &body[ 1 ] );
+                connection().channels_.reset( &body[ 1 ] );
+            }
+            else if ( opcode == LL_PHY_UPDATE_IND )
+            {
+                // M_TO_S_PHY is the PHY, the slave receives on
+                if ( body[ 1 ] != details::phy_ll_encoding::le_unchanged_coding )
+                    connection().receive_phy_ = static_cast< phy_t >( body[ 1 ] );
+
+                if ( body[ 2 ] != details::phy_ll_encoding::le_unchanged_coding )
+                    connection().transmit_phy_ = static_cast< phy_t >( body[ 2 ] );
+
+                calculate_effective_data_length();
+
+                // the maximum times, the peer knows, were reported for the old PHYs
+                if ( larger_data_length_useful() )
+                    connection().data_length_request_pending_ = true;
             }
             else if ( opcode == LL_CONNECTION_UPDATE_REQ )
             {
-                connection_interval_old_ = connection_interval_;
+                connection().connection_interval_old_ = connection().connection_interval_;
                 if ( parse_timing_parameters_from_connection_update_request( body ) )
                 {
-                    timeouts_til_connection_lost_ = 0;
-                    state_ = state::connection_update;
+                    connection().timeouts_til_connection_lost_ = 0;
+                    connection().state_ = state::connection_update;
 
-                    this->connection_changed( details(), connection_details_, static_cast< radio_t& >( *this ) );
+                    this->connection_changed( details(), connection().connection_details_, static_cast< radio_t& >( *this ) );
                 }
                 else
                 {
@@ -1255,8 +2289,6 @@ namespace link_layer {
             {
                 assert( !"invalid opcode" );
             }
-
-            defered_ll_control_pdu_ = write_buffer{ nullptr, 0 };
         }
 
         return result;
@@ -1266,11 +2298,11 @@ namespace link_layer {
     connection_details link_layer< Server, ScheduledRadio, Options... >::details() const
     {
         return connection_details(
-            channels_,
-            connection_interval_.usec() / 1250,
-            slave_latency_,
-            timeout_value_,
-            cumulated_sleep_clock_accuracy_ );
+            connection().channels_,
+            connection().connection_interval_.usec() / 1250,
+            connection().slave_latency_,
+            connection().timeout_value_,
+            connection().cumulated_sleep_clock_accuracy_ );
     }
 
     template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
@@ -1309,6 +2341,87 @@ namespace link_layer {
         return address_;
     }
 
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    bluetoe::details::uint128_t link_layer< Server, ScheduledRadio, Options... >::database_hash() const
+    {
+        bluetoe::details::uint128_t result{ { 0 } };
+
+        if ( const std::uint8_t* const hash = Server::database_hash() )
+            std::copy( hash, hash + result.size(), result.begin() );
+
+        return result;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::schedule_advertisment(
+        unsigned            channel,
+        const write_buffer& advertising_data,
+        const write_buffer& response_data,
+        delta_time          when,
+        const read_buffer&  receive )
+    {
+        this->schedule_advertising_activity( channel, advertising_data, response_data, when, receive );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    void link_layer< Server, ScheduledRadio, Options... >::set_access_address_and_crc_init( std::uint32_t access_address, std::uint32_t crc_init )
+    {
+        this->advertising_access_address_and_crc_init( access_address, crc_init );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    typename link_layer< Server, ScheduledRadio, Options... >::connection_state& link_layer< Server, ScheduledRadio, Options... >::connection()
+    {
+        return connections_[ current_connection_ ];
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    const typename link_layer< Server, ScheduledRadio, Options... >::connection_state& link_layer< Server, ScheduledRadio, Options... >::connection() const
+    {
+        return connections_[ current_connection_ ];
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    typename link_layer< Server, ScheduledRadio, Options... >::buffer_t& link_layer< Server, ScheduledRadio, Options... >::buffer()
+    {
+        return buffer( connection() );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    const typename link_layer< Server, ScheduledRadio, Options... >::buffer_t& link_layer< Server, ScheduledRadio, Options... >::buffer() const
+    {
+        return const_cast< link_layer< Server, ScheduledRadio, Options... >& >( *this ).buffer();
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    typename link_layer< Server, ScheduledRadio, Options... >::buffer_t& link_layer< Server, ScheduledRadio, Options... >::buffer( connection_state& link )
+    {
+        return buffer( link, std::integral_constant< bool, multiple_connections >() );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    typename link_layer< Server, ScheduledRadio, Options... >::radio_t& link_layer< Server, ScheduledRadio, Options... >::buffer( connection_state&, std::false_type )
+    {
+        return static_cast< radio_t& >( *this );
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    typename link_layer< Server, ScheduledRadio, Options... >::connection_buffer_t& link_layer< Server, ScheduledRadio, Options... >::buffer( connection_state& link, std::true_type )
+    {
+        return link.pdu_buffer_;
+    }
+
+    template < class Server, template < std::size_t, std::size_t, class > class ScheduledRadio, typename ... Options >
+    std::size_t link_layer< Server, ScheduledRadio, Options... >::free_connection() const
+    {
+        std::size_t link = 0;
+
+        for ( ; link != max_connections && connections_[ link ].state_ != state::advertising; ++link )
+            ;
+
+        return link;
+    }
+
 }
 }
 
@@ -6,6 +6,7 @@
 #include <cassert>
 #include <initializer_list>
 #include <algorithm>
+#include <type_traits>
 
 #include <bluetoe/default_pdu_layout.hpp>
 #include "ring_buffer.hpp"
@@ -13,6 +14,153 @@
 namespace bluetoe {
 namespace link_layer {
 
+    /**
+     * @brief default storage of the ll_data_pdu_buffer: two rings of fixed sizes for transmitted and received PDUs
+     *
+     * PDUs are inserted at the front and removed from the end of the rings. So memory is only freed in the order,
+     * in which it was allocated and a transmitted PDU, that waits for its acknowledgment, blocks the reuse of all
+     * memory behind it.
+     *
+     * A storage offers the same interface for the transmitting and the receiving side: alloc_*() returns memory for
+     * a PDU (or an empty buffer), push_*() stores a PDU in the allocated memory, next_*() returns the oldest stored
+     * PDU and pop_*() frees it. The receiving side is allocated and pushed by the radio, all other accesses are
+     * serialized by the ll_data_pdu_buffer through Radio::lock_guard, unless the storage is lock_free.
+     *
+     * Both rings have a single producer and a single consumer (the link layer and the radio), so this storage
+     * is lock_free.
+     */
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout >
+    class pdu_ring_storage
+    {
+    public:
+        /**
+         * @brief the size of memory in bytes that are return by raw()
+         */
+        static constexpr std::size_t size = TransmitSize + ReceiveSize;
+
+        /**
+         * @brief the largest transmitted PDU (header + payload)
+         */
+        static constexpr std::size_t max_transmit_size = TransmitSize - ( Layout::data_channel_pdu_memory_size( 0 ) - 2 );
+
+        /**
+         * @brief the largest received PDU (header + payload)
+         */
+        static constexpr std::size_t max_receive_size = ReceiveSize - ( Layout::data_channel_pdu_memory_size( 0 ) - 2 );
+
+        /**
+         * @brief the memory, allocated for a fragmented L2CAP PDU, is limited to half of the transmit ring
+         */
+        static constexpr std::size_t max_l2cap_transmit_memory = ( TransmitSize - 1 ) / 2;
+
+        /**
+         * @brief the distance in memory of two consecutive fragments of an L2CAP PDU
+         */
+        static constexpr std::size_t fragment_memory( std::size_t payload )
+        {
+            return Layout::data_channel_pdu_memory_size( payload );
+        }
+
+        /**
+         * @brief the transmitting and receiving side can be accessed concurrently without Radio::lock_guard
+         */
+        static constexpr bool lock_free = true;
+
+        pdu_ring_storage()
+            : receive_buffer_( receive_buffer() )
+            , transmit_buffer_( transmit_buffer() )
+        {
+        }
+
+        std::uint8_t* raw()
+        {
+            return &buffer_[ 0 ];
+        }
+
+        void reset()
+        {
+            receive_buffer_.reset( receive_buffer() );
+            transmit_buffer_.reset( transmit_buffer() );
+        }
+
+        read_buffer alloc_transmit( std::size_t size ) const
+        {
+            return transmit_buffer_.alloc_front( const_cast< std::uint8_t* >( transmit_buffer() ), size );
+        }
+
+        void push_transmit( const read_buffer& pdu )
+        {
+            transmit_buffer_.push_front( transmit_buffer(), pdu );
+        }
+
+        // allocated memory is not reserved in a ring, so there is nothing to release
+        void release_transmit_allocation()
+        {
+        }
+
+        read_buffer next_transmit() const
+        {
+            return transmit_buffer_.next_end( const_cast< std::uint8_t* >( transmit_buffer() ) );
+        }
+
+        void pop_transmit()
+        {
+            transmit_buffer_.pop_end( transmit_buffer() );
+        }
+
+        bool more_than_one_transmit() const
+        {
+            return transmit_buffer_.more_than_one( const_cast< std::uint8_t* >( transmit_buffer() ) );
+        }
+
+        read_buffer alloc_receive( std::size_t size ) const
+        {
+            return receive_buffer_.alloc_front( const_cast< std::uint8_t* >( receive_buffer() ), size );
+        }
+
+        void push_receive( const read_buffer& pdu )
+        {
+            receive_buffer_.push_front( receive_buffer(), pdu );
+        }
+
+        read_buffer next_received() const
+        {
+            return receive_buffer_.next_end( const_cast< std::uint8_t* >( receive_buffer() ) );
+        }
+
+        void pop_received()
+        {
+            receive_buffer_.pop_end( receive_buffer() );
+        }
+
+    private:
+        const std::uint8_t* transmit_buffer() const
+        {
+            return &buffer_[ 0 ];
+        }
+
+        std::uint8_t* transmit_buffer()
+        {
+            return &buffer_[ 0 ];
+        }
+
+        const std::uint8_t* receive_buffer() const
+        {
+            return &buffer_[ TransmitSize ];
+        }
+
+        std::uint8_t* receive_buffer()
+        {
+            return &buffer_[ TransmitSize ];
+        }
+
+        // transmit buffer followed by receive buffer at buffer_[ TransmitSize ]
+        std::uint8_t    buffer_[ size ];
+
+        pdu_ring_buffer< ReceiveSize, read_buffer, Layout >  receive_buffer_;
+        pdu_ring_buffer< TransmitSize, read_buffer, Layout > transmit_buffer_;
+    };
+
     /**
      * @brief ring buffers for ingoing and outgoing LL Data PDUs
      *
@@ -32,8 +180,18 @@ namespace link_layer {
      * TransmitSize and ReceiveSize are the total size of memory for the receiving and
      * transmitting buffer. Depending on the layout of the used Radio, there might be
      * an overhead per PDU.
+     *
+     * Storage defines, how the memory is divided between the PDUs. By default, there are separate rings for the
+     * transmitting and the receiving side (pdu_ring_storage). The pdu_slab_storage shares the memory between both
+     * sides in fixed size slots.
+     *
+     * The link layer is the producer of transmitted PDUs and the consumer of received PDUs, the radio is the
+     * consumer of transmitted and the producer of received PDUs. The sequence numbers are maintained by the radio
+     * side only. If the Storage is lock_free, the link layer does not have to lock the radio (Radio::lock_guard)
+     * to exchange PDUs, only reset() does.
      */
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio,
+        template < std::size_t, std::size_t, typename > class Storage = pdu_ring_storage >
     class ll_data_pdu_buffer
     {
     public:
@@ -67,6 +225,31 @@ namespace link_layer {
         static constexpr std::size_t    header_size     = 2u;
         static constexpr std::size_t    layout_overhead = layout::data_channel_pdu_memory_size( 0 ) - header_size;
 
+        /**
+         * @brief the storage of the transmitted and received PDUs
+         */
+        using storage_t = Storage< TransmitSize, ReceiveSize, layout >;
+
+    private:
+        static constexpr std::size_t    min_payload_size        = min_buffer_size - header_size;
+        static constexpr std::size_t    min_fragment_memory     = storage_t::fragment_memory( min_payload_size );
+        static constexpr std::size_t    min_l2cap_memory        = storage_t::max_l2cap_transmit_memory > min_buffer_size + layout_overhead
+            ? storage_t::max_l2cap_transmit_memory
+            : min_buffer_size + layout_overhead;
+        static constexpr std::size_t    last_fragment_memory    = min_l2cap_memory % min_fragment_memory;
+        static constexpr std::size_t    last_fragment_payload   = last_fragment_memory > layout::data_channel_pdu_memory_size( 0 )
+            ? ( last_fragment_memory - layout::data_channel_pdu_memory_size( 0 ) < min_payload_size ? last_fragment_memory - layout::data_channel_pdu_memory_size( 0 ) : min_payload_size )
+            : 0;
+
+    public:
+        /**
+         * @brief the size of an L2CAP PDU (including the L2CAP header), that fits into a buffer allocated by
+         *        allocate_l2cap_transmit_buffer() with every max_tx_size()
+         *
+         * Small PDUs need the most memory per L2CAP byte, so this is the size with the default data length.
+         */
+        static constexpr std::size_t    guaranteed_l2cap_transmit_size = min_l2cap_memory / min_fragment_memory * min_payload_size + last_fragment_payload;
+
         static_assert( TransmitSize >= layout_overhead + min_buffer_size,
             "TransmitSize should at least be large enough to store one L2CAP PDU plus overheader required by the hardware." );
 
@@ -81,11 +264,11 @@ namespace link_layer {
         /**
          * @brief returns the maximum value that can be used as maximum receive size.
          *
-         * The result is equal to ReceiveSize.
+         * With the default storage, the result is equal to ReceiveSize minus the layout overhead.
          */
         constexpr std::size_t max_max_rx_size() const
         {
-            return ReceiveSize - layout_overhead;
+            return storage_t::max_receive_size;
         }
 
         /**
@@ -109,13 +292,13 @@ namespace link_layer {
         void max_rx_size( std::size_t max_size );
 
         /**
-         * @brief returns the maximum value that can be used as maximum receive size.
+         * @brief returns the maximum value that can be used as maximum transmit size.
          *
-         * The result is equal to TransmitSize.
+         * With the default storage, the result is equal to TransmitSize minus the layout overhead.
          */
         constexpr std::size_t max_max_tx_size() const
         {
-            return TransmitSize - ( layout::data_channel_pdu_memory_size( 0 ) - 2 );
+            return storage_t::max_transmit_size;
         }
 
         /**
@@ -210,6 +393,43 @@ namespace link_layer {
          */
         void commit_transmit_buffer( read_buffer );
 
+        /**
+         * @brief allocates memory for an L2CAP PDU, that might be too large to fit into a single LL PDU
+         *
+         * The returned memory spans as many consecutive PDUs of max_tx_size() as are necessary to store an L2CAP PDU
+         * of l2cap_size bytes (including the L2CAP header). The L2CAP PDU has to be written contiguously to
+         * layout::body( result ).first. Once the size of the L2CAP PDU is known, commit_l2cap_transmit_buffer() splits
+         * the PDU in place into a start fragment and continuation fragments.
+         *
+         * To make sure, that the memory can be allocated, once the transmit buffer is empty, the allocated memory is
+         * limited to half of the TransmitSize (but at least one PDU of max_tx_size()). Use l2cap_transmit_size() to
+         * query the size of the L2CAP PDU that can be stored in the returned memory.
+         *
+         * If not enough memory is available, the function will return an empty buffer (size == 0).
+         *
+         * @pre buffer is in running mode
+         */
+        read_buffer allocate_l2cap_transmit_buffer( std::size_t l2cap_size );
+
+        /**
+         * @brief the maximum size of an L2CAP PDU (including the L2CAP header), that fits into a buffer allocated by allocate_l2cap_transmit_buffer()
+         */
+        std::size_t l2cap_transmit_size( const read_buffer& ) const;
+
+        /**
+         * @brief splits an L2CAP PDU of l2cap_size bytes into LL PDUs and commits them for transmission
+         *
+         * The first LL PDU is marked as start of an L2CAP PDU, all following LL PDUs are marked as continuation fragments.
+         * The fragments are moved to their place in the transmit buffer, starting with the last fragment, so no additional
+         * memory is required.
+         *
+         * @pre buffer was allocated by a call to allocate_l2cap_transmit_buffer()
+         * @pre l2cap_size > 0 && l2cap_size <= l2cap_transmit_size( buffer )
+         * @pre max_tx_size() was not changed since the call to allocate_l2cap_transmit_buffer()
+         * @pre buffer is in running mode
+         */
+        void commit_l2cap_transmit_buffer( read_buffer buffer, std::size_t l2cap_size );
+
         /**@}*/
 
         /**@{*/
@@ -287,149 +507,247 @@ namespace link_layer {
         /**@}*/
 
     private:
-        // transmit buffer followed by receive buffer at buffer_[ TransmitSize ]
-        std::uint8_t    buffer_[ size ];
-
-        pdu_ring_buffer< ReceiveSize, read_buffer, layout >  receive_buffer_;
+        storage_t                       storage_;
         volatile std::size_t            max_rx_size_;
-
-        pdu_ring_buffer< TransmitSize, read_buffer, layout > transmit_buffer_;
         volatile std::size_t            max_tx_size_;
 
         bool                    sequence_number_;
         bool                    next_expected_sequence_number_;
+        // the oldest PDU in the transmit buffer got its sequence number assigned
+        bool                    next_numbered_;
         uint8_t                 empty_[ layout::data_channel_pdu_memory_size( 0 ) ];
         bool                    next_empty_;
         bool                    empty_sequence_number_;
 
-        static constexpr std::size_t  ll_header_size = 2;
-        static constexpr std::uint8_t more_data_flag = 0x10;
-        static constexpr std::uint8_t sn_flag        = 0x8;
-        static constexpr std::uint8_t nesn_flag      = 0x4;
-        static constexpr std::uint8_t ll_empty_id    = 0x01;
+        static constexpr std::size_t  ll_header_size     = 2;
+        static constexpr std::uint8_t more_data_flag     = 0x10;
+        static constexpr std::uint8_t sn_flag            = 0x8;
+        static constexpr std::uint8_t nesn_flag          = 0x4;
+        static constexpr std::uint8_t ll_empty_id        = 0x01;
+        static constexpr std::uint8_t ll_continuation_id = 0x01;
+        static constexpr std::uint8_t ll_start_id        = 0x02;
 
+        struct no_lock {};
 
-        const std::uint8_t* transmit_buffer() const
+        // serializes the accesses of the link layer with the radio, if the storage requires this
+        class storage_lock
         {
-            return &buffer_[ 0 ];
-        }
+        public:
+            storage_lock() {}
+            ~storage_lock() {}
 
-        std::uint8_t* transmit_buffer()
-        {
-            return &buffer_[ 0 ];
-        }
+        private:
+            typename std::conditional< storage_t::lock_free, no_lock, typename Radio::lock_guard >::type lock_;
+        };
 
-        const std::uint8_t* receive_buffer() const
-        {
-            return &buffer_[ TransmitSize ];
-        }
+        write_buffer set_next_expected_sequence_number( read_buffer ) const;
 
-        std::uint8_t* receive_buffer()
-        {
-            return &buffer_[ TransmitSize ];
-        }
+        void commit_transmit_pdu( read_buffer pdu );
 
-        write_buffer set_next_expected_sequence_number( read_buffer ) const;
+        void assign_sequence_number( read_buffer next );
 
         void acknowledge( bool sequence_number );
     };
 
+    template < typename Radio, std::size_t TransmitSize, std::size_t ReceiveSize >
+    class connection_pdu_buffer;
+
+    /*
+     * a connection_pdu_buffer uses the layout of the radio, it is used with
+     */
+    template < typename Radio, std::size_t TransmitSize, std::size_t ReceiveSize >
+    struct pdu_layout_by_radio< connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >
+    {
+        using pdu_layout = typename pdu_layout_by_radio< Radio >::pdu_layout;
+    };
+
+    /**
+     * @brief receive and transmit buffers of a single connection, for radios that support multiple connections
+     *
+     * If the link layer maintains more than one connection, every connection owns a connection_pdu_buffer, while
+     * the ll_data_pdu_buffer inherited by the radio is only used for advertising. Before a connection event is
+     * scheduled, the link layer passes the buffer of the connection to the radio. The radio then uses the interface
+     * to the radio hardware of the passed buffer, instead of the one of its own ll_data_pdu_buffer.
+     *
+     * Encryption is not supported, so the packet counters are not maintained.
+     */
+    template < typename Radio, std::size_t TransmitSize, std::size_t ReceiveSize >
+    class connection_pdu_buffer : public ll_data_pdu_buffer< TransmitSize, ReceiveSize, connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >
+    {
+    public:
+        /**
+         * @brief the connection_pdu_buffer is synchronized with the same means as the radios buffer
+         */
+        using lock_guard = typename Radio::lock_guard;
+
+        /**@{*/
+        /**
+         * @name Interface to the radio hardware
+         */
+        using ll_data_pdu_buffer< TransmitSize, ReceiveSize, connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >::allocate_receive_buffer;
+        using ll_data_pdu_buffer< TransmitSize, ReceiveSize, connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >::received;
+        using ll_data_pdu_buffer< TransmitSize, ReceiveSize, connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >::crc_error;
+        using ll_data_pdu_buffer< TransmitSize, ReceiveSize, connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >::timeout;
+        using ll_data_pdu_buffer< TransmitSize, ReceiveSize, connection_pdu_buffer< Radio, TransmitSize, ReceiveSize > >::next_transmit;
+        /**@}*/
+
+        void increment_receive_packet_counter() {}
+        void increment_transmit_packet_counter() {}
+    };
+
     // implementation
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::ll_data_pdu_buffer()
-        : receive_buffer_( receive_buffer() )
-        , transmit_buffer_( transmit_buffer() )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::ll_data_pdu_buffer()
     {
         layout::header( empty_, 0 );
         reset();
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    std::size_t ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::max_rx_size() const
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    std::size_t ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::max_rx_size() const
     {
         return max_rx_size_;
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::max_rx_size( std::size_t max_size )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::max_rx_size( std::size_t max_size )
     {
         assert( max_size >= min_buffer_size );
         assert( max_size <= max_buffer_size );
-        assert( max_size <= ReceiveSize - layout_overhead );
+        assert( max_size <= max_max_rx_size() );
 
         max_rx_size_ = max_size;
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    std::size_t ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::max_tx_size() const
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    std::size_t ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::max_tx_size() const
     {
         return max_tx_size_;
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::max_tx_size( std::size_t max_size )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::max_tx_size( std::size_t max_size )
     {
         assert( max_size >= min_buffer_size );
         assert( max_size <= max_buffer_size );
-        assert( max_size <= TransmitSize - layout_overhead );
+        assert( max_size <= max_max_tx_size() );
 
         max_tx_size_ = max_size;
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::reset()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::reset()
     {
-        max_rx_size_    = min_buffer_size;
-        receive_buffer_.reset( receive_buffer() );
+        typename Radio::lock_guard lock;
 
+        max_rx_size_    = min_buffer_size;
         max_tx_size_    = min_buffer_size;
-        transmit_buffer_.reset( transmit_buffer() );
+        storage_.reset();
 
         sequence_number_ = false;
         next_expected_sequence_number_ = false;
+        next_numbered_   = false;
         next_empty_      = false;
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    std::uint8_t* ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::raw()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    std::uint8_t* ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::raw()
     {
-        return &buffer_[ 0 ];
+        return storage_.raw();
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::allocate_transmit_buffer( std::size_t size )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::allocate_transmit_buffer( std::size_t size )
     {
-        typename Radio::lock_guard lock;
+        storage_lock lock;
+
+        return storage_.alloc_transmit( size );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::commit_transmit_buffer( read_buffer pdu )
+    {
+        storage_lock lock;
 
-        return transmit_buffer_.alloc_front( transmit_buffer(), size );
+        commit_transmit_pdu( pdu );
+        storage_.release_transmit_allocation();
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::commit_transmit_buffer( read_buffer pdu )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::commit_transmit_pdu( read_buffer pdu )
     {
         static constexpr std::uint8_t header_rfu_mask = 0xe0;
         static_cast< void >( header_rfu_mask );
 
-        // make sure, no NFU bits are set
-        std::uint16_t header = layout::header( pdu );
-        assert( ( header & header_rfu_mask ) == 0 );
+        // make sure, no NFU bits are set; the sequence number is added, when the PDU is transmitted
+        assert( ( layout::header( pdu ) & header_rfu_mask ) == 0 );
 
-        typename Radio::lock_guard lock;
+        storage_.push_transmit( pdu );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::allocate_l2cap_transmit_buffer( std::size_t l2cap_size )
+    {
+        const std::size_t payload   = max_tx_size_ - header_size;
+        const std::size_t fragments = l2cap_size == 0 ? 1 : ( l2cap_size + payload - 1 ) / payload;
+        const std::size_t last_size = l2cap_size - ( fragments - 1 ) * payload;
+        const std::size_t max_size  = std::max( std::size_t{ storage_t::max_l2cap_transmit_memory }, max_tx_size_ + layout_overhead );
+
+        const std::size_t size      = std::min( max_size,
+            ( fragments - 1 ) * storage_t::fragment_memory( payload ) + layout::data_channel_pdu_memory_size( last_size ) );
 
-        // add sequence number
-        if ( sequence_number_ )
+        return allocate_transmit_buffer( size );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    std::size_t ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::l2cap_transmit_size( const read_buffer& buffer ) const
+    {
+        const std::size_t payload     = max_tx_size_ - header_size;
+        const std::size_t pdu_memory  = storage_t::fragment_memory( payload );
+        const std::size_t last_memory = buffer.size % pdu_memory;
+        const std::size_t overhead    = layout::data_channel_pdu_memory_size( 0 );
+
+        return buffer.size / pdu_memory * payload + ( last_memory > overhead ? std::min( payload, last_memory - overhead ) : 0 );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::commit_l2cap_transmit_buffer( read_buffer buffer, std::size_t l2cap_size )
+    {
+        assert( l2cap_size > 0 );
+        assert( l2cap_size <= l2cap_transmit_size( buffer ) );
+
+        const std::size_t   payload    = max_tx_size_ - header_size;
+        const std::size_t   pdu_memory = storage_t::fragment_memory( payload );
+        const std::size_t   fragments  = ( l2cap_size + payload - 1 ) / payload;
+        const std::uint8_t* l2cap      = layout::body( buffer ).first;
+
+        // every fragment is moved towards the end of the buffer; starting with the last fragment makes sure,
+        // that no fragment is overwritten before it was moved.
+        for ( std::size_t fragment = fragments - 1; fragment != 0; --fragment )
         {
-            header |= sn_flag;
-            layout::header( pdu, header );
+            const std::uint8_t* begin = l2cap + fragment * payload;
+            const std::size_t   size  = std::min( payload, l2cap_size - fragment * payload );
+            const read_buffer   pdu{ buffer.buffer + fragment * pdu_memory, layout::data_channel_pdu_memory_size( size ) };
+
+            std::copy_backward( begin, begin + size, layout::body( pdu ).first + size );
         }
 
-        sequence_number_ = !sequence_number_;
+        storage_lock lock;
 
-        transmit_buffer_.push_front( transmit_buffer(), pdu );
+        for ( std::size_t fragment = 0; fragment != fragments; ++fragment )
+        {
+            const std::size_t   size  = std::min( payload, l2cap_size - fragment * payload );
+            const read_buffer   pdu{ buffer.buffer + fragment * pdu_memory, layout::data_channel_pdu_memory_size( size ) };
+
+            layout::header( pdu, static_cast< std::uint16_t >( ( fragment == 0 ? ll_start_id : ll_continuation_id ) | ( size << 8 ) ) );
+            commit_transmit_pdu( pdu );
+        }
+
+        storage_.release_transmit_allocation();
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::set_next_expected_sequence_number( read_buffer buf ) const
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::set_next_expected_sequence_number( read_buffer buf ) const
     {
         // insert the next expected sequence for every attempt to send the PDU, because it could be that
         // the slave is able to receive data, while the master is not able to.
@@ -444,10 +762,10 @@ namespace link_layer {
         return write_buffer( buf );
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::next_transmit()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::next_transmit()
     {
-        const read_buffer next = transmit_buffer_.next_end();
+        const read_buffer next = storage_.next_transmit();
 
         if ( next_empty_ )
         {
@@ -477,14 +795,33 @@ namespace link_layer {
             return set_next_expected_sequence_number( read_buffer{ &empty_[ 0 ], sizeof( empty_ ) } );
         }
 
-        if ( transmit_buffer_.more_than_one() )
+        assign_sequence_number( next );
+
+        if ( storage_.more_than_one_transmit() )
             layout::header( next, layout::header( next ) | more_data_flag );
 
         return set_next_expected_sequence_number( next );
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::acknowledge( bool nesn )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::assign_sequence_number( read_buffer next )
+    {
+        // the oldest PDU gets a new sequence number only once
+        if ( next_numbered_ )
+            return;
+
+        const std::uint16_t header = layout::header( next );
+
+        layout::header( next, sequence_number_
+            ? ( header | sn_flag )
+            : ( header & ~sn_flag ) );
+
+        next_numbered_   = true;
+        sequence_number_ = !sequence_number_;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::acknowledge( bool nesn )
     {
         if ( next_empty_ )
         {
@@ -493,51 +830,54 @@ namespace link_layer {
         }
         else
         {
-            const read_buffer next = transmit_buffer_.next_end();
+            const read_buffer next = storage_.next_transmit();
 
             // the transmit buffer could be empty if we receive without sending prior. That happens during testing
             if ( next.empty() )
                 return;
 
+            assign_sequence_number( next );
+
             const std::uint16_t header = layout::header( next );
             if ( static_cast< bool >( header & sn_flag ) != nesn )
             {
-                transmit_buffer_.pop_end( transmit_buffer() );
+                next_numbered_ = false;
+                storage_.pop_transmit();
                 static_cast< Radio* >( this )->increment_transmit_packet_counter();
             }
         }
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::allocate_transmit_buffer()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::allocate_transmit_buffer()
     {
         return allocate_transmit_buffer( max_tx_size_ + layout_overhead );
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::next_received() const
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::next_received() const
     {
-        typename Radio::lock_guard lock;
+        storage_lock lock;
 
-        return write_buffer( receive_buffer_.next_end() );
+        return write_buffer( storage_.next_received() );
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::free_received()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::free_received()
     {
-        typename Radio::lock_guard lock;
+        storage_lock lock;
 
-        receive_buffer_.pop_end( receive_buffer() );
+        storage_.pop_received();
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::allocate_receive_buffer() const
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    read_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::allocate_receive_buffer() const
     {
-        return receive_buffer_.alloc_front( const_cast< std::uint8_t* >( receive_buffer() ), layout::data_channel_pdu_memory_size( max_rx_size_ - ll_header_size ) );
+        return const_cast< storage_t& >( storage_ ).alloc_receive( layout::data_channel_pdu_memory_size( max_rx_size_ - ll_header_size ) );
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::received( read_buffer pdu )
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::received( read_buffer pdu )
     {
         const std::uint16_t header = layout::header( pdu );
 
@@ -553,7 +893,7 @@ namespace link_layer {
 
                 if ( ( header & 0xff00 ) != 0 )
                 {
-                    receive_buffer_.push_front( receive_buffer(), pdu );
+                    storage_.push_receive( pdu );
                     static_cast< Radio* >( this )->increment_receive_packet_counter();
                 }
             }
@@ -562,14 +902,14 @@ namespace link_layer {
         return next_transmit();
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::crc_error()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    write_buffer ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::crc_error()
     {
         return write_buffer{ 0, 0 };
     }
 
-    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio >
-    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio >::timeout()
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Radio, template < std::size_t, std::size_t, typename > class Storage >
+    void ll_data_pdu_buffer< TransmitSize, ReceiveSize, Radio, Storage >::timeout()
     {
     }
 }
@@ -14,6 +14,8 @@ namespace link_layer
         struct device_address_meta_type {};
         struct buffer_sizes_meta_type {};
         struct mtu_size_meta_type {};
+        struct notifications_per_event_meta_type {};
+        struct max_connections_meta_type {};
     }
 
     /**
@@ -118,6 +120,8 @@ namespace link_layer
 
     /**
      * @brief defines link layer transmit and receive buffer sizes
+     *
+     * @sa auto_buffer_sizes
      */
     template < std::size_t TransmitSize = 61, std::size_t ReceiveSize = 61 >
     struct buffer_sizes
@@ -137,15 +141,53 @@ namespace link_layer
          * configured link layer receive buffer size in bytes.
          */
         static constexpr std::size_t receive_buffer_size  = ReceiveSize;
+
+        /** @cond HIDDEN_SYMBOLS */
+        template < class Requirements >
+        using impl = buffer_sizes< TransmitSize, ReceiveSize >;
+        /** @endcond */
+    };
+
+    /**
+     * @brief calculates the link layer transmit and receive buffer sizes from the GATT server and the link layer options
+     *
+     * Instead of giving the sizes explicitly by buffer_sizes, the recommended sizes are calculated at compile time:
+     * - the receive buffer has room for two link layer PDUs, large enough to carry an L2CAP PDU of max_mtu_size
+     *   (but not more than 251 bytes), so that the data length can be extended to that size.
+     * - the transmit buffer has room for one notification or indication of max_mtu_size for every characteristic,
+     *   that can be notified or indicated (but not more than max_notifications_per_event) and at least for two.
+     * - together, both buffers are large enough for the advertising types in use.
+     *
+     * The calculated sizes and the minimum sizes are available as link_layer::buffer_requirements. The sizes
+     * of characteristic values are not known at compile time, so notifications are assumed to be of MTU size.
+     *
+     * @sa buffer_sizes
+     * @sa max_mtu_size
+     * @sa max_notifications_per_event
+     */
+    struct auto_buffer_sizes
+    {
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::buffer_sizes_meta_type,
+            details::valid_link_layer_option_meta_type {};
+
+        template < class Requirements >
+        using impl = buffer_sizes< Requirements::recommended_transmit_size, Requirements::recommended_receive_size >;
+        /** @endcond */
     };
 
     /**
      * @brief define the maximum L2CAP MTU size to be used by the link layer
      *
-     * The default is the minimum of 23.
+     * The default is the minimum of 23, the maximum is 517 (the largest possible ATT attribute value plus
+     * the ATT header). L2CAP PDUs, that do not fit into a single link layer PDU are reassembled in a buffer
+     * of MaxMTU + 4 bytes.
      */
-    template < std::uint8_t MaxMTU >
+    template < std::uint16_t MaxMTU >
     struct max_mtu_size {
+        static_assert( MaxMTU >= 23 && MaxMTU <= 517, "MTU size must be in the range of 23 to 517" );
+
         /** @cond HIDDEN_SYMBOLS */
         struct meta_type :
             details::mtu_size_meta_type,
@@ -155,6 +197,58 @@ namespace link_layer
         /** @endcond */
     };
 
+    /**
+     * @brief limits the number of notification and indication PDUs, that are queued for transmission with
+     *        every call to link_layer::run()
+     *
+     * Usually, run() returns once per connection event. By default, notifications are queued until the transmit
+     * buffer is full or until there are no more outstanding notifications. A limit leaves room in the transmit
+     * buffer for other traffic, like ATT responses.
+     */
+    template < unsigned MaxNotifications >
+    struct max_notifications_per_event {
+        static_assert( MaxNotifications > 0, "at least one notification per connection event is required" );
+
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::notifications_per_event_meta_type,
+            details::valid_link_layer_option_meta_type {};
+
+        static constexpr unsigned max_notifications = MaxNotifications;
+        /** @endcond */
+    };
+
+    /**
+     * @brief defines the maximum number of simultaneous connections to centrals
+     *
+     * By default, the link layer supports a single connection and stops advertising, once a connection was
+     * established. With a MaxConnections larger than 1, the link layer keeps the state of every connection
+     * in an array, interleaves the connection events of all established connections and continues to advertise
+     * connectable, as long as not all connections are in use.
+     *
+     * Every connection has its own receive and transmit buffers of the size given by buffer_sizes. The buffers
+     * of the radio are then only used for advertising.
+     *
+     * More than one connection requires a scheduled radio, that supports multiple connections
+     * (hardware_supports_multiple_connections). Encryption and the L2CAP signaling channel are only supported
+     * with a single connection.
+     *
+     * To address a single connection, link_layer::disconnect() and link_layer::connection_parameter_update_request()
+     * take the connection data, that the server passes to the connection callbacks.
+     */
+    template < unsigned MaxConnections >
+    struct max_connections {
+        static_assert( MaxConnections > 0, "at least one connection is required" );
+
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::max_connections_meta_type,
+            details::valid_link_layer_option_meta_type {};
+
+        static constexpr unsigned connections = MaxConnections;
+        /** @endcond */
+    };
+
 }
 }
 
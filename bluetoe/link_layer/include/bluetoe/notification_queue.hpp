@@ -7,6 +7,8 @@
 #include <cassert>
 #include <algorithm>
 #include <iterator>
+#include <bluetoe/bits.hpp>
+#include <bluetoe/atomic_word.hpp>
 
 namespace bluetoe {
 namespace link_layer {
@@ -24,7 +26,7 @@ namespace link_layer {
             indication
         };
 
-        template < typename Size, int C >
+        template < typename Size, int C, class Lock >
         class notification_queue_impl_base;
 
         static constexpr std::size_t no_outstanding_indicaton = ~std::size_t{ 0 };
@@ -34,17 +36,21 @@ namespace link_layer {
      * @brief class responsible to keep track of those characteristics that have outstanding
      *        notifications or indications.
      *
-     * All operations on the queue must be reentrent / atomic!
+     * Queuing notifications and indications can be done from any context (interrupt service routines of any priority
+     * or other threads), while the link layer dequeues entries. All other functions must only be called from the context
+     * of the link layer. On targets without lock-free atomic read-modify-write operations (ATOMIC_INT_LOCK_FREE != 2),
+     * these operations are done while holding a Lock.
      *
      * @param Sizes List of number of characteristics that have notifications and / or indications enabled by priorities.
      * @param Mixin a class to be mixed in, to allow empty base class optimizations
+     * @param Lock RAII type, that locks out all producers while being in scope (like the radios lock_guard)
      *
      * For all function, index is an index into a list of all the characterstics with notifications / indications
-     * enable. The queue is implemented by an array that contains a few bits (2) per characteristic to store the
-     * requested (or queued) notifications / indications.
+     * enable. The queue is implemented by two bitmaps per priority, one for requested (or queued) notifications and one for
+     * indications. Characteristics of the same priority are served round robin.
      */
-    template < typename Sizes, class Mixin >
-    class notification_queue : public Mixin, details::notification_queue_impl_base< Sizes, 0 >
+    template < typename Sizes, class Mixin, class Lock = ::bluetoe::details::no_atomic_word_lock >
+    class notification_queue : public Mixin, details::notification_queue_impl_base< Sizes, 0, Lock >
     {
     public:
         using entry_type = details::notification_queue_entry_type;
@@ -108,53 +114,70 @@ namespace link_layer {
          */
         std::pair< details::notification_queue_entry_type, std::size_t > dequeue_indication_or_confirmation();
 
+        /**
+         * @brief return the next notification to be send
+         *
+         * Like dequeue_indication_or_confirmation(), but queued indications are left in the queue. Used to
+         * collect further notifications, once a notification was dequeued.
+         */
+        std::pair< details::notification_queue_entry_type, std::size_t > dequeue_notification();
+
         /**
          * @brief removes all entries from the queue
          */
         void clear_indications_and_confirmations();
 
     private:
-        using impl = details::notification_queue_impl_base< Sizes, 0 >;
+        using impl = details::notification_queue_impl_base< Sizes, 0, Lock >;
         std::size_t outstanding_confirmation_index_;
     };
 
     // impl
-    template < typename Sizes, class Mixin >
+    template < typename Sizes, class Mixin, class Lock >
     template < class ... Args >
-    notification_queue< Sizes, Mixin >::notification_queue( Args... mixin_arguments )
+    notification_queue< Sizes, Mixin, Lock >::notification_queue( Args... mixin_arguments )
         : Mixin( mixin_arguments... )
         , outstanding_confirmation_index_( details::no_outstanding_indicaton )
     {
     }
 
-    template < typename Sizes, class Mixin >
-    bool notification_queue< Sizes, Mixin >::queue_notification( std::size_t index )
+    template < typename Sizes, class Mixin, class Lock >
+    bool notification_queue< Sizes, Mixin, Lock >::queue_notification( std::size_t index )
     {
         return impl::queue_notification( index );
     }
 
-    template < typename Sizes, class Mixin >
-    bool notification_queue< Sizes, Mixin >::queue_indication( std::size_t index )
+    template < typename Sizes, class Mixin, class Lock >
+    bool notification_queue< Sizes, Mixin, Lock >::queue_indication( std::size_t index )
     {
         return impl::queue_indication( index );
     }
 
-    template < typename Sizes, class Mixin >
-    void notification_queue< Sizes, Mixin >::indication_confirmed()
+    template < typename Sizes, class Mixin, class Lock >
+    void notification_queue< Sizes, Mixin, Lock >::indication_confirmed()
     {
         outstanding_confirmation_index_ = details::no_outstanding_indicaton;
     }
 
-    template < typename Sizes, class Mixin >
-    std::pair< details::notification_queue_entry_type, std::size_t > notification_queue< Sizes, Mixin >::dequeue_indication_or_confirmation()
+    template < typename Sizes, class Mixin, class Lock >
+    std::pair< details::notification_queue_entry_type, std::size_t > notification_queue< Sizes, Mixin, Lock >::dequeue_indication_or_confirmation()
     {
         const auto result = impl::dequeue_indication_or_confirmation( 0, outstanding_confirmation_index_ );
 
         return result;
     }
 
-    template < typename Sizes, class Mixin >
-    void notification_queue< Sizes, Mixin >::clear_indications_and_confirmations()
+    template < typename Sizes, class Mixin, class Lock >
+    std::pair< details::notification_queue_entry_type, std::size_t > notification_queue< Sizes, Mixin, Lock >::dequeue_notification()
+    {
+        // pretending an outstanding confirmation, keeps indications in the queue
+        std::size_t outstanding_confirmation_index = 0;
+
+        return impl::dequeue_indication_or_confirmation( 0, outstanding_confirmation_index );
+    }
+
+    template < typename Sizes, class Mixin, class Lock >
+    void notification_queue< Sizes, Mixin, Lock >::clear_indications_and_confirmations()
     {
         outstanding_confirmation_index_ = details::no_outstanding_indicaton;
         impl::clear_indications_and_confirmations();
@@ -162,8 +185,10 @@ namespace link_layer {
 
     namespace details
     {
+        using ::bluetoe::details::lowest_bit_set;
+
         // C is introduced to make baseclasses with the very same Size not ambiguous
-        template < int Size, int C >
+        template < int Size, int C, class Lock >
         class notification_queue_impl
         {
         public:
@@ -172,103 +197,193 @@ namespace link_layer {
                 clear_indications_and_confirmations();
             }
 
+            notification_queue_impl( const notification_queue_impl& other )
+            {
+                *this = other;
+            }
+
+            notification_queue_impl& operator=( const notification_queue_impl& other )
+            {
+                next_ = other.next_;
+                copy( notification_words_, other.notification_words_ );
+                copy( indication_words_, other.indication_words_ );
+
+                for ( std::size_t word = 0; word != words; ++word )
+                {
+                    copy( notifications_[ word ], other.notifications_[ word ] );
+                    copy( indications_[ word ], other.indications_[ word ] );
+                }
+
+                return *this;
+            }
+
             bool queue_notification( std::size_t index )
             {
                 assert( index < Size );
-                return add( index, notification_bit );
+                return add( notifications_, notification_words_, index );
             }
 
             bool queue_indication( std::size_t index )
             {
                 assert( index < Size );
 
-                return add( index, indication_bit );
+                return add( indications_, indication_words_, index );
             }
 
             std::pair< notification_queue_entry_type, std::size_t > dequeue_indication_or_confirmation( std::size_t offset, std::size_t& outstanding_confirmation )
             {
-                bool ignore_first = true;
+                const bool indications_allowed = outstanding_confirmation == no_outstanding_indicaton;
+                const std::size_t i = next_pending( next_, indications_allowed );
 
-                // loop over all entries in a circle
-                for ( std::size_t i = next_; ignore_first || i != next_; i = ( i + 1 ) % Size )
-                {
-                    ignore_first = false;
-                    auto entry = at( i );
-
-                    if ( entry & indication_bit && outstanding_confirmation == no_outstanding_indicaton )
-                    {
-                        outstanding_confirmation = i + offset;
-                        next_ = ( i + 1 ) % Size;
-                        remove( i, indication_bit );
-                        return { indication, i + offset };
-                    }
-                    else if ( entry & notification_bit )
-                    {
-                        next_ = ( i + 1 ) % Size;
-                        remove( i, notification_bit );
-                        return { notification, i + offset };
-                    }
+                if ( i == Size )
+                    return { empty, 0 };
+
+                next_ = ( i + 1 ) % Size;
 
+                if ( indications_allowed && is_set( indications_, i ) )
+                {
+                    outstanding_confirmation = i + offset;
+                    remove( indications_, indication_words_, i );
+                    return { indication, i + offset };
                 }
 
-                return { empty, 0 };
+                remove( notifications_, notification_words_, i );
+                return { notification, i + offset };
             }
 
             void clear_indications_and_confirmations()
             {
                 next_ = 0;
-                std::fill( std::begin( queue_ ), std::end( queue_ ), 0 );
+                notification_words_.store( 0 );
+                indication_words_.store( 0 );
+
+                for ( std::size_t word = 0; word != words; ++word )
+                {
+                    notifications_[ word ].store( 0 );
+                    indications_[ word ].store( 0 );
+                }
             }
 
         private:
-            int at( std::size_t index )
+            static constexpr std::size_t bits_per_word = 32;
+            static constexpr std::size_t words         = ( Size + bits_per_word - 1 ) / bits_per_word;
+
+            static_assert( words <= bits_per_word, "more than 1024 characteristics with the same priority are not supported" );
+
+            using word_t = ::bluetoe::details::atomic_word< std::uint32_t, Lock >;
+            using bitmap = word_t[ words ];
+
+            static void copy( word_t& target, const word_t& source )
+            {
+                target.store( source.load() );
+            }
+
+            std::uint32_t pending_bits( std::size_t word, bool indications_allowed ) const
             {
-                const auto bit_offset  = ( index * bits_per_characteristc ) % 8;
-                const auto byte_offset = index * bits_per_characteristc / 8;
-                assert( byte_offset < sizeof( queue_ ) / sizeof( queue_[ 0 ] ) );
+                return notifications_[ word ].load() | ( indications_allowed ? indications_[ word ].load() : 0 );
+            }
 
-                return ( queue_[ byte_offset ] >> bit_offset ) & 0x03;
+            std::uint32_t pending_words( bool indications_allowed ) const
+            {
+                return notification_words_.load() | ( indications_allowed ? indication_words_.load() : 0 );
             }
 
-            bool add( std::size_t index, int bits )
+            /*
+             * The next pending entry, starting at start in circular order. Every word has a bit in a summary word,
+             * that is set, if any bit in the word is set. So finding the next pending entry takes 3 bit scans.
+             *
+             * A producer sets the bit in the summary word, after setting the bit of the entry. Thus a summary bit
+             * can be set for an empty word for a short while; such a word is skipped.
+             */
+            std::size_t next_pending( std::size_t start, bool indications_allowed )
             {
-                assert( bits & ( ( 1 << bits_per_characteristc ) -1 ) );
-                const auto bit_offset  = ( index * bits_per_characteristc ) % 8;
-                const auto byte_offset = index * bits_per_characteristc / 8;
-                assert( byte_offset < sizeof( queue_ ) / sizeof( queue_[ 0 ] ) );
+                const std::size_t   start_word = start / bits_per_word;
 
-                const bool result = ( queue_[ byte_offset ] & ( bits << bit_offset ) ) == 0;
-                queue_[ byte_offset ] |= bits << bit_offset;
+                // remaining bits in the start word
+                const std::uint32_t first = pending_bits( start_word, indications_allowed ) & ( ~std::uint32_t( 0 ) << ( start % bits_per_word ) );
+
+                if ( first )
+                    return start_word * bits_per_word + lowest_bit_set( first );
+
+                for ( ;; )
+                {
+                    const std::uint32_t summary = pending_words( indications_allowed );
+
+                    // following words and then, from the beginning
+                    const std::uint32_t following = start_word + 1 < bits_per_word
+                        ? summary & ( ~std::uint32_t( 0 ) << ( start_word + 1 ) )
+                        : 0;
+
+                    const std::uint32_t candidates = following ? following : summary;
+
+                    if ( candidates == 0 )
+                        return Size;
+
+                    const std::size_t   word = lowest_bit_set( candidates );
+                    const std::uint32_t bits = pending_bits( word, indications_allowed );
+
+                    if ( bits )
+                        return word * bits_per_word + lowest_bit_set( bits );
+
+                    update_summary( notifications_, notification_words_, word );
+                    update_summary( indications_, indication_words_, word );
+                }
+            }
+
+            static bool is_set( const bitmap& map, std::size_t index )
+            {
+                return map[ index / bits_per_word ].load() & ( std::uint32_t( 1 ) << ( index % bits_per_word ) );
+            }
+
+            /*
+             * can be called from any context
+             */
+            static bool add( bitmap& map, word_t& summary, std::size_t index )
+            {
+                const std::size_t   word = index / bits_per_word;
+                const std::uint32_t bit  = std::uint32_t( 1 ) << ( index % bits_per_word );
+
+                const bool result = ( map[ word ].fetch_or( bit ) & bit ) == 0;
+                summary.fetch_or( std::uint32_t( 1 ) << word );
 
                 return result;
             }
 
-            void remove( std::size_t index, int bits )
+            /*
+             * must only be called by the consumer
+             */
+            static void remove( bitmap& map, word_t& summary, std::size_t index )
             {
-                assert( bits & ( ( 1 << bits_per_characteristc ) -1 ) );
-                const auto bit_offset  = ( index * bits_per_characteristc ) % 8;
-                const auto byte_offset = index * bits_per_characteristc / 8;
-                assert( byte_offset < sizeof( queue_ ) / sizeof( queue_[ 0 ] ) );
+                const std::size_t   word = index / bits_per_word;
+                const std::uint32_t bit  = std::uint32_t( 1 ) << ( index % bits_per_word );
 
-                queue_[ byte_offset ] &= ~( bits << bit_offset );
+                if ( ( map[ word ].fetch_and( ~bit ) & ~bit ) == 0 )
+                    update_summary( map, summary, word );
             }
 
-            static constexpr std::size_t bits_per_characteristc = 2;
+            static void update_summary( bitmap& map, word_t& summary, std::size_t word )
+            {
+                const std::uint32_t word_bit = std::uint32_t( 1 ) << word;
+
+                // a producer could have set a bit in the word after it was found to be empty
+                summary.fetch_and( ~word_bit );
 
-            enum char_bits {
-                notification_bit = 0x01,
-                indication_bit   = 0x02
-            };
+                if ( map[ word ].load() != 0 )
+                    summary.fetch_or( word_bit );
+            }
 
             std::size_t     next_;
-            std::uint8_t    queue_[ ( Size * bits_per_characteristc + 7 ) / 8 ];
+            word_t          notification_words_;
+            word_t          indication_words_;
+            bitmap          notifications_;
+            bitmap          indications_;
         };
 
         /**
          * @brief Specialisation for one characteritics with notification or indication enabled
          */
-        template < int C >
-        class notification_queue_impl< 1, C >
+        template < int C, class Lock >
+        class notification_queue_impl< 1, C, Lock >
         {
         public:
             notification_queue_impl()
@@ -276,54 +391,65 @@ namespace link_layer {
             {
             }
 
-            bool queue_notification( std::size_t idx )
+            notification_queue_impl( const notification_queue_impl& other )
+                : state_( other.state_.load() )
             {
-                assert( idx == 0 );
+            }
 
-                const bool result = state_ == empty;
+            notification_queue_impl& operator=( const notification_queue_impl& other )
+            {
+                state_.store( other.state_.load() );
 
-                if ( result )
-                    state_ = notification;
+                return *this;
+            }
 
-                return result;
+            bool queue_notification( std::size_t idx )
+            {
+                assert( idx == 0 );
+
+                return add( notification );
             }
 
             bool queue_indication( std::size_t idx )
             {
                 assert( idx == 0 );
-                const bool result = state_ == empty;
 
-                if ( result )
-                    state_ = indication;
-
-                return result;
+                return add( indication );
             }
 
             std::pair< notification_queue_entry_type, std::size_t > dequeue_indication_or_confirmation( std::size_t offset, std::size_t& outstanding_confirmation )
             {
-                const auto result = state_ == notification || ( state_ == indication && outstanding_confirmation == details::no_outstanding_indicaton )
-                    ? std::pair< notification_queue_entry_type, std::size_t >{ static_cast< notification_queue_entry_type >( state_ ), offset }
+                // only the consumer changes a none empty state
+                const notification_queue_entry_type state = state_.load();
+
+                const auto result = state == notification || ( state == indication && outstanding_confirmation == details::no_outstanding_indicaton )
+                    ? std::pair< notification_queue_entry_type, std::size_t >{ state, offset }
                     : std::pair< notification_queue_entry_type, std::size_t >{ empty, 0 };
 
                 if ( result.first == indication )
                     outstanding_confirmation = offset;
 
                 if ( result.first != empty )
-                    state_ = empty;
+                    state_.store( empty );
 
                 return result;
             }
 
             void clear_indications_and_confirmations()
             {
-                state_ = empty;
+                state_.store( empty );
             }
         private:
-            notification_queue_entry_type state_;
+            bool add( notification_queue_entry_type entry )
+            {
+                return state_.compare_exchange( empty, entry );
+            }
+
+            ::bluetoe::details::atomic_word< notification_queue_entry_type, Lock > state_;
         };
 
-        template < int C >
-        class notification_queue_impl_base< std::tuple<>, C >
+        template < int C, class Lock >
+        class notification_queue_impl_base< std::tuple<>, C, Lock >
         {
         public:
             bool queue_notification( std::size_t ) { return false; }
@@ -337,14 +463,14 @@ namespace link_layer {
             void clear_indications_and_confirmations() {}
         };
 
-        template < int Size, class ...Ts, int C >
-        class notification_queue_impl_base< std::tuple< std::integral_constant< int, Size >, Ts... >, C >
-            : public notification_queue_impl_base< std::tuple< Ts... >, C + 1 >
-            , private notification_queue_impl< Size, C >
+        template < int Size, class ...Ts, int C, class Lock >
+        class notification_queue_impl_base< std::tuple< std::integral_constant< int, Size >, Ts... >, C, Lock >
+            : public notification_queue_impl_base< std::tuple< Ts... >, C + 1, Lock >
+            , private notification_queue_impl< Size, C, Lock >
         {
         public:
-            using base = notification_queue_impl_base< std::tuple< Ts... >, C + 1 >;
-            using impl = notification_queue_impl< Size, C >;
+            using base = notification_queue_impl_base< std::tuple< Ts... >, C + 1, Lock >;
+            using impl = notification_queue_impl< Size, C, Lock >;
 
             bool queue_notification( std::size_t idx )
             {
@@ -0,0 +1,484 @@
+#ifndef BLUETOE_LINK_LAYER_PDU_SLAB_STORAGE_HPP
+#define BLUETOE_LINK_LAYER_PDU_SLAB_STORAGE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+#include <bluetoe/bits.hpp>
+#include <bluetoe/buffer.hpp>
+
+namespace bluetoe {
+namespace link_layer {
+
+    /**
+     * @brief storage for the ll_data_pdu_buffer, that divides the memory into fixed size slots, shared by the
+     *        transmitting and the receiving side
+     *
+     * Every PDU is stored in a slot, large enough to store a PDU of SlotSize bytes (header + payload). Free slots
+     * are kept in a bitmap, so allocating and freeing a slot does not depend on the number of stored PDUs and slots
+     * can be freed in any order: a transmitted PDU, that waits for its acknowledgment, does not block the reuse
+     * of the slots of other PDUs. Only the memory for fragmented L2CAP PDUs spans consecutive slots. Such runs of
+     * free slots are searched a bitmap word at a time, by counting the trailing zeros and ones of each word; the cost
+     * grows with the number of free and used runs in the bitmap, not with the number of slots.
+     *
+     * The TransmitSize + ReceiveSize bytes of memory are used as a single arena, from which both sides allocate
+     * slots dynamically. To make sure, that a side can always make progress, the last free slot is not handed out
+     * to one side, if the other side does not own a slot.
+     *
+     * A slot stays reserved from the allocation until the PDU is freed. Memory, that was allocated but not used,
+     * is freed with the next allocation of the same side (and by release_transmit_allocation()).
+     *
+     * Use pdu_slab_storage for slots of 29 bytes (LL PDUs without Data Length Extension). To use larger slots, define
+     * an alias template with the desired SlotSize:
+     * @code
+     * template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout >
+     * using large_pdu_slab_storage = bluetoe::link_layer::basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, 251 >;
+     * @endcode
+     *
+     * @sa pdu_ring_storage
+     */
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    class basic_pdu_slab_storage
+    {
+    public:
+        /**
+         * @brief the size of memory in bytes that are return by raw()
+         */
+        static constexpr std::size_t size = TransmitSize + ReceiveSize;
+
+        /**
+         * @brief memory size of a single slot
+         */
+        static constexpr std::size_t slot_size = Layout::data_channel_pdu_memory_size( SlotSize - 2 );
+
+        /**
+         * @brief number of slots in the arena
+         */
+        static constexpr std::size_t slots = size / slot_size;
+
+        /**
+         * @brief the largest transmitted PDU (header + payload)
+         */
+        static constexpr std::size_t max_transmit_size = SlotSize;
+
+        /**
+         * @brief the largest received PDU (header + payload)
+         */
+        static constexpr std::size_t max_receive_size = SlotSize;
+
+        /**
+         * @brief the memory, allocated for a fragmented L2CAP PDU, is limited to half of the slots
+         */
+        static constexpr std::size_t max_l2cap_transmit_memory = slots / 2 * slot_size;
+
+        static_assert( SlotSize >= 29 && SlotSize <= 251, "SlotSize has to be in the range of 29 to 251" );
+        static_assert( slots >= 2, "there have to be at least two slots, one for transmitting and one for receiving" );
+        static_assert( slots < 256, "not more than 255 slots supported" );
+
+        /**
+         * @brief every fragment of an L2CAP PDU starts in its own slot
+         */
+        static constexpr std::size_t fragment_memory( std::size_t )
+        {
+            return slot_size;
+        }
+
+        /**
+         * @brief the bitmap of free slots is shared by both sides, so the link layer has to lock out the radio
+         */
+        static constexpr bool lock_free = false;
+
+        basic_pdu_slab_storage();
+
+        std::uint8_t* raw();
+
+        void reset();
+
+        read_buffer alloc_transmit( std::size_t size );
+
+        void push_transmit( const read_buffer& pdu );
+
+        void release_transmit_allocation();
+
+        read_buffer next_transmit() const;
+
+        void pop_transmit();
+
+        bool more_than_one_transmit() const;
+
+        read_buffer alloc_receive( std::size_t size );
+
+        void push_receive( const read_buffer& pdu );
+
+        read_buffer next_received() const;
+
+        void pop_received();
+
+        /**
+         * @brief number of slots, that are neither allocated nor store a PDU
+         */
+        std::size_t free_slots() const;
+
+    private:
+        static constexpr std::size_t    bits_per_word = 32;
+        static constexpr std::size_t    words         = ( slots + bits_per_word - 1 ) / bits_per_word;
+
+        // PDUs of one side in the order of their reception or their commitment
+        class queue
+        {
+        public:
+            void reset()
+            {
+                first_ = 0;
+                count_ = 0;
+            }
+
+            std::size_t size() const
+            {
+                return count_;
+            }
+
+            std::size_t front() const
+            {
+                return slots_[ first_ ];
+            }
+
+            void push( std::size_t slot )
+            {
+                assert( count_ != slots );
+                slots_[ ( first_ + count_ ) % slots ] = static_cast< std::uint8_t >( slot );
+                ++count_;
+            }
+
+            void pop()
+            {
+                assert( count_ );
+                first_ = ( first_ + 1 ) % slots;
+                --count_;
+            }
+
+        private:
+            std::uint8_t    slots_[ slots ];
+            std::size_t     first_;
+            std::size_t     count_;
+        };
+
+        // slots allocated by one side, but not jet used to store a PDU
+        struct allocation
+        {
+            std::size_t first;
+            std::size_t count;
+        };
+
+        static constexpr std::size_t slots_required( std::size_t memory )
+        {
+            return ( memory + slot_size - 1 ) / slot_size;
+        }
+
+        std::uint8_t* slot( std::size_t index );
+        const std::uint8_t* slot( std::size_t index ) const;
+        std::size_t slot_index( const std::uint8_t* pdu ) const;
+
+        read_buffer stored_pdu( std::size_t index ) const;
+
+        read_buffer allocate( allocation& alloc, std::size_t& used, std::size_t other_used, std::size_t memory );
+        void release( allocation& alloc, std::size_t& used, std::size_t count );
+        void take_from( allocation& alloc, std::size_t& used, std::size_t index );
+        void free_slot( std::size_t index, std::size_t& used );
+
+        std::size_t find_free( std::size_t count ) const;
+        void mark( std::size_t first, std::size_t count, bool used );
+
+        std::uint8_t    buffer_[ size ];
+
+        // a set bit denotes an allocated or used slot; bits behind the last slot are always set
+        std::uint32_t   used_[ words ];
+        std::size_t     free_;
+
+        queue           transmit_;
+        allocation      transmit_allocation_;
+        std::size_t     transmit_used_;
+
+        queue           receive_;
+        allocation      receive_allocation_;
+        std::size_t     receive_used_;
+    };
+
+    /**
+     * @brief basic_pdu_slab_storage with slots for LL PDUs without Data Length Extension
+     */
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout >
+    using pdu_slab_storage = basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, 29 >;
+
+    // implementation
+    /** @cond HIDDEN_SYMBOLS */
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::basic_pdu_slab_storage()
+    {
+        reset();
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    std::uint8_t* basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::raw()
+    {
+        return &buffer_[ 0 ];
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::reset()
+    {
+        for ( auto& word : used_ )
+            word = 0;
+
+        mark( slots, words * bits_per_word - slots, true );
+        free_ = slots;
+
+        transmit_.reset();
+        transmit_allocation_ = allocation{ 0, 0 };
+        transmit_used_       = 0;
+
+        receive_.reset();
+        receive_allocation_  = allocation{ 0, 0 };
+        receive_used_        = 0;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    read_buffer basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::alloc_transmit( std::size_t memory )
+    {
+        return allocate( transmit_allocation_, transmit_used_, receive_used_, memory );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::push_transmit( const read_buffer& pdu )
+    {
+        const std::size_t index = slot_index( pdu.buffer );
+
+        take_from( transmit_allocation_, transmit_used_, index );
+        transmit_.push( index );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::release_transmit_allocation()
+    {
+        release( transmit_allocation_, transmit_used_, transmit_allocation_.count );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    read_buffer basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::next_transmit() const
+    {
+        return transmit_.size() == 0
+            ? read_buffer{ nullptr, 0 }
+            : stored_pdu( transmit_.front() );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::pop_transmit()
+    {
+        free_slot( transmit_.front(), transmit_used_ );
+        transmit_.pop();
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    bool basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::more_than_one_transmit() const
+    {
+        return transmit_.size() > 1;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    read_buffer basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::alloc_receive( std::size_t memory )
+    {
+        assert( memory <= slot_size );
+
+        return allocate( receive_allocation_, receive_used_, transmit_used_, memory );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::push_receive( const read_buffer& pdu )
+    {
+        const std::size_t index = slot_index( pdu.buffer );
+
+        take_from( receive_allocation_, receive_used_, index );
+        receive_.push( index );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    read_buffer basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::next_received() const
+    {
+        return receive_.size() == 0
+            ? read_buffer{ nullptr, 0 }
+            : stored_pdu( receive_.front() );
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::pop_received()
+    {
+        free_slot( receive_.front(), receive_used_ );
+        receive_.pop();
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    std::size_t basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::free_slots() const
+    {
+        return free_;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    std::uint8_t* basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::slot( std::size_t index )
+    {
+        return &buffer_[ index * slot_size ];
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    const std::uint8_t* basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::slot( std::size_t index ) const
+    {
+        return &buffer_[ index * slot_size ];
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    std::size_t basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::slot_index( const std::uint8_t* pdu ) const
+    {
+        assert( pdu >= &buffer_[ 0 ] && pdu < &buffer_[ slots * slot_size ] );
+        assert( ( pdu - &buffer_[ 0 ] ) % slot_size == 0 );
+
+        return static_cast< std::size_t >( pdu - &buffer_[ 0 ] ) / slot_size;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    read_buffer basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::stored_pdu( std::size_t index ) const
+    {
+        std::uint8_t* const pdu = const_cast< std::uint8_t* >( slot( index ) );
+
+        return read_buffer{ pdu, Layout::data_channel_pdu_memory_size( Layout::header( pdu ) >> 8 ) };
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    read_buffer basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::allocate(
+        allocation& alloc, std::size_t& used, std::size_t other_used, std::size_t memory )
+    {
+        release( alloc, used, alloc.count );
+
+        const std::size_t count = slots_required( memory );
+
+        // leave the last free slot to the other side, if it owns no slot
+        if ( count + ( other_used == 0 ? 1 : 0 ) > free_ )
+            return read_buffer{ nullptr, 0 };
+
+        const std::size_t first = find_free( count );
+
+        if ( first == slots )
+            return read_buffer{ nullptr, 0 };
+
+        mark( first, count, true );
+        alloc  = allocation{ first, count };
+        used  += count;
+        free_ -= count;
+
+        return read_buffer{ slot( first ), memory };
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::release( allocation& alloc, std::size_t& used, std::size_t count )
+    {
+        mark( alloc.first, count, false );
+        alloc.first += count;
+        alloc.count -= count;
+        used        -= count;
+        free_       += count;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::take_from( allocation& alloc, std::size_t& used, std::size_t index )
+    {
+        assert( index >= alloc.first && index < alloc.first + alloc.count );
+
+        // slots in front of the PDU are not used
+        release( alloc, used, index - alloc.first );
+
+        // the slot of the PDU is not part of the allocation any more, but stays in use
+        ++alloc.first;
+        --alloc.count;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::free_slot( std::size_t index, std::size_t& used )
+    {
+        mark( index, 1, false );
+        --used;
+        ++free_;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    std::size_t basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::find_free( std::size_t count ) const
+    {
+        // the common case: the first word with a free slot
+        if ( count == 1 )
+        {
+            for ( std::size_t word = 0; word != words; ++word )
+            {
+                if ( used_[ word ] != ~std::uint32_t( 0 ) )
+                    return word * bits_per_word + ::bluetoe::details::lowest_bit_set( ~used_[ word ] );
+            }
+
+            return slots;
+        }
+
+        // runs of free slots are searched word by word: every step skips a whole run of free or of used slots
+        std::size_t first = 0;
+        std::size_t run   = 0;
+
+        for ( std::size_t word = 0; word != words; ++word )
+        {
+            for ( std::size_t bit = 0; bit != bits_per_word; )
+            {
+                const std::uint32_t used = used_[ word ] >> bit;
+
+                if ( used == 0 )
+                {
+                    run += bits_per_word - bit;
+                    break;
+                }
+
+                const std::size_t free_bits = ::bluetoe::details::lowest_bit_set( used );
+
+                if ( run + free_bits >= count )
+                    return first;
+
+                // the run ends in front of the next used slot; skip the used slots
+                const std::uint32_t not_used = ~( used >> free_bits );
+
+                bit  += free_bits + ( not_used == 0 ? bits_per_word : ::bluetoe::details::lowest_bit_set( not_used ) );
+                bit   = bit > bits_per_word ? bits_per_word : bit;
+                first = word * bits_per_word + bit;
+                run   = 0;
+            }
+
+            if ( run >= count )
+                return first;
+        }
+
+        return slots;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename Layout, std::size_t SlotSize >
+    void basic_pdu_slab_storage< TransmitSize, ReceiveSize, Layout, SlotSize >::mark( std::size_t first, std::size_t count, bool used )
+    {
+        while ( count != 0 )
+        {
+            const std::size_t   bit   = first % bits_per_word;
+            const std::size_t   bits  = count < bits_per_word - bit ? count : bits_per_word - bit;
+            const std::uint32_t mask  = ( bits == bits_per_word ? ~std::uint32_t( 0 ) : ( std::uint32_t( 1 ) << bits ) - 1 ) << bit;
+
+            used_[ first / bits_per_word ] = used
+                ? used_[ first / bits_per_word ] | mask
+                : used_[ first / bits_per_word ] & ~mask;
+
+            first += bits;
+            count -= bits;
+        }
+    }
+    /** @endcond */
+}
+}
+
+#endif
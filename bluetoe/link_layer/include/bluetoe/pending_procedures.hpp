@@ -0,0 +1,148 @@
+#ifndef BLUETOE_LINK_LAYER_PENDING_PROCEDURES_HPP
+#define BLUETOE_LINK_LAYER_PENDING_PROCEDURES_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+namespace bluetoe {
+namespace link_layer {
+namespace details {
+
+    /**
+     * @brief LL control procedures with an instant, that wait for their instant to be reached
+     *
+     * The bodies of the LL control PDUs (LL_CONNECTION_UPDATE_IND, LL_CHANNEL_MAP_IND, LL_PHY_UPDATE_IND) are
+     * copied, so that the receive buffer can be released and the data path is not blocked until the instant.
+     * For every opcode, there is at maximum one pending procedure.
+     *
+     * @param Size the maximum number of procedures that can be pending at the same time.
+     */
+    template < std::size_t Size >
+    class pending_procedures
+    {
+    public:
+        /**
+         * @brief size of the largest LL control PDU body with an instant (LL_CONNECTION_UPDATE_IND)
+         */
+        static constexpr std::size_t max_body_size = 12;
+
+        /**
+         * @brief constructs an empty set of pending procedures
+         *
+         * @post empty()
+         */
+        pending_procedures();
+
+        /**
+         * @brief stores the given LL control PDU body, that has to be applied at the given instant
+         *
+         * A pending procedure with the same opcode is replaced. Returns false, if there is no more room for the
+         * procedure.
+         *
+         * @pre size > 0 && size <= max_body_size
+         */
+        bool add( std::uint16_t instant, const std::uint8_t* body, std::size_t size );
+
+        /**
+         * @brief removes a procedure, that is due at the given connection event counter, and returns its body
+         *
+         * If no procedure is due, the function returns nullptr. The returned body stays valid until the next
+         * call to add() or reset().
+         */
+        const std::uint8_t* take_due( std::uint16_t conn_event_counter );
+
+        /**
+         * @brief returns true, if no procedure is pending
+         */
+        bool empty() const;
+
+        /**
+         * @brief discard all pending procedures
+         *
+         * @post empty()
+         */
+        void reset();
+
+    private:
+        struct procedure
+        {
+            std::uint16_t   instant;
+            std::uint8_t    size;
+            std::uint8_t    body[ max_body_size ];
+        };
+
+        // a procedure with size 0 is not pending
+        procedure   procedures_[ Size ];
+    };
+
+    // implementation
+    template < std::size_t Size >
+    pending_procedures< Size >::pending_procedures()
+    {
+        reset();
+    }
+
+    template < std::size_t Size >
+    bool pending_procedures< Size >::add( std::uint16_t instant, const std::uint8_t* body, std::size_t size )
+    {
+        procedure* slot = nullptr;
+
+        for ( auto& p : procedures_ )
+        {
+            if ( p.size != 0 && p.body[ 0 ] == body[ 0 ] )
+            {
+                slot = &p;
+                break;
+            }
+
+            if ( p.size == 0 && slot == nullptr )
+                slot = &p;
+        }
+
+        if ( slot == nullptr || size > max_body_size )
+            return false;
+
+        slot->instant = instant;
+        slot->size    = static_cast< std::uint8_t >( size );
+        std::copy( body, body + size, &slot->body[ 0 ] );
+
+        return true;
+    }
+
+    template < std::size_t Size >
+    const std::uint8_t* pending_procedures< Size >::take_due( std::uint16_t conn_event_counter )
+    {
+        for ( auto& p : procedures_ )
+        {
+            if ( p.size != 0 && p.instant == conn_event_counter )
+            {
+                p.size = 0;
+
+                return &p.body[ 0 ];
+            }
+        }
+
+        return nullptr;
+    }
+
+    template < std::size_t Size >
+    bool pending_procedures< Size >::empty() const
+    {
+        return std::none_of( std::begin( procedures_ ), std::end( procedures_ ),
+            []( const procedure& p ) { return p.size != 0; } );
+    }
+
+    template < std::size_t Size >
+    void pending_procedures< Size >::reset()
+    {
+        for ( auto& p : procedures_ )
+            p.size = 0;
+    }
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef BLUETOE_LINK_LAYER_PHY_ENCODINGS_HPP
+#define BLUETOE_LINK_LAYER_PHY_ENCODINGS_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace bluetoe {
+namespace link_layer {
+namespace details {
+
+    /**
+     * @brief encoding of the PHYs as used in the LL_PHY_REQ, LL_PHY_RSP and LL_PHY_UPDATE_IND PDUs
+     */
+    struct phy_ll_encoding {
+        enum phy_ll_encoding_t : std::uint8_t {
+            le_unchanged_coding = 0x00,
+            le_1m_phy           = 0x01,
+            le_2m_phy           = 0x02,
+            le_coded_phy        = 0x04
+        };
+    };
+
+    /**
+     * @brief time in µs, it takes to transmit a data channel PDU with the given size on the given PHY
+     *
+     * pdu_size is the size of the LL header and the payload (including a MIC, if present). Preamble (1 octet on
+     * LE 1M, 2 octets on LE 2M), access address and CRC are added. The coded PHY is not supported.
+     */
+    constexpr std::uint32_t air_time( phy_ll_encoding::phy_ll_encoding_t phy, std::size_t pdu_size )
+    {
+        return phy == phy_ll_encoding::le_2m_phy
+            ? static_cast< std::uint32_t >( ( pdu_size + 2 + 4 + 3 ) * 4 )
+            : static_cast< std::uint32_t >( ( pdu_size + 1 + 4 + 3 ) * 8 );
+    }
+
+}
+}
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <cassert>
 #include <cstdlib>
+#include <atomic>
 
 #include <bluetoe/buffer.hpp>
 #include <bluetoe/default_pdu_layout.hpp>
@@ -22,6 +23,12 @@ namespace link_layer {
      *
      * The Layout is used to access the header field of the PDU and to determin the in memory
      * length of stored PDUs.
+     *
+     * The ring can be used by a single producer (alloc_front(), push_front()) and a single consumer
+     * (next_end(), pop_end(), more_than_one()) that run concurrently (for example the link layer and the
+     * radio ISR) without further synchronization: the producer only changes the front_ pointer, the consumer only
+     * changes the end_ pointer and the PDU memory is handed over by release stores and acquire loads of these
+     * pointers. reset() requires both sides to be stopped.
      */
     template < std::size_t Size, typename Buffer = read_buffer, typename Layout = default_pdu_layout >
     class pdu_ring_buffer
@@ -76,20 +83,25 @@ namespace link_layer {
          * @brief returns the next PDU from the ring.
          *
          * If no PDU is stored in the ring, the function will return an empty write_buffer.
+         *
+         * @pre buffer must point to an array of at least Size bytes
          */
-        Buffer next_end() const;
+        Buffer next_end( std::uint8_t* buffer ) const;
 
         /**
          * @brief frees the last PDU at the end of the ring
          *
-         * @pre next_end().size == 0
+         * @pre next_end( buffer ).size != 0
+         * @pre buffer must point to an array of at least Size bytes
          */
         void pop_end( std::uint8_t* buffer );
 
         /**
          * @brief returns true, if the buffer contains at least 2 elements
+         *
+         * @pre buffer must point to an array of at least Size bytes
          */
-        bool more_than_one() const;
+        bool more_than_one( std::uint8_t* buffer ) const;
 
     private:
         static constexpr std::size_t    ll_header_size = 2;
@@ -101,14 +113,24 @@ namespace link_layer {
         template < typename P >
         static std::size_t pdu_length( P* );
 
+        // the position of the oldest PDU, if the ring is not empty and end is the position of a wrap mark or
+        // too close to the end of the buffer to contain a PDU header, the oldest PDU is at the beginning of the buffer
+        static std::uint8_t* wrapped_end( std::uint8_t* buffer, std::uint8_t* end, const std::uint8_t* front );
+
+        // consumer side: if end_ points to a wrap mark, end_ is moved to the beginning of the buffer, so that the
+        // producer can use the memory behind the mark again.
+        std::uint8_t* follow_wrap_mark( std::uint8_t* buffer, const std::uint8_t* front ) const;
+
         // 1) if end_ == front_, the ring is empty
         //        end_ and front_ can point to everywhere into the buffer
         // 2) if front_ > end_, the all elements are between front_ and end_
         // 3) if end_ > front_, -> buffer splited
         //        there are elements from front_ to the end of the buffer
         //        and there are elements from the beginning of the buffer till end_
-        std::uint8_t* end_;
-        std::uint8_t* front_;
+        // end_ is only written by the consumer, front_ is only written by the producer. If the consumer did not
+        // follow a wrap mark yet, end_ points to the wrap mark and the mark can not be overwritten.
+        mutable std::atomic< std::uint8_t* > end_;
+        std::atomic< std::uint8_t* > front_;
     };
 
     template < std::size_t Size, typename Buffer, typename Layout >
@@ -121,8 +143,8 @@ namespace link_layer {
     void pdu_ring_buffer< Size, Buffer, Layout >::reset( std::uint8_t* buffer )
     {
         assert( buffer );
-        front_ = buffer;
-        end_   = buffer;
+        front_.store( buffer, std::memory_order_relaxed );
+        end_.store( buffer, std::memory_order_relaxed );
 
         Layout::header( buffer, wrap_mark );
     }
@@ -133,24 +155,28 @@ namespace link_layer {
         assert( buffer );
         assert( size >= Layout::data_channel_pdu_memory_size( 0 ) );
 
+        // the consumer might free more memory concurrently, but it will not use memory that was freed
+        std::uint8_t* const end   = end_.load( std::memory_order_acquire );
+        std::uint8_t* const front = front_.load( std::memory_order_relaxed );
+
         // buffer splited? There must be one byte left to not overflow the ring.
-        if ( end_ > front_ && static_cast< std::ptrdiff_t >( size ) < end_ - front_ )
+        if ( end > front && static_cast< std::ptrdiff_t >( size ) < end - front )
         {
-            return Buffer{ front_, size };
+            return Buffer{ front, size };
         }
 
-        if ( front_ >= end_ )
+        if ( front >= end )
         {
             const std::uint8_t* end_of_buffer = buffer + Size;
 
             // allocate at the end?
-            if ( static_cast< std::ptrdiff_t >( size ) <= end_of_buffer - front_ )
+            if ( static_cast< std::ptrdiff_t >( size ) <= end_of_buffer - front )
             {
-                return Buffer{ front_, size };
+                return Buffer{ front, size };
             }
 
             // allocate at the begining? Again, there must be one byte left between the end front_ and the end_
-            if ( static_cast< std::ptrdiff_t >( size ) < end_ - buffer )
+            if ( static_cast< std::ptrdiff_t >( size ) < end - buffer )
             {
                 return Buffer{ buffer, size };
             }
@@ -165,40 +191,62 @@ namespace link_layer {
         assert( pdu.size >= pdu_length( pdu ) );
 
         const std::uint8_t* end_of_buffer = buffer + Size;
+        std::uint8_t* const front         = front_.load( std::memory_order_relaxed );
 
-        // set size to 0 to mark force the end_ pointer to wrap here
-        if ( front_ != pdu.buffer && front_ + 1 < end_of_buffer )
+        // set size to 0 to mark force the end_ pointer to wrap here. If the ring is empty, the consumer
+        // might currently point to this position, but it will not read the mark before the new front_ is published.
+        if ( front != pdu.buffer && front + 1 < end_of_buffer )
         {
-            Layout::header( front_, wrap_mark );
+            Layout::header( front, wrap_mark );
         }
 
-        const bool was_empty = front_ == end_;
-
-        front_ = pdu.buffer + pdu_length( pdu );
-
-        // if the ring was empty, the end_ ptr have to wrap too now
-        if ( was_empty )
-            end_ = pdu.buffer;
+        // publish the PDU and the wrap mark to the consumer
+        front_.store( pdu.buffer + pdu_length( pdu ), std::memory_order_release );
     }
 
     template < std::size_t Size, typename Buffer, typename Layout >
-    Buffer pdu_ring_buffer< Size, Buffer, Layout >::next_end() const
+    Buffer pdu_ring_buffer< Size, Buffer, Layout >::next_end( std::uint8_t* buffer ) const
     {
-        return front_ == end_
+        const std::uint8_t* const front = front_.load( std::memory_order_acquire );
+        std::uint8_t* const       end   = follow_wrap_mark( buffer, front );
+
+        return front == end
             ? Buffer{ 0, 0 }
-            : Buffer{ end_, pdu_length( end_ ) };
+            : Buffer{ end, pdu_length( end ) };
     }
 
     template < std::size_t Size, typename Buffer, typename Layout >
     void pdu_ring_buffer< Size, Buffer, Layout >::pop_end( std::uint8_t* buffer )
     {
-        end_ += pdu_length( end_ );
+        const std::uint8_t* const front = front_.load( std::memory_order_acquire );
+        std::uint8_t* const       end   = follow_wrap_mark( buffer, front );
+
+        // hand the memory of the PDU back to the producer and wrap right away, if the next PDU is already stored
+        // at the beginning of the buffer
+        end_.store( wrapped_end( buffer, end + pdu_length( end ), front ), std::memory_order_release );
+    }
+
+    template < std::size_t Size, typename Buffer, typename Layout >
+    std::uint8_t* pdu_ring_buffer< Size, Buffer, Layout >::follow_wrap_mark( std::uint8_t* buffer, const std::uint8_t* front ) const
+    {
+        std::uint8_t* const end     = end_.load( std::memory_order_relaxed );
+        std::uint8_t* const wrapped = wrapped_end( buffer, end, front );
 
+        // the consumer is the only writer of end_
+        if ( wrapped != end )
+            end_.store( wrapped, std::memory_order_release );
+
+        return wrapped;
+    }
+
+    template < std::size_t Size, typename Buffer, typename Layout >
+    std::uint8_t* pdu_ring_buffer< Size, Buffer, Layout >::wrapped_end( std::uint8_t* buffer, std::uint8_t* end, const std::uint8_t* front )
+    {
         const std::uint8_t* end_of_buffer = buffer + Size;
 
-        // wrap the end_ pointer to the beginning, if the buffer is not empty
-        if ( end_ != front_ && ( end_ + 1 >= end_of_buffer || end_[ 1 ] == wrap_mark ) )
-            end_ = buffer;
+        return end != front && ( end + 1 >= end_of_buffer || ( Layout::header( end ) >> 8 ) == wrap_mark )
+            ? buffer
+            : end;
     }
 
     template < std::size_t Size, typename Buffer, typename Layout >
@@ -216,9 +264,12 @@ namespace link_layer {
     }
 
     template < std::size_t Size, typename Buffer, typename Layout >
-    bool pdu_ring_buffer< Size, Buffer, Layout >::more_than_one() const
+    bool pdu_ring_buffer< Size, Buffer, Layout >::more_than_one( std::uint8_t* buffer ) const
     {
-        return end_ != front_ && ( end_ + pdu_length( end_) ) != front_;
+        const std::uint8_t* const front = front_.load( std::memory_order_acquire );
+        std::uint8_t* const       end   = follow_wrap_mark( buffer, front );
+
+        return end != front && ( end + pdu_length( end ) ) != front;
     }
 
 }
@@ -5,6 +5,7 @@
 #include <buffer.hpp>
 #include <address.hpp>
 #include <ll_data_pdu_buffer.hpp>
+#include <phy_encodings.hpp>
 
 namespace bluetoe {
 namespace link_layer {
@@ -71,13 +72,20 @@ namespace link_layer {
          *
          * Data to be transmitted and received is passed by the inherited ll_data_pdu_buffer.
          *
+         * receive_phy and transmit_phy denote the PHY used to receive PDUs from the master and to transmit
+         * PDUs to the master. The link layer will only pass details::phy_ll_encoding::le_2m_phy, if
+         * hardware_supports_2mbit is true. T_IFS is 150µs on all PHYs and start_receive / end_receive already
+         * contain the window widening. Both are independent from the used PHY.
+         *
          * @ret the distance from now to start_receive
          */
         bluetoe::link_layer::delta_time schedule_connection_event(
             unsigned                                    channel,
             bluetoe::link_layer::delta_time             start_receive,
             bluetoe::link_layer::delta_time             end_receive,
-            bluetoe::link_layer::delta_time             connection_interval );
+            bluetoe::link_layer::delta_time             connection_interval,
+            details::phy_ll_encoding::phy_ll_encoding_t receive_phy,
+            details::phy_ll_encoding::phy_ll_encoding_t transmit_phy );
 
         /**
          * @brief set the access address initial CRC value for transmitted and received PDU
@@ -214,6 +222,38 @@ namespace link_layer {
          * @brief indication no support for encryption
          */
         static constexpr bool hardware_supports_encryption = false;
+
+        /**
+         * @brief indication support for the LE 2M PHY
+         *
+         * If true, the link layer announces the LE 2M PHY feature and accepts the PHY update procedure.
+         */
+        static constexpr bool hardware_supports_2mbit = false;
+
+        /**
+         * @brief indication support for more than one connection
+         *
+         * If true, the link layer can be configured with max_connections<> greater than 1 and the radio has to implement
+         * select_connection_buffer() and connection_event_anchor().
+         */
+        static constexpr bool hardware_supports_multiple_connections = false;
+
+        /**
+         * @brief selects the buffer to be used by the next connection event
+         *
+         * With more than one connection, every connection has its own PDU buffers. The link layer selects the buffers of a
+         * connection, before it calls schedule_connection_event() for that connection. The inherited ll_data_pdu_buffer
+         * is then not used for connection events.
+         */
+        void select_connection_buffer( connection_pdu_buffer< scheduled_radio< TransmitSize, ReceiveSize, CallBack >, TransmitSize, ReceiveSize >& buffer );
+
+        /**
+         * @brief the offset of the new T0 from start_receive of the last connection event
+         *
+         * With more than one connection, the link layer keeps track of the anchors of all connections. This function is called
+         * from CallBack::end_event() to learn, when exactly the first PDU of the connection event was received.
+         */
+        delta_time connection_event_anchor() const;
     };
 
     /**
@@ -74,11 +74,38 @@ namespace details {
          */
         connection_security_attributes security_attributes() const;
 
+        /**
+         * @brief returns true, if the client is change-aware with respect to the GATT database
+         *
+         * A new connection starts change-aware. A layer that knows, that a bonded client has
+         * cached a different version of the GATT database, sets the client change-unaware.
+         */
+        bool change_aware() const;
+
+        /**
+         * @brief sets the change-aware state of the client
+         * @post change_aware() == aware
+         * @post !database_out_of_sync_reported()
+         */
+        void change_aware( bool aware );
+
+        /**
+         * @brief returns true, if a change-unaware client was informed by a "Database Out Of Sync" error response
+         */
+        bool database_out_of_sync_reported() const;
+
+        /**
+         * @brief records, that a change-unaware client was informed by a "Database Out Of Sync" error response
+         */
+        void database_out_of_sync_reported( bool reported );
+
     private:
         std::uint16_t               server_mtu_;
         std::uint16_t               client_mtu_;
         bool                        encrypted_;
         device_pairing_status       pairing_status_;
+        bool                        change_aware_;
+        bool                        out_of_sync_reported_;
     };
 
     /** @cond HIDDEN_SYMBOLS */
@@ -89,6 +116,8 @@ namespace details {
         , client_mtu_( details::default_att_mtu_size )
         , encrypted_( false )
         , pairing_status_( device_pairing_status::no_key )
+        , change_aware_( true )
+        , out_of_sync_reported_( false )
     {
         assert( server_mtu >= details::default_att_mtu_size );
     }
@@ -148,6 +177,31 @@ namespace details {
         return connection_security_attributes{ encrypted_, pairing_status_ };
     }
 
+    template < class ATTState >
+    bool link_state< ATTState >::change_aware() const
+    {
+        return change_aware_;
+    }
+
+    template < class ATTState >
+    void link_state< ATTState >::change_aware( bool aware )
+    {
+        change_aware_         = aware;
+        out_of_sync_reported_ = false;
+    }
+
+    template < class ATTState >
+    bool link_state< ATTState >::database_out_of_sync_reported() const
+    {
+        return out_of_sync_reported_;
+    }
+
+    template < class ATTState >
+    void link_state< ATTState >::database_out_of_sync_reported( bool reported )
+    {
+        out_of_sync_reported_ = reported;
+    }
+
     /** @endcond */
 }
 }
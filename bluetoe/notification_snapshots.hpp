@@ -0,0 +1,388 @@
+#ifndef BLUETOE_NOTIFICATION_SNAPSHOTS_HPP
+#define BLUETOE_NOTIFICATION_SNAPSHOTS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <bluetoe/meta_types.hpp>
+#include <bluetoe/atomic_word.hpp>
+
+namespace bluetoe {
+
+    namespace details {
+        struct notification_snapshots_meta_type {};
+
+        template < std::uint16_t S, class Lock >
+        class notification_snapshot_ring;
+
+        class no_notification_snapshot_ring;
+    }
+
+    /**
+     * @brief defines the size of a per connection buffer in bytes, that stores the values of notified characteristics
+     *
+     * By default, the server keeps track of which characteristic has to be notified and reads the characteristics value,
+     * when the notification is actually send. A characteristic can only be queued once for notification and notify()
+     * returns false, as long as the characteristic is queued. Value changes between the call to notify() and the
+     * transmission of the notification are thus coalesced.
+     *
+     * With this option, notify() reads the value of the characteristic immediately, and stores the resulting ATT
+     * Handle Value Notification in a ring buffer of S bytes. The link layer transmits the stored notifications in the
+     * order in which notify() was called. If there is not enough room left in the buffer, notify() returns false and
+     * the application has to retry later. This allows lossless streaming of (for example) sampled sensor data.
+     *
+     * Every entry occupies the size of the notification PDU (opcode, handle and value), rounded up to an even number,
+     * plus 2 bytes. The notification is read directly into the buffer, so an entry is never split at the end of the
+     * buffer; if it does not fit in front of the end, the bytes up to the end are skipped. If there is less room left
+     * than the largest possible notification, the value is not truncated to the remaining room, but notify() returns
+     * false.
+     *
+     * As with notifications without this option, a value is truncated to the negotiated MTU. The stored notification
+     * has to fit into every transmit buffer of the link layer, so the link layer requires a transmit buffer, that
+     * can carry a notification of max_mtu_size with the default data length of 27 bytes (see auto_buffer_sizes).
+     *
+     * Indications are not affected by this option.
+     *
+     * notify() can be called from any context (interrupt service routines of any priority or other threads). Every
+     * call reserves room for its notification with a compare-and-swap operation, reads the value into that room and
+     * then marks the entry as committed. The link layer transmits an entry only after it was committed. Where atomic
+     * read-modify-write operations are lock-free (ATOMIC_INT_LOCK_FREE == 2, for example on a Cortex-M3 / M4), calls
+     * to notify() that preempt each other do not block. Elsewhere (for example on the Cortex-M0 of the nRF51), the
+     * compare-and-swap and the commit are done while holding the lock of the radio, which disables interrupts for a
+     * few instructions.
+     *
+     * @sa server
+     * @sa server::notify
+     *
+     * example:
+     * @code
+    std::int16_t adc_sample;
+
+    typedef bluetoe::server<
+        bluetoe::notification_snapshots< 256 >,
+        bluetoe::service<
+            bluetoe::service_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CA9 >,
+            bluetoe::characteristic<
+                bluetoe::bind_characteristic_value< decltype( adc_sample ), &adc_sample >,
+                bluetoe::notify
+            >
+        >
+    > sampling_server;
+     * @endcode
+     */
+    template < std::uint16_t S >
+    struct notification_snapshots {
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::notification_snapshots_meta_type,
+            details::valid_server_option_meta_type {};
+
+        static constexpr std::uint16_t buffer_size = S;
+
+        template < class Lock >
+        using buffer = details::notification_snapshot_ring< S, Lock >;
+        /** @endcond */
+    };
+
+namespace details {
+
+    /*
+     * default: no value snapshots, values are read, when the notification is send
+     */
+    struct no_notification_snapshots {
+        struct meta_type :
+            details::notification_snapshots_meta_type,
+            details::valid_server_option_meta_type {};
+
+        template < class Lock >
+        using buffer = no_notification_snapshot_ring;
+    };
+
+    /*
+     * Ring of variable sized snapshots with multiple producers (notify()) and a single consumer (the link layer).
+     * Every entry starts with a 16 bit header, followed by the stored PDU. Entries are stored contiguously and start
+     * at even positions, so that there is always room for a header in front of the end of the buffer. The header
+     * contains the size of the PDU or, with skip_entry set, the number of bytes to skip.
+     *
+     * The read and write positions run from 0 to 2 * capacity - 1 to distinguish a full from an empty ring. Producers
+     * reserve room by a compare-and-swap of the write position and commit an entry by setting the entries bit in the
+     * committed_ bitmap. The consumer stops at the first entry, that is not committed yet, and releases the memory of
+     * consumed entries by a store of the read position. Where read-modify-write operations are not lock-free, they are
+     * done while holding Lock (see atomic_word).
+     */
+    template < std::uint16_t S, class Lock = no_atomic_word_lock >
+    class notification_snapshot_ring
+    {
+    public:
+        static constexpr bool enabled = true;
+
+        notification_snapshot_ring();
+
+        /*
+         * reserves room for a snapshot of up to size bytes and returns a pointer to the reserved memory. If there is
+         * less room left, the remaining room is reserved and size is reduced accordingly. Returns nullptr, if there
+         * is no room left at all.
+         *
+         * Every reservation has to be committed by commit_snapshot(). Can be called concurrently.
+         *
+         * @pre size != 0
+         */
+        std::uint8_t* reserve_snapshot( std::size_t& size );
+
+        /*
+         * makes the first size bytes of a snapshot reserved by reserve_snapshot() available to the consumer.
+         * A size of 0 discards the reservation.
+         *
+         * @pre size is not larger than the size returned by reserve_snapshot()
+         */
+        void commit_snapshot( std::uint8_t* snapshot, std::size_t size );
+
+        /*
+         * returns the size of the oldest snapshot or 0, if there is no committed snapshot stored.
+         */
+        std::size_t next_snapshot_size();
+
+        /*
+         * copies the oldest snapshot to output and removes it from the ring
+         *
+         * @pre next_snapshot_size() != 0
+         * @pre output points to at least next_snapshot_size() bytes
+         */
+        void pop_snapshot( std::uint8_t* output );
+
+        /*
+         * removes all snapshots
+         */
+        void clear_snapshots();
+
+    private:
+        static constexpr std::size_t    header_size = 2;
+        static constexpr std::uint16_t  skip_entry  = 0x8000;
+        static constexpr std::size_t    capacity    = S - S % header_size;
+        static constexpr std::size_t    word_bits   = 32;
+
+        static_assert( capacity > header_size, "the buffer has to store at least one snapshot" );
+        static_assert( S <= skip_entry, "the buffer size must fit into a header" );
+
+        static std::size_t span( std::size_t size );
+        static std::size_t advance( std::size_t position, std::size_t size );
+
+        std::uint16_t header( std::size_t position ) const;
+        void header( std::size_t position, std::uint16_t value );
+
+        bool committed( std::size_t position ) const;
+        void commit( std::size_t position );
+        void release( std::size_t position, std::size_t size );
+
+        std::uint8_t                                buffer_[ S ];
+        // one bit for every even position, set by the producers, cleared by the consumer
+        atomic_word< std::uint32_t, Lock >          committed_[ ( capacity / header_size + word_bits - 1 ) / word_bits ];
+        // written by the consumer only
+        atomic_word< std::size_t, Lock >            read_;
+        // reserved by the producers
+        atomic_word< std::size_t, Lock >            write_;
+    };
+
+    class no_notification_snapshot_ring
+    {
+    public:
+        static constexpr bool enabled = false;
+
+        std::uint8_t* reserve_snapshot( std::size_t& ) { return nullptr; }
+        void commit_snapshot( std::uint8_t*, std::size_t ) {}
+        std::size_t next_snapshot_size() { return 0; }
+        void pop_snapshot( std::uint8_t* ) {}
+        void clear_snapshots() {}
+    };
+
+    // implementation
+    template < std::uint16_t S, class Lock >
+    notification_snapshot_ring< S, Lock >::notification_snapshot_ring()
+    {
+        clear_snapshots();
+    }
+
+    template < std::uint16_t S, class Lock >
+    std::uint8_t* notification_snapshot_ring< S, Lock >::reserve_snapshot( std::size_t& size )
+    {
+        assert( size != 0 );
+
+        const auto room = []( std::size_t bytes ) -> std::size_t {
+            return bytes > header_size ? bytes - header_size : 0;
+        };
+
+        std::size_t write;
+        std::size_t skip;
+        std::size_t reserved;
+
+        do
+        {
+            write = write_.load();
+
+            // the consumer must have finished reading the freed memory, before it gets overwritten
+            const std::size_t used = ( write + 2 * capacity - read_.load() ) % ( 2 * capacity );
+            const std::size_t free = capacity - used;
+            const std::size_t tail = capacity - write % capacity;
+
+            // room in front of the end of the buffer and after skipping the end of the buffer
+            const std::size_t room_here  = room( std::min( free, tail ) );
+            const std::size_t room_start = free > tail ? room( free - tail ) : 0;
+
+            skip     = room_here < size && room_start > room_here ? tail : 0;
+            reserved = std::min( size, skip ? room_start : room_here );
+
+            if ( reserved == 0 )
+                return nullptr;
+        }
+        while ( !write_.compare_exchange( write, advance( write, skip + span( reserved ) ) ) );
+
+        if ( skip )
+        {
+            header( write, static_cast< std::uint16_t >( skip_entry | ( skip - header_size ) ) );
+            commit( write );
+            write = advance( write, skip );
+        }
+
+        // until committed, the entry skips the whole reservation
+        header( write, static_cast< std::uint16_t >( skip_entry | ( span( reserved ) - header_size ) ) );
+        size = reserved;
+
+        return &buffer_[ write % capacity + header_size ];
+    }
+
+    template < std::uint16_t S, class Lock >
+    void notification_snapshot_ring< S, Lock >::commit_snapshot( std::uint8_t* snapshot, std::size_t size )
+    {
+        const std::size_t position = static_cast< std::size_t >( snapshot - buffer_ ) - header_size;
+        const std::size_t reserved = header_size + ( header( position ) & ~skip_entry );
+        const std::size_t used     = size == 0 ? 0 : span( size );
+
+        assert( used <= reserved );
+
+        // give back the unused room, if there was no reservation since. snapshot only tells the position in the buffer,
+        // but the write position can not be a whole buffer ahead of an uncommitted entry.
+        const std::size_t end = write_.load();
+
+        if ( end % capacity == ( position + reserved ) % capacity
+          && write_.compare_exchange( end, advance( end, 2 * capacity - reserved + used ) ) )
+        {
+            if ( used == 0 )
+                return;
+        }
+        else if ( used != 0 && used != reserved )
+        {
+            header( position + used, static_cast< std::uint16_t >( skip_entry | ( reserved - used - header_size ) ) );
+            commit( position + used );
+        }
+
+        if ( used != 0 )
+            header( position, static_cast< std::uint16_t >( size ) );
+
+        commit( position );
+    }
+
+    template < std::uint16_t S, class Lock >
+    std::size_t notification_snapshot_ring< S, Lock >::next_snapshot_size()
+    {
+        for ( ;; )
+        {
+            const std::size_t read = read_.load();
+
+            // wait for the producer to commit the oldest entry
+            if ( !committed( read ) )
+                return 0;
+
+            const std::uint16_t entry = header( read );
+
+            if ( ( entry & skip_entry ) == 0 )
+                return entry;
+
+            release( read, header_size + ( entry & ~skip_entry ) );
+        }
+    }
+
+    template < std::uint16_t S, class Lock >
+    void notification_snapshot_ring< S, Lock >::pop_snapshot( std::uint8_t* output )
+    {
+        const std::size_t size = next_snapshot_size();
+        assert( size != 0 );
+
+        const std::size_t read  = read_.load();
+        const std::uint8_t* const begin = &buffer_[ read % capacity + header_size ];
+        std::copy( begin, begin + size, output );
+
+        release( read, span( size ) );
+    }
+
+    template < std::uint16_t S, class Lock >
+    void notification_snapshot_ring< S, Lock >::clear_snapshots()
+    {
+        for ( auto& word : committed_ )
+            word.store( 0 );
+
+        read_.store( 0 );
+        write_.store( 0 );
+    }
+
+    template < std::uint16_t S, class Lock >
+    std::size_t notification_snapshot_ring< S, Lock >::span( std::size_t size )
+    {
+        return header_size + ( size + header_size - 1 ) / header_size * header_size;
+    }
+
+    template < std::uint16_t S, class Lock >
+    std::size_t notification_snapshot_ring< S, Lock >::advance( std::size_t position, std::size_t size )
+    {
+        return ( position + size ) % ( 2 * capacity );
+    }
+
+    template < std::uint16_t S, class Lock >
+    std::uint16_t notification_snapshot_ring< S, Lock >::header( std::size_t position ) const
+    {
+        position %= capacity;
+
+        return static_cast< std::uint16_t >( buffer_[ position ] | ( buffer_[ position + 1 ] << 8 ) );
+    }
+
+    template < std::uint16_t S, class Lock >
+    void notification_snapshot_ring< S, Lock >::header( std::size_t position, std::uint16_t value )
+    {
+        position %= capacity;
+
+        buffer_[ position ]     = static_cast< std::uint8_t >( value & 0xff );
+        buffer_[ position + 1 ] = static_cast< std::uint8_t >( value >> 8 );
+    }
+
+    template < std::uint16_t S, class Lock >
+    bool notification_snapshot_ring< S, Lock >::committed( std::size_t position ) const
+    {
+        const std::size_t bit = position % capacity / header_size;
+
+        return committed_[ bit / word_bits ].load() & ( std::uint32_t{ 1 } << bit % word_bits );
+    }
+
+    template < std::uint16_t S, class Lock >
+    void notification_snapshot_ring< S, Lock >::commit( std::size_t position )
+    {
+        const std::size_t bit = position % capacity / header_size;
+
+        // publish the entry, after it was completely written
+        committed_[ bit / word_bits ].fetch_or( std::uint32_t{ 1 } << bit % word_bits );
+    }
+
+    template < std::uint16_t S, class Lock >
+    void notification_snapshot_ring< S, Lock >::release( std::size_t position, std::size_t size )
+    {
+        const std::size_t bit = position % capacity / header_size;
+
+        committed_[ bit / word_bits ].fetch_and( ~( std::uint32_t{ 1 } << bit % word_bits ) );
+
+        // release the memory of the entry, after it was completely read
+        read_.store( advance( position, size ) );
+    }
+}
+}
+
+#endif
@@ -0,0 +1,401 @@
+#ifndef BLUETOE_PRECOMPUTED_DISCOVERY_HPP
+#define BLUETOE_PRECOMPUTED_DISCOVERY_HPP
+
+#include <bluetoe/attribute.hpp>
+#include <bluetoe/codes.hpp>
+#include <bluetoe/bits.hpp>
+#include <bluetoe/meta_types.hpp>
+#include <bluetoe/meta_tools.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <tuple>
+
+namespace bluetoe {
+
+    namespace details {
+        struct discovery_responses_meta_type {};
+
+        /*
+         * default: all discovery responses are assembled at runtime by accessing the attributes
+         */
+        struct no_precomputed_discovery_responses {
+            struct meta_type :
+                discovery_responses_meta_type,
+                valid_server_option_meta_type {};
+
+            template < typename Services, typename AttributeGenerators >
+            struct responses
+            {
+                static bool primary_services( std::uint16_t, std::uint16_t, std::uint8_t*, std::size_t& )
+                {
+                    return false;
+                }
+
+                static bool characteristic_declarations( std::uint16_t, std::uint16_t, std::uint8_t*, std::size_t& )
+                {
+                    return false;
+                }
+
+                static bool find_information( std::uint16_t, std::uint16_t, std::uint8_t*, std::size_t& )
+                {
+                    return false;
+                }
+            };
+        };
+    }
+
+    /**
+     * @brief precompute the responses to the GATT discovery procedures at compile time
+     *
+     * As the GATT database of a server is fixed at compile time, the responses to the
+     * "Discover All Primary Services" (Read By Group Type Request), "Discover All Characteristics of a Service"
+     * (Read By Type Request for the Characteristic Declaration) and "Discover All Characteristic Descriptors"
+     * (Find Information Request) procedures are constant too.
+     *
+     * With this option, the handle / UUID records of these responses are built as constant byte arrays at compile time.
+     * Assembling a response becomes a search for the first record in the requested handle range and a copy of as many
+     * records as fit into the negotiated MTU. No attribute access function is called.
+     *
+     * This costs flash memory for the records: 6 or 20 bytes per primary service, 7 or 21 bytes per characteristic
+     * and 4 or 18 bytes per attribute.
+     *
+     * example:
+     * @code
+    typedef bluetoe::server<
+        bluetoe::precomputed_discovery_responses,
+        ...
+    > server;
+     * @endcode
+     *
+     * @sa server
+     */
+    struct precomputed_discovery_responses {
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::discovery_responses_meta_type,
+            details::valid_server_option_meta_type {};
+
+        template < typename Services, typename AttributeGenerators >
+        struct responses;
+        /** @endcond */
+    };
+
+    /** @cond HIDDEN_SYMBOLS */
+    namespace details {
+
+        /*
+         * compile time list of bytes
+         */
+        template < std::uint8_t ... Bytes >
+        struct byte_list {};
+
+        template < typename ... Lists >
+        struct concat_byte_lists;
+
+        template <>
+        struct concat_byte_lists<>
+        {
+            using type = byte_list<>;
+        };
+
+        template < std::uint8_t ... Bytes >
+        struct concat_byte_lists< byte_list< Bytes... > >
+        {
+            using type = byte_list< Bytes... >;
+        };
+
+        template < std::uint8_t ... As, std::uint8_t ... Bs, typename ... Lists >
+        struct concat_byte_lists< byte_list< As... >, byte_list< Bs... >, Lists... >
+            : concat_byte_lists< byte_list< As..., Bs... >, Lists... > {};
+
+        template < std::uint16_t Value >
+        using le16_bytes = byte_list< static_cast< std::uint8_t >( Value & 0xff ), static_cast< std::uint8_t >( Value >> 8 ) >;
+
+        template < std::size_t ... I >
+        struct index_list {};
+
+        template < std::size_t N, std::size_t ... I >
+        struct make_index_list : make_index_list< N - 1, N - 1, I... > {};
+
+        template < std::size_t ... I >
+        struct make_index_list< 0, I... >
+        {
+            using type = index_list< I... >;
+        };
+
+        /*
+         * the little endian bytes of a 16 or 128 bit UUID
+         */
+        template < typename UUID, typename Indices = typename make_index_list< sizeof( UUID::bytes ) >::type >
+        struct uuid_bytes;
+
+        template < typename UUID, std::size_t ... I >
+        struct uuid_bytes< UUID, index_list< I... > >
+        {
+            using type = byte_list< UUID::bytes[ I ]... >;
+        };
+
+        /*
+         * places a byte_list into (read only) memory
+         */
+        template < typename List >
+        struct byte_blob;
+
+        template < std::uint8_t ... Bytes >
+        struct byte_blob< byte_list< Bytes... > >
+        {
+            static constexpr std::size_t size = sizeof ...(Bytes);
+
+            // one additional byte to not end up with an array of size 0
+            static constexpr std::uint8_t bytes[ sizeof ...(Bytes) + 1 ] = { Bytes..., 0 };
+        };
+
+        template < std::uint8_t ... Bytes >
+        constexpr std::uint8_t byte_blob< byte_list< Bytes... > >::bytes[ sizeof ...(Bytes) + 1 ];
+
+        /*
+         * list of records, with equal size, sorted by handle. Every record starts with the handle.
+         */
+        struct discovery_records
+        {
+            const std::uint8_t* begin;
+            const std::uint8_t* end;
+            std::size_t         record_size;
+
+            // first record with a handle equal or greater than handle
+            const std::uint8_t* lower_bound( std::uint16_t handle ) const
+            {
+                std::size_t first = 0;
+                std::size_t count = ( end - begin ) / record_size;
+
+                while ( count > 0 )
+                {
+                    const std::size_t step = count / 2;
+
+                    if ( read_handle( begin + ( first + step ) * record_size ) < handle )
+                    {
+                        first += step + 1;
+                        count -= step + 1;
+                    }
+                    else
+                    {
+                        count = step;
+                    }
+                }
+
+                return begin + first * record_size;
+            }
+        };
+
+        /*
+         * Assembles a response out of the records of 16 bit UUIDs and 128 bit UUIDs. The first record within the requested range
+         * defines, which of both lists is used. The response ends in front of the first record of the other list, so that a client,
+         * that continues behind the last reported handle, does not miss it. Returns false, if there is no record within the
+         * requested range.
+         */
+        inline bool discovery_response(
+            const discovery_records& short_uuids, std::uint8_t short_format,
+            const discovery_records& long_uuids, std::uint8_t long_format,
+            att_opcodes opcode, std::uint16_t starting_handle, std::uint16_t ending_handle,
+            std::uint8_t* output, std::size_t& out_size )
+        {
+            static constexpr std::size_t header_size = 2;
+
+            const std::uint8_t* const first_short = short_uuids.lower_bound( starting_handle );
+            const std::uint8_t* const first_long  = long_uuids.lower_bound( starting_handle );
+
+            const bool short_available = first_short != short_uuids.end && read_handle( first_short ) <= ending_handle;
+            const bool long_available  = first_long != long_uuids.end && read_handle( first_long ) <= ending_handle;
+
+            if ( ( !short_available && !long_available ) || out_size < header_size )
+                return false;
+
+            const bool use_short = short_available && ( !long_available || read_handle( first_short ) < read_handle( first_long ) );
+
+            const discovery_records& records = use_short ? short_uuids : long_uuids;
+            const std::uint8_t*      begin   = use_short ? first_short : first_long;
+            const std::uint8_t*      end     = begin;
+
+            const bool          other_available = use_short ? long_available : short_available;
+            const std::uint16_t last_handle     = other_available
+                ? read_handle( use_short ? first_long : first_short ) - 1
+                : ending_handle;
+
+            for ( std::size_t space = out_size - header_size; space >= records.record_size && end != records.end
+                && read_handle( end ) <= last_handle; space -= records.record_size )
+            {
+                end += records.record_size;
+            }
+
+            if ( begin == end )
+                return false;
+
+            output[ 0 ] = bits( opcode );
+            output[ 1 ] = use_short ? short_format : long_format;
+            std::copy( begin, end, output + header_size );
+
+            out_size = header_size + ( end - begin );
+
+            return true;
+        }
+
+        template < typename Blob >
+        discovery_records discovery_records_from_blob( std::size_t record_size )
+        {
+            return discovery_records{ &Blob::bytes[ 0 ], &Blob::bytes[ Blob::size ], record_size };
+        }
+
+        /*
+         * Primary Service Discovery: start handle, end handle, service UUID
+         */
+        template < typename Services, std::uint16_t Handle, typename Short = byte_list<>, typename Long = byte_list<> >
+        struct primary_service_records;
+
+        template < std::uint16_t Handle, typename Short, typename Long >
+        struct primary_service_records< std::tuple<>, Handle, Short, Long >
+        {
+            using short_uuids = Short;
+            using long_uuids  = Long;
+        };
+
+        template < typename Service, typename ... Services, std::uint16_t Handle, typename Short, typename Long >
+        struct primary_service_records< std::tuple< Service, Services... >, Handle, Short, Long >
+        {
+            static constexpr std::uint16_t end_handle = Handle + Service::number_of_attributes - 1;
+
+            using record = typename concat_byte_lists<
+                le16_bytes< Handle >,
+                le16_bytes< end_handle >,
+                typename uuid_bytes< typename Service::uuid >::type >::type;
+
+            using short_record = typename select_type< !Service::is_secondary && !Service::uuid::is_128bit, record, byte_list<> >::type;
+            using long_record  = typename select_type< !Service::is_secondary && Service::uuid::is_128bit, record, byte_list<> >::type;
+
+            using next = primary_service_records<
+                std::tuple< Services... >,
+                Handle + Service::number_of_attributes,
+                typename concat_byte_lists< Short, short_record >::type,
+                typename concat_byte_lists< Long, long_record >::type >;
+
+            using short_uuids = typename next::short_uuids;
+            using long_uuids  = typename next::long_uuids;
+        };
+
+        /*
+         * walks over a list of generate_attribute<> types and collects the records, generated by Record< Applicable, Generator, Handle >,
+         * where Record< false, Generator, Handle >::applicable selects the specialization to use.
+         */
+        template < template < bool, typename, std::uint16_t > class Record, typename Generators, std::uint16_t Handle, typename Short = byte_list<>, typename Long = byte_list<> >
+        struct attribute_records;
+
+        template < template < bool, typename, std::uint16_t > class Record, std::uint16_t Handle, typename Short, typename Long >
+        struct attribute_records< Record, std::tuple<>, Handle, Short, Long >
+        {
+            using short_uuids = Short;
+            using long_uuids  = Long;
+        };
+
+        template < template < bool, typename, std::uint16_t > class Record, typename Generator, typename ... Generators, std::uint16_t Handle, typename Short, typename Long >
+        struct attribute_records< Record, std::tuple< Generator, Generators... >, Handle, Short, Long >
+        {
+            using record = Record< Record< false, Generator, Handle >::applicable, Generator, Handle >;
+
+            using short_record = typename select_type< record::is_128bit, byte_list<>, typename record::type >::type;
+            using long_record  = typename select_type< record::is_128bit, typename record::type, byte_list<> >::type;
+
+            using next = attribute_records<
+                Record,
+                std::tuple< Generators... >,
+                Handle + 1,
+                typename concat_byte_lists< Short, short_record >::type,
+                typename concat_byte_lists< Long, long_record >::type >;
+
+            using short_uuids = typename next::short_uuids;
+            using long_uuids  = typename next::long_uuids;
+        };
+
+        /*
+         * Characteristic Discovery: handle, properties, value handle, characteristic UUID
+         */
+        template < bool Applicable, typename Generator, std::uint16_t Handle >
+        struct characteristic_declaration_record
+        {
+            static constexpr bool applicable = Generator::attr.uuid == bits( gatt_uuids::characteristic );
+            static constexpr bool is_128bit  = false;
+            using type = byte_list<>;
+        };
+
+        template < typename Generator, std::uint16_t Handle >
+        struct characteristic_declaration_record< true, Generator, Handle >
+        {
+            static constexpr bool is_128bit  = Generator::uuid::is_128bit;
+
+            using type = typename concat_byte_lists<
+                le16_bytes< Handle >,
+                byte_list< Generator::properties >,
+                le16_bytes< Handle + 1 >,
+                typename uuid_bytes< typename Generator::uuid >::type >::type;
+        };
+
+        /*
+         * Find Information: handle, attribute type
+         */
+        template < bool Applicable, typename Generator, std::uint16_t Handle >
+        struct information_record
+        {
+            static constexpr bool applicable = Generator::attr.uuid == bits( gatt_uuids::internal_128bit_uuid );
+            static constexpr bool is_128bit  = false;
+
+            using type = typename concat_byte_lists<
+                le16_bytes< Handle >,
+                le16_bytes< Generator::attr.uuid > >::type;
+        };
+
+        template < typename Generator, std::uint16_t Handle >
+        struct information_record< true, Generator, Handle >
+        {
+            static constexpr bool is_128bit  = true;
+
+            using type = typename concat_byte_lists<
+                le16_bytes< Handle >,
+                typename uuid_bytes< typename Generator::uuid >::type >::type;
+        };
+    }
+
+    template < typename Services, typename AttributeGenerators >
+    struct precomputed_discovery_responses::responses
+    {
+        using services        = details::primary_service_records< Services, 1 >;
+        using characteristics = details::attribute_records< details::characteristic_declaration_record, AttributeGenerators, 1 >;
+        using information     = details::attribute_records< details::information_record, AttributeGenerators, 1 >;
+
+        static bool primary_services( std::uint16_t starting_handle, std::uint16_t ending_handle, std::uint8_t* output, std::size_t& out_size )
+        {
+            return details::discovery_response(
+                details::discovery_records_from_blob< details::byte_blob< typename services::short_uuids > >( 2 + 2 + 2 ), 2 + 2 + 2,
+                details::discovery_records_from_blob< details::byte_blob< typename services::long_uuids > >( 2 + 2 + 16 ), 2 + 2 + 16,
+                details::att_opcodes::read_by_group_type_response, starting_handle, ending_handle, output, out_size );
+        }
+
+        static bool characteristic_declarations( std::uint16_t starting_handle, std::uint16_t ending_handle, std::uint8_t* output, std::size_t& out_size )
+        {
+            return details::discovery_response(
+                details::discovery_records_from_blob< details::byte_blob< typename characteristics::short_uuids > >( 2 + 1 + 2 + 2 ), 2 + 1 + 2 + 2,
+                details::discovery_records_from_blob< details::byte_blob< typename characteristics::long_uuids > >( 2 + 1 + 2 + 16 ), 2 + 1 + 2 + 16,
+                details::att_opcodes::read_by_type_response, starting_handle, ending_handle, output, out_size );
+        }
+
+        static bool find_information( std::uint16_t starting_handle, std::uint16_t ending_handle, std::uint8_t* output, std::size_t& out_size )
+        {
+            return details::discovery_response(
+                details::discovery_records_from_blob< details::byte_blob< typename information::short_uuids > >( 2 + 2 ), bits( details::att_uuid_format::short_16bit ),
+                details::discovery_records_from_blob< details::byte_blob< typename information::long_uuids > >( 2 + 16 ), bits( details::att_uuid_format::long_128bit ),
+                details::att_opcodes::find_information_response, starting_handle, ending_handle, output, out_size );
+        }
+    };
+    /** @endcond */
+}
+
+#endif
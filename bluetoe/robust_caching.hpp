@@ -0,0 +1,420 @@
+#ifndef BLUETOE_ROBUST_CACHING_HPP
+#define BLUETOE_ROBUST_CACHING_HPP
+
+#include <bluetoe/service.hpp>
+#include <bluetoe/characteristic.hpp>
+#include <bluetoe/characteristic_value.hpp>
+#include <bluetoe/attribute.hpp>
+#include <bluetoe/codes.hpp>
+#include <bluetoe/bits.hpp>
+#include <bluetoe/meta_types.hpp>
+#include <bluetoe/aes_cmac.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+#include <type_traits>
+
+namespace bluetoe {
+
+    namespace details {
+        struct robust_caching_meta_type {};
+
+        /*
+         * Bits of the Client Supported Features characteristic value
+         */
+        enum class client_supported_features : std::uint8_t {
+            robust_caching                      = 0x01,
+            multiple_handle_value_notifications = 0x04
+        };
+
+        constexpr std::uint8_t bits( client_supported_features f )
+        {
+            return static_cast< std::uint8_t >( f );
+        }
+
+        /*
+         * default: no GATT service, no Database Hash and all clients are treated as change-aware
+         */
+        struct no_robust_caching {
+            struct meta_type :
+                robust_caching_meta_type,
+                valid_server_option_meta_type {};
+
+            static constexpr bool stores_client_supported_features = false;
+
+            template < typename Services, typename ... ServerOptions >
+            struct add_service {
+                typedef Services type;
+            };
+
+            template < class Connection >
+            static bool reject_pdu( const std::uint8_t*, std::size_t, Connection& )
+            {
+                return false;
+            }
+
+            template < class Server >
+            static void calculate_database_hash()
+            {
+            }
+
+            template < class Server >
+            static const std::uint8_t* database_hash()
+            {
+                return nullptr;
+            }
+        };
+
+        /*
+         * The GATT Database Hash (Vol 3, Part G, 7.3): AES-CMAC with a zero key over handle, type and (for
+         * declarations) value of all attributes that define the structure of the database. As the database is
+         * constant, the hash is calculated once by the constructor of the server, before the ATT layer or the
+         * security manager can read it, and is not changed afterwards.
+         */
+        template < class Server >
+        struct database_hash
+        {
+            static constexpr std::size_t size = 16;
+
+            static void initialize()
+            {
+                if ( !calculated )
+                {
+                    calculate( hash );
+                    calculated = true;
+                }
+            }
+
+            static const std::uint8_t* value()
+            {
+                assert( calculated );
+
+                return hash;
+            }
+
+            static bool hashed_with_value( std::uint16_t type )
+            {
+                return type == bits( gatt_uuids::primary_service )
+                    || type == bits( gatt_uuids::secondary_service )
+                    || type == bits( gatt_uuids::include )
+                    || type == bits( gatt_uuids::characteristic )
+                    || type == bits( gatt_uuids::characteristic_extended_properties );
+            }
+
+            static bool hashed_without_value( std::uint16_t type )
+            {
+                return type == bits( gatt_uuids::characteristic_user_description )
+                    || type == bits( gatt_uuids::client_characteristic_configuration )
+                    || type == bits( gatt_uuids::server_characteristic_configuration )
+                    || type == bits( gatt_uuids::characteristic_presentation_format )
+                    || type == bits( gatt_uuids::characteristic_aggregate_format );
+            }
+
+            static void calculate( std::uint8_t* hash )
+            {
+                static const std::uint8_t zero_key[ aes_cmac::block_size ] = { 0 };
+                aes_cmac cmac( zero_key );
+
+                for ( std::size_t index = 0; index != Server::number_of_attributes; ++index )
+                {
+                    const attribute       attr   = Server::attribute_at( index );
+                    const std::uint16_t   handle = static_cast< std::uint16_t >( index + 1 );
+
+                    if ( !hashed_with_value( attr.uuid ) && !hashed_without_value( attr.uuid ) )
+                        continue;
+
+                    // handle, type and the largest declaration value: properties, value handle and a 128 bit UUID
+                    std::uint8_t  buffer[ 2 + 2 + 1 + 2 + 16 ];
+                    std::uint8_t* end = write_16bit_uuid( write_handle( &buffer[ 0 ], handle ), attr.uuid );
+
+                    if ( hashed_with_value( attr.uuid ) )
+                    {
+                        auto read = attribute_access_arguments::read( end, std::end( buffer ), 0,
+                            client_characteristic_configuration(), connection_security_attributes(), nullptr );
+
+                        if ( attr.access( read, handle ) == attribute_access_result::success )
+                            end += read.buffer_size;
+                    }
+
+                    cmac.update( &buffer[ 0 ], end );
+                }
+
+                std::uint8_t mac[ size ];
+                cmac.finish( mac );
+
+                // the CMAC is most significant octet first, the characteristic value is little endian
+                std::reverse_copy( std::begin( mac ), std::end( mac ), hash );
+            }
+
+            static std::uint8_t hash[ size ];
+            static bool         calculated;
+        };
+
+        template < class Server >
+        std::uint8_t database_hash< Server >::hash[ database_hash< Server >::size ];
+
+        template < class Server >
+        bool database_hash< Server >::calculated = false;
+
+        /*
+         * adds the Characteristics to the GATT service (0x1801), if the list of Services already contains one,
+         * otherwise a GATT service with the Characteristics is appended to the Services
+         */
+        template < typename Services, typename ... Characteristics >
+        struct add_to_gatt_service;
+
+        template < typename ... Characteristics >
+        struct add_to_gatt_service< std::tuple<>, Characteristics... >
+        {
+            typedef std::tuple< service< service_uuid16< 0x1801 >, Characteristics... > > type;
+        };
+
+        template < typename Service, typename ... Services, typename ... Characteristics >
+        struct add_to_gatt_service< std::tuple< Service, Services... >, Characteristics... >
+        {
+            typedef typename add_type<
+                Service,
+                typename add_to_gatt_service< std::tuple< Services... >, Characteristics... >::type
+            >::type type;
+        };
+
+        template < typename ... Options, typename ... Services, typename ... Characteristics >
+        struct add_to_gatt_service< std::tuple< service< Options... >, Services... >, Characteristics... >
+        {
+            typedef typename select_type<
+                std::is_same< typename service< Options... >::uuid, service_uuid16< 0x1801 > >::value,
+                std::tuple< service< Options..., Characteristics... >, Services... >,
+                typename add_type<
+                    service< Options... >,
+                    typename add_to_gatt_service< std::tuple< Services... >, Characteristics... >::type
+                >::type
+            >::type type;
+        };
+
+        /*
+         * read only value of the Database Hash characteristic
+         */
+        struct database_hash_value
+        {
+            template < typename ... Options >
+            class value_impl
+            {
+            public:
+                static constexpr bool has_read_access  = true;
+                static constexpr bool has_write_access = false;
+                static constexpr bool has_write_without_response = false;
+                static constexpr bool has_notification = false;
+                static constexpr bool has_indication   = false;
+
+                template < class Server, std::size_t ClientCharacteristicIndex, bool RequiresEncryption  >
+                static details::attribute_access_result characteristic_value_access( details::attribute_access_arguments& args, std::uint16_t )
+                {
+                    if ( args.type != details::attribute_access_type::read )
+                        return details::attribute_access_result::write_not_permitted;
+
+                    if ( args.buffer_offset > database_hash< Server >::size )
+                        return details::attribute_access_result::invalid_offset;
+
+                    args.buffer_size = std::min< std::size_t >( args.buffer_size, database_hash< Server >::size - args.buffer_offset );
+
+                    const std::uint8_t* const hash = database_hash< Server >::value() + args.buffer_offset;
+                    std::copy( hash, hash + args.buffer_size, args.buffer );
+
+                    return details::attribute_access_result::success;
+                }
+
+                static constexpr bool is_this( const void* )
+                {
+                    return false;
+                }
+            };
+
+            struct meta_type :
+                details::characteristic_value_meta_type,
+                details::characteristic_value_declaration_parameter,
+                details::valid_characteristic_option_meta_type {};
+        };
+
+        /*
+         * per connection value of the Client Supported Features characteristic
+         */
+        struct client_supported_features_value
+        {
+            static constexpr std::uint8_t supported_features =
+                bits( client_supported_features::robust_caching ) | bits( client_supported_features::multiple_handle_value_notifications );
+
+            template < typename ... Options >
+            class value_impl
+            {
+            public:
+                static constexpr bool has_read_access  = true;
+                static constexpr bool has_write_access = true;
+                static constexpr bool has_write_without_response = false;
+                static constexpr bool has_notification = false;
+                static constexpr bool has_indication   = false;
+
+                template < class Server, std::size_t ClientCharacteristicIndex, bool RequiresEncryption  >
+                static details::attribute_access_result characteristic_value_access( details::attribute_access_arguments& args, std::uint16_t )
+                {
+                    const std::uint8_t current = args.client_config.client_supported_features();
+
+                    if ( args.type == details::attribute_access_type::read )
+                    {
+                        if ( args.buffer_offset > sizeof( current ) )
+                            return details::attribute_access_result::invalid_offset;
+
+                        args.buffer_size = std::min< std::size_t >( args.buffer_size, sizeof( current ) - args.buffer_offset );
+
+                        if ( args.buffer_size )
+                            args.buffer[ 0 ] = current;
+
+                        return details::attribute_access_result::success;
+                    }
+
+                    if ( args.type != details::attribute_access_type::write )
+                        return details::attribute_access_result::write_not_permitted;
+
+                    if ( args.buffer_offset != 0 )
+                        return details::attribute_access_result::invalid_offset;
+
+                    if ( args.buffer_size == 0 )
+                        return details::attribute_access_result::success;
+
+                    // features that are not supported by the server are ignored, but a client must not clear a bit, once set
+                    const std::uint8_t features = args.buffer[ 0 ] & supported_features;
+
+                    if ( current & ~features )
+                        return details::attribute_access_result::value_not_allowed;
+
+                    args.client_config.client_supported_features( features );
+
+                    return details::attribute_access_result::success;
+                }
+
+                static constexpr bool is_this( const void* )
+                {
+                    return false;
+                }
+            };
+
+            struct meta_type :
+                details::characteristic_value_meta_type,
+                details::characteristic_value_declaration_parameter,
+                details::valid_characteristic_option_meta_type {};
+        };
+    }
+
+    /**
+     * @brief adds the Client Supported Features and the Database Hash characteristic to the GATT service
+     *
+     * Clients that support GATT Caching can use the Database Hash to verify, that the GATT database did not change
+     * since the last connection and then skip the service discovery entirely. The hash is calculated over the
+     * attribute table of the server, when the server is constructed.
+     *
+     * If the server already defines a GATT service (service_uuid16< 0x1801 >), for example to add the Service Changed
+     * characteristic, both characteristics are added to the end of that service. Otherwise, a GATT service is added
+     * as last service to the server.
+     *
+     * A client enables Robust Caching by setting bit 0 of the Client Supported Features. If such a client is change-unaware
+     * (see link_state::change_aware()), requests are answered with a "Database Out Of Sync" error and commands are ignored,
+     * until the client reads the Database Hash or sends an other request after the error response.
+     *
+     * A client can also use the Client Supported Features to enable the reception of Multiple Handle Value Notifications
+     * (bit 2). The link layer then packs pending notifications into a single ATT PDU. As the Client Supported Features
+     * characteristic is only part of a server with this option, a server without robust_caching never sends Multiple
+     * Handle Value Notifications.
+     *
+     * example:
+     * @code
+    typedef bluetoe::server<
+        bluetoe::robust_caching,
+        ...
+    > server;
+     * @endcode
+     *
+     * @sa server
+     * @sa gap_service_for_gatt_servers
+     */
+    struct robust_caching
+    {
+        /** @cond HIDDEN_SYMBOLS */
+        struct meta_type :
+            details::robust_caching_meta_type,
+            details::valid_server_option_meta_type {};
+
+        // the Client Supported Features have to be stored per connection
+        static constexpr bool stores_client_supported_features = true;
+
+        template < typename Services, typename ... ServerOptions >
+        struct add_service {
+            typedef typename details::add_to_gatt_service<
+                Services,
+                characteristic<
+                    characteristic_uuid16< 0x2B29 >,
+                    details::client_supported_features_value
+                >,
+                characteristic<
+                    characteristic_uuid16< 0x2B2A >,
+                    details::database_hash_value
+                >
+            >::type type;
+        };
+
+        /*
+         * calculates the GATT Database Hash; called by the constructor of the server
+         */
+        template < class Server >
+        static void calculate_database_hash()
+        {
+            details::database_hash< Server >::initialize();
+        }
+
+        /*
+         * the GATT Database Hash of the server, to recognize bonded clients, that cached a different database
+         */
+        template < class Server >
+        static const std::uint8_t* database_hash()
+        {
+            return details::database_hash< Server >::value();
+        }
+
+        /*
+         * returns true, if the PDU must not be processed, because the client is change-unaware
+         */
+        template < class Connection >
+        static bool reject_pdu( const std::uint8_t* input, std::size_t in_size, Connection& connection )
+        {
+            if ( connection.change_aware()
+              || !( connection.client_supported_features() & bits( details::client_supported_features::robust_caching ) ) )
+                return false;
+
+            const std::uint8_t opcode = input[ 0 ];
+
+            if ( opcode & details::att_command_flag )
+                return true;
+
+            if ( opcode == bits( details::att_opcodes::exchange_mtu_request ) || opcode == bits( details::att_opcodes::confirmation ) )
+                return false;
+
+            // reading the database hash by type or the first request after the error, makes the client change-aware
+            const bool reads_database_hash = opcode == bits( details::att_opcodes::read_by_type_request )
+                && in_size == 5 + 2 && details::read_16bit_uuid( &input[ 5 ] ) == 0x2B2A;
+
+            if ( reads_database_hash || connection.database_out_of_sync_reported() )
+            {
+                connection.change_aware( true );
+                return false;
+            }
+
+            connection.database_out_of_sync_reported( true );
+
+            return true;
+        }
+        /** @endcond */
+    };
+}
+
+#endif
@@ -11,12 +11,15 @@
 #include <bluetoe/server_meta_type.hpp>
 #include <bluetoe/client_characteristic_configuration.hpp>
 #include <bluetoe/write_queue.hpp>
+#include <bluetoe/notification_snapshots.hpp>
 #include <bluetoe/gap_service.hpp>
 #include <bluetoe/appearance.hpp>
 #include <bluetoe/mixin.hpp>
 #include <bluetoe/find_notification_data.hpp>
 #include <bluetoe/outgoing_priority.hpp>
 #include <bluetoe/link_state.hpp>
+#include <bluetoe/precomputed_discovery.hpp>
+#include <bluetoe/robust_caching.hpp>
 #include <cstdint>
 #include <cstddef>
 #include <algorithm>
@@ -61,7 +64,12 @@ namespace bluetoe {
         // append gap serivce for gatt servers
         using gap_service_definition = typename details::find_by_meta_type< details::gap_service_definition_meta_type,
             Options..., gap_service_for_gatt_servers >::type;
-        using services = typename gap_service_definition::template add_service< services_without_gap, Options... >::type;
+        using services_without_gatt = typename gap_service_definition::template add_service< services_without_gap, Options... >::type;
+
+        // append the gatt service, if robust caching is requested
+        using caching_definition = typename details::find_by_meta_type< details::robust_caching_meta_type,
+            Options..., details::no_robust_caching >::type;
+        using services = typename caching_definition::template add_service< services_without_gatt, Options... >::type;
 
         static constexpr std::size_t number_of_client_configs = details::sum_by< services, details::sum_by_client_configs >::value;
 
@@ -73,6 +81,10 @@ namespace bluetoe {
             "Only one of bluetoe::higher_outgoing_priority<> or bluetoe::lower_outgoing_priority<> per server allowed!" );
 
         using cccd_indices = typename details::find_notification_data_in_list< notification_priority, services >::cccd_indices;
+
+        template < class Lock >
+        using notification_snapshot_buffer = typename details::find_by_meta_type< details::notification_snapshots_meta_type,
+            Options..., details::no_notification_snapshots >::type::template buffer< Lock >;
         /** @endcond */
 
         /**
@@ -83,7 +95,7 @@ namespace bluetoe {
          * be reset with a new connection.
          */
         using connection_data = details::link_state<
-            details::client_characteristic_configurations< number_of_client_configs > >;
+            details::client_characteristic_configurations< number_of_client_configs, caching_definition::stores_client_supported_features > >;
 
         /**
          * @brief a server takes no runtime construction parameters
@@ -122,7 +134,9 @@ namespace bluetoe {
         @endcode
 
          * @return The function will return false, if the given notification was ignored, because the
-         *         characteristic is already queued for notification, but not yet send out.
+         *         characteristic is already queued for notification, but not yet send out. If the
+         *         server was configured with notification_snapshots, the function returns false, if
+         *         there is no room left to store the current value.
          */
         template < class T >
         bool notify( const T& value );
@@ -158,7 +172,9 @@ namespace bluetoe {
         @endcode
 
          * @return The function will return false, if the given notification was ignored, because the
-         *         characteristic is already queued for notification, but not yet send out.
+         *         characteristic is already queued for notification, but not yet send out. If the
+         *         server was configured with notification_snapshots, the function returns false, if
+         *         there is no room left to store the current value.
          */
         template < class CharacteristicUUID >
         bool notify();
@@ -236,9 +252,28 @@ namespace bluetoe {
          */
         void notification_callback( lcap_notification_callback_t, void* usr_arg );
 
-        void notification_output( std::uint8_t* output, std::size_t& out_size, connection_data&, const details::notification_data& data );
+        /**
+         * @brief builds an ATT Handle Value Notification of at most out_size bytes
+         *
+         * If truncate is false and the value would have to be truncated to fit into out_size, out_size is set to 0.
+         */
+        void notification_output( std::uint8_t* output, std::size_t& out_size, connection_data&, const details::notification_data& data, bool truncate = true );
         void notification_output( std::uint8_t* output, std::size_t& out_size, connection_data& connection, std::size_t client_characteristic_configuration_index );
 
+        /**
+         * @brief adds the value of the given characteristic to an ATT Multiple Handle Value Notification
+         *
+         * pdu_size is the size of the PDU that was already build at output (0 to start a new PDU) and out_size is the size
+         * of the buffer at output. Returns true and updates pdu_size, if the value was added. Returns false, if the client
+         * did not enable Multiple Handle Value Notifications or notifications for the given characteristic, or if the value
+         * does not fit into the remaining buffer without being truncated. A PDU must contain at least two values; if only one
+         * value was added, the l2cap layer has to send a notification_output() instead.
+         *
+         * Clients can only enable Multiple Handle Value Notifications with the Client Supported Features characteristic,
+         * which is added by bluetoe::robust_caching. Without that option, this function always returns false.
+         */
+        bool multiple_notification_output( std::uint8_t* output, std::size_t& pdu_size, std::size_t out_size, connection_data& connection, std::size_t client_characteristic_configuration_index );
+
         void indication_output( std::uint8_t* output, std::size_t& out_size, connection_data& connection, std::size_t client_characteristic_configuration_index );
 
         /**
@@ -249,10 +284,23 @@ namespace bluetoe {
         typedef details::server_meta_type meta_type;
 
         static details::attribute attribute_at( std::size_t index );
+
+        // GATT Database Hash of the server; nullptr without robust_caching
+        static const std::uint8_t* database_hash();
+
+        static constexpr std::size_t number_of_attributes       = details::sum_by< services, details::sum_by_attributes >::value;
         /** @endcond */
 
     private:
-        static constexpr std::size_t number_of_attributes       = details::sum_by< services, details::sum_by_attributes >::value;
+
+        // all attributes of all services in one, flat, constant table; indexed by handle - 1
+        using attribute_generators = typename details::attribute_generators_of_list< services, cccd_indices, 0, services, server< Options... > >::type;
+        using attribute_table      = details::attribute_table< attribute_generators >;
+
+        using discovery_responses = typename details::find_by_meta_type<
+            details::discovery_responses_meta_type,
+            Options...,
+            details::no_precomputed_discovery_responses >::type::template responses< services, attribute_generators >;
 
         static_assert( std::tuple_size< services >::value > 0, "A server should at least contain one service." );
 
@@ -261,6 +309,12 @@ namespace bluetoe {
 
         static details::att_error_codes access_result_to_att_code( details::attribute_access_result, details::att_error_codes default_att_code );
 
+        // true, if the value of attr is longer than value_size
+        bool value_truncated( const details::attribute& attr, std::uint16_t handle, std::size_t value_size, connection_data& connection );
+
+        // length of the whole value of attr, of which the first value_size bytes are known to exist
+        std::size_t value_length( const details::attribute& attr, std::uint16_t handle, std::size_t value_size, connection_data& connection );
+
         /**
          * for a PDU what starts with an opcode, followed by a pair of handles, the function checks the size of the PDU (must be A or B) and checks the handles.
          * The starting handle must not be 0, must be greate than ending_handle and must be with in the range of attributes available.
@@ -287,6 +341,8 @@ namespace bluetoe {
         template < typename ConnectionData >
         void handle_read_multiple_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, ConnectionData& );
         template < typename ConnectionData >
+        void handle_read_multiple_variable_length_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, ConnectionData& );
+        template < typename ConnectionData >
         void handle_write_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, ConnectionData& );
         template < typename ConnectionData >
         void handle_write_command( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, ConnectionData& );
@@ -299,16 +355,16 @@ namespace bluetoe {
         void handle_execute_write_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data&, const WriteQueue& );
         void handle_value_confirmation( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data& );
 
+        /*
+         * visits all attributes in the range [starting_handle, ending_handle] in a single pass over the attribute table.
+         * The iterator is called for every attribute, the filter returns true for. It returns false, to stop the iteration.
+         */
         template < class Iterator, class Filter = details::all_uuid_filter >
         void all_attributes( std::uint16_t starting_handle, std::uint16_t ending_handle, Iterator&, const Filter& filter = details::all_uuid_filter() );
 
         template < class Iterator, class Filter = details::all_uuid_filter >
         bool all_services_by_group( std::uint16_t starting_handle, std::uint16_t ending_handle, Iterator&, const Filter& filter = details::all_uuid_filter() );
 
-        std::uint8_t* collect_handle_uuid_tuples( std::uint16_t start, std::uint16_t end, bool only_16_bit, std::uint8_t* output, std::uint8_t* output_end );
-
-        static void write_128bit_uuid( std::uint8_t* out, const details::attribute& char_declaration );
-
         // data
         lcap_notification_callback_t l2cap_cb_;
         void*                        l2cap_arg_;
@@ -369,7 +425,7 @@ namespace bluetoe {
     server< Options... >::server()
         : l2cap_cb_( nullptr )
     {
-
+        caching_definition::template calculate_database_hash< server< Options... > >();
     }
 
     template < typename ... Options >
@@ -382,6 +438,21 @@ namespace bluetoe {
         assert( in_size != 0 );
         assert( out_size >= details::default_att_mtu_size );
 
+        if ( caching_definition::reject_pdu( input, in_size, connection ) )
+        {
+            // requests of a change-unaware client are answered with an error, commands are ignored
+            if ( input[ 0 ] & details::att_command_flag )
+            {
+                out_size = 0;
+            }
+            else
+            {
+                error_response( *input, details::att_error_codes::database_out_of_sync, output, out_size );
+            }
+
+            return;
+        }
+
         const details::att_opcodes opcode = static_cast< details::att_opcodes >( input[ 0 ] );
 
         switch ( opcode )
@@ -410,6 +481,9 @@ namespace bluetoe {
         case details::att_opcodes::read_multiple_request:
             handle_read_multiple_request( input, in_size, output, out_size, connection );
             break;
+        case details::att_opcodes::read_multiple_variable_length_request:
+            handle_read_multiple_variable_length_request( input, in_size, output, out_size, connection );
+            break;
         case details::att_opcodes::write_request:
             handle_write_request( input, in_size, output, out_size, connection );
             break;
@@ -468,6 +542,15 @@ namespace bluetoe {
             }
         };
 
+        // true, if the value of attr is longer than size; probes for a single byte behind the first size bytes
+        inline bool value_longer_than( const attribute& attr, std::uint16_t handle, std::size_t size,
+            const client_characteristic_configuration& config, const connection_security_attributes& security, void* server )
+        {
+            std::uint8_t next;
+            auto probe = attribute_access_arguments::read( &next, &next + 1, size, config, security, server );
+
+            return attr.access( probe, handle ) == attribute_access_result::success && probe.buffer_size != 0;
+        }
     }
 
     template < typename ... Options >
@@ -633,7 +716,7 @@ namespace bluetoe {
     }
 
     template < typename ... Options >
-    void server< Options... >::notification_output( std::uint8_t* output, std::size_t& out_size, connection_data& connection, const details::notification_data& data )
+    void server< Options... >::notification_output( std::uint8_t* output, std::size_t& out_size, connection_data& connection, const details::notification_data& data, bool truncate )
     {
         assert( data.valid() );
 
@@ -650,7 +733,11 @@ namespace bluetoe {
                 details::write_handle( output +1, data.handle() );
             }
 
+            const bool filled = 3 + read.buffer_size == out_size;
             out_size = 3 + read.buffer_size;
+
+            if ( !truncate && filled && value_truncated( attr, data.handle(), read.buffer_size, connection ) )
+                out_size = 0;
         }
         else
         {
@@ -664,6 +751,71 @@ namespace bluetoe {
         notification_output( output, out_size, connection, find_notification_data_by_index( client_characteristic_configuration_index ) );
     }
 
+    template < typename ... Options >
+    bool server< Options... >::multiple_notification_output( std::uint8_t* output, std::size_t& pdu_size, std::size_t out_size, connection_data& connection, std::size_t client_characteristic_configuration_index )
+    {
+        const auto data = find_notification_data_by_index( client_characteristic_configuration_index );
+        assert( data.valid() );
+
+        static constexpr std::size_t opcode_size       = 1;
+        static constexpr std::size_t tuple_header_size = 4;
+
+        if ( !( connection.client_supported_features() & bits( details::client_supported_features::multiple_handle_value_notifications ) )
+          || !( connection.client_configurations().flags( data.client_characteristic_configuration_index() ) & details::client_characteristic_configuration_notification_enabled ) )
+            return false;
+
+        std::uint8_t* const tuple = output + ( pdu_size == 0 ? opcode_size : pdu_size );
+
+        if ( tuple + tuple_header_size > output + out_size )
+            return false;
+
+        auto read = details::attribute_access_arguments::read( tuple + tuple_header_size, output + out_size, 0, connection.client_configurations(), connection.security_attributes(), this );
+        auto attr = attribute_at( data.handle() - 1 );
+
+        if ( attr.access( read, data.handle() ) != details::attribute_access_result::success )
+            return false;
+
+        // values in a Multiple Handle Value Notification must not be truncated
+        if ( tuple + tuple_header_size + read.buffer_size == output + out_size && value_truncated( attr, data.handle(), read.buffer_size, connection ) )
+            return false;
+
+        *output = bits( details::att_opcodes::multiple_handle_value_notification );
+        details::write_16bit( details::write_handle( tuple, data.handle() ), static_cast< std::uint16_t >( read.buffer_size ) );
+        pdu_size = tuple + tuple_header_size + read.buffer_size - output;
+
+        return true;
+    }
+
+    template < typename ... Options >
+    bool server< Options... >::value_truncated( const details::attribute& attr, std::uint16_t handle, std::size_t value_size, connection_data& connection )
+    {
+        return details::value_longer_than( attr, handle, value_size, connection.client_configurations(), connection.security_attributes(), this );
+    }
+
+    template < typename ... Options >
+    std::size_t server< Options... >::value_length( const details::attribute& attr, std::uint16_t handle, std::size_t value_size, connection_data& connection )
+    {
+        // an attribute value is at max 512 bytes long; a read handler that ignores the offset would otherwise never end the loop
+        static constexpr std::size_t max_attribute_value_length = 512;
+
+        std::uint8_t chunk[ 16 ];
+
+        while ( value_size < max_attribute_value_length )
+        {
+            auto probe = details::attribute_access_arguments::read( std::begin( chunk ), std::end( chunk ), value_size, connection.client_configurations(), connection.security_attributes(), this );
+
+            if ( attr.access( probe, handle ) != details::attribute_access_result::success )
+                break;
+
+            value_size += probe.buffer_size;
+
+            if ( probe.buffer_size < sizeof( chunk ) )
+                break;
+        }
+
+        return std::min( value_size, max_attribute_value_length );
+    }
+
     template < typename ... Options >
     void server< Options... >::indication_output( std::uint8_t* output, std::size_t& out_size, connection_data& connection, std::size_t client_characteristic_configuration_index )
     {
@@ -697,10 +849,18 @@ namespace bluetoe {
         this->free_write_queue( client );
     }
 
+    template < typename ... Options >
+    const std::uint8_t* server< Options... >::database_hash()
+    {
+        return caching_definition::template database_hash< server< Options... > >();
+    }
+
     template < typename ... Options >
     details::attribute server< Options... >::attribute_at( std::size_t index )
     {
-        return details::attribute_from_service_list< services, server< Options... >, cccd_indices >::attribute_at( index );
+        static_assert( attribute_table::number_of_attributes == number_of_attributes, "attribute table and service definitions out of sync" );
+
+        return attribute_table::attribute_at( index );
     }
 
     template < typename ... Options >
@@ -821,6 +981,74 @@ namespace bluetoe {
         out_size = 3u;
     }
 
+    namespace details {
+        inline void write_128bit_uuid( std::uint8_t* out, const details::attribute& char_declaration )
+        {
+            // this is a little bit tricky: To save memory, details::attribute contains only 16 bit uuids at all,
+            // but the "Characteristic Value Declaration" contain 16 bit uuids. However, as the "Characteristic Value Declaration"
+            // "is the first Attribute after the characteristic declaration", the attribute just in front of the
+            // "Characteristic Value Declaration" contains the the 128 bit uuid.
+            assert( char_declaration.uuid == bits( details::gatt_uuids::characteristic ) );
+
+            std::uint8_t buffer[ 3 + 16 ];
+            auto read = details::attribute_access_arguments::read( buffer, 0 );
+            char_declaration.access( read, 1 );
+
+            assert( read.buffer_size == sizeof( buffer ) );
+
+            std::copy( &read.buffer[ 3 ], &read.buffer[ 3 + 16 ], out );
+        }
+
+        template < class Server >
+        struct collect_handle_uuid_tuples
+        {
+            collect_handle_uuid_tuples( std::uint8_t* begin, std::uint8_t* end, bool only_16_bit )
+                : current_( begin )
+                , end_( end )
+                , only_16_bit_( only_16_bit )
+                , size_per_tuple_( only_16_bit ? 2 + 2 : 2 + 16 )
+            {
+            }
+
+            bool operator()( std::uint16_t handle, const details::attribute& attr )
+            {
+                if ( static_cast< std::size_t >( end_ - current_ ) < size_per_tuple_ )
+                    return false;
+
+                const bool is_16_bit_uuids = attr.uuid != bits( details::gatt_uuids::internal_128bit_uuid );
+
+                // a client continues behind the last reported handle and must not miss an attribute with the other UUID size
+                if ( only_16_bit_ != is_16_bit_uuids )
+                    return false;
+
+                details::write_handle( current_, handle );
+
+                if ( is_16_bit_uuids )
+                {
+                    details::write_16bit_uuid( current_ + 2, attr.uuid );
+                }
+                else
+                {
+                    write_128bit_uuid( current_ + 2, Server::attribute_at( handle - 2 ) );
+                }
+
+                current_ += size_per_tuple_;
+
+                return true;
+            }
+
+            std::uint8_t* end() const
+            {
+                return current_;
+            }
+
+            std::uint8_t*       current_;
+            std::uint8_t* const end_;
+            const bool          only_16_bit_;
+            const std::size_t   size_per_tuple_;
+        };
+    }
+
     template < typename ... Options >
     void server< Options... >::handle_find_information_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size )
     {
@@ -829,6 +1057,9 @@ namespace bluetoe {
         if ( !check_size_and_handle_range< 5u >( input, in_size, output, out_size, starting_handle, ending_handle ) )
             return;
 
+        if ( discovery_responses::find_information( starting_handle, ending_handle, output, out_size ) )
+            return;
+
         const bool only_16_bit_uuids = attribute_at( starting_handle -1 ).uuid != bits( details::gatt_uuids::internal_128bit_uuid );
 
         std::uint8_t*        write_ptr = &output[ 0 ];
@@ -848,9 +1079,10 @@ namespace bluetoe {
 
         }
 
-        write_ptr = collect_handle_uuid_tuples( starting_handle, ending_handle, only_16_bit_uuids, write_ptr, write_end );
+        details::collect_handle_uuid_tuples< server< Options... > > iterator( write_ptr, write_end, only_16_bit_uuids );
+        all_attributes( starting_handle, ending_handle, iterator );
 
-        out_size = write_ptr - &output[ 0 ];
+        out_size = iterator.end() - &output[ 0 ];
     }
 
     namespace details {
@@ -864,10 +1096,10 @@ namespace bluetoe {
             {
             }
 
-            bool operator()( std::uint16_t, const details::attribute& attr ) const
+            bool operator()( std::uint16_t handle, const details::attribute& attr ) const
             {
                 auto read = details::attribute_access_arguments::compare_value( begin_, end_, &server_ );
-                return attr.access( read, 1 ) == details::attribute_access_result::value_equal;
+                return attr.access( read, handle ) == details::attribute_access_result::value_equal;
             }
 
             const std::uint8_t* const begin_;
@@ -991,35 +1223,44 @@ namespace bluetoe {
         template < typename Server >
         struct collect_attributes
         {
-            void operator()( std::uint16_t handle, const details::attribute& attr )
+            bool operator()( std::uint16_t handle, const details::attribute& attr )
             {
                 static constexpr std::size_t maximum_pdu_size = 253u;
                 static constexpr std::size_t header_size      = 2u;
 
-                if ( end_ - current_ >= static_cast< std::ptrdiff_t >( header_size ) )
+                // no room left for an other handle, value pair
+                if ( end_ - current_ < static_cast< std::ptrdiff_t >( header_size ) )
+                    return false;
+
+                const std::size_t max_data_size = std::min< std::size_t >( end_ - current_, maximum_pdu_size + header_size ) - header_size;
+
+                auto read = attribute_access_arguments::read( current_ + header_size, current_ + header_size + max_data_size, 0, config_, security_, &server_ );
+                auto rc   = attr.access( read, handle );
+
+                if ( rc == details::attribute_access_result::success )
                 {
-                    const std::size_t max_data_size = std::min< std::size_t >( end_ - current_, maximum_pdu_size + header_size ) - header_size;
+                    assert( read.buffer_size <= maximum_pdu_size );
 
-                    auto read = attribute_access_arguments::read( current_ + header_size, current_ + header_size + max_data_size, 0, config_, security_, &server_ );
-                    auto rc   = attr.access( read, handle );
+                    const bool first = first_;
 
-                    if ( rc == details::attribute_access_result::success )
+                    if ( first_ )
                     {
-                        assert( read.buffer_size <= maximum_pdu_size );
-
-                        if ( first_ )
-                        {
-                            size_   = read.buffer_size + header_size;
-                            first_  = false;
-                        }
-
-                        if ( read.buffer_size + header_size == size_ )
-                        {
-                            current_ = details::write_handle( current_, handle );
-                            current_ += static_cast< std::uint8_t >( read.buffer_size );
-                        }
+                        size_   = read.buffer_size + header_size;
+                        first_  = false;
                     }
+
+                    // only the first value may be truncated; a value that exactly fills the remaining space might be longer.
+                    // The response ends in front of the first value of an other size, as the client continues behind the last
+                    // reported handle.
+                    if ( read.buffer_size + header_size != size_
+                      || ( !first && read.buffer_size == max_data_size && value_longer_than( attr, handle, read.buffer_size, config_, security_, &server_ ) ) )
+                        return false;
+
+                    current_ = details::write_handle( current_, handle );
+                    current_ += static_cast< std::uint8_t >( read.buffer_size );
                 }
+
+                return true;
             }
 
             collect_attributes( std::uint8_t* begin, std::uint8_t* end,
@@ -1072,6 +1313,10 @@ namespace bluetoe {
         if ( !check_size_and_handle_range< 5 + 2, 5 + 16 >( input, in_size, output, out_size, starting_handle, ending_handle ) )
              return;
 
+        if ( in_size == 5 + 2 && details::read_handle( &input[ 5 ] ) == bits( details::gatt_uuids::characteristic )
+          && discovery_responses::characteristic_declarations( starting_handle, ending_handle, output, out_size ) )
+            return;
+
         details::collect_attributes< server< Options... > > iterator( output + 2, output + out_size,
             connection.client_configurations(), connection.security_attributes(), *this );
 
@@ -1100,6 +1345,7 @@ namespace bluetoe {
                 , starting_handle_( starting_handle )
                 , ending_handle_( ending_handle )
                 , first_( true )
+                , done_( false )
                 , is_128bit_uuid_( true )
                 , attribute_data_size_( attribute_data_size )
                 , server_( server )
@@ -1109,7 +1355,7 @@ namespace bluetoe {
             template< typename Service >
             void each()
             {
-                if ( starting_handle_ <= index_ && index_ <= ending_handle_ )
+                if ( !Service::is_secondary && starting_handle_ <= index_ && index_ <= ending_handle_ && !done_ )
                 {
                     if ( first_ )
                     {
@@ -1118,6 +1364,9 @@ namespace bluetoe {
                         attribute_data_size_    = is_128bit_uuid_ ? 16 + 4 : 2 + 4;
                     }
 
+                    // the client continues behind the last reported service and must not miss a service with the other UUID size
+                    done_ = is_128bit_uuid_ != Service::uuid::is_128bit;
+
                     /// TODO: ClientCharacteristicIndex is derivable from Service and ServiceList, if 0 is used,
                     /// some templates are most likely more than once instanciated
                     output_ = Service::template read_primary_service_response< CCCDIndices, 0, ServiceList, Server >( output_, end_, index_, is_128bit_uuid_, server_ );
@@ -1132,6 +1381,7 @@ namespace bluetoe {
             const std::uint16_t   starting_handle_;
             const std::uint16_t   ending_handle_;
                   bool            first_;
+                  bool            done_;
                   bool            is_128bit_uuid_;
                   std::uint8_t&   attribute_data_size_;
                   Server&         server_;
@@ -1149,6 +1399,9 @@ namespace bluetoe {
         if ( in_size == 5 + 16 || details::read_handle( &input[ 5 ] ) != bits( details::gatt_uuids::primary_service ) )
             return error_response( *input, details::att_error_codes::unsupported_group_type, starting_handle, output, out_size );
 
+        if ( discovery_responses::primary_services( starting_handle, ending_handle, output, out_size ) )
+            return;
+
         std::uint8_t*       begin = output;
         std::uint8_t* const end   = output + out_size;
 
@@ -1212,6 +1465,63 @@ namespace bluetoe {
         out_size = out_ptr - output;
     }
 
+    template < typename ... Options >
+    template < typename ConnectionData >
+    void server< Options... >::handle_read_multiple_variable_length_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* const output, std::size_t& out_size, ConnectionData& cc )
+    {
+        if ( in_size < 5 || in_size % 2 == 0 )
+            return error_response( *input, details::att_error_codes::invalid_pdu, output, out_size );
+
+        const std::uint8_t opcode = *input;
+        ++input;
+        --in_size;
+
+        std::uint8_t* const end_output = output + out_size;
+        std::uint8_t*       out_ptr    = output;
+
+        *out_ptr = bits( details::att_opcodes::read_multiple_variable_length_response );
+        ++out_ptr;
+
+        static constexpr std::size_t length_size = 2;
+
+        for ( const std::uint8_t* const end_input = input + in_size; input != end_input; input += 2 )
+        {
+            const std::uint16_t handle = details::read_handle( input );
+
+            if ( handle == 0 )
+                return error_response( opcode, details::att_error_codes::invalid_handle, handle, output, out_size );
+
+            if ( handle > number_of_attributes )
+                return error_response( opcode, details::att_error_codes::attribute_not_found, handle, output, out_size );
+
+            // once the response is full, the remaining attributes are still accessed, to report unreadable attributes
+            const std::size_t   room        = end_output - out_ptr;
+            std::uint8_t* const value_ptr   = room >= length_size ? out_ptr + length_size : end_output;
+            const auto&         attr        = attribute_at( handle - 1 );
+
+            auto read = details::attribute_access_arguments::read( value_ptr, end_output, 0, cc.client_configurations(), cc.security_attributes(), this );
+            auto rc   = attr.access( read, handle );
+
+            if ( rc != details::attribute_access_result::success )
+                return error_response( opcode, access_result_to_att_code( rc, details::att_error_codes::read_not_permitted ), handle, output, out_size );
+
+            // the response is the first MTU - 1 bytes of the list of all length / value tuples; the length field contains
+            // the length of the whole value and might be truncated itself
+            const std::size_t length = value_ptr + read.buffer_size == end_output
+                ? value_length( attr, handle, read.buffer_size, cc )
+                : read.buffer_size;
+
+            std::uint8_t length_field[ length_size ];
+            details::write_16bit( length_field, static_cast< std::uint16_t >( length ) );
+            std::copy( &length_field[ 0 ], &length_field[ std::min( room, length_size ) ], out_ptr );
+
+            out_ptr = value_ptr + read.buffer_size;
+            assert( out_ptr <= end_output );
+        }
+
+        out_size = out_ptr - output;
+    }
+
     template < typename ... Options >
     template < typename ConnectionData >
     void server< Options... >::handle_write_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, ConnectionData& connection )
@@ -1350,12 +1660,18 @@ namespace bluetoe {
     template < class Iterator, class Filter >
     void server< Options... >::all_attributes( std::uint16_t starting_handle, std::uint16_t ending_handle, Iterator& iter, const Filter& filter )
     {
-        for ( ; starting_handle <= ending_handle && starting_handle <= number_of_attributes; ++starting_handle )
-        {
-            const details::attribute attr = attribute_at( starting_handle -1 );
+        const std::uint16_t last_handle = std::min< std::size_t >( ending_handle, std::size_t{ number_of_attributes } );
 
-            if ( filter( starting_handle, attr ) )
-                iter( starting_handle, attr );
+        if ( starting_handle == 0 || starting_handle > last_handle )
+            return;
+
+        // the cursor points into the attribute table and is advanced together with the handle
+        const details::attribute* cursor = &attribute_table::attributes[ starting_handle - 1 ];
+
+        for ( ; starting_handle <= last_handle; ++starting_handle, ++cursor )
+        {
+            if ( filter( starting_handle, *cursor ) && !iter( starting_handle, *cursor ) )
+                return;
         }
     }
 
@@ -1410,57 +1726,6 @@ namespace bluetoe {
         return result;
     }
 
-    template < typename ... Options >
-    std::uint8_t* server< Options... >::collect_handle_uuid_tuples( std::uint16_t start, std::uint16_t end, bool only_16_bit, std::uint8_t* out, std::uint8_t* out_end )
-    {
-        const std::size_t size_per_tuple = only_16_bit
-            ? 2 + 2
-            : 2 + 16;
-
-        for ( ; start <= end && start <= number_of_attributes
-            && static_cast< std::size_t >( out_end - out ) >= size_per_tuple; ++start )
-        {
-            const details::attribute attr = attribute_at( start -1 );
-            const bool is_16_bit_uuids    = attr.uuid != bits( details::gatt_uuids::internal_128bit_uuid );
-
-            if ( only_16_bit == is_16_bit_uuids )
-            {
-                details::write_handle( out, start );
-
-                if ( is_16_bit_uuids )
-                {
-                    details::write_16bit_uuid( out + 2, attr.uuid );
-                }
-                else
-                {
-                    write_128bit_uuid( out + 2, attribute_at( start -2 ) );
-                }
-
-                out += size_per_tuple;
-            }
-        }
-
-        return out;
-    }
-
-    template < typename ... Options >
-    void server< Options... >::write_128bit_uuid( std::uint8_t* out, const details::attribute& char_declaration )
-    {
-        // this is a little bit tricky: To save memory, details::attribute contains only 16 bit uuids at all,
-        // but the "Characteristic Value Declaration" contain 16 bit uuids. However, as the "Characteristic Value Declaration"
-        // "is the first Attribute after the characteristic declaration", the attribute just in front of the
-        // "Characteristic Value Declaration" contains the the 128 bit uuid.
-        assert( char_declaration.uuid == bits( details::gatt_uuids::characteristic ) );
-
-        std::uint8_t buffer[ 3 + 16 ];
-        auto read = details::attribute_access_arguments::read( buffer, 0 );
-        char_declaration.access( read, 1 );
-
-        assert( read.buffer_size == sizeof( buffer ) );
-
-        std::copy( &read.buffer[ 3 ], &read.buffer[ 3 + 16 ], out );
-    }
-
     template < typename ... Options >
     details::notification_data server< Options... >::find_notification_data( const void* value ) const
     {
@@ -14,6 +14,7 @@
 #include <cassert>
 #include <algorithm>
 #include <type_traits>
+#include <iterator>
 
 namespace bluetoe {
 
@@ -31,6 +32,16 @@ namespace bluetoe {
 
         template < typename ... Options >
         struct count_service_attributes;
+
+        template < typename ... Options >
+        using attribute_generation_parameters = typename
+                add_type<
+                    service_defintion_tag, // force generation of service generation attribute
+                    typename find_all_by_meta_type<
+                        include_service_meta_type,
+                        Options...
+                    >::type
+                >::type;
     }
 
     /**
@@ -85,6 +96,8 @@ namespace bluetoe {
         /** @endcond */
     };
 
+    struct is_secondary_service;
+
     /**
      * @brief a service with zero or more characteristics
      *
@@ -155,6 +168,11 @@ namespace bluetoe {
               number_of_service_attributes
             + number_of_characteristic_attributes;
 
+        /**
+         * true, if the service is a secondary service, that must not be reported by the Primary Service Discovery
+         */
+        static constexpr bool is_secondary = details::has_option< is_secondary_service, Options... >::value;
+
         struct meta_type :
             details::service_meta_type,
             details::valid_server_option_meta_type {};
@@ -165,6 +183,17 @@ namespace bluetoe {
         template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename ServiceList, typename Server >
         static details::attribute attribute_at( std::size_t index );
 
+        /**
+         * list of the generate_attribute<> types of all attributes of the service, including all characteristics
+         */
+        template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename ServiceList, typename Server >
+        using attribute_generators = typename details::add_type<
+            typename details::attribute_generator_types<
+                details::attribute_generation_parameters< Options... >, CCCDIndices, ClientCharacteristicIndex, service< Options... >, Server, std::tuple< Options..., ServiceList > >::type,
+            typename details::attribute_generators_of_list<
+                characteristics, CCCDIndices, ClientCharacteristicIndex, service< Options... >, Server >::type
+        >::type;
+
         /**
          * @brief assembles one data packet for a "Read by Group Type Response"
          */
@@ -256,18 +285,6 @@ namespace bluetoe {
     /** @cond HIDDEN_SYMBOLS */
 
     // service implementation
-    namespace details {
-        template < typename ... Options >
-        using attribute_generation_parameters = typename
-                add_type<
-                    service_defintion_tag, // force generation of service generation attribute
-                    typename find_all_by_meta_type<
-                        include_service_meta_type,
-                        Options...
-                    >::type
-                >::type;
-    }
-
     template < typename ... Options >
     template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename ServiceList, typename Server >
     details::attribute service< Options... >::attribute_at( std::size_t index )
@@ -378,16 +395,16 @@ namespace bluetoe {
                 return attribute_access_result::write_not_permitted;
             }
 
-            static const attribute attr;
+            static constexpr attribute attr {
+                bits( has_option< is_secondary_service, Options... >::value
+                    ? gatt_uuids::secondary_service
+                    : gatt_uuids::primary_service ),
+                &access
+            };
         };
 
         template < typename CCCDIndices, std::size_t ClientCharacteristicIndex, typename ServiceUUID, typename Server, typename ... Options >
-        constexpr attribute generate_attribute< service_defintion_tag, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::attr {
-            bits( has_option< is_secondary_service, Options... >::value
-                ? gatt_uuids::secondary_service
-                : gatt_uuids::primary_service ),
-            &generate_attribute< service_defintion_tag, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::access
-        };
+        constexpr attribute generate_attribute< service_defintion_tag, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::attr;
 
         /*
          * include attribute for 16-bit includes
@@ -422,7 +439,10 @@ namespace bluetoe {
                 return attribute_value_read_only_access( args, &value[ 0 ], sizeof( value ) );
             }
 
-            static const attribute attr;
+            static constexpr attribute attr {
+                bits( details::gatt_uuids::include ),
+                &access
+            };
         };
 
         template <
@@ -432,11 +452,7 @@ namespace bluetoe {
             typename ServiceUUID,
             typename Server,
             typename ... Options >
-        constexpr attribute generate_attribute< include_service< service_uuid16< UUID > >, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::attr =
-        {
-            bits( details::gatt_uuids::include ),
-            &generate_attribute< include_service< service_uuid16< UUID > >, CCCDIndices, ClientCharacteristicIndex, Options... >::access
-        };
+        constexpr attribute generate_attribute< include_service< service_uuid16< UUID > >, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::attr;
 
         /*
          * include attribute for 128-bit includes
@@ -473,7 +489,10 @@ namespace bluetoe {
                 return attribute_value_read_only_access( args, &value[ 0 ], sizeof( value ) );
             }
 
-            static const attribute attr;
+            static constexpr attribute attr {
+                bits( details::gatt_uuids::include ),
+                &access
+            };
         };
 
         template <
@@ -487,10 +506,7 @@ namespace bluetoe {
             typename ServiceUUID,
             typename Server,
             typename ... Options >
-        constexpr attribute generate_attribute< include_service< service_uuid< A, B, C, D, E > >, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::attr {
-            bits( details::gatt_uuids::include ),
-            &generate_attribute< include_service< service_uuid< A, B, C, D, E > >, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::access
-        };
+        constexpr attribute generate_attribute< include_service< service_uuid< A, B, C, D, E > >, CCCDIndices, ClientCharacteristicIndex, ServiceUUID, Server, Options... >::attr;
 
         template < typename ... Options >
         struct count_service_attributes{
@@ -7,6 +7,8 @@
 #include <bluetoe/meta_tools.hpp>
 #include <bluetoe/meta_types.hpp>
 
+#include <iterator>
+
 namespace bluetoe {
 
     namespace csc {
@@ -0,0 +1,372 @@
+#ifndef BLUETOE_SM_BOND_STORE_HPP
+#define BLUETOE_SM_BOND_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <array>
+#include <algorithm>
+#include <iterator>
+
+#include <bluetoe/address.hpp>
+#include <bluetoe/client_characteristic_configuration.hpp>
+
+namespace bluetoe {
+
+    namespace details {
+
+        using uint128_t = std::array< std::uint8_t, 16 >;
+
+        /**
+         * @brief Tuple to store a longterm key along with
+         *        EDIV and Rand value to identify them later.
+         */
+        struct longterm_key_t
+        {
+            std::array< std::uint8_t, 16 >  longterm_key;
+            std::uint64_t                   rand;
+            std::uint16_t                   ediv;
+        };
+
+        /*
+         * GATT Database Hash of the database, the client of a bond is aware of; only stored on request
+         */
+        template < bool Stored >
+        struct bond_database_hash
+        {
+            uint128_t database_hash() const
+            {
+                return hash_;
+            }
+
+            void database_hash( const uint128_t& hash )
+            {
+                hash_ = hash;
+            }
+
+            uint128_t hash_;
+        };
+
+        template <>
+        struct bond_database_hash< false >
+        {
+            uint128_t database_hash() const
+            {
+                return uint128_t{ { 0 } };
+            }
+
+            void database_hash( const uint128_t& )
+            {
+            }
+        };
+    }
+
+    /**
+     * @brief keys and addresses, that were exchanged with a bonded peer
+     */
+    struct bond_data
+    {
+        /**
+         * @brief long term key, along with EDIV and Rand, distributed by the local device
+         */
+        details::longterm_key_t             long_term_key;
+
+        /**
+         * @brief identity resolving key distributed by the peer; all zero, if the peer did not distribute an IRK
+         */
+        details::uint128_t                  identity_resolving_key;
+
+        /**
+         * @brief identity address of the peer; the connection address, if the peer did not distribute an identity address
+         */
+        link_layer::device_address          identity_address;
+    };
+
+    /**
+     * @brief bond store, that does not store any bond
+     *
+     * This is the bond store of the bluetoe::security_manager, which does not bond at all. A
+     * bond store is passed as template parameter to the bonding_security_manager and has
+     * to implement the following interface:
+     *
+     * @code
+     * static constexpr std::size_t no_bond;
+     * static constexpr std::size_t max_client_configurations;
+     *
+     * std::size_t add_bond( const bond_data& );
+     * std::size_t find_bond( std::uint16_t ediv, std::uint64_t rand ) const;
+     * details::uint128_t long_term_key( std::size_t bond ) const;
+     *
+     * void store_client_configurations( std::size_t bond, const details::client_characteristic_configuration&, std::size_t count, const details::uint128_t& database_hash );
+     * void load_client_configurations( std::size_t bond, details::client_characteristic_configuration, std::size_t count ) const;
+     * details::uint128_t database_hash( std::size_t bond ) const;
+     * @endcode
+     *
+     * Bonds are identified by an index. add_bond() and find_bond() return no_bond, if the bond
+     * could not be stored or found. A bond store replaces an existing bond with the same identity
+     * address. The client characteristic configurations, the Client Supported Features and the
+     * hash of the GATT database, the client is aware of, are stored with their last value, when a
+     * bonded peer disconnects, and are restored, when the peer reconnects. A store, that does not keep
+     * the database hash, returns an all zero hash. That is the hash of a server without robust_caching;
+     * with robust_caching, a bonded client is then change-unaware after every reconnect.
+     * max_client_configurations is the maximum number of client characteristic configurations, that
+     * can be stored along with a bond.
+     *
+     * @sa ram_bond_store
+     * @sa file_bond_store
+     * @sa bonding_security_manager
+     */
+    class no_bond_store
+    {
+    public:
+        /** @cond HIDDEN_SYMBOLS */
+        static constexpr std::size_t no_bond = ~std::size_t{ 0 };
+        static constexpr std::size_t max_client_configurations = ~std::size_t{ 0 };
+
+        std::size_t add_bond( const bond_data& )
+        {
+            return no_bond;
+        }
+
+        std::size_t find_bond( std::uint16_t, std::uint64_t ) const
+        {
+            return no_bond;
+        }
+
+        details::uint128_t long_term_key( std::size_t ) const
+        {
+            return details::uint128_t{ { 0 } };
+        }
+
+        void store_client_configurations( std::size_t, const details::client_characteristic_configuration&, std::size_t, const details::uint128_t& )
+        {
+        }
+
+        void load_client_configurations( std::size_t, details::client_characteristic_configuration, std::size_t ) const
+        {
+        }
+
+        details::uint128_t database_hash( std::size_t ) const
+        {
+            return details::uint128_t{ { 0 } };
+        }
+        /** @endcond */
+    };
+
+    /**
+     * @brief bond store, that keeps bonds in RAM
+     *
+     * Bonds are lost, when the device is reset. If there is no more room for a new bond, the
+     * oldest bond is replaced.
+     *
+     * @tparam MaxBonds the maximum number of bonds stored
+     * @tparam MaxClientConfigurations the maximum number of client characteristic configurations stored per bond
+     * @tparam StoreDatabaseHash if true, the GATT Database Hash, the client is aware of, is stored with a bond, which
+     *         costs 16 bytes per bond. Only useful with a server that uses bluetoe::robust_caching.
+     *
+     * @sa no_bond_store
+     * @sa bonding_security_manager
+     */
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations = 8, bool StoreDatabaseHash = false >
+    class ram_bond_store
+    {
+    public:
+        static_assert( MaxBonds > 0, "a ram_bond_store has to store at least one bond" );
+
+        /**
+         * @brief index returned, if a bond could not be stored or found
+         */
+        static constexpr std::size_t no_bond = ~std::size_t{ 0 };
+
+        /**
+         * @brief maximum number of client characteristic configurations stored per bond
+         */
+        static constexpr std::size_t max_client_configurations = MaxClientConfigurations;
+
+        /**
+         * @brief constructs an empty store
+         */
+        ram_bond_store();
+
+        /**
+         * @brief stores a new bond and returns its index
+         *
+         * The stored client characteristic configurations are cleared.
+         */
+        std::size_t add_bond( const bond_data& bond );
+
+        /**
+         * @brief returns the index of the bond, with the given EDIV and Rand, or no_bond
+         */
+        std::size_t find_bond( std::uint16_t ediv, std::uint64_t rand ) const;
+
+        /**
+         * @brief returns the long term key of the given bond
+         *
+         * @pre index < MaxBonds
+         */
+        details::uint128_t long_term_key( std::size_t index ) const;
+
+        /**
+         * @brief returns the data of the given bond
+         *
+         * @pre index < MaxBonds
+         */
+        const bond_data& bond( std::size_t index ) const;
+
+        /**
+         * @brief returns the number of stored bonds
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief stores the first count client characteristic configurations, the Client Supported Features and
+         *        the hash of the GATT database, the client is aware of, for the given bond
+         */
+        void store_client_configurations( std::size_t index, const details::client_characteristic_configuration& configs, std::size_t count, const details::uint128_t& database_hash );
+
+        /**
+         * @brief restores the first count client characteristic configurations and the Client Supported Features of the given bond
+         */
+        void load_client_configurations( std::size_t index, details::client_characteristic_configuration configs, std::size_t count ) const;
+
+        /**
+         * @brief returns the hash of the GATT database, the client of the given bond is aware of; all zero,
+         *        if StoreDatabaseHash is false
+         *
+         * @pre index < MaxBonds
+         */
+        details::uint128_t database_hash( std::size_t index ) const;
+
+    protected:
+        /** @cond HIDDEN_SYMBOLS */
+        static constexpr std::size_t config_size =
+            ( MaxClientConfigurations * details::client_characteristic_configuration::bits_per_config + 7 ) / 8;
+
+        struct record : details::bond_database_hash< StoreDatabaseHash >
+        {
+            bool            used;
+            bond_data       data;
+            std::uint8_t    configs[ config_size == 0 ? 1 : config_size ];
+            std::uint8_t    client_supported_features;
+        };
+
+        std::array< record, MaxBonds >  records_;
+        std::size_t                     next_;
+        /** @endcond */
+    };
+
+    // implementation
+    /** @cond HIDDEN_SYMBOLS */
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::ram_bond_store()
+        : next_( 0 )
+    {
+        for ( auto& r : records_ )
+            r.used = false;
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    std::size_t ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::add_bond( const bond_data& bond )
+    {
+        auto slot = std::find_if( records_.begin(), records_.end(), [&bond]( const record& r ) {
+            return r.used && r.data.identity_address == bond.identity_address;
+        } );
+
+        if ( slot == records_.end() )
+            slot = std::find_if( records_.begin(), records_.end(), []( const record& r ) { return !r.used; } );
+
+        // replace the oldest bond
+        if ( slot == records_.end() )
+        {
+            slot  = std::next( records_.begin(), next_ );
+            next_ = ( next_ + 1 ) % MaxBonds;
+        }
+
+        slot->used = true;
+        slot->data = bond;
+        std::fill( std::begin( slot->configs ), std::end( slot->configs ), 0 );
+        slot->client_supported_features = 0;
+        slot->database_hash( details::uint128_t{ { 0 } } );
+
+        return static_cast< std::size_t >( slot - records_.begin() );
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    std::size_t ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::find_bond( std::uint16_t ediv, std::uint64_t rand ) const
+    {
+        const auto pos = std::find_if( records_.begin(), records_.end(), [ediv, rand]( const record& r ) {
+            return r.used && r.data.long_term_key.ediv == ediv && r.data.long_term_key.rand == rand;
+        } );
+
+        return pos == records_.end()
+            ? no_bond
+            : static_cast< std::size_t >( pos - records_.begin() );
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    details::uint128_t ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::long_term_key( std::size_t index ) const
+    {
+        return bond( index ).long_term_key.longterm_key;
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    const bond_data& ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::bond( std::size_t index ) const
+    {
+        assert( index < MaxBonds );
+
+        return records_[ index ].data;
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    std::size_t ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::size() const
+    {
+        return static_cast< std::size_t >( std::count_if( records_.begin(), records_.end(), []( const record& r ) { return r.used; } ) );
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    void ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::store_client_configurations(
+        std::size_t index, const details::client_characteristic_configuration& configs, std::size_t count, const details::uint128_t& database_hash )
+    {
+        assert( index < MaxBonds );
+        assert( count <= MaxClientConfigurations );
+
+        record& r = records_[ index ];
+        details::client_characteristic_configuration stored( &r.configs[ 0 ], MaxClientConfigurations );
+
+        for ( std::size_t config = 0; config != count; ++config )
+            stored.flags( config, configs.flags( config ) );
+
+        r.client_supported_features = configs.client_supported_features();
+        r.database_hash( database_hash );
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    void ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::load_client_configurations(
+        std::size_t index, details::client_characteristic_configuration configs, std::size_t count ) const
+    {
+        assert( index < MaxBonds );
+        assert( count <= MaxClientConfigurations );
+
+        // the stored configurations are only read
+        const details::client_characteristic_configuration stored(
+            const_cast< std::uint8_t* >( &records_[ index ].configs[ 0 ] ), MaxClientConfigurations );
+
+        for ( std::size_t config = 0; config != count; ++config )
+            configs.flags( config, stored.flags( config ) );
+
+        if ( configs.has_client_supported_features() )
+            configs.client_supported_features( records_[ index ].client_supported_features );
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    details::uint128_t ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::database_hash( std::size_t index ) const
+    {
+        assert( index < MaxBonds );
+
+        return records_[ index ].database_hash();
+    }
+    /** @endcond */
+}
+
+#endif
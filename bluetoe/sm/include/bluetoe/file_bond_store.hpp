@@ -0,0 +1,203 @@
+#ifndef BLUETOE_SM_FILE_BOND_STORE_HPP
+#define BLUETOE_SM_FILE_BOND_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <bluetoe/bond_store.hpp>
+#include <bluetoe/bits.hpp>
+
+namespace bluetoe {
+
+    /**
+     * @brief bond store, that keeps bonds in RAM and writes them to a file on every change
+     *
+     * Intended for hosted environments, like tests or a HCI based link layer. Before the first
+     * bond is added, open() has to be called to load existing bonds and to define the file, where
+     * changes are written to. Without a call to open(), the store behaves like a ram_bond_store.
+     * If the file can not be written, add_bond() returns no_bond and the store keeps the bonds, it had before.
+     *
+     * @tparam MaxBonds the maximum number of bonds stored
+     * @tparam MaxClientConfigurations the maximum number of client characteristic configurations stored per bond
+     * @tparam StoreDatabaseHash if true, the GATT Database Hash, the client is aware of, is stored with a bond
+     *
+     * @sa ram_bond_store
+     * @sa bonding_security_manager
+     */
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations = 8, bool StoreDatabaseHash = false >
+    class file_bond_store : public ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >
+    {
+    public:
+        /**
+         * @brief loads the bonds from the given file and writes all further changes to this file
+         *
+         * A missing file is not an error and results in an empty store. Returns false, if the file
+         * exists, but was not written by a store with the same capacity.
+         */
+        bool open( const std::string& path );
+
+        /**
+         * @brief stores a new bond, writes it to the file and returns its index
+         *
+         * Returns no_bond, if the file could not be written. In this case, the bond, that would have been
+         * replaced by the new bond, is kept.
+         */
+        std::size_t add_bond( const bond_data& bond );
+
+        /**
+         * @brief stores the client state of the given bond and writes it to the file
+         *
+         * Returns false, if the file could not be written. The state is kept in RAM nevertheless.
+         *
+         * @sa ram_bond_store::store_client_configurations
+         */
+        bool store_client_configurations( std::size_t index, const details::client_characteristic_configuration& configs, std::size_t count, const details::uint128_t& database_hash );
+
+    private:
+        using base = ram_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >;
+
+        static constexpr std::size_t database_hash_size = StoreDatabaseHash ? 16 : 0;
+
+        // used flag, LTK, Rand, EDIV, IRK, address type, address, database hash (if stored), the client characteristic
+        // configurations and the Client Supported Features
+        static constexpr std::size_t record_size = 1 + 16 + 8 + 2 + 16 + 1 + 6 + database_hash_size + sizeof base::record::configs + 1;
+        static constexpr std::size_t file_size   = 4 + MaxBonds * record_size;
+
+        bool save() const;
+
+        std::string path_;
+    };
+
+    // implementation
+    /** @cond HIDDEN_SYMBOLS */
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    bool file_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::open( const std::string& path )
+    {
+        path_ = path;
+
+        std::FILE* const file = std::fopen( path_.c_str(), "rb" );
+
+        if ( file == nullptr )
+            return true;
+
+        std::vector< std::uint8_t > content( file_size + 1 );
+        const std::size_t size = std::fread( content.data(), 1, content.size(), file );
+        std::fclose( file );
+
+        if ( size != file_size )
+            return false;
+
+        const std::uint8_t* read = content.data();
+        this->next_ = details::read_32bit( read ) % MaxBonds;
+        read += 4;
+
+        for ( auto& r : this->records_ )
+        {
+            r.used = *read++ != 0;
+
+            std::copy( read, read + 16, r.data.long_term_key.longterm_key.begin() );
+            read += 16;
+
+            r.data.long_term_key.rand = details::read_32bit( read ) | ( std::uint64_t( details::read_32bit( read + 4 ) ) << 32 );
+            read += 8;
+
+            r.data.long_term_key.ediv = details::read_16bit( read );
+            read += 2;
+
+            std::copy( read, read + 16, r.data.identity_resolving_key.begin() );
+            read += 16;
+
+            r.data.identity_address = link_layer::device_address( read + 1, *read != 0 );
+            read += 7;
+
+            if ( StoreDatabaseHash )
+            {
+                details::uint128_t hash;
+                std::copy( read, read + database_hash_size, hash.begin() );
+                r.database_hash( hash );
+                read += database_hash_size;
+            }
+
+            std::copy( read, read + sizeof r.configs, &r.configs[ 0 ] );
+            read += sizeof r.configs;
+
+            r.client_supported_features = *read++;
+        }
+
+        return true;
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    std::size_t file_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::add_bond( const bond_data& bond )
+    {
+        // base::add_bond() replaces a record; it is restored, if the new bond can not be written
+        const auto        records = this->records_;
+        const std::size_t next    = this->next_;
+
+        const std::size_t index = base::add_bond( bond );
+
+        if ( save() )
+            return index;
+
+        this->records_[ index ] = records[ index ];
+        this->next_             = next;
+
+        return base::no_bond;
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    bool file_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::store_client_configurations(
+        std::size_t index, const details::client_characteristic_configuration& configs, std::size_t count, const details::uint128_t& database_hash )
+    {
+        base::store_client_configurations( index, configs, count, database_hash );
+
+        return save();
+    }
+
+    template < std::size_t MaxBonds, std::size_t MaxClientConfigurations, bool StoreDatabaseHash >
+    bool file_bond_store< MaxBonds, MaxClientConfigurations, StoreDatabaseHash >::save() const
+    {
+        if ( path_.empty() )
+            return true;
+
+        std::vector< std::uint8_t > content( file_size );
+        std::uint8_t* write = details::write_32bit( content.data(), static_cast< std::uint32_t >( this->next_ ) );
+
+        for ( const auto& r : this->records_ )
+        {
+            write = details::write_byte( write, r.used ? 1 : 0 );
+            write = std::copy( r.data.long_term_key.longterm_key.begin(), r.data.long_term_key.longterm_key.end(), write );
+            write = details::write_64bit( write, r.data.long_term_key.rand );
+            write = details::write_16bit( write, r.data.long_term_key.ediv );
+            write = std::copy( r.data.identity_resolving_key.begin(), r.data.identity_resolving_key.end(), write );
+            write = details::write_byte( write, r.data.identity_address.is_random() ? 1 : 0 );
+            write = std::copy( r.data.identity_address.begin(), r.data.identity_address.end(), write );
+
+            if ( StoreDatabaseHash )
+            {
+                const details::uint128_t hash = r.database_hash();
+                write = std::copy( hash.begin(), hash.end(), write );
+            }
+
+            write = std::copy( std::begin( r.configs ), std::end( r.configs ), write );
+            write = details::write_byte( write, r.client_supported_features );
+        }
+
+        std::FILE* const file = std::fopen( path_.c_str(), "wb" );
+
+        if ( file == nullptr )
+            return false;
+
+        const bool written = std::fwrite( content.data(), 1, content.size(), file ) == content.size();
+
+        // fclose() flushes the buffered content and can fail as well
+        return std::fclose( file ) == 0 && written;
+    }
+    /** @endcond */
+}
+
+#endif
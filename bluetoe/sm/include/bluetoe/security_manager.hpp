@@ -5,29 +5,20 @@
 #include <cstdint>
 #include <cassert>
 #include <array>
+#include <iterator>
+#include <type_traits>
 
 #include <bluetoe/codes.hpp>
+#include <bluetoe/bits.hpp>
 #include <bluetoe/address.hpp>
 #include <bluetoe/link_state.hpp>
 #include <bluetoe/pairing_status.hpp>
+#include <bluetoe/bond_store.hpp>
 
 namespace bluetoe {
 
     namespace details {
 
-        using uint128_t = std::array< std::uint8_t, 16 >;
-
-        /**
-         * @brief Tuple to store a longterm key along with
-         *        EDIV and Rand value to identify them later.
-         */
-        struct longterm_key_t
-        {
-            std::array< std::uint8_t, 16 >  longterm_key;
-            std::uint64_t                   rand;
-            std::uint16_t                   ediv;
-        };
-
         struct security_manager_meta_type {};
 
         enum class sm_error_codes : std::uint8_t {
@@ -80,6 +71,23 @@ namespace bluetoe {
             pairing_completed,
         };
 
+        // bits of the AuthReq and key distribution fields of the pairing request and response
+        static constexpr std::uint8_t sm_bonding_flags_mask = 0x03;
+        static constexpr std::uint8_t sm_bonding            = 0x01;
+        static constexpr std::uint8_t sm_enc_key            = 0x01;
+        static constexpr std::uint8_t sm_id_key             = 0x02;
+
+        /*
+         * Key distribution PDUs, that are still to be exchanged after pairing.
+         */
+        enum pending_key : std::uint8_t {
+            local_encryption_information    = 0x01,
+            local_master_identification     = 0x02,
+            remote_identity_information     = 0x04,
+            remote_identity_address         = 0x08,
+            local_keys                      = local_encryption_information | local_master_identification
+        };
+
         inline void error_response( details::sm_error_codes error_code, std::uint8_t* output, std::size_t& out_size )
         {
             output[ 0 ] = static_cast< std::uint8_t >( sm_opcodes::pairing_failed );
@@ -90,9 +98,25 @@ namespace bluetoe {
     }
 
     /**
-     * @brief A Security manager implementation that supports legacy pairing.
+     * @brief A Security manager implementation that supports legacy pairing and bonding.
+     *
+     * If the peer requests bonding, the security manager distributes a long term key (Encryption Information
+     * and Master Identification) and asks the peer to distribute its Identity Information and Identity
+     * Address Information. Once all keys are exchanged, the bond is kept in the BondStore. When a bonded
+     * peer reconnects and starts encryption with the EDIV and Rand of a stored long term key, the link
+     * is encrypted without a new pairing and the client characteristic configurations and the Client Supported
+     * Features of the last connection are restored. The peer is change-aware, if the GATT database did not
+     * change since the last connection (see bluetoe::robust_caching). With robust_caching, the BondStore has
+     * to store the database hash (see ram_bond_store) to find out.
+     *
+     * @tparam BondStore the store, where bonds are kept.
+     *
+     * @sa security_manager
+     * @sa ram_bond_store
+     * @sa file_bond_store
      */
-    class security_manager
+    template < class BondStore >
+    class bonding_security_manager
     {
     public:
         /** @cond HIDDEN_SYMBOLS */
@@ -104,6 +128,9 @@ namespace bluetoe {
             connection_data( Args&&... args )
                 : OtherConnectionData( args... )
                 , state_( details::pairing_state::idle )
+                , pending_keys_( 0 )
+                , bonding_( false )
+                , bond_( BondStore::no_bond )
             {}
 
             details::pairing_state state() const
@@ -113,7 +140,8 @@ namespace bluetoe {
 
             void remote_connection_created( const bluetoe::link_layer::device_address& remote )
             {
-                remote_addr_ = remote;
+                remote_addr_     = remote;
+                identity_addr_   = remote;
             }
 
             const bluetoe::link_layer::device_address& remote_address() const
@@ -145,12 +173,90 @@ namespace bluetoe {
                 state_ = details::pairing_state::pairing_completed;
 
                 state_data_.completed_state.short_term_key = short_term_key;
+                state_data_.completed_state.identity_resolving_key = details::uint128_t{ { 0 } };
+            }
+
+            /*
+             * set of details::pending_key, that have to be exchanged, after the link is encrypted
+             */
+            void key_distribution( std::uint8_t pending_keys )
+            {
+                pending_keys_ = pending_keys;
+                bonding_      = pending_keys != 0;
+            }
+
+            std::uint8_t pending_keys() const
+            {
+                return state_ == details::pairing_state::pairing_completed ? pending_keys_ : 0;
+            }
+
+            void key_exchanged( details::pending_key key )
+            {
+                pending_keys_ = static_cast< std::uint8_t >( pending_keys_ & ~key );
+            }
+
+            void long_term_key( const details::longterm_key_t& key )
+            {
+                state_data_.completed_state.long_term_key = key;
+            }
+
+            const details::longterm_key_t& long_term_key() const
+            {
+                return state_data_.completed_state.long_term_key;
+            }
+
+            void identity_resolving_key( const std::uint8_t* irk )
+            {
+                std::copy( irk, irk + state_data_.completed_state.identity_resolving_key.size(),
+                    state_data_.completed_state.identity_resolving_key.begin() );
+            }
+
+            void identity_address( const bluetoe::link_layer::device_address& address )
+            {
+                identity_addr_ = address;
+            }
+
+            /*
+             * true, if all keys of a requested bonding are exchanged, but not stored yet
+             */
+            bool bonding_completed() const
+            {
+                return bonding_ && pending_keys() == 0 && state_ == details::pairing_state::pairing_completed;
+            }
+
+            bond_data exchanged_keys() const
+            {
+                return bond_data{
+                    state_data_.completed_state.long_term_key,
+                    state_data_.completed_state.identity_resolving_key,
+                    identity_addr_ };
+            }
+
+            void bonded( std::size_t bond )
+            {
+                bonding_ = false;
+                bond_    = bond;
+            }
+
+            void bond_restored( std::size_t bond )
+            {
+                state_        = details::pairing_state::pairing_completed;
+                pending_keys_ = 0;
+                bonded( bond );
+            }
+
+            /*
+             * index of the bond in the BondStore, or BondStore::no_bond
+             */
+            std::size_t bond() const
+            {
+                return bond_;
             }
 
             template < class T >
             bool outgoing_security_manager_data_available( const bluetoe::details::link_state< T >& link ) const
             {
-                return link.is_encrypted() && state_ != details::pairing_state::pairing_completed;
+                return link.is_encrypted() && ( pending_keys() & details::local_keys ) != 0;
             }
 
             std::pair< bool, details::uint128_t > find_key( std::uint16_t ediv, std::uint64_t rand ) const
@@ -163,7 +269,9 @@ namespace bluetoe {
 
             void error_reset()
             {
-                state_ = details::pairing_state::idle;
+                state_        = details::pairing_state::idle;
+                pending_keys_ = 0;
+                bonding_      = false;
             }
 
             const details::uint128_t& c1_p1() const
@@ -195,7 +303,11 @@ namespace bluetoe {
 
         private:
             bluetoe::link_layer::device_address remote_addr_;
+            bluetoe::link_layer::device_address identity_addr_;
             details::pairing_state              state_;
+            std::uint8_t                        pending_keys_;
+            bool                                bonding_;
+            std::size_t                         bond_;
 
             union {
                 struct {
@@ -206,7 +318,9 @@ namespace bluetoe {
                 }                                   pairing_state;
 
                 struct {
-                    details::uint128_t short_term_key;
+                    details::uint128_t      short_term_key;
+                    details::longterm_key_t long_term_key;
+                    details::uint128_t      identity_resolving_key;
                 }                                   completed_state;
             }                       state_data_;
         };
@@ -214,16 +328,51 @@ namespace bluetoe {
         template < class OtherConnectionData, class SecurityFunctions >
         void l2cap_input( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >&, SecurityFunctions& );
 
+        /*
+         * distributes the next local key; to be called, when outgoing_security_manager_data_available() returns true
+         */
+        template < class OtherConnectionData, class SecurityFunctions >
+        void l2cap_output( std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >&, SecurityFunctions& );
+
+        /*
+         * looks up the short term key, or the long term key of a bond; restores the bonds
+         * client characteristic configurations, if a bond was found.
+         */
+        template < class OtherConnectionData, class SecurityFunctions >
+        std::pair< bool, details::uint128_t > find_key( std::uint16_t ediv, std::uint64_t rand, connection_data< OtherConnectionData >&, SecurityFunctions& );
+
+        /*
+         * stores the client characteristic configurations of a bonded peer
+         */
+        template < class OtherConnectionData, class SecurityFunctions >
+        void remote_connection_closed( connection_data< OtherConnectionData >&, SecurityFunctions& );
+
         typedef details::security_manager_meta_type meta_type;
+        /** @endcond */
+
+        /**
+         * @brief the store, where bonds are kept
+         *
+         * Can be used to open a file_bond_store, for example.
+         */
+        BondStore& bond_store();
+
+        /**
+         * @copydoc bond_store()
+         */
+        const BondStore& bond_store() const;
+
     private:
+        /** @cond HIDDEN_SYMBOLS */
         static constexpr std::uint8_t   min_max_key_size = 7;
         static constexpr std::uint8_t   max_max_key_size = 16;
         static constexpr std::size_t    pairing_req_resp_size = 7;
+        static constexpr bool           bonding_supported = !std::is_same< BondStore, no_bond_store >::value;
 
         template < class OtherConnectionData, class SecurityFunctions >
         void handle_pairing_request( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >&, SecurityFunctions& );
 
-        void create_pairing_response( std::uint8_t* output, std::size_t& out_size );
+        void create_pairing_response( std::uint8_t* output, std::size_t& out_size, std::uint8_t auth_req, std::uint8_t initiator_keys, std::uint8_t responder_keys );
 
         template < class OtherConnectionData, class SecurityFunctions >
         void handle_pairing_confirm( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >&, SecurityFunctions& );
@@ -231,6 +380,15 @@ namespace bluetoe {
         template < class OtherConnectionData, class SecurityFunctions >
         void handle_pairing_random( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >&, SecurityFunctions& );
 
+        template < class OtherConnectionData >
+        void handle_identity_information( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& );
+
+        template < class OtherConnectionData >
+        void handle_identity_address_information( const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& );
+
+        template < class OtherConnectionData >
+        void store_bond( connection_data< OtherConnectionData >& );
+
         template < class OtherConnectionData >
         void error_response( details::sm_error_codes error_code, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& );
 
@@ -243,9 +401,17 @@ namespace bluetoe {
             const bluetoe::link_layer::device_address& initiating_device,
             const bluetoe::link_layer::device_address& responding_device );
 
+        BondStore   bond_store_;
         /** @endcond */
     };
 
+    /**
+     * @brief A Security manager implementation that supports legacy pairing, without bonding.
+     *
+     * @sa bonding_security_manager
+     */
+    using security_manager = bonding_security_manager< no_bond_store >;
+
     /**
      * @brief current default implementation of the security manager, that actievly rejects every pairing attempt.
      */
@@ -284,8 +450,9 @@ namespace bluetoe {
      * Implementation
      */
     /** @cond HIDDEN_SYMBOLS */
+    template < class BondStore >
     template < class OtherConnectionData, class SecurityFunctions >
-    void security_manager::l2cap_input(
+    void bonding_security_manager< BondStore >::l2cap_input(
         const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state, SecurityFunctions& func )
     {
         using namespace bluetoe::details;
@@ -310,13 +477,112 @@ namespace bluetoe {
             case sm_opcodes::pairing_random:
                 handle_pairing_random( input, in_size, output, out_size, state, func );
                 break;
+            case sm_opcodes::identity_information:
+                handle_identity_information( input, in_size, output, out_size, state );
+                break;
+            case sm_opcodes::identity_address_information:
+                handle_identity_address_information( input, in_size, output, out_size, state );
+                break;
             default:
                 error_response( sm_error_codes::command_not_supported, output, out_size, state );
         }
     }
 
+    template < class BondStore >
+    template < class OtherConnectionData, class SecurityFunctions >
+    void bonding_security_manager< BondStore >::l2cap_output(
+        std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state, SecurityFunctions& func )
+    {
+        using namespace details;
+
+        static constexpr std::size_t encryption_information_size = 17;
+        static constexpr std::size_t master_identification_size  = 11;
+
+        assert( out_size >= encryption_information_size );
+
+        if ( state.pending_keys() & local_encryption_information )
+        {
+            state.long_term_key( func.create_long_term_key() );
+            state.key_exchanged( local_encryption_information );
+
+            const auto& ltk = state.long_term_key().longterm_key;
+
+            out_size = encryption_information_size;
+            output[ 0 ] = static_cast< std::uint8_t >( sm_opcodes::encryption_information );
+            std::copy( ltk.begin(), ltk.end(), &output[ 1 ] );
+        }
+        else if ( state.pending_keys() & local_master_identification )
+        {
+            state.key_exchanged( local_master_identification );
+
+            out_size = master_identification_size;
+            output[ 0 ] = static_cast< std::uint8_t >( sm_opcodes::master_identification );
+            write_64bit( write_16bit( &output[ 1 ], state.long_term_key().ediv ), state.long_term_key().rand );
+        }
+        else
+        {
+            out_size = 0;
+        }
+
+        store_bond( state );
+    }
+
+    template < class BondStore >
+    template < class OtherConnectionData, class SecurityFunctions >
+    std::pair< bool, details::uint128_t > bonding_security_manager< BondStore >::find_key(
+        std::uint16_t ediv, std::uint64_t rand, connection_data< OtherConnectionData >& state, SecurityFunctions& func )
+    {
+        static constexpr std::size_t configurations = OtherConnectionData::number_of_characteristics_with_configuration;
+        static_assert( configurations <= BondStore::max_client_configurations,
+            "the bond store can not store all client characteristic configurations of the GATT server" );
+
+        if ( ediv == 0 && rand == 0 )
+            return state.find_key( ediv, rand );
+
+        const std::size_t bond = bond_store_.find_bond( ediv, rand );
+
+        if ( bond == BondStore::no_bond )
+            return std::pair< bool, details::uint128_t >{};
+
+        state.bond_restored( bond );
+        bond_store_.load_client_configurations( bond, state.client_configurations(), configurations );
+        // the peer cached the database, it was aware of at the end of the last connection
+        state.change_aware( bond_store_.database_hash( bond ) == func.database_hash() );
+
+        return { true, bond_store_.long_term_key( bond ) };
+    }
+
+    template < class BondStore >
+    template < class OtherConnectionData, class SecurityFunctions >
+    void bonding_security_manager< BondStore >::remote_connection_closed( connection_data< OtherConnectionData >& state, SecurityFunctions& func )
+    {
+        if ( state.bond() == BondStore::no_bond )
+            return;
+
+        // a change-unaware peer still knows the database of the previous connection
+        const details::uint128_t known_database = state.change_aware()
+            ? func.database_hash()
+            : bond_store_.database_hash( state.bond() );
+
+        bond_store_.store_client_configurations( state.bond(), state.client_configurations(),
+            OtherConnectionData::number_of_characteristics_with_configuration, known_database );
+    }
+
+    template < class BondStore >
+    BondStore& bonding_security_manager< BondStore >::bond_store()
+    {
+        return bond_store_;
+    }
+
+    template < class BondStore >
+    const BondStore& bonding_security_manager< BondStore >::bond_store() const
+    {
+        return bond_store_;
+    }
+
+    template < class BondStore >
     template < class OtherConnectionData, class SecurityFunctions >
-    void security_manager::handle_pairing_request(
+    void bonding_security_manager< BondStore >::handle_pairing_request(
         const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state, SecurityFunctions& functions )
     {
         using namespace details;
@@ -346,16 +612,26 @@ namespace bluetoe {
             return error_response( sm_error_codes::invalid_parameters, output, out_size, state );
         }
 
-        create_pairing_response( output, out_size );
+        // the local device distributes a LTK; the peer its identity, so that the bond can be recognized
+        const bool         bonding        = bonding_supported && ( auth_req & sm_bonding_flags_mask ) == sm_bonding;
+        const std::uint8_t initiator_keys = bonding ? initiator_key_distribution & sm_id_key : 0;
+        const std::uint8_t responder_keys = bonding ? responder_key_distribution & sm_enc_key : 0;
+
+        create_pairing_response( output, out_size, bonding ? sm_bonding : 0, initiator_keys, responder_keys );
 
         const details::uint128_t srand    = functions.create_srand();
         const details::uint128_t p1       = c1_p1( input, output, state.remote_address(), functions.local_address() );
         const details::uint128_t p2       = c1_p2( state.remote_address(), functions.local_address() );
 
         state.pairing_request( srand, p1, p2 );
+        state.key_distribution(
+            ( responder_keys & sm_enc_key ? local_encryption_information | local_master_identification : 0 )
+          | ( initiator_keys & sm_id_key ? remote_identity_information | remote_identity_address : 0 ) );
     }
 
-    inline void security_manager::create_pairing_response( std::uint8_t* output, std::size_t& out_size )
+    template < class BondStore >
+    void bonding_security_manager< BondStore >::create_pairing_response(
+        std::uint8_t* output, std::size_t& out_size, std::uint8_t auth_req, std::uint8_t initiator_keys, std::uint8_t responder_keys )
     {
         using namespace details;
 
@@ -363,14 +639,15 @@ namespace bluetoe {
         output[ 0 ] = static_cast< std::uint8_t >( sm_opcodes::pairing_response );
         output[ 1 ] = static_cast< std::uint8_t >( io_capabilities::no_input_no_output );
         output[ 2 ] = 0;
-        output[ 3 ] = 0;
+        output[ 3 ] = auth_req;
         output[ 4 ] = max_max_key_size;
-        output[ 5 ] = 0;
-        output[ 6 ] = 0;
+        output[ 5 ] = initiator_keys;
+        output[ 6 ] = responder_keys;
     }
 
+    template < class BondStore >
     template < class OtherConnectionData, class SecurityFunctions >
-    void security_manager::handle_pairing_confirm(
+    void bonding_security_manager< BondStore >::handle_pairing_confirm(
         const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state, SecurityFunctions& func )
     {
         using namespace details;
@@ -393,8 +670,9 @@ namespace bluetoe {
         std::copy( sconfirm.begin(), sconfirm.end(), &output[ 1 ] );
     }
 
+    template < class BondStore >
     template < class OtherConnectionData, class SecurityFunctions >
-    void security_manager::handle_pairing_random(
+    void bonding_security_manager< BondStore >::handle_pairing_random(
         const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state, SecurityFunctions& func )
     {
         using namespace details;
@@ -424,14 +702,69 @@ namespace bluetoe {
         state.pairing_completed( stk );
     }
 
+    template < class BondStore >
+    template < class OtherConnectionData >
+    void bonding_security_manager< BondStore >::handle_identity_information(
+        const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state )
+    {
+        using namespace details;
+
+        static constexpr std::size_t    identity_information_size = 17;
+
+        if ( ( state.pending_keys() & remote_identity_information ) == 0 )
+            return error_response( sm_error_codes::command_not_supported, output, out_size, state );
+
+        if ( in_size != identity_information_size )
+            return error_response( sm_error_codes::invalid_parameters, output, out_size, state );
+
+        state.identity_resolving_key( &input[ 1 ] );
+        state.key_exchanged( remote_identity_information );
+        out_size = 0;
+
+        store_bond( state );
+    }
+
+    template < class BondStore >
+    template < class OtherConnectionData >
+    void bonding_security_manager< BondStore >::handle_identity_address_information(
+        const std::uint8_t* input, std::size_t in_size, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state )
+    {
+        using namespace details;
+
+        static constexpr std::size_t    identity_address_information_size = 8;
+
+        if ( ( state.pending_keys() & remote_identity_address ) == 0 )
+            return error_response( sm_error_codes::command_not_supported, output, out_size, state );
+
+        if ( in_size != identity_address_information_size || input[ 1 ] > 1 )
+            return error_response( sm_error_codes::invalid_parameters, output, out_size, state );
+
+        state.identity_address( bluetoe::link_layer::device_address( &input[ 2 ], input[ 1 ] != 0 ) );
+        state.key_exchanged( remote_identity_address );
+        out_size = 0;
+
+        store_bond( state );
+    }
+
+    template < class BondStore >
+    template < class OtherConnectionData >
+    void bonding_security_manager< BondStore >::store_bond( connection_data< OtherConnectionData >& state )
+    {
+        // the database hash, the peer is aware of, is stored, when the connection is closed
+        if ( state.bonding_completed() )
+            state.bonded( bond_store_.add_bond( state.exchanged_keys() ) );
+    }
+
+    template < class BondStore >
     template < class OtherConnectionData >
-    void security_manager::error_response( details::sm_error_codes error_code, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state )
+    void bonding_security_manager< BondStore >::error_response( details::sm_error_codes error_code, std::uint8_t* output, std::size_t& out_size, connection_data< OtherConnectionData >& state )
     {
         state.error_reset();
         details::error_response( error_code, output, out_size );
     }
 
-    inline details::uint128_t security_manager::c1_p1(
+    template < class BondStore >
+    details::uint128_t bonding_security_manager< BondStore >::c1_p1(
         const std::uint8_t* input, const std::uint8_t* output,
         const bluetoe::link_layer::device_address& initiating_device,
         const bluetoe::link_layer::device_address& responding_device )
@@ -446,7 +779,8 @@ namespace bluetoe {
         return result;
     }
 
-    inline details::uint128_t security_manager::c1_p2(
+    template < class BondStore >
+    details::uint128_t bonding_security_manager< BondStore >::c1_p2(
         const bluetoe::link_layer::device_address& initiating_device,
         const bluetoe::link_layer::device_address& responding_device )
     {
@@ -0,0 +1,160 @@
+#include <bluetoe/aes_cmac.hpp>
+#include <algorithm>
+#include <iterator>
+
+namespace bluetoe {
+namespace details {
+
+    namespace {
+        const std::uint8_t sbox[ 256 ] = {
+            0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+            0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+            0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+            0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+            0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+            0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+            0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+            0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+            0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+            0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+            0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+            0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+            0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+            0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+            0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+            0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+        };
+
+        std::uint8_t xtime( std::uint8_t x )
+        {
+            return static_cast< std::uint8_t >( ( x << 1 ) ^ ( ( x & 0x80 ) ? 0x1b : 0x00 ) );
+        }
+
+        // multiplication by x in GF(2^128), used to derive the CMAC subkeys
+        void shift_left( std::uint8_t* block )
+        {
+            const bool msb_set = block[ 0 ] & 0x80;
+
+            for ( std::size_t i = 0; i != aes_cmac::block_size - 1; ++i )
+                block[ i ] = static_cast< std::uint8_t >( ( block[ i ] << 1 ) | ( block[ i + 1 ] >> 7 ) );
+
+            block[ aes_cmac::block_size - 1 ] = static_cast< std::uint8_t >( block[ aes_cmac::block_size - 1 ] << 1 );
+
+            if ( msb_set )
+                block[ aes_cmac::block_size - 1 ] ^= 0x87;
+        }
+
+        void xor_block( std::uint8_t* target, const std::uint8_t* source )
+        {
+            for ( std::size_t i = 0; i != aes_cmac::block_size; ++i )
+                target[ i ] ^= source[ i ];
+        }
+    }
+
+    aes_cmac::aes_cmac( const std::uint8_t* key )
+        : buffered_( 0 )
+    {
+        std::copy( key, key + block_size, &round_keys_[ 0 ] );
+
+        std::uint8_t rcon = 0x01;
+
+        for ( std::size_t i = block_size; i != sizeof( round_keys_ ); i += 4 )
+        {
+            std::uint8_t word[ 4 ] = { round_keys_[ i - 4 ], round_keys_[ i - 3 ], round_keys_[ i - 2 ], round_keys_[ i - 1 ] };
+
+            if ( i % block_size == 0 )
+            {
+                const std::uint8_t first = word[ 0 ];
+                word[ 0 ] = sbox[ word[ 1 ] ] ^ rcon;
+                word[ 1 ] = sbox[ word[ 2 ] ];
+                word[ 2 ] = sbox[ word[ 3 ] ];
+                word[ 3 ] = sbox[ first ];
+
+                rcon = xtime( rcon );
+            }
+
+            for ( std::size_t b = 0; b != 4; ++b )
+                round_keys_[ i + b ] = round_keys_[ i + b - block_size ] ^ word[ b ];
+        }
+
+        std::fill( std::begin( state_ ), std::end( state_ ), 0 );
+    }
+
+    void aes_cmac::encrypt( std::uint8_t* block ) const
+    {
+        xor_block( block, &round_keys_[ 0 ] );
+
+        for ( std::size_t round = 1; round != number_of_round_keys; ++round )
+        {
+            // SubBytes and ShiftRows
+            std::uint8_t shifted[ block_size ];
+
+            for ( std::size_t column = 0; column != 4; ++column )
+            {
+                for ( std::size_t row = 0; row != 4; ++row )
+                    shifted[ column * 4 + row ] = sbox[ block[ ( ( column + row ) % 4 ) * 4 + row ] ];
+            }
+
+            // MixColumns, but not in the last round
+            if ( round != number_of_round_keys - 1 )
+            {
+                for ( std::size_t column = 0; column != 4; ++column )
+                {
+                    std::uint8_t* const c = &shifted[ column * 4 ];
+                    const std::uint8_t all = c[ 0 ] ^ c[ 1 ] ^ c[ 2 ] ^ c[ 3 ];
+                    const std::uint8_t first = c[ 0 ];
+
+                    c[ 0 ] ^= all ^ xtime( c[ 0 ] ^ c[ 1 ] );
+                    c[ 1 ] ^= all ^ xtime( c[ 1 ] ^ c[ 2 ] );
+                    c[ 2 ] ^= all ^ xtime( c[ 2 ] ^ c[ 3 ] );
+                    c[ 3 ] ^= all ^ xtime( c[ 3 ] ^ first );
+                }
+            }
+
+            std::copy( std::begin( shifted ), std::end( shifted ), block );
+            xor_block( block, &round_keys_[ round * block_size ] );
+        }
+    }
+
+    void aes_cmac::process_buffer()
+    {
+        xor_block( state_, buffer_ );
+        encrypt( state_ );
+        buffered_ = 0;
+    }
+
+    void aes_cmac::update( const std::uint8_t* begin, const std::uint8_t* end )
+    {
+        for ( ; begin != end; ++begin )
+        {
+            // the last block is treated differently; so a full block is only processed, when there is more input
+            if ( buffered_ == block_size )
+                process_buffer();
+
+            buffer_[ buffered_ ] = *begin;
+            ++buffered_;
+        }
+    }
+
+    void aes_cmac::finish( std::uint8_t* mac )
+    {
+        // subkey generation
+        std::uint8_t subkey[ block_size ] = { 0 };
+        encrypt( subkey );
+        shift_left( subkey );
+
+        if ( buffered_ != block_size )
+        {
+            shift_left( subkey );
+
+            buffer_[ buffered_ ] = 0x80;
+            std::fill( &buffer_[ buffered_ + 1 ], &buffer_[ block_size ], 0 );
+        }
+
+        xor_block( buffer_, subkey );
+        process_buffer();
+
+        std::copy( std::begin( state_ ), std::end( state_ ), mac );
+    }
+}
+}
@@ -0,0 +1,56 @@
+#ifndef BLUETOE_UTILITY_AES_CMAC_HPP
+#define BLUETOE_UTILITY_AES_CMAC_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace bluetoe {
+namespace details {
+
+    /**
+     * @brief AES-CMAC (RFC 4493) based on a software implementation of AES-128
+     *
+     * Intended for the rare cases, where a MAC has to be calculated without the help of
+     * the security functions of the link layer (like the GATT Database Hash).
+     * Key and MAC are in the byte order used by RFC 4493 (most significant octet first).
+     */
+    class aes_cmac
+    {
+    public:
+        static constexpr std::size_t block_size = 16;
+
+        /**
+         * @brief starts a new MAC calculation with the given 16 byte key
+         */
+        explicit aes_cmac( const std::uint8_t* key );
+
+        /**
+         * @brief adds the given bytes to the message
+         */
+        void update( const std::uint8_t* begin, const std::uint8_t* end );
+
+        /**
+         * @brief finish the calculation and write the 16 byte MAC to mac
+         */
+        void finish( std::uint8_t* mac );
+
+        /**
+         * @brief encrypts a single block in place with AES-128
+         */
+        void encrypt( std::uint8_t* block ) const;
+
+    private:
+        void process_buffer();
+
+        static constexpr std::size_t number_of_round_keys = 11;
+
+        std::uint8_t round_keys_[ number_of_round_keys * block_size ];
+        std::uint8_t state_[ block_size ];
+        std::uint8_t buffer_[ block_size ];
+        std::size_t  buffered_;
+    };
+
+}
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef BLUETOE_UTILITY_ATOMIC_WORD_HPP
+#define BLUETOE_UTILITY_ATOMIC_WORD_HPP
+
+#include <atomic>
+
+namespace bluetoe {
+namespace details {
+
+    struct no_atomic_word_lock
+    {
+        no_atomic_word_lock() {}
+    };
+
+    /*
+     * A word, that is changed concurrently by interrupt service routines or threads.
+     *
+     * Where read-modify-write operations on a word are lock-free (ARMv7-M, like the Cortex-M3 / M4 with
+     * exclusive load / store instructions, and the usual hosts), std::atomic is used. ARMv6-M (for example the
+     * Cortex-M0 of the nRF51) has no such instructions; std::atomic would call into libatomic, which is not
+     * available with arm-none-eabi. There, the read-modify-write operations are done while holding Lock, which
+     * has to lock out all other contexts that access the word (like the PRIMASK lock of the nRF51 radio). Plain
+     * loads and stores are compiler barriers, which is sufficient on a single core.
+     */
+#if ATOMIC_INT_LOCK_FREE == 2
+    template < typename T, class Lock >
+    class atomic_word
+    {
+    public:
+        atomic_word() = default;
+
+        explicit atomic_word( T value ) : value_( value ) {}
+
+        T load() const { return value_.load(); }
+        void store( T value ) { value_.store( value ); }
+        T fetch_or( T bits ) { return value_.fetch_or( bits ); }
+        T fetch_and( T bits ) { return value_.fetch_and( bits ); }
+
+        bool compare_exchange( T expected, T desired )
+        {
+            return value_.compare_exchange_strong( expected, desired );
+        }
+
+    private:
+        std::atomic< T > value_;
+    };
+#else
+    template < typename T, class Lock >
+    class atomic_word
+    {
+    public:
+        atomic_word() = default;
+
+        explicit atomic_word( T value ) : value_( value ) {}
+
+        T load() const
+        {
+            const T result = value_;
+            std::atomic_signal_fence( std::memory_order_seq_cst );
+
+            return result;
+        }
+
+        void store( T value )
+        {
+            std::atomic_signal_fence( std::memory_order_seq_cst );
+            value_ = value;
+        }
+
+        T fetch_or( T bits )
+        {
+            Lock lock;
+            const T result = value_;
+            value_ = result | bits;
+
+            return result;
+        }
+
+        T fetch_and( T bits )
+        {
+            Lock lock;
+            const T result = value_;
+            value_ = result & bits;
+
+            return result;
+        }
+
+        bool compare_exchange( T expected, T desired )
+        {
+            Lock lock;
+            const bool result = value_ == expected;
+
+            if ( result )
+                value_ = desired;
+
+            return result;
+        }
+
+    private:
+        volatile T value_;
+    };
+#endif
+}
+}
+
+#endif
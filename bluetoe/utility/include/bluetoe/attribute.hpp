@@ -28,6 +28,7 @@ namespace details {
         request_not_supported           = 0x06,
         insufficient_encryption         = 0x0f,
         insufficient_authentication     = 0x05,
+        value_not_allowed               = 0x13,
 
         // returned when access type is compare_128bit_uuid and the attribute contains a 128bit uuid and
         // the buffer in attribute_access_arguments is equal to the contained uuid.
@@ -2,6 +2,7 @@
 #define BLUETOE_BITS_HPP
 
 #include <cstdint>
+#include <cassert>
 
 namespace bluetoe {
 namespace details {
@@ -61,6 +62,24 @@ namespace details {
         return out + 1;
     }
 
+    /*
+     * index of the least significant bit set in a none zero word
+     */
+    inline unsigned lowest_bit_set( std::uint32_t word )
+    {
+        assert( word != 0 );
+#if defined( __GNUC__ )
+        return static_cast< unsigned >( __builtin_ctz( word ) );
+#else
+        unsigned result = 0;
+
+        for ( ; ( word & 1 ) == 0; word >>= 1 )
+            ++result;
+
+        return result;
+#endif
+    }
+
 }
 }
 #endif
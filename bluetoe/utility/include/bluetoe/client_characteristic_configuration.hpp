@@ -4,6 +4,7 @@
 #include <cassert>
 #include <cstdint>
 #include <algorithm>
+#include <iterator>
 
 namespace bluetoe {
 namespace details {
@@ -19,12 +20,14 @@ namespace details {
         constexpr client_characteristic_configuration()
             : data_( nullptr )
             , size_( 0 )
+            , features_( nullptr )
         {
         }
 
-        constexpr explicit client_characteristic_configuration( std::uint8_t* data, std::size_t s )
+        constexpr explicit client_characteristic_configuration( std::uint8_t* data, std::size_t s, std::uint8_t* features = nullptr )
             : data_( data )
             , size_( s )
+            , features_( features )
         {
         }
 
@@ -45,6 +48,31 @@ namespace details {
             data_[ index / 4 ] = ( data_[ index / 4 ] & ~mask( index ) ) | ( ( new_flags & 0x03 ) << shift( index ) );
         }
 
+        /**
+         * @brief the value of the Client Supported Features characteristic, written by the client
+         *
+         * Returns 0, if there is no storage for the features.
+         */
+        std::uint8_t client_supported_features() const
+        {
+            return features_ ? *features_ : 0;
+        }
+
+        void client_supported_features( std::uint8_t features )
+        {
+            assert( features_ );
+
+            *features_ = features;
+        }
+
+        /**
+         * @brief returns true, if there is storage for the value of the Client Supported Features characteristic
+         */
+        bool has_client_supported_features() const
+        {
+            return features_ != nullptr;
+        }
+
         static constexpr std::size_t bits_per_config = 2;
 
     private:
@@ -62,15 +90,63 @@ namespace details {
 
         // this member is purly for debugging and can be removed
         std::size_t     size_;
+
+        std::uint8_t*   features_;
+    };
+
+    /*
+     * storage for the value of the Client Supported Features characteristic; the value is only stored, if the
+     * server contains that characteristic
+     */
+    template < bool ClientSupportedFeatures >
+    class client_supported_features_storage
+    {
+    public:
+        std::uint8_t client_supported_features() const
+        {
+            return 0;
+        }
+
+    protected:
+        std::uint8_t* client_supported_features_storage_ptr()
+        {
+            return nullptr;
+        }
+    };
+
+    template <>
+    class client_supported_features_storage< true >
+    {
+    public:
+        client_supported_features_storage()
+            : features_( 0 )
+        {
+        }
+
+        std::uint8_t client_supported_features() const
+        {
+            return features_;
+        }
+
+    protected:
+        std::uint8_t* client_supported_features_storage_ptr()
+        {
+            return &features_;
+        }
+
+    private:
+        std::uint8_t features_;
     };
 
     /**
      * Store for configuration and state informations for characteristics that need such informations to be
      * stored among the connection. Such characteristics are characteristics with notification or indication
      * beeing enabled.
+     *
+     * If ClientSupportedFeatures is true, the value of the Client Supported Features characteristic is stored too.
      */
-    template < std::size_t Size >
-    class client_characteristic_configurations
+    template < std::size_t Size, bool ClientSupportedFeatures = false >
+    class client_characteristic_configurations : public client_supported_features_storage< ClientSupportedFeatures >
     {
     public:
         /**
@@ -86,20 +162,22 @@ namespace details {
 
         client_characteristic_configuration client_configurations()
         {
-            return client_characteristic_configuration( &configs_[ 0 ], Size );
+            return client_characteristic_configuration( &configs_[ 0 ], Size, this->client_supported_features_storage_ptr() );
         };
 
     private:
         std::uint8_t configs_[ ( Size * client_characteristic_configuration::bits_per_config + 7 ) / 8 ];
     };
 
-    template <>
-    class client_characteristic_configurations< 0 >
+    template < bool ClientSupportedFeatures >
+    class client_characteristic_configurations< 0, ClientSupportedFeatures > : public client_supported_features_storage< ClientSupportedFeatures >
     {
     public:
+        static constexpr std::size_t number_of_characteristics_with_configuration = 0;
+
         client_characteristic_configuration client_configurations()
         {
-            return client_characteristic_configuration();
+            return client_characteristic_configuration( nullptr, 0, this->client_supported_features_storage_ptr() );
         }
     };
 
@@ -32,6 +32,9 @@ namespace details {
         prepare_write_response      = 0x17,
         execute_write_request       = 0x18,
         execute_write_response      = 0x19,
+        read_multiple_variable_length_request  = 0x20,
+        read_multiple_variable_length_response = 0x21,
+        multiple_handle_value_notification     = 0x23,
         write_command               = 0x52,
         notification                = 0x1B,
         indication                  = 0x1D,
@@ -44,6 +47,9 @@ namespace details {
         return static_cast< std::uint8_t >( c );
     }
 
+    // bit in the opcode, that marks an ATT command (that is not answered by the server)
+    static constexpr std::uint8_t att_command_flag = 0x40;
+
     enum class att_error_codes : std::uint8_t {
         invalid_handle                      = 0x01,
         read_not_permitted,
@@ -61,7 +67,9 @@ namespace details {
         unlikely_error,
         insufficient_encryption,
         unsupported_group_type,
-        insufficient_resources
+        insufficient_resources,
+        database_out_of_sync,
+        value_not_allowed
     };
 
     constexpr std::uint8_t bits( att_error_codes c )
@@ -84,8 +92,12 @@ namespace details {
         secondary_service                   = 0x2801,
         include                             = 0x2802,
         characteristic                      = 0x2803,
+        characteristic_extended_properties  = 0x2900,
         characteristic_user_description     = 0x2901,
         client_characteristic_configuration = 0x2902,
+        server_characteristic_configuration = 0x2903,
+        characteristic_presentation_format  = 0x2904,
+        characteristic_aggregate_format     = 0x2905,
 
         internal_128bit_uuid    = 1
     };
@@ -88,28 +88,29 @@ BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE( more_than_one_characteristics )
 
-BOOST_FIXTURE_TEST_CASE( as_long_as_mtu_size_is_large_enough_all_16bit_uuids_will_be_served, test::request_with_reponse< test::three_apes_service > )
+/*
+ * the client continues behind the last reported handle; the response must end in front of the first 128 bit UUID
+ */
+BOOST_FIXTURE_TEST_CASE( response_ends_in_front_of_the_first_128bit_uuid, test::request_with_reponse< test::three_apes_service > )
 {
     l2cap_input( request_all_attributes );
 
     expected_result({
         0x05, 0x01,             // response opcode and format
         0x01, 0x00, 0x00, 0x28, // service definition
-        0x02, 0x00, 0x03, 0x28, // Characteristic Declaration
-        0x04, 0x00, 0x03, 0x28,
-        0x06, 0x00, 0x03, 0x28
+        0x02, 0x00, 0x03, 0x28  // Characteristic Declaration
     });
 }
 
 BOOST_FIXTURE_TEST_CASE( response_includes_the_starting_and_ending_handle, test::request_with_reponse< test::three_apes_service > )
 {
-    const std::uint8_t request[] = { 0x04, 0x02, 0x00, 0x04, 0x00 };
+    const std::uint8_t request[] = { 0x04, 0x01, 0x00, 0x02, 0x00 };
     l2cap_input( request );
 
     expected_result({
         0x05, 0x01,
-        0x02, 0x00, 0x03, 0x28,
-        0x04, 0x00, 0x03, 0x28
+        0x01, 0x00, 0x00, 0x28,
+        0x02, 0x00, 0x03, 0x28
     });
 }
 
@@ -126,16 +127,21 @@ BOOST_FIXTURE_TEST_CASE( response_will_contain_only_128bit_uuids_if_the_first_on
         0xAA, 0x3C, 0xC7, 0x5B,
         0xED, 0x4E, 0x8A, 0xA2,
         0x9F, 0x49, 0xE2, 0x0D,
-        0x94, 0x40, 0x8B, 0x8C,
+        0x94, 0x40, 0x8B, 0x8C
+    });
+}
+
+BOOST_FIXTURE_TEST_CASE( client_continues_behind_the_16bit_uuid, request_with_reponse_three_apes_service_56 )
+{
+    const std::uint8_t request[] = { 0x04, 0x05, 0x00, 0xff, 0xff };
+    l2cap_input( request );
+
+    expected_result({
+        0x05, 0x02,
         0x05, 0x00,
         0xAB, 0x3C, 0xC7, 0x5B,
         0xED, 0x4E, 0x8A, 0xA2,
         0x9F, 0x49, 0xE2, 0x0D,
-        0x94, 0x40, 0x8B, 0x8C,
-        0x07, 0x00,
-        0xAC, 0x3C, 0xC7, 0x5B,
-        0xED, 0x4E, 0x8A, 0xA2,
-        0x9F, 0x49, 0xE2, 0x0D,
         0x94, 0x40, 0x8B, 0x8C
     });
 }
@@ -152,11 +158,6 @@ BOOST_FIXTURE_TEST_CASE( response_will_contain_one_whole_tuples, request_with_re
         0xAA, 0x3C, 0xC7, 0x5B,
         0xED, 0x4E, 0x8A, 0xA2,
         0x9F, 0x49, 0xE2, 0x0D,
-        0x94, 0x40, 0x8B, 0x8C,
-        0x05, 0x00,
-        0xAB, 0x3C, 0xC7, 0x5B,
-        0xED, 0x4E, 0x8A, 0xA2,
-        0x9F, 0x49, 0xE2, 0x0D,
         0x94, 0x40, 0x8B, 0x8C
     });
 }
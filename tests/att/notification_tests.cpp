@@ -71,6 +71,22 @@ BOOST_AUTO_TEST_SUITE( notifications_by_value )
         } );
     }
 
+    BOOST_FIXTURE_TEST_CASE( notification_data_is_not_truncated_on_request, test::request_with_reponse< large_value_notify_server > )
+    {
+        l2cap_input( { 0x12, 0x04, 0x00, 0x01, 0x00 } );
+        expected_result( { 0x13 } );
+
+        std::uint8_t buffer[ 3 + sizeof( large_buffer ) ];
+        std::size_t  size = sizeof( buffer ) - 1;
+
+        notification_output( &buffer[ 0 ], size, connection, find_notification_data( &large_buffer ), false );
+        BOOST_CHECK_EQUAL( size, 0u );
+
+        size = sizeof( buffer );
+        notification_output( &buffer[ 0 ], size, connection, find_notification_data( &large_buffer ), false );
+        BOOST_CHECK_EQUAL( size, sizeof( buffer ) );
+    }
+
     std::uint8_t value_a1 = 1;
     std::uint8_t value_a2 = 2;
     std::uint8_t value_b1 = 3;
@@ -146,6 +162,109 @@ BOOST_AUTO_TEST_SUITE( notifications_by_value )
     }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE( multiple_handle_value_notifications )
+
+    // the Client Supported Features are only stored, if the server contains the characteristic
+    template < typename Server >
+    struct with_robust_caching;
+
+    template < typename ... Options >
+    struct with_robust_caching< bluetoe::server< Options... > >
+    {
+        using type = bluetoe::server< Options..., bluetoe::robust_caching >;
+    };
+
+    struct multiple_notifications_enabled : test::request_with_reponse< with_robust_caching< notifications_by_value::server_with_multiple_char >::type >
+    {
+        multiple_notifications_enabled()
+            : pdu_size( 0 )
+        {
+            // enable notifications for a1, b1 and c1
+            l2cap_input( { 0x12, 0x04, 0x00, 0x01, 0x00 } );
+            l2cap_input( { 0x12, 0x0B, 0x00, 0x01, 0x00 } );
+            l2cap_input( { 0x12, 0x0F, 0x00, 0x01, 0x00 } );
+
+            connection.client_configurations().client_supported_features( 0x04 );
+        }
+
+        bool add( std::size_t index, std::size_t out_size = 23 )
+        {
+            return multiple_notification_output( &buffer[ 0 ], pdu_size, out_size, connection, index );
+        }
+
+        void expected_pdu( const std::initializer_list< std::uint8_t >& expected )
+        {
+            BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), &buffer[ 0 ], &buffer[ pdu_size ] );
+        }
+
+        std::uint8_t    buffer[ 50 ];
+        std::size_t     pdu_size;
+    };
+
+    BOOST_FIXTURE_TEST_CASE( two_values, multiple_notifications_enabled )
+    {
+        BOOST_CHECK( add( 0 ) );
+        BOOST_CHECK( add( 2 ) );
+
+        expected_pdu( {
+            0x23,
+            0x03, 0x00, 0x01, 0x00, 0x01,
+            0x0A, 0x00, 0x01, 0x00, 0x03
+        } );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( requires_client_supported_feature, multiple_notifications_enabled )
+    {
+        connection_data other_connection( 23 );
+        l2cap_input( { 0x12, 0x04, 0x00, 0x01, 0x00 }, other_connection );
+
+        BOOST_CHECK( !multiple_notification_output( &buffer[ 0 ], pdu_size, 23, other_connection, 0 ) );
+        BOOST_CHECK_EQUAL( pdu_size, 0u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( requires_notifications_to_be_enabled, multiple_notifications_enabled )
+    {
+        BOOST_CHECK( add( 0 ) );
+        BOOST_CHECK( !add( 1 ) );
+
+        expected_pdu( { 0x23, 0x03, 0x00, 0x01, 0x00, 0x01 } );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( values_that_do_not_fit_are_not_added, multiple_notifications_enabled )
+    {
+        BOOST_CHECK( add( 0, 10 ) );
+        BOOST_CHECK( !add( 2, 10 ) );
+
+        expected_pdu( { 0x23, 0x03, 0x00, 0x01, 0x00, 0x01 } );
+
+        BOOST_CHECK( add( 2, 11 ) );
+        BOOST_CHECK_EQUAL( pdu_size, 11u );
+    }
+
+    struct large_value_fixture : test::request_with_reponse< with_robust_caching< notifications_by_value::large_value_notify_server >::type >
+    {
+        large_value_fixture()
+            : pdu_size( 0 )
+        {
+            l2cap_input( { 0x12, 0x04, 0x00, 0x01, 0x00 } );
+            connection.client_configurations().client_supported_features( 0x04 );
+        }
+
+        std::uint8_t    buffer[ 50 ];
+        std::size_t     pdu_size;
+    };
+
+    BOOST_FIXTURE_TEST_CASE( values_are_not_truncated, large_value_fixture )
+    {
+        BOOST_CHECK( !multiple_notification_output( &buffer[ 0 ], pdu_size, 1 + 4 + sizeof( notifications_by_value::large_buffer ) - 1, connection, 0 ) );
+        BOOST_CHECK_EQUAL( pdu_size, 0u );
+
+        BOOST_CHECK( multiple_notification_output( &buffer[ 0 ], pdu_size, 1 + 4 + sizeof( notifications_by_value::large_buffer ), connection, 0 ) );
+        BOOST_CHECK_EQUAL( pdu_size, 1 + 4 + sizeof( notifications_by_value::large_buffer ) );
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE( notifications_by_uuid )
 
     static const std::uint16_t value1 = 0x1111;
@@ -0,0 +1,219 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+#include <boost/mpl/list.hpp>
+
+#include "test_servers.hpp"
+
+namespace {
+    std::uint8_t value1 = 1;
+    std::uint16_t value2 = 2;
+    std::uint32_t value3 = 3;
+
+    char name[] = "Name";
+
+    /*
+     * a mix of 16 and 128 bit UUIDs, descriptors and a secondary service
+     */
+    template < typename ... Options >
+    using mixed_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0101 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value1 >
+            >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CA9 >,
+                bluetoe::bind_characteristic_value< std::uint16_t, &value2 >,
+                bluetoe::characteristic_name< name >,
+                bluetoe::notify
+            >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0103 >,
+                bluetoe::bind_characteristic_value< std::uint32_t, &value3 >,
+                bluetoe::indicate
+            >
+        >,
+        bluetoe::secondary_service<
+            bluetoe::service_uuid16< 0x1235 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0104 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value1 >
+            >
+        >,
+        bluetoe::service<
+            bluetoe::service_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CB0 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CB1 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value1 >,
+                bluetoe::no_write_access
+            >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0105 >,
+                bluetoe::bind_characteristic_value< std::uint16_t, &value2 >,
+                bluetoe::no_read_access
+            >
+        >,
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1236 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0106 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value1 >,
+                bluetoe::characteristic_name< name >
+            >
+        >,
+        Options...
+    >;
+
+    template < typename ... Options >
+    using temperature_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CA9 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CAA >,
+                bluetoe::bind_characteristic_value< std::uint16_t, &value2 >,
+                bluetoe::no_write_access
+            >
+        >,
+        Options...
+    >;
+
+    template < template < typename ... > class Server >
+    struct servers
+    {
+        using runtime     = Server<>;
+        using precomputed = Server< bluetoe::precomputed_discovery_responses >;
+    };
+
+    template < class Server >
+    std::vector< std::uint8_t > response( const std::vector< std::uint8_t >& request, std::size_t mtu )
+    {
+        Server                              server;
+        typename Server::connection_data    connection( mtu );
+        connection.client_mtu( mtu );
+
+        std::vector< std::uint8_t > output( mtu );
+        std::size_t                 out_size = mtu;
+
+        server.l2cap_input( request.data(), request.size(), output.data(), out_size, connection );
+        output.resize( out_size );
+
+        return output;
+    }
+
+    template < class Servers >
+    void compare_all_ranges( const std::vector< std::uint8_t >& request_prefix, std::uint16_t max_handle, std::size_t mtu )
+    {
+        for ( std::uint16_t start = 0; start <= max_handle + 1; ++start )
+        {
+            for ( std::uint16_t end = start; end <= max_handle + 1; ++end )
+            {
+                for ( const std::uint16_t ending_handle : { end, std::uint16_t( 0xffff ) } )
+                {
+                    std::vector< std::uint8_t > request = { request_prefix[ 0 ],
+                        std::uint8_t( start & 0xff ), std::uint8_t( start >> 8 ),
+                        std::uint8_t( ending_handle & 0xff ), std::uint8_t( ending_handle >> 8 ) };
+
+                    request.insert( request.end(), request_prefix.begin() + 1, request_prefix.end() );
+
+                    const auto expected = response< typename Servers::runtime >( request, mtu );
+                    const auto result   = response< typename Servers::precomputed >( request, mtu );
+
+                    BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), result.begin(), result.end() );
+                }
+            }
+        }
+    }
+
+    using all_servers = boost::mpl::list<
+        servers< mixed_server >,
+        servers< temperature_server >
+    >;
+
+    const std::size_t mtus[] = { 23, 24, 27, 50, 100, 255 };
+
+    template < class Servers >
+    std::uint16_t number_of_handles()
+    {
+        std::uint16_t handle = 1;
+
+        // find the first handle, that results in an error
+        while ( response< typename Servers::runtime >( { 0x04, std::uint8_t( handle & 0xff ), std::uint8_t( handle >> 8 ), 0xff, 0xff }, 23 )[ 0 ] == 0x05 )
+            ++handle;
+
+        return handle - 1;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( equal_to_runtime_responses )
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( find_information, Servers, all_servers )
+{
+    for ( const auto mtu : mtus )
+        compare_all_ranges< Servers >( { 0x04 }, number_of_handles< Servers >(), mtu );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( discover_all_characteristics, Servers, all_servers )
+{
+    for ( const auto mtu : mtus )
+        compare_all_ranges< Servers >( { 0x08, 0x03, 0x28 }, number_of_handles< Servers >(), mtu );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( discover_all_primary_services, Servers, all_servers )
+{
+    for ( const auto mtu : mtus )
+        compare_all_ranges< Servers >( { 0x10, 0x00, 0x28 }, number_of_handles< Servers >(), mtu );
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( other_group_types_are_not_affected, Servers, all_servers )
+{
+    compare_all_ranges< Servers >( { 0x10, 0x01, 0x28 }, number_of_handles< Servers >(), 23 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( precomputed_responses )
+
+using precomputed_mixed_server = test::request_with_reponse< mixed_server< bluetoe::precomputed_discovery_responses > >;
+
+BOOST_FIXTURE_TEST_CASE( secondary_services_are_not_reported, precomputed_mixed_server )
+{
+    // the secondary service spans the handles 0x0B - 0x0D
+    BOOST_CHECK( check_error_response( { 0x10, 0x0B, 0x00, 0x0D, 0x00, 0x00, 0x28 }, 0x10, 0x000B, 0x0A ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( response_ends_in_front_of_a_record_of_the_other_uuid_size, precomputed_mixed_server )
+{
+    // the 128 bit characteristic declaration at handle 4 must not be skipped
+    l2cap_input( { 0x08, 0x01, 0x00, 0xff, 0xff, 0x03, 0x28 } );
+    expected_result( {
+        0x09, 0x07,
+        0x02, 0x00, 0x0A, 0x03, 0x00, 0x01, 0x01
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_continues_behind_the_record_of_the_other_uuid_size, precomputed_mixed_server )
+{
+    l2cap_input( { 0x08, 0x05, 0x00, 0xff, 0xff, 0x03, 0x28 } );
+    expected_result( {
+        0x09, 0x07,
+        0x08, 0x00, 0x2A, 0x09, 0x00, 0x03, 0x01,
+        0x0C, 0x00, 0x0A, 0x0D, 0x00, 0x04, 0x01
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( find_information_128bit, precomputed_mixed_server )
+{
+    l2cap_input( { 0x04, 0x05, 0x00, 0x05, 0x00 } );
+    expected_result( {
+        0x05, 0x02,
+        0x05, 0x00, 0xA9, 0x3C, 0xC7, 0x5B, 0xED, 0x4E, 0x8A, 0xA2, 0x9F, 0x49, 0xE2, 0x0D, 0x94, 0x40, 0x8B, 0x8C
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( out_of_range_results_in_an_error, precomputed_mixed_server )
+{
+    BOOST_CHECK( check_error_response( { 0x04, 0x40, 0x00, 0xff, 0xff }, 0x04, 0x0040, 0x0A ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -128,7 +128,10 @@ typedef bluetoe::server<
 
 typedef test::request_with_reponse< server_with_16bit_characteristics_in_the_middle, 100 > server_with_16bit_characteristics_in_the_middle_100;
 
-BOOST_FIXTURE_TEST_CASE( different_attribute_data_size_with_gap, server_with_16bit_characteristics_in_the_middle_100 )
+/*
+ * the client continues behind the last reported service; the response must end in front of the service with the 16 bit UUID
+ */
+BOOST_FIXTURE_TEST_CASE( different_attribute_data_size_ends_the_response, server_with_16bit_characteristics_in_the_middle_100 )
 {
     l2cap_input( { 0x10, 0x01, 0x00, 0xff, 0xff, 0x00, 0x28 } );
 
@@ -138,12 +141,7 @@ BOOST_FIXTURE_TEST_CASE( different_attribute_data_size_with_gap, server_with_16b
         0x2A, 0xD9, 0x91, 0x11,     // service_uuid global_temperature_service
         0xAB, 0x5B, 0x58, 0xB0,
         0x3B, 0x4F, 0x50, 0x44,
-        0x52, 0x6E, 0x42, 0xF0,
-        0x09, 0x00, 0x0F, 0x00,     // handle 0x0004 - 0x000A
-        0xA9, 0x3C, 0xC7, 0x5B,
-        0xED, 0x4E, 0x8A, 0xA2,
-        0x9F, 0x49, 0xE2, 0x0D,
-        0x94, 0x40, 0x8B, 0x8C
+        0x52, 0x6E, 0x42, 0xF0
     };
 
     BOOST_CHECK_EQUAL_COLLECTIONS( &response[ 0 ], &response[ response_size ], std::begin( expected_result ), std::end( expected_result ) );
@@ -183,6 +183,9 @@ typedef bluetoe::server<
 
 typedef test::request_with_reponse< server_with_16bit_uuid_in_the_middle, 200 > r_and_r_with_server_with_16bit_uuid_in_the_middle_100;
 
+/*
+ * the client continues behind the last reported handle; the response must end in front of the declaration with the 16 bit UUID
+ */
 BOOST_FIXTURE_TEST_CASE( read_multiple_attributes_within_mixed_size, r_and_r_with_server_with_16bit_uuid_in_the_middle_100 )
 {
     l2cap_input( { 0x08, 0x01, 0x00, 0xff, 0xff, 0x03, 0x28 } );
@@ -195,7 +198,18 @@ BOOST_FIXTURE_TEST_CASE( read_multiple_attributes_within_mixed_size, r_and_r_wit
         0xAA, 0x3C, 0xC7, 0x5B,     // Characteristic UUID
         0xED, 0x4E, 0x8A, 0xA2,
         0x9F, 0x49, 0xE2, 0x0D,
-        0x94, 0x40, 0x8B, 0x8C,
+        0x94, 0x40, 0x8B, 0x8C
+    };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( &response[ 0 ], &response[ response_size ], std::begin( expected_result ), std::end( expected_result ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( read_attributes_behind_a_different_size, r_and_r_with_server_with_16bit_uuid_in_the_middle_100 )
+{
+    l2cap_input( { 0x08, 0x05, 0x00, 0xff, 0xff, 0x03, 0x28 } );
+
+    static const std::uint8_t expected_result[] = {
+        0x09, 0x15,                 // response code, size = 2 for handle and 19 for attribute value (Properties, Value Handle + UUID)
         0x06, 0x00,                 // attribute handle
         0x0A,                       // Characteristic Properties (read + write)
         0x07, 0x00,                 // Characteristic Value Handle
@@ -0,0 +1,171 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include "test_servers.hpp"
+
+BOOST_AUTO_TEST_SUITE( read_multiple_variable_length_errors )
+
+BOOST_FIXTURE_TEST_CASE( pdu_to_small, test::small_temperature_service_with_response<> )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x02, 0x00 }, 0x20, 0x0000, 0x04 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( pdu_half_an_handle, test::small_temperature_service_with_response<> )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x02, 0x00, 0x03, 0x00, 0x04 }, 0x20, 0x0000, 0x04 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( the_first_handle_is_invalid, test::small_temperature_service_with_response<> )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x00, 0x00, 0x03, 0x00, 0x04, 0x00 }, 0x20, 0x0000, 0x01 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( the_second_handle_is_invalid, test::small_temperature_service_with_response<> )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x02, 0x00, 0x00, 0x00, 0x04, 0x00 }, 0x20, 0x0000, 0x01 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( the_first_handle_is_unknown, test::small_temperature_service_with_response<> )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x02, 0x80, 0x03, 0x00, 0x04, 0x00 }, 0x20, 0x8002, 0x0A ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( the_second_handle_is_unknown, test::small_temperature_service_with_response<> )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x02, 0x00, 0x03, 0x00, 0xf4, 0xff }, 0x20, 0xfff4, 0x0A ) );
+}
+
+typedef bluetoe::server<
+    bluetoe::service<
+        bluetoe::service_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CA9 >,
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid< 0x8C8B4094, 0x0DE2, 0x499F, 0xA28A, 0x4EED5BC73CAA >,
+            bluetoe::bind_characteristic_value< decltype( test::temperature_value ), &test::temperature_value >,
+            bluetoe::no_read_access
+        >
+    >
+> unreadable_server;
+
+BOOST_FIXTURE_TEST_CASE( first_attribute_not_readable, test::request_with_reponse< unreadable_server > )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x03, 0x00, 0x02, 0x00 }, 0x20, 0x0003, 0x02 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( last_attribute_not_readable, test::request_with_reponse< unreadable_server > )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x02, 0x00, 0x03, 0x00 }, 0x20, 0x0003, 0x02 ) );
+}
+
+// even if there is no room left in the response, all attributes have to be readable
+BOOST_FIXTURE_TEST_CASE( attribute_not_readable_after_the_response_is_full, test::request_with_reponse< unreadable_server > )
+{
+    BOOST_CHECK( check_error_response( { 0x20, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00 }, 0x20, 0x0003, 0x02 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( read_multiple_variable_length )
+
+BOOST_FIXTURE_TEST_CASE( read_two_attributes, test::small_temperature_service_with_response< 100 > )
+{
+    l2cap_input( { 0x20, 0x02, 0x00, 0x03, 0x00 } );
+
+    expected_result( {
+        0x21,                                           // opcode
+        0x13, 0x00,                                     // length
+        0x02, 0x03, 0x00,                               // Characteristic Declaration
+        0xAA, 0x3C, 0xC7, 0x5B, 0xED, 0x4E, 0x8A, 0xA2,
+        0x9F, 0x49, 0xE2, 0x0D, 0x94, 0x40, 0x8B, 0x8C,
+        0x02, 0x00,                                     // length
+        0x04, 0x01                                      // Characteristic Value Declaration
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( read_the_same_attribute_twice, test::small_temperature_service_with_response<> )
+{
+    l2cap_input( { 0x20, 0x03, 0x00, 0x03, 0x00 } );
+
+    expected_result( {
+        0x21,                                           // opcode
+        0x02, 0x00, 0x04, 0x01,
+        0x02, 0x00, 0x04, 0x01
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( last_value_clipped_at_the_mtu, test::small_temperature_service_with_response<> )
+{
+    l2cap_input( { 0x20, 0x03, 0x00, 0x02, 0x00 } );
+
+    expected_result( {
+        0x21,                                           // opcode
+        0x02, 0x00,                                     // length
+        0x04, 0x01,                                     // Characteristic Value Declaration
+        0x13, 0x00,                                     // length of the whole value
+        0x02, 0x03, 0x00,                               // Characteristic Declaration, clipped at the mtu of 23
+        0xAA, 0x3C, 0xC7, 0x5B, 0xED, 0x4E, 0x8A, 0xA2,
+        0x9F, 0x49, 0xE2, 0x0D, 0x94
+    } );
+}
+
+// if there is no room for the whole length of the next tuple, the length is clipped too
+BOOST_FIXTURE_TEST_CASE( length_of_the_last_tuple_clipped_at_the_mtu, test::small_temperature_service_with_response<> )
+{
+    l2cap_input( { 0x20, 0x02, 0x00, 0x03, 0x00, 0x01, 0x00 } );
+
+    expected_result( {
+        0x21,                                           // opcode
+        0x13, 0x00,                                     // length
+        0x02, 0x03, 0x00,                               // Characteristic Declaration
+        0xAA, 0x3C, 0xC7, 0x5B, 0xED, 0x4E, 0x8A, 0xA2,
+        0x9F, 0x49, 0xE2, 0x0D, 0x94, 0x40, 0x8B, 0x8C,
+        0x02                                            // first byte of the length of the Characteristic Value
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( larger_mtu_results_in_less_clipping, test::small_temperature_service_with_response< 30 > )
+{
+    l2cap_input( { 0x20, 0x03, 0x00, 0x02, 0x00, 0x01, 0x00 } );
+
+    expected_result( {
+        0x21,                                           // opcode
+        0x02, 0x00,                                     // length
+        0x04, 0x01,                                     // Characteristic Value Declaration
+        0x13, 0x00,                                     // length
+        0x02, 0x03, 0x00,                               // Characteristic Declaration
+        0xAA, 0x3C, 0xC7, 0x5B, 0xED, 0x4E, 0x8A, 0xA2,
+        0x9F, 0x49, 0xE2, 0x0D, 0x94, 0x40, 0x8B, 0x8C,
+        0x10, 0x00,                                     // length of the whole value
+        0xA9, 0x3C                                      // Primary Service, clipped at the mtu of 30
+    } );
+}
+
+std::uint8_t endless_value_handler( std::size_t, std::size_t read_size, std::uint8_t* out_buffer, std::size_t& out_size )
+{
+    std::fill( out_buffer, out_buffer + read_size, 0x42 );
+    out_size = read_size;
+
+    return bluetoe::error_codes::success;
+}
+
+typedef bluetoe::server<
+    bluetoe::service<
+        bluetoe::service_uuid16< 0x8C8B >,
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x8C8C >,
+            bluetoe::free_read_blob_handler< &endless_value_handler >
+        >
+    >
+> offset_ignoring_server;
+
+// a handler, that ignores the offset, fills every buffer; the reported length ends at the maximum attribute length
+BOOST_FIXTURE_TEST_CASE( length_of_an_endless_value_is_limited, test::request_with_reponse< offset_ignoring_server > )
+{
+    l2cap_input( { 0x20, 0x03, 0x00, 0x03, 0x00 } );
+
+    BOOST_REQUIRE_EQUAL( response_size, 23u );
+    BOOST_CHECK_EQUAL( response[ 0 ], 0x21 );
+    BOOST_CHECK_EQUAL( response[ 1 ], 0x00 );
+    BOOST_CHECK_EQUAL( response[ 2 ], 0x02 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,74 @@
+/*
+ * Compares the costs of looking up an attribute by its handle in the flat attribute table of the server
+ * with the costs of looking it up by recursively descending the list of services and characteristics.
+ */
+#include <bluetoe/server.hpp>
+#include "benchmark.hpp"
+
+namespace {
+    template < std::size_t I >
+    struct value_holder {
+        static std::uint32_t value;
+    };
+
+    template < std::size_t I >
+    std::uint32_t value_holder< I >::value = 0;
+
+    template < std::size_t Service, std::size_t Characteristic, typename ... Options >
+    using benchmark_characteristic = bluetoe::characteristic<
+        bluetoe::characteristic_uuid16< 0x1000 + Service * 16 + Characteristic >,
+        bluetoe::bind_characteristic_value< std::uint32_t, &value_holder< Service * 16 + Characteristic >::value >,
+        Options...
+    >;
+
+    // 1 + 3 + 3 + 2 attributes
+    template < std::size_t Service >
+    using benchmark_service = bluetoe::service<
+        bluetoe::service_uuid16< 0x2000 + Service >,
+        benchmark_characteristic< Service, 0, bluetoe::notify >,
+        benchmark_characteristic< Service, 1, bluetoe::notify >,
+        benchmark_characteristic< Service, 2 >
+    >;
+
+    template < std::size_t N, typename ... Services >
+    struct make_server : make_server< N - 1, benchmark_service< N - 1 >, Services... > {};
+
+    template < typename ... Services >
+    struct make_server< 0, Services... >
+    {
+        using type = bluetoe::server< Services... >;
+    };
+
+    template < std::size_t NumberOfServices >
+    void lookup_benchmark()
+    {
+        using server     = typename make_server< NumberOfServices >::type;
+        using recursive  = bluetoe::details::attribute_from_service_list< typename server::services, server, typename server::cccd_indices >;
+
+        static constexpr std::size_t number_of_attributes = bluetoe::details::sum_by< typename server::services, bluetoe::details::sum_by_attributes >::value;
+        static constexpr std::size_t runs = 20000;
+
+        const double table_lookup = benchmark::measure( runs, []{
+            for ( std::size_t index = 0; index != number_of_attributes; ++index )
+                benchmark::do_not_optimize( server::attribute_at( index ) );
+        } );
+
+        const double recursive_lookup = benchmark::measure( runs, []{
+            for ( std::size_t index = 0; index != number_of_attributes; ++index )
+                benchmark::do_not_optimize( recursive::attribute_at( index ) );
+        } );
+
+        benchmark::print_row( number_of_attributes, table_lookup / number_of_attributes, recursive_lookup / number_of_attributes );
+    }
+}
+
+int main()
+{
+    benchmark::print_header( "average costs of a single attribute lookup [ns]", "attributes", "table", "recursive" );
+
+    lookup_benchmark< 1 >();
+    lookup_benchmark< 5 >();
+    lookup_benchmark< 10 >();
+    lookup_benchmark< 20 >();
+    lookup_benchmark< 40 >();
+}
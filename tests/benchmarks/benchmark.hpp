@@ -0,0 +1,51 @@
+#ifndef BLUETOE_TESTS_BENCHMARKS_BENCHMARK_HPP
+#define BLUETOE_TESTS_BENCHMARKS_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace benchmark {
+
+    /*
+     * keeps the optimizer from removing the benchmarked code
+     */
+    template < class T >
+    void do_not_optimize( const T& value )
+    {
+        asm volatile( "" : : "r" ( &value ) : "memory" );
+    }
+
+    /*
+     * calls f() runs times and returns the average duration of a single call in nano seconds
+     */
+    template < class F >
+    double measure( std::size_t runs, F f )
+    {
+        using clock = std::chrono::steady_clock;
+
+        // warm up
+        f();
+
+        const auto start = clock::now();
+
+        for ( std::size_t run = 0; run != runs; ++run )
+            f();
+
+        const auto duration = std::chrono::duration_cast< std::chrono::nanoseconds >( clock::now() - start );
+
+        return static_cast< double >( duration.count() ) / runs;
+    }
+
+    inline void print_header( const char* title, const char* column1, const char* column2, const char* column3 )
+    {
+        std::printf( "%s\n%-20s %15s %15s\n", title, column1, column2, column3 );
+    }
+
+    inline void print_row( std::size_t size, double value1, double value2 )
+    {
+        std::printf( "%-20zu %15.2f %15.2f\n", size, value1, value2 );
+    }
+}
+
+#endif
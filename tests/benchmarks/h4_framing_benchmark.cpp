@@ -0,0 +1,135 @@
+/*
+ * Measures the costs of framing a stream of received HCI ACL data packets, read from an emulated UART. The
+ * h4_framing reads as many bytes as fit directly into its ring and hands out views to complete packets. As a
+ * reference, every packet is read in three steps (indicator, header, payload) into a single packet buffer and
+ * the ACL payload is copied into an L2CAP reassembly buffer, like the HCI link layer did, before it used the
+ * h4_framing.
+ */
+#include <bluetoe/h4_framing.hpp>
+#include "benchmark.hpp"
+
+#include <vector>
+#include <algorithm>
+
+namespace {
+    static constexpr std::size_t max_packet_size = 1 + 4 + 255;
+    static constexpr std::size_t packets_per_run = 64;
+
+    // byte stream of ACL data packets with the given payload size, read in chunks of at most the requested size
+    class uart
+    {
+    public:
+        explicit uart( std::size_t payload )
+        {
+            for ( std::size_t packet = 0; packet != packets_per_run; ++packet )
+            {
+                const std::uint8_t header[] = { 0x02, 0x42, 0x20, static_cast< std::uint8_t >( payload ), 0x00 };
+                stream_.insert( stream_.end(), std::begin( header ), std::end( header ) );
+
+                for ( std::size_t i = 0; i != payload; ++i )
+                    stream_.push_back( static_cast< std::uint8_t >( i ) );
+            }
+
+            rewind();
+        }
+
+        void rewind()
+        {
+            pos_ = 0;
+        }
+
+        std::size_t read( std::uint8_t* buffer, std::size_t size )
+        {
+            size = std::min( size, stream_.size() - pos_ );
+            std::copy( &stream_[ pos_ ], &stream_[ pos_ + size ], buffer );
+            pos_ += size;
+
+            return size;
+        }
+
+    private:
+        std::vector< std::uint8_t > stream_;
+        std::size_t                 pos_;
+    };
+
+    struct copying_receiver
+    {
+        std::uint8_t packet[ max_packet_size ];
+        std::size_t  packet_size = 0;
+        std::uint8_t l2cap[ max_packet_size ];
+
+        std::size_t expected_size() const
+        {
+            if ( packet_size == 0 )
+                return 1;
+
+            return packet_size < 5 ? 5 : 5 + bluetoe::details::read_16bit( &packet[ 3 ] );
+        }
+
+        void receive( uart& input )
+        {
+            for ( std::size_t size = 1; size; )
+            {
+                size = input.read( &packet[ packet_size ], expected_size() - packet_size );
+                packet_size += size;
+
+                if ( packet_size == expected_size() && packet_size > 5 )
+                {
+                    std::copy( &packet[ 5 ], &packet[ packet_size ], l2cap );
+                    benchmark::do_not_optimize( l2cap[ 0 ] );
+                    packet_size = 0;
+                }
+            }
+        }
+    };
+
+    struct framing_receiver
+    {
+        bluetoe::hci::h4_framing< max_packet_size > framing;
+
+        void receive( uart& input )
+        {
+            for ( std::size_t size = 1; size; )
+            {
+                const auto space = framing.receive_buffer();
+                size = input.read( space.buffer, space.size );
+                framing.received( size );
+
+                for ( auto packet = framing.next_packet(); packet.size; packet = framing.next_packet() )
+                {
+                    benchmark::do_not_optimize( packet.buffer[ 5 ] );
+                    framing.pop_packet();
+                }
+            }
+        }
+    };
+
+    template < class Receiver >
+    double framing_costs( std::size_t payload )
+    {
+        static constexpr std::size_t runs = 20000;
+
+        uart     input( payload );
+        Receiver receiver;
+
+        return benchmark::measure( runs, [&]{
+            input.rewind();
+            receiver.receive( input );
+        } ) / packets_per_run;
+    }
+
+    void framing_benchmark( std::size_t payload )
+    {
+        benchmark::print_row( payload, framing_costs< copying_receiver >( payload ), framing_costs< framing_receiver >( payload ) );
+    }
+}
+
+int main()
+{
+    benchmark::print_header( "average costs of receiving an ACL data packet [ns]", "ACL payload", "copying", "h4_framing" );
+
+    framing_benchmark( 27 );
+    framing_benchmark( 64 );
+    framing_benchmark( 128 );
+    framing_benchmark( 251 );
+}
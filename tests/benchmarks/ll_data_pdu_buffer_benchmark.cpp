@@ -0,0 +1,113 @@
+/*
+ * Compares the storages of the ll_data_pdu_buffer: the default pdu_ring_storage with separate rings for
+ * transmitting and receiving and the pdu_slab_storage, where both sides share fixed size slots. Both buffers
+ * use 2 * 116 bytes of memory (8 slots of 29 bytes for the slab storage).
+ *
+ * The utilisation is the number of PDUs, that can be queued for transmission, while the peer does not
+ * acknowledge. The throughput is measured with the traffic of the ll_data_pdu_buffer_tests: a PDU is
+ * transmitted, the peer acknowledges with a PDU of the same size, which is then freed by the link layer.
+ */
+#include <bluetoe/ll_data_pdu_buffer.hpp>
+#include <bluetoe/pdu_slab_storage.hpp>
+#include "benchmark.hpp"
+
+namespace {
+    static constexpr std::size_t buffer_size = 4 * 29;
+
+    template < template < std::size_t, std::size_t, typename > class Storage >
+    struct radio : bluetoe::link_layer::ll_data_pdu_buffer< buffer_size, buffer_size, radio< Storage >, Storage >
+    {
+        struct lock_guard {
+            lock_guard() {}
+            ~lock_guard() {}
+        };
+
+        void increment_receive_packet_counter() {}
+        void increment_transmit_packet_counter() {}
+
+        radio()
+            : sequence_number( false )
+        {
+            this->reset();
+        }
+
+        bool transmit( std::size_t payload )
+        {
+            const auto pdu = this->allocate_transmit_buffer( payload + 2 );
+
+            if ( pdu.size == 0 )
+                return false;
+
+            pdu.buffer[ 0 ] = 0x02;
+            pdu.buffer[ 1 ] = static_cast< std::uint8_t >( payload );
+            this->commit_transmit_buffer( pdu );
+
+            return true;
+        }
+
+        // receives a PDU from the peer, that acknowledges the last transmitted PDU
+        void receive( std::size_t payload )
+        {
+            const auto pdu = this->allocate_receive_buffer();
+
+            pdu.buffer[ 0 ] = static_cast< std::uint8_t >( 0x02 | ( sequence_number ? 0x0c : 0x00 ) );
+            pdu.buffer[ 1 ] = static_cast< std::uint8_t >( payload );
+            sequence_number = !sequence_number;
+
+            this->received( pdu );
+        }
+
+        void exchange( std::size_t payload )
+        {
+            transmit( payload );
+            benchmark::do_not_optimize( this->next_transmit() );
+            receive( payload );
+
+            const auto pdu = this->next_received();
+            benchmark::do_not_optimize( pdu.buffer[ 2 ] );
+            this->free_received();
+        }
+
+        bool sequence_number;
+    };
+
+    using ring_radio = radio< bluetoe::link_layer::pdu_ring_storage >;
+    using slab_radio = radio< bluetoe::link_layer::pdu_slab_storage >;
+
+    template < class Radio >
+    double queued_pdus( std::size_t payload )
+    {
+        Radio buffer;
+        std::size_t pdus = 0;
+
+        while ( buffer.transmit( payload ) )
+            ++pdus;
+
+        return static_cast< double >( pdus );
+    }
+
+    template < class Radio >
+    double exchange_costs( std::size_t payload )
+    {
+        static constexpr std::size_t runs = 1000000;
+
+        Radio buffer;
+
+        return benchmark::measure( runs, [&]{
+            buffer.exchange( payload );
+        } );
+    }
+}
+
+int main()
+{
+    benchmark::print_header( "PDUs queued for transmission without acknowledgment", "LL payload", "ring", "slab" );
+
+    for ( std::size_t payload : { 1, 10, 27 } )
+        benchmark::print_row( payload, queued_pdus< ring_radio >( payload ), queued_pdus< slab_radio >( payload ) );
+
+    benchmark::print_header( "\naverage costs of transmitting, receiving and freeing a PDU [ns]", "LL payload", "ring", "slab" );
+
+    for ( std::size_t payload : { 1, 10, 27 } )
+        benchmark::print_row( payload, exchange_costs< ring_radio >( payload ), exchange_costs< slab_radio >( payload ) );
+}
@@ -0,0 +1,270 @@
+/*
+ * Measures the number of notifications, that the link layer transmits per connection event, when a number of
+ * notifications is pending. A link layer, that is limited to a single notification per connection event (the
+ * former behaviour) is compared with a link layer without such a limit.
+ */
+#include <bluetoe/link_layer.hpp>
+#include <bluetoe/server.hpp>
+#include "benchmark.hpp"
+
+#include <memory>
+#include <algorithm>
+#include <vector>
+#include <cassert>
+
+namespace {
+    template < std::size_t I >
+    struct value_holder {
+        static std::uint8_t value;
+    };
+
+    template < std::size_t I >
+    std::uint8_t value_holder< I >::value = 0;
+
+    template < std::size_t I >
+    using notified_characteristic = bluetoe::characteristic<
+        bluetoe::characteristic_uuid16< 0x1000 + I >,
+        bluetoe::bind_characteristic_value< std::uint8_t, &value_holder< I >::value >,
+        bluetoe::notify
+    >;
+
+    // the CCCD of the I-th characteristic has the handle 4 + 3 * I
+    static constexpr std::size_t number_of_characteristics = 16;
+
+    template < std::size_t N, typename ... Characteristics >
+    struct make_server : make_server< N - 1, notified_characteristic< N - 1 >, Characteristics... > {};
+
+    template < typename ... Characteristics >
+    struct make_server< 0, Characteristics... >
+    {
+        using type = bluetoe::server<
+            bluetoe::service<
+                bluetoe::service_uuid16< 0x2000 >,
+                Characteristics...
+            >
+        >;
+    };
+
+    using server = make_server< number_of_characteristics >::type;
+
+    template < std::size_t ... I >
+    struct value_table
+    {
+        static std::uint8_t* const values[ sizeof...( I ) ];
+    };
+
+    template < std::size_t ... I >
+    std::uint8_t* const value_table< I... >::values[ sizeof...( I ) ] = { &value_holder< I >::value... };
+
+    using values = value_table< 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 >;
+
+    const std::vector< std::uint8_t > connection_request_pdu =
+    {
+        0xc5, 0x22,                         // header
+        0x3c, 0x1c, 0x62, 0x92, 0xf0, 0x48, // InitA: 48:f0:92:62:1c:3c (random)
+        0x47, 0x11, 0x08, 0x15, 0x0f, 0xc0, // AdvA:  c0:0f:15:08:11:47 (random)
+        0x5a, 0xb3, 0x9a, 0xaf,             // Access Address
+        0x08, 0x81, 0xf6,                   // CRC Init
+        0x03,                               // transmit window size
+        0x0b, 0x00,                         // window offset
+        0x18, 0x00,                         // interval (30ms)
+        0x00, 0x00,                         // slave latency
+        0x48, 0x00,                         // connection timeout (720ms)
+        0xff, 0xff, 0xff, 0xff, 0x1f,       // used channel map
+        0xaa                                // hop increment and sleep clock accuracy (10 and 50ppm)
+    };
+
+    /*
+     * Minimal scheduled radio, that plays the master: the connection request is answered and every connection
+     * event is simulated by sending the given PDUs, followed by empty PDUs, as long as the link layer signals
+     * more data. The radio uses the default PDU layout, where in memory and over the air layout are equal.
+     */
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
+    class radio : public bluetoe::link_layer::ll_data_pdu_buffer< TransmitSize, ReceiveSize, radio< TransmitSize, ReceiveSize, CallBack > >
+    {
+    public:
+        radio()
+            : advertising_( false )
+            , connection_event_( false )
+            , sequence_number_( 0 )
+            , ne_sequence_number_( 0 )
+        {
+        }
+
+        void schedule_advertisment(
+            unsigned,
+            const bluetoe::link_layer::write_buffer&,
+            const bluetoe::link_layer::write_buffer&,
+            bluetoe::link_layer::delta_time,
+            const bluetoe::link_layer::read_buffer&     receive )
+        {
+            advertising_ = true;
+            receive_     = receive;
+        }
+
+        bluetoe::link_layer::delta_time schedule_connection_event(
+            unsigned,
+            bluetoe::link_layer::delta_time,
+            bluetoe::link_layer::delta_time,
+            bluetoe::link_layer::delta_time,
+            bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t,
+            bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t )
+        {
+            connection_event_ = true;
+
+            return bluetoe::link_layer::delta_time();
+        }
+
+        void set_access_address_and_crc_init( std::uint32_t, std::uint32_t ) {}
+
+        std::uint32_t static_random_address_seed() const
+        {
+            return 0x47110815;
+        }
+
+        // all radio events are simulated explicitly
+        void run() {}
+        void wake_up() {}
+
+        struct lock_guard {
+            lock_guard() {}
+            ~lock_guard() {}
+        };
+
+        static constexpr std::size_t radio_maximum_white_list_entries = 0;
+        static constexpr bool hardware_supports_encryption = false;
+        static constexpr bool hardware_supports_2mbit = false;
+        static constexpr bool hardware_supports_multiple_connections = false;
+
+        void increment_receive_packet_counter() {}
+        void increment_transmit_packet_counter() {}
+
+        void connect()
+        {
+            assert( advertising_ );
+            assert( receive_.size >= connection_request_pdu.size() );
+
+            advertising_ = false;
+            std::copy( connection_request_pdu.begin(), connection_request_pdu.end(), receive_.buffer );
+
+            static_cast< CallBack* >( this )->adv_received(
+                bluetoe::link_layer::read_buffer{ receive_.buffer, connection_request_pdu.size() } );
+        }
+
+        // simulates a connection event and returns the number of notifications, that where transmitted
+        std::size_t connection_event( std::vector< std::uint8_t > pdu = { 0x01, 0x00 } )
+        {
+            static constexpr std::uint8_t sn_flag        = 0x8;
+            static constexpr std::uint8_t nesn_flag      = 0x4;
+            static constexpr std::uint8_t more_data_flag = 0x10;
+            static constexpr std::uint8_t att_notification = 0x1B;
+
+            assert( connection_event_ );
+            connection_event_ = false;
+
+            std::size_t notifications = 0;
+            bool        more_data     = false;
+
+            do
+            {
+                const auto receive = this->allocate_receive_buffer();
+                assert( receive.size >= pdu.size() );
+
+                std::copy( pdu.begin(), pdu.end(), receive.buffer );
+                receive.buffer[ 0 ] = static_cast< std::uint8_t >( ( receive.buffer[ 0 ] & ~( sn_flag | nesn_flag ) ) | sequence_number_ | ne_sequence_number_ );
+
+                sequence_number_    ^= sn_flag;
+                ne_sequence_number_ ^= nesn_flag;
+
+                const auto response = this->received( receive );
+
+                if ( ( response.buffer[ 0 ] & 0x03 ) == 0x02 && response.size > 6 && response.buffer[ 6 ] == att_notification )
+                    ++notifications;
+
+                more_data = response.buffer[ 0 ] & more_data_flag;
+                pdu       = { 0x01, 0x00 };
+            } while ( more_data );
+
+            static_cast< CallBack* >( this )->end_event();
+
+            return notifications;
+        }
+
+    private:
+        bool                                advertising_;
+        bool                                connection_event_;
+        bluetoe::link_layer::read_buffer    receive_;
+        std::uint8_t                        sequence_number_;
+        std::uint8_t                        ne_sequence_number_;
+    };
+
+    template < typename ... Options >
+    struct connection : bluetoe::link_layer::link_layer< server, radio,
+        bluetoe::link_layer::buffer_sizes< 1000u, 200u >, Options... >
+    {
+        // connects and subscribes to all characteristics
+        connection()
+        {
+            this->run( server_ );
+            this->connect();
+
+            for ( std::uint8_t handle = 4; handle != 4 + 3 * number_of_characteristics; handle += 3 )
+            {
+                this->connection_event( { 0x02, 0x09, 0x05, 0x00, 0x04, 0x00, 0x12, handle, 0x00, 0x01, 0x00 } );
+                this->run( server_ );
+            }
+
+            this->connection_event();
+            this->connection_event();
+        }
+
+        // notifies the first pending characteristics and returns the average number of notifications per connection event
+        double notifications_per_event( std::size_t pending )
+        {
+            for ( std::size_t index = 0; index != pending; ++index )
+                server_.notify( *values::values[ index ] );
+
+            std::size_t notifications = 0;
+            std::size_t events        = 0;
+
+            while ( notifications != pending )
+            {
+                this->run( server_ );
+
+                const std::size_t count = this->connection_event();
+
+                if ( count )
+                {
+                    notifications += count;
+                    ++events;
+                }
+            }
+
+            return static_cast< double >( notifications ) / events;
+        }
+
+        server server_;
+    };
+
+    void burst_benchmark( std::size_t pending )
+    {
+        std::unique_ptr< connection< bluetoe::link_layer::max_notifications_per_event< 1 > > > single( new connection< bluetoe::link_layer::max_notifications_per_event< 1 > > );
+        std::unique_ptr< connection<> > burst( new connection<> );
+
+        const double single_rate = single->notifications_per_event( pending );
+        const double burst_rate  = burst->notifications_per_event( pending );
+
+        benchmark::print_row( pending, single_rate, burst_rate );
+    }
+}
+
+int main()
+{
+    benchmark::print_header( "average number of notifications per connection event", "pending", "one per event", "burst" );
+
+    burst_benchmark( 1 );
+    burst_benchmark( 2 );
+    burst_benchmark( 4 );
+    burst_benchmark( 8 );
+    burst_benchmark( 16 );
+}
@@ -0,0 +1,55 @@
+/*
+ * Measures the costs of dequeuing an entry from the notification queue for different numbers of characteristics
+ * with notifications enabled. The costs are measured with a single pending entry, that is located just before
+ * the current round robin position (the worst case for a linear scan) and with all entries pending.
+ */
+#include <bluetoe/notification_queue.hpp>
+#include "benchmark.hpp"
+
+namespace {
+    struct empty_mixin {};
+
+    template < int Size >
+    using queue = bluetoe::link_layer::notification_queue< std::tuple< std::integral_constant< int, Size > >, empty_mixin >;
+
+    template < int Size >
+    void dequeue_benchmark()
+    {
+        static constexpr std::size_t runs = 200000;
+
+        queue< Size > single;
+        std::size_t   index = 0;
+
+        const double one_pending = benchmark::measure( runs, [&]{
+            // queue the entry, that was just served, so that the scan has to wrap around
+            single.queue_notification( index );
+            const auto entry = single.dequeue_indication_or_confirmation();
+            index = entry.second;
+
+            benchmark::do_not_optimize( entry );
+        } );
+
+        queue< Size > all;
+
+        for ( std::size_t entry = 0; entry != Size; ++entry )
+            all.queue_notification( entry );
+
+        const double all_pending = benchmark::measure( runs, [&]{
+            const auto entry = all.dequeue_indication_or_confirmation();
+            all.queue_notification( entry.second );
+
+            benchmark::do_not_optimize( entry );
+        } );
+
+        benchmark::print_row( Size, one_pending, all_pending );
+    }
+}
+
+int main()
+{
+    benchmark::print_header( "average costs of queuing and dequeuing a notification [ns]", "characteristics", "one pending", "all pending" );
+
+    dequeue_benchmark< 8 >();
+    dequeue_benchmark< 64 >();
+    dequeue_benchmark< 256 >();
+}
@@ -0,0 +1,251 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <bluetoe/h4_framing.hpp>
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+namespace {
+    using packet_t = std::vector< std::uint8_t >;
+
+    template < std::size_t Size >
+    struct framing : bluetoe::hci::h4_framing< Size >
+    {
+        // writes the given bytes in chunks of at most max_chunk into the ring; returns the number of bytes accepted
+        std::size_t feed( const packet_t& bytes, std::size_t max_chunk = 1024 )
+        {
+            std::size_t pos = 0;
+
+            while ( pos != bytes.size() )
+            {
+                const auto space = this->receive_buffer();
+                const std::size_t size = std::min( { space.size, max_chunk, bytes.size() - pos } );
+
+                if ( size == 0 )
+                    break;
+
+                std::copy( bytes.begin() + pos, bytes.begin() + pos + size, space.buffer );
+                this->received( size );
+                pos += size;
+            }
+
+            return pos;
+        }
+
+        packet_t next() const
+        {
+            const auto packet = this->next_packet();
+
+            return packet_t( packet.buffer, packet.buffer + packet.size );
+        }
+
+        packet_t pop()
+        {
+            const packet_t result = next();
+            this->pop_packet();
+
+            return result;
+        }
+    };
+
+    packet_t event( std::uint8_t code, std::size_t parameters )
+    {
+        packet_t result = { 0x04, code, static_cast< std::uint8_t >( parameters ) };
+
+        for ( std::size_t i = 0; i != parameters; ++i )
+            result.push_back( static_cast< std::uint8_t >( code + i ) );
+
+        return result;
+    }
+
+    packet_t acl_packet( std::size_t size )
+    {
+        packet_t result = { 0x02, 0x42, 0x20, static_cast< std::uint8_t >( size ), static_cast< std::uint8_t >( size >> 8 ) };
+
+        for ( std::size_t i = 0; i != size; ++i )
+            result.push_back( static_cast< std::uint8_t >( i ) );
+
+        return result;
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_by_default, framing< 64 > )
+{
+    BOOST_CHECK_EQUAL( next_packet().size, 0u );
+    BOOST_CHECK_EQUAL( receive_buffer().size, 64u );
+}
+
+BOOST_FIXTURE_TEST_CASE( frames_an_event_received_byte_by_byte, framing< 64 > )
+{
+    const packet_t command_complete = { 0x04, 0x0E, 0x04, 0x01, 0x03, 0x0C, 0x00 };
+
+    BOOST_CHECK_EQUAL( feed( command_complete, 1 ), command_complete.size() );
+
+    const packet_t packet = pop();
+    BOOST_CHECK_EQUAL_COLLECTIONS( packet.begin(), packet.end(), command_complete.begin(), command_complete.end() );
+    BOOST_CHECK_EQUAL( next_packet().size, 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( frames_packets_received_at_once, framing< 64 > )
+{
+    const packet_t first  = event( 0x0E, 4 );
+    const packet_t second = acl_packet( 8 );
+
+    packet_t stream = first;
+    stream.insert( stream.end(), second.begin(), second.end() );
+    stream.insert( stream.end(), 3, 0x02 );
+
+    // both packets and the beginning of the third packet are received with a single read
+    const auto space = receive_buffer();
+    std::copy( stream.begin(), stream.end(), space.buffer );
+    received( stream.size() );
+
+    const packet_t p1 = pop();
+    const packet_t p2 = pop();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( p1.begin(), p1.end(), first.begin(), first.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( p2.begin(), p2.end(), second.begin(), second.end() );
+    BOOST_CHECK_EQUAL( next_packet().size, 0u );
+    BOOST_CHECK_EQUAL( receive_buffer().size, 64u - stream.size() );
+}
+
+BOOST_FIXTURE_TEST_CASE( packets_are_views_into_the_ring, framing< 64 > )
+{
+    const auto start = receive_buffer().buffer;
+
+    feed( acl_packet( 10 ) );
+
+    BOOST_CHECK( next_packet().buffer == start );
+    BOOST_CHECK_EQUAL( next_packet().size, 15u );
+}
+
+BOOST_FIXTURE_TEST_CASE( stores_multiple_packets, framing< 64 > )
+{
+    const packet_t first  = event( 0x0E, 4 );
+    const packet_t second = acl_packet( 8 );
+    const packet_t third  = event( 0x13, 5 );
+
+    feed( first );
+    feed( second );
+    feed( third );
+
+    const packet_t p1 = pop();
+    const packet_t p2 = pop();
+    const packet_t p3 = pop();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( p1.begin(), p1.end(), first.begin(), first.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( p2.begin(), p2.end(), second.begin(), second.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( p3.begin(), p3.end(), third.begin(), third.end() );
+    BOOST_CHECK_EQUAL( next_packet().size, 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_packets_are_framed, framing< 64 > )
+{
+    feed( acl_packet( 0 ) );
+    feed( event( 0x0E, 0 ) );
+
+    BOOST_CHECK_EQUAL( pop().size(), 5u );
+    BOOST_CHECK_EQUAL( pop().size(), 3u );
+}
+
+BOOST_FIXTURE_TEST_CASE( unknown_packet_indicators_are_dropped, framing< 64 > )
+{
+    const packet_t command_complete = { 0x04, 0x0E, 0x04, 0x01, 0x03, 0x0C, 0x00 };
+
+    feed( { 0x00, 0xff, 0x17 } );
+    feed( command_complete );
+
+    const packet_t packet = pop();
+    BOOST_CHECK_EQUAL_COLLECTIONS( packet.begin(), packet.end(), command_complete.begin(), command_complete.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( packets_larger_than_the_ring_are_dropped, framing< 32 > )
+{
+    const packet_t large = acl_packet( 40 );
+    const packet_t small = event( 0x05, 4 );
+
+    BOOST_CHECK_EQUAL( feed( large, 7 ), large.size() );
+    BOOST_CHECK_EQUAL( next_packet().size, 0u );
+
+    feed( small );
+
+    const packet_t packet = pop();
+    BOOST_CHECK_EQUAL_COLLECTIONS( packet.begin(), packet.end(), small.begin(), small.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( full_ring_accepts_no_more_bytes, framing< 32 > )
+{
+    BOOST_CHECK_EQUAL( feed( acl_packet( 20 ) ), 25u );
+
+    // the header and the first 2 bytes of the payload fit, but not the whole packet
+    BOOST_CHECK_EQUAL( feed( acl_packet( 10 ) ), 7u );
+    BOOST_CHECK_EQUAL( receive_buffer().size, 0u );
+
+    pop();
+
+    // the partial packet is moved to the beginning of the ring
+    const packet_t expected = acl_packet( 10 );
+
+    BOOST_CHECK_EQUAL( receive_buffer().size, 25u );
+    BOOST_CHECK_EQUAL( feed( packet_t( expected.begin() + 7, expected.end() ) ), 8u );
+
+    const packet_t packet = pop();
+    BOOST_CHECK_EQUAL_COLLECTIONS( packet.begin(), packet.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_ring_can_store_a_packet_of_ring_size, framing< 32 > )
+{
+    feed( event( 0x0E, 10 ) );
+    pop();
+
+    const packet_t large = acl_packet( 27 );
+    BOOST_CHECK_EQUAL( feed( large ), 32u );
+
+    const packet_t packet = pop();
+    BOOST_CHECK_EQUAL_COLLECTIONS( packet.begin(), packet.end(), large.begin(), large.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( packets_wrap_around_the_ring, framing< 50 > )
+{
+    std::deque< packet_t > expected;
+    std::size_t            in_ring = 0;
+
+    for ( std::size_t round = 0; round != 1000; ++round )
+    {
+        const packet_t next = round % 3 == 0
+            ? event( static_cast< std::uint8_t >( round ), round % 11 )
+            : acl_packet( round % 17 );
+
+        // feed a packet in chunks, pop a packet, when the ring is full
+        std::size_t pos = 0;
+
+        while ( pos != next.size() )
+        {
+            pos += feed( packet_t( next.begin() + pos, next.end() ), 1 + round % 23 );
+
+            if ( pos != next.size() )
+            {
+                BOOST_REQUIRE( !expected.empty() );
+
+                const packet_t packet = pop();
+                BOOST_REQUIRE_EQUAL_COLLECTIONS( packet.begin(), packet.end(), expected.front().begin(), expected.front().end() );
+                expected.pop_front();
+            }
+        }
+
+        expected.push_back( next );
+        in_ring = std::max( in_ring, expected.size() );
+    }
+
+    while ( !expected.empty() )
+    {
+        const packet_t packet = pop();
+        BOOST_REQUIRE_EQUAL_COLLECTIONS( packet.begin(), packet.end(), expected.front().begin(), expected.front().end() );
+        expected.pop_front();
+    }
+
+    BOOST_CHECK_EQUAL( next_packet().size, 0u );
+    BOOST_CHECK_GT( in_ring, 2u );
+}
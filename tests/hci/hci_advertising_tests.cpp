@@ -19,9 +19,192 @@ using simple_gatt_server = bluetoe::server<
     >
 >;
 
-using link_layer = bluetoe::hci::link_layer< simple_gatt_server, test::transport >;
+struct link_layer : bluetoe::hci::link_layer< simple_gatt_server, test::transport >
+{
+    void run()
+    {
+        bluetoe::hci::link_layer< simple_gatt_server, test::transport >::run( server_ );
+    }
+
+    simple_gatt_server server_;
+};
 
 BOOST_FIXTURE_TEST_CASE( starts_advertising, link_layer )
 {
+    run();
+
+    BOOST_CHECK( advertising() );
+}
+
+BOOST_FIXTURE_TEST_CASE( resets_the_controller_first, link_layer )
+{
+    run();
+
+    BOOST_REQUIRE( !commands().empty() );
+    BOOST_CHECK_EQUAL( commands().front().opcode, reset_opcode );
+}
+
+BOOST_FIXTURE_TEST_CASE( sends_one_command_at_a_time, link_layer )
+{
+    run();
+
+    const std::vector< std::uint16_t > expected = {
+        reset_opcode,
+        set_event_mask_opcode,
+        le_set_event_mask_opcode,
+        read_bd_addr_opcode,
+        le_read_buffer_size_opcode,
+        le_set_advertising_params_opcode,
+        le_set_advertising_data_opcode,
+        le_set_advertise_enable_opcode
+    };
+
+    const auto opcodes = command_opcodes();
+    BOOST_CHECK_EQUAL_COLLECTIONS( opcodes.begin(), opcodes.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( waits_for_the_answer_to_a_setup_command, link_layer )
+{
+    command_credits( 5 );
+    answer_commands_immediately( false );
+
+    run();
+    answer_commands();
+    run();
+    run();
+
+    std::vector< std::uint16_t > expected = { reset_opcode, set_event_mask_opcode };
+    auto opcodes = command_opcodes();
+    BOOST_CHECK_EQUAL_COLLECTIONS( opcodes.begin(), opcodes.end(), expected.begin(), expected.end() );
+
+    answer_commands_immediately( true );
+    answer_commands();
+    run();
+
+    expected = {
+        reset_opcode,
+        set_event_mask_opcode,
+        le_set_event_mask_opcode,
+        read_bd_addr_opcode,
+        le_read_buffer_size_opcode,
+        le_set_advertising_params_opcode,
+        le_set_advertising_data_opcode,
+        le_set_advertise_enable_opcode
+    };
+
+    opcodes = command_opcodes();
+    BOOST_CHECK_EQUAL_COLLECTIONS( opcodes.begin(), opcodes.end(), expected.begin(), expected.end() );
+    BOOST_CHECK( advertising() );
+    BOOST_CHECK( !setup_failed() );
+}
+
+BOOST_FIXTURE_TEST_CASE( a_rejected_setup_command_is_repeated, link_layer )
+{
+    reject_command( read_bd_addr_opcode, 1 );
+    run();
+
+    const auto opcodes = command_opcodes();
+    BOOST_CHECK_EQUAL( std::count( opcodes.begin(), opcodes.end(), read_bd_addr_opcode ), 2 );
+    BOOST_CHECK( advertising() );
+    BOOST_CHECK( !setup_failed() );
+}
+
+BOOST_FIXTURE_TEST_CASE( enables_le_meta_and_disconnection_complete_events, link_layer )
+{
+    run();
+
+    BOOST_CHECK( event_mask() & ( std::uint64_t( 1 ) << 61 ) );
+    BOOST_CHECK( event_mask() & ( std::uint64_t( 1 ) << 4 ) );
+    BOOST_CHECK( le_event_mask() & 0x01 );
+}
+
+BOOST_FIXTURE_TEST_CASE( connectable_undirected_advertising, link_layer )
+{
+    run();
+
+    const auto params = std::find_if( commands().begin(), commands().end(),
+        []( const command& c ) { return c.opcode == le_set_advertising_params_opcode; } );
+
+    BOOST_REQUIRE( params != commands().end() );
+    BOOST_REQUIRE_EQUAL( params->parameters.size(), 15u );
+    BOOST_CHECK_EQUAL( params->parameters[ 4 ], 0x00 );
+    BOOST_CHECK_EQUAL( params->parameters[ 13 ], 0x07 );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_data_of_the_server, link_layer )
+{
+    run();
+
+    std::uint8_t expected[ 31 ];
+    const std::size_t size = server_.advertising_data( expected, sizeof( expected ) );
+
+    BOOST_CHECK_GT( size, 0u );
+    BOOST_CHECK_EQUAL_COLLECTIONS( advertising_data().begin(), advertising_data().end(), &expected[ 0 ], &expected[ size ] );
+}
+
+BOOST_FIXTURE_TEST_CASE( reads_the_public_address_of_the_controller, link_layer )
+{
+    run();
+
+    const auto expected = public_address();
+
+    BOOST_CHECK( local_address().is_public() );
+    BOOST_CHECK( local_address() == bluetoe::link_layer::public_device_address( expected.data() ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( falls_back_to_shared_acl_buffers, link_layer )
+{
+    le_buffer_size( 0, 0 );
+    buffer_size( 64, 3 );
+    run();
+
+    const auto opcodes = command_opcodes();
+    BOOST_CHECK( std::find( opcodes.begin(), opcodes.end(), read_buffer_size_opcode ) != opcodes.end() );
+    BOOST_CHECK_EQUAL( acl_statistics().controller_buffers, 3u );
+    BOOST_CHECK( advertising() );
+}
+
+BOOST_FIXTURE_TEST_CASE( uses_dedicated_le_acl_buffers, link_layer )
+{
+    le_buffer_size( 27, 7 );
+    buffer_size( 64, 3 );
+    run();
+
+    const auto opcodes = command_opcodes();
+    BOOST_CHECK( std::find( opcodes.begin(), opcodes.end(), read_buffer_size_opcode ) == opcodes.end() );
+    BOOST_CHECK_EQUAL( acl_statistics().controller_buffers, 7u );
+    BOOST_CHECK_EQUAL( acl_statistics().free_controller_buffers, 7u );
+}
+
+BOOST_FIXTURE_TEST_CASE( repeats_a_failed_setup_command, link_layer )
+{
+    fail_command( read_bd_addr_opcode, 2 );
+    run();
+
+    const auto opcodes = command_opcodes();
+    BOOST_CHECK_EQUAL( std::count( opcodes.begin(), opcodes.end(), read_bd_addr_opcode ), 3 );
+    BOOST_CHECK( local_address() == bluetoe::link_layer::public_device_address( public_address().data() ) );
+    BOOST_CHECK( advertising() );
+    BOOST_CHECK( !setup_failed() );
+}
+
+BOOST_FIXTURE_TEST_CASE( return_parameters_of_a_failed_command_are_ignored, link_layer )
+{
+    fail_command( le_read_buffer_size_opcode, 1 );
+    le_buffer_size( 27, 7 );
+    run();
+
+    BOOST_CHECK_EQUAL( acl_statistics().controller_buffers, 7u );
+}
+
+BOOST_FIXTURE_TEST_CASE( stops_the_setup_when_a_command_keeps_failing, link_layer )
+{
+    fail_command( le_set_advertising_params_opcode, 3 );
+    run();
 
-}
\ No newline at end of file
+    const auto opcodes = command_opcodes();
+    BOOST_CHECK_EQUAL( std::count( opcodes.begin(), opcodes.end(), le_set_advertising_params_opcode ), 3 );
+    BOOST_CHECK( std::find( opcodes.begin(), opcodes.end(), le_set_advertising_data_opcode ) == opcodes.end() );
+    BOOST_CHECK( !advertising() );
+    BOOST_CHECK( setup_failed() );
+}
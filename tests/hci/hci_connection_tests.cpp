@@ -0,0 +1,219 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <bluetoe/server.hpp>
+#include <bluetoe/service.hpp>
+#include <bluetoe/characteristic.hpp>
+#include <bluetoe/link_layer.hpp>
+#include "transport.hpp"
+
+std::uint16_t value = 0x0815;
+
+// handles: service 1, characteristic declaration 2, value 3, CCCD 4
+using gatt_server = bluetoe::server<
+    bluetoe::service<
+        bluetoe::service_uuid16< 0x4766 >,
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x2021 >,
+            bluetoe::bind_characteristic_value< std::uint16_t, &value >,
+            bluetoe::notify,
+            bluetoe::indicate
+        >
+    >
+>;
+
+namespace {
+    static constexpr std::uint16_t handle      = 0x0042;
+    static constexpr std::uint16_t att_channel = 0x0004;
+    static constexpr std::uint16_t sm_channel  = 0x0006;
+
+    using packet_t = std::vector< std::uint8_t >;
+
+    struct link_layer : bluetoe::hci::link_layer< gatt_server, test::transport >
+    {
+        void run()
+        {
+            bluetoe::hci::link_layer< gatt_server, test::transport >::run( server_ );
+        }
+
+        gatt_server server_;
+    };
+
+    struct connected : link_layer
+    {
+        connected()
+        {
+            run();
+            connect( handle );
+            run();
+        }
+
+        packet_t last_att_output() const
+        {
+            const auto output = l2cap_output( att_channel );
+
+            return output.empty() ? packet_t() : output.back();
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( stops_advertising_when_connected, connected )
+{
+    BOOST_CHECK( !advertising() );
+}
+
+BOOST_FIXTURE_TEST_CASE( att_request_is_answered, connected )
+{
+    // Read Request for the characteristic value
+    l2cap_input( handle, att_channel, { 0x0A, 0x03, 0x00 } );
+    run();
+
+    const packet_t expected = { 0x0B, 0x15, 0x08 };
+    const packet_t output   = last_att_output();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( output.begin(), output.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( response_is_send_over_the_connection, connected )
+{
+    l2cap_input( handle, att_channel, { 0x0A, 0x03, 0x00 } );
+    run();
+
+    BOOST_REQUIRE_EQUAL( acl_output().size(), 1u );
+    BOOST_CHECK_EQUAL( acl_output().front().handle, handle );
+    BOOST_CHECK_EQUAL( acl_output().front().packet_boundary, 0x00 );
+}
+
+BOOST_FIXTURE_TEST_CASE( fragmented_request_is_reassembled, connected )
+{
+    l2cap_input( handle, att_channel, { 0x0A, 0x03, 0x00 }, 3 );
+    run();
+
+    const packet_t expected = { 0x0B, 0x15, 0x08 };
+    const packet_t output   = last_att_output();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( output.begin(), output.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( data_for_other_handles_is_ignored, connected )
+{
+    l2cap_input( handle + 1, att_channel, { 0x0A, 0x03, 0x00 } );
+    run();
+
+    BOOST_CHECK( acl_output().empty() );
+}
+
+BOOST_FIXTURE_TEST_CASE( no_data_without_connection, link_layer )
+{
+    run();
+    l2cap_input( handle, att_channel, { 0x0A, 0x03, 0x00 } );
+    run();
+
+    BOOST_CHECK( acl_output().empty() );
+}
+
+BOOST_FIXTURE_TEST_CASE( notification_is_send_over_acl, connected )
+{
+    // enable notifications
+    l2cap_input( handle, att_channel, { 0x12, 0x04, 0x00, 0x01, 0x00 } );
+    run();
+
+    value = 0x4711;
+    server_.notify( value );
+    run();
+
+    const packet_t expected = { 0x1B, 0x03, 0x00, 0x11, 0x47 };
+    const packet_t output   = last_att_output();
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( output.begin(), output.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( next_indication_waits_for_confirmation, connected )
+{
+    // enable indications
+    l2cap_input( handle, att_channel, { 0x12, 0x04, 0x00, 0x02, 0x00 } );
+    run();
+
+    server_.indicate( value );
+    run();
+
+    BOOST_CHECK_EQUAL( last_att_output()[ 0 ], 0x1D );
+    BOOST_CHECK_EQUAL( l2cap_output( att_channel ).size(), 2u );
+
+    server_.indicate( value );
+    run();
+
+    BOOST_CHECK_EQUAL( l2cap_output( att_channel ).size(), 2u );
+
+    // Handle Value Confirmation
+    l2cap_input( handle, att_channel, { 0x1E } );
+    run();
+
+    BOOST_CHECK_EQUAL( l2cap_output( att_channel ).size(), 3u );
+    BOOST_CHECK_EQUAL( last_att_output()[ 0 ], 0x1D );
+}
+
+BOOST_FIXTURE_TEST_CASE( no_notifications_without_connection, link_layer )
+{
+    run();
+
+    BOOST_CHECK( !server_.notify( value ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( pairing_is_not_supported, connected )
+{
+    l2cap_input( handle, sm_channel, { 0x01, 0x03, 0x00, 0x01, 0x10, 0x07, 0x07 } );
+    run();
+
+    const auto output = l2cap_output( sm_channel );
+    const packet_t expected = { 0x05, 0x05 };
+
+    BOOST_REQUIRE_EQUAL( output.size(), 1u );
+    BOOST_CHECK_EQUAL_COLLECTIONS( output[ 0 ].begin(), output[ 0 ].end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_restarts_after_disconnect, connected )
+{
+    disconnected( handle );
+    run();
+
+    BOOST_CHECK( advertising() );
+}
+
+BOOST_FIXTURE_TEST_CASE( local_disconnect, connected )
+{
+    disconnect();
+    run();
+
+    const command& disconnect_command = commands()[ commands().size() - 2 ];
+    const packet_t expected = { 0x42, 0x00, 0x13 };
+
+    BOOST_CHECK_EQUAL( disconnect_command.opcode, disconnect_opcode );
+    BOOST_CHECK_EQUAL_COLLECTIONS( disconnect_command.parameters.begin(), disconnect_command.parameters.end(), expected.begin(), expected.end() );
+
+    // after the disconnection completed
+    BOOST_CHECK_EQUAL( commands().back().opcode, le_set_advertise_enable_opcode );
+    BOOST_CHECK( advertising() );
+}
+
+BOOST_FIXTURE_TEST_CASE( connection_parameter_update, connected )
+{
+    BOOST_CHECK( connection_parameter_update_request( 0x0010, 0x0020, 2, 0x0100 ) );
+    run();
+
+    const packet_t expected = {
+        0x42, 0x00,
+        0x10, 0x00, 0x20, 0x00,
+        0x02, 0x00, 0x00, 0x01,
+        0x00, 0x00, 0x00, 0x00 };
+
+    BOOST_CHECK_EQUAL( commands().back().opcode, le_connection_update_opcode );
+    BOOST_CHECK_EQUAL_COLLECTIONS( commands().back().parameters.begin(), commands().back().parameters.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( no_connection_parameter_update_without_connection, link_layer )
+{
+    run();
+
+    BOOST_CHECK( !connection_parameter_update_request( 0x0010, 0x0020, 2, 0x0100 ) );
+}
@@ -0,0 +1,205 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <bluetoe/server.hpp>
+#include <bluetoe/service.hpp>
+#include <bluetoe/characteristic.hpp>
+#include <bluetoe/link_layer.hpp>
+#include "transport.hpp"
+
+#include <array>
+
+std::uint16_t value1 = 0x0001;
+std::uint16_t value2 = 0x0002;
+std::uint16_t value3 = 0x0003;
+std::uint16_t value4 = 0x0004;
+
+std::array< std::uint8_t, 60 > large_value = { { 0 } };
+
+template < std::uint16_t UUID, std::uint16_t* Value >
+using notified_characteristic = bluetoe::characteristic<
+    bluetoe::characteristic_uuid16< UUID >,
+    bluetoe::bind_characteristic_value< std::uint16_t, Value >,
+    bluetoe::notify
+>;
+
+// notified values have the handles 3, 6, 9 and 12, the CCCDs 4, 7, 10 and 13. The large value has the handle 15
+using gatt_server = bluetoe::server<
+    bluetoe::service<
+        bluetoe::service_uuid16< 0x4766 >,
+        notified_characteristic< 0x2021, &value1 >,
+        notified_characteristic< 0x2022, &value2 >,
+        notified_characteristic< 0x2023, &value3 >,
+        notified_characteristic< 0x2024, &value4 >,
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x2025 >,
+            bluetoe::bind_characteristic_value< decltype( large_value ), &large_value >,
+            bluetoe::no_write_access
+        >
+    >
+>;
+
+namespace {
+    static constexpr std::uint16_t handle      = 0x0042;
+    static constexpr std::uint16_t att_channel = 0x0004;
+
+    using link_layer_t = bluetoe::hci::link_layer< gatt_server, test::transport, bluetoe::link_layer::max_mtu_size< 100 > >;
+
+    template < std::uint8_t Buffers >
+    struct connected : link_layer_t
+    {
+        connected()
+        {
+            le_buffer_size( 27, Buffers );
+            run();
+            connect( handle );
+            run();
+
+            for ( std::uint8_t cccd = 4; cccd <= 13; cccd += 3 )
+            {
+                l2cap_input( handle, att_channel, { 0x12, cccd, 0x00, 0x01, 0x00 } );
+                run();
+            }
+
+            // from now on, the test completes packets
+            auto_complete_packets( false );
+        }
+
+        void run()
+        {
+            link_layer_t::run( server_ );
+        }
+
+        void notify_all()
+        {
+            server_.notify( value1 );
+            server_.notify( value2 );
+            server_.notify( value3 );
+            server_.notify( value4 );
+        }
+
+        std::size_t notifications() const
+        {
+            const auto output = l2cap_output( att_channel );
+
+            return std::count_if( output.begin(), output.end(), []( const packet_t& pdu ) {
+                return !pdu.empty() && pdu[ 0 ] == 0x1B;
+            } );
+        }
+
+        gatt_server server_;
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( sends_no_more_packets_than_the_controller_has_buffers, connected< 2 > )
+{
+    notify_all();
+    run();
+
+    BOOST_CHECK_EQUAL( notifications(), 2u );
+    BOOST_CHECK_EQUAL( buffers_in_use(), 2u );
+    BOOST_CHECK( !buffer_overflow() );
+}
+
+BOOST_FIXTURE_TEST_CASE( completed_packets_replenish_credits, connected< 2 > )
+{
+    notify_all();
+    run();
+
+    complete_packets();
+    run();
+
+    BOOST_CHECK_EQUAL( notifications(), 4u );
+    BOOST_CHECK( !buffer_overflow() );
+}
+
+BOOST_FIXTURE_TEST_CASE( batches_packets_per_write, connected< 8 > )
+{
+    const std::size_t writes = acl_packets_per_write().size();
+
+    notify_all();
+    run();
+
+    BOOST_CHECK_EQUAL( acl_packets_per_write().size(), writes + 1 );
+    BOOST_CHECK_EQUAL( acl_packets_per_write().back(), 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( reports_queue_depth, connected< 1 > )
+{
+    notify_all();
+    run();
+
+    const auto statistics = acl_statistics();
+
+    BOOST_CHECK_EQUAL( statistics.queued_packets, 3u );
+    BOOST_CHECK_EQUAL( statistics.max_queued_packets, 4u );
+    BOOST_CHECK_EQUAL( statistics.free_controller_buffers, 0u );
+    BOOST_CHECK_EQUAL( statistics.controller_buffers, 1u );
+
+    complete_packets();
+    run();
+
+    BOOST_CHECK_EQUAL( acl_statistics().queued_packets, 2u );
+    BOOST_CHECK_EQUAL( acl_statistics().free_controller_buffers, 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( response_is_queued_behind_notifications, connected< 1 > )
+{
+    notify_all();
+    run();
+
+    l2cap_input( handle, att_channel, { 0x0A, 0x03, 0x00 } );
+    run();
+
+    for ( int i = 0; i != 5; ++i )
+    {
+        complete_packets();
+        run();
+    }
+
+    const auto output = l2cap_output( att_channel );
+
+    BOOST_REQUIRE( !output.empty() );
+    BOOST_CHECK_EQUAL( output.back()[ 0 ], 0x0B );
+    BOOST_CHECK_EQUAL( notifications(), 4u );
+    BOOST_CHECK( !buffer_overflow() );
+}
+
+BOOST_FIXTURE_TEST_CASE( fragments_to_the_controllers_acl_length, connected< 8 > )
+{
+    auto_complete_packets( true );
+
+    // exchange an MTU of 100 and read the large value
+    l2cap_input( handle, att_channel, { 0x02, 100, 0x00 } );
+    run();
+
+    const std::size_t packets = acl_output().size();
+
+    l2cap_input( handle, att_channel, { 0x0A, 15, 0x00 } );
+    run();
+
+    // 4 + 1 + 60 bytes, fragmented into 27 + 27 + 11 bytes
+    BOOST_REQUIRE_EQUAL( acl_output().size(), packets + 3 );
+    BOOST_CHECK_EQUAL( acl_output()[ packets ].packet_boundary, 0x00 );
+    BOOST_CHECK_EQUAL( acl_output()[ packets ].data.size(), 27u );
+    BOOST_CHECK_EQUAL( acl_output()[ packets + 1 ].packet_boundary, 0x01 );
+    BOOST_CHECK_EQUAL( acl_output()[ packets + 1 ].data.size(), 27u );
+    BOOST_CHECK_EQUAL( acl_output()[ packets + 2 ].packet_boundary, 0x01 );
+    BOOST_CHECK_EQUAL( acl_output()[ packets + 2 ].data.size(), 11u );
+
+    const auto response = l2cap_output( att_channel ).back();
+    BOOST_CHECK_EQUAL( response.size(), 61u );
+    BOOST_CHECK( !buffer_overflow() );
+}
+
+BOOST_FIXTURE_TEST_CASE( disconnect_frees_all_buffers, connected< 1 > )
+{
+    notify_all();
+    run();
+
+    disconnected( handle );
+    run();
+
+    BOOST_CHECK_EQUAL( acl_statistics().queued_packets, 0u );
+    BOOST_CHECK_EQUAL( acl_statistics().free_controller_buffers, 1u );
+}
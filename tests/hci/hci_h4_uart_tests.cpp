@@ -0,0 +1,141 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <bluetoe/server.hpp>
+#include <bluetoe/service.hpp>
+#include <bluetoe/characteristic.hpp>
+#include <bluetoe/link_layer.hpp>
+#include "pty_transport.hpp"
+
+std::uint16_t value = 0x0815;
+
+// handles: service 1, characteristic declaration 2, value 3
+using gatt_server = bluetoe::server<
+    bluetoe::service<
+        bluetoe::service_uuid16< 0x4766 >,
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x2021 >,
+            bluetoe::bind_characteristic_value< std::uint16_t, &value >
+        >
+    >
+>;
+
+namespace {
+    using packet_t = std::vector< std::uint8_t >;
+
+    const packet_t connection_complete = {
+        0x04, 0x3E, 0x13, 0x01,             // LE Meta Event: LE Connection Complete
+        0x00, 0x42, 0x00, 0x01, 0x00,       // status, handle, role, peer address type
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, // peer address
+        0x18, 0x00, 0x00, 0x00, 0x48, 0x00, // interval, latency, timeout
+        0x00                                // clock accuracy
+    };
+
+    // Read Request for the characteristic value over L2CAP channel 4; the response starts non-flushable
+    const packet_t read_request = { 0x02, 0x42, 0x20, 0x07, 0x00, 0x03, 0x00, 0x04, 0x00, 0x0A, 0x03, 0x00 };
+    const packet_t read_response = { 0x02, 0x42, 0x00, 0x07, 0x00, 0x03, 0x00, 0x04, 0x00, 0x0B, 0x15, 0x08 };
+
+    struct link_layer : bluetoe::hci::link_layer< gatt_server, test::pty_transport >
+    {
+        // runs the link layer, until no more input arrives
+        void run()
+        {
+            do
+                bluetoe::hci::link_layer< gatt_server, test::pty_transport >::run( server_ );
+            while ( wait_for_input( 20 ) );
+        }
+
+        // reads the next command from the host and answers it with a Command Complete event
+        std::uint16_t answer_command( const packet_t& return_parameters = { 0x00 } )
+        {
+            const packet_t header = controller_read( 4 );
+            BOOST_REQUIRE_EQUAL( header.size(), 4u );
+            BOOST_REQUIRE_EQUAL( header[ 0 ], 0x01 );
+
+            controller_read( header[ 3 ] );
+
+            packet_t event = { 0x04, 0x0E, static_cast< std::uint8_t >( 3 + return_parameters.size() ), 0x01, header[ 1 ], header[ 2 ] };
+            event.insert( event.end(), return_parameters.begin(), return_parameters.end() );
+            controller_write( event );
+
+            return static_cast< std::uint16_t >( header[ 1 ] | header[ 2 ] << 8 );
+        }
+
+        gatt_server server_;
+    };
+
+    struct advertising : link_layer
+    {
+        advertising()
+        {
+            for ( int command = 0; command != 3; ++command )
+            {
+                run();
+                opcodes.push_back( answer_command() );
+            }
+
+            run();
+            opcodes.push_back( answer_command( { 0x00, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01 } ) );
+            run();
+            opcodes.push_back( answer_command( { 0x00, 0x1b, 0x00, 0x04 } ) );
+
+            for ( int command = 0; command != 3; ++command )
+            {
+                run();
+                opcodes.push_back( answer_command() );
+            }
+
+            run();
+        }
+
+        std::vector< std::uint16_t > opcodes;
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( sets_up_the_controller_over_a_pseudo_terminal, advertising )
+{
+    const std::vector< std::uint16_t > expected = { 0x0C03, 0x0C01, 0x2001, 0x1009, 0x2002, 0x2006, 0x2008, 0x200A };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( opcodes.begin(), opcodes.end(), expected.begin(), expected.end() );
+    BOOST_CHECK_EQUAL( local_address(), bluetoe::link_layer::public_device_address( { 0x06, 0x05, 0x04, 0x03, 0x02, 0x01 } ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( handles_packets_received_with_a_single_read, advertising )
+{
+    packet_t stream = connection_complete;
+    stream.insert( stream.end(), read_request.begin(), read_request.end() );
+
+    controller_write( stream );
+    run();
+
+    const packet_t response = controller_read( read_response.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( response.begin(), response.end(), read_response.begin(), read_response.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( handles_packets_received_byte_by_byte, advertising )
+{
+    packet_t stream = connection_complete;
+    stream.insert( stream.end(), read_request.begin(), read_request.end() );
+
+    for ( const auto byte : stream )
+    {
+        controller_write( { byte } );
+        run();
+    }
+
+    const packet_t response = controller_read( read_response.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( response.begin(), response.end(), read_response.begin(), read_response.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( resynchronizes_after_garbage, advertising )
+{
+    packet_t stream = { 0x00, 0xff, 0x17 };
+    stream.insert( stream.end(), connection_complete.begin(), connection_complete.end() );
+    stream.insert( stream.end(), read_request.begin(), read_request.end() );
+
+    controller_write( stream );
+    run();
+
+    const packet_t response = controller_read( read_response.size() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( response.begin(), response.end(), read_response.begin(), read_response.end() );
+}
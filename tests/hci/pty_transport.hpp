@@ -0,0 +1,140 @@
+#ifndef TESTS_HCI_PTY_TRANSPORT_HPP
+#define TESTS_HCI_PTY_TRANSPORT_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cerrno>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace test
+{
+    /*
+     * Transport over a POSIX pseudo terminal: The link layer uses the slave side, like the tty device of a UART
+     * connected controller. The test acts as the controller on the master side of the pseudo terminal.
+     */
+    template < typename LinkLayer >
+    class pty_transport
+    {
+    public:
+        using packet_t = std::vector< std::uint8_t >;
+
+        pty_transport()
+            : master_( ::posix_openpt( O_RDWR | O_NOCTTY ) )
+            , slave_( -1 )
+        {
+            if ( master_ < 0 || ::grantpt( master_ ) != 0 || ::unlockpt( master_ ) != 0 )
+                throw std::runtime_error( "unable to open pseudo terminal" );
+
+            slave_ = ::open( ::ptsname( master_ ), O_RDWR | O_NOCTTY | O_NONBLOCK );
+
+            if ( slave_ < 0 )
+                throw std::runtime_error( "unable to open pseudo terminal slave" );
+
+            // binary data, no echo, no line editing
+            termios settings;
+            ::tcgetattr( slave_, &settings );
+            ::cfmakeraw( &settings );
+            ::tcsetattr( slave_, TCSANOW, &settings );
+        }
+
+        ~pty_transport()
+        {
+            ::close( slave_ );
+            ::close( master_ );
+        }
+
+        pty_transport( const pty_transport& ) = delete;
+        pty_transport& operator=( const pty_transport& ) = delete;
+
+        // transport interface
+        void write( const std::uint8_t* buffer, std::size_t size )
+        {
+            while ( size )
+            {
+                const ssize_t written = ::write( slave_, buffer, size );
+
+                if ( written < 0 && errno != EAGAIN )
+                    throw std::runtime_error( "writing to pseudo terminal failed" );
+
+                if ( written < 0 )
+                {
+                    wait( slave_, POLLOUT );
+                    continue;
+                }
+
+                buffer += written;
+                size   -= static_cast< std::size_t >( written );
+            }
+        }
+
+        std::size_t read( std::uint8_t* buffer, std::size_t size )
+        {
+            const ssize_t received = ::read( slave_, buffer, size );
+
+            return received < 0 ? 0 : static_cast< std::size_t >( received );
+        }
+
+        // test interface
+
+        /*
+         * writes bytes to the host
+         */
+        void controller_write( const packet_t& bytes )
+        {
+            if ( ::write( master_, bytes.data(), bytes.size() ) != static_cast< ssize_t >( bytes.size() ) )
+                throw std::runtime_error( "writing to pseudo terminal master failed" );
+        }
+
+        /*
+         * reads exactly size bytes, send by the host. Returns less bytes, if the host did not send more bytes
+         * within timeout_ms
+         */
+        packet_t controller_read( std::size_t size, int timeout_ms = 1000 )
+        {
+            packet_t result( size );
+            std::size_t pos = 0;
+
+            while ( pos != size && wait( master_, POLLIN, timeout_ms ) )
+            {
+                const ssize_t received = ::read( master_, &result[ pos ], size - pos );
+
+                if ( received <= 0 )
+                    break;
+
+                pos += static_cast< std::size_t >( received );
+            }
+
+            result.resize( pos );
+
+            return result;
+        }
+
+        /*
+         * waits until input for the host is available
+         */
+        bool wait_for_input( int timeout_ms )
+        {
+            return wait( slave_, POLLIN, timeout_ms );
+        }
+
+    private:
+        static bool wait( int fd, short events, int timeout_ms = 1000 )
+        {
+            pollfd poll_fd = { fd, events, 0 };
+
+            return ::poll( &poll_fd, 1, timeout_ms ) == 1 && ( poll_fd.revents & events );
+        }
+
+        int master_;
+        int slave_;
+    };
+}
+
+#endif
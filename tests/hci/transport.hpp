@@ -1,13 +1,604 @@
 #ifndef TESTS_HCI_TRANSPORT_HPP
 #define TESTS_HCI_TRANSPORT_HPP
 
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+
 namespace test
 {
+    /*
+     * Loopback transport, that emulates an HCI controller. Commands of the host are answered with the
+     * corresponding command complete / command status events. Events and ACL data from a central can
+     * be injected by the test. Like a real controller, the transport drops events, that are masked out by the
+     * HCI_Set_Event_Mask and HCI_LE_Set_Event_Mask commands of the host.
+     */
     template < typename LinkLayer >
     class transport
     {
+    public:
+        using packet_t = std::vector< std::uint8_t >;
+
+        struct command {
+            std::uint16_t   opcode;
+            packet_t        parameters;
+        };
+
+        struct acl_packet {
+            std::uint16_t   handle;
+            std::uint8_t    packet_boundary;
+            packet_t        data;
+        };
+
+        static constexpr std::uint16_t disconnect_opcode                = 0x0406;
+        static constexpr std::uint16_t set_event_mask_opcode            = 0x0C01;
+        static constexpr std::uint16_t reset_opcode                     = 0x0C03;
+        static constexpr std::uint16_t read_buffer_size_opcode          = 0x1005;
+        static constexpr std::uint16_t read_bd_addr_opcode              = 0x1009;
+        static constexpr std::uint16_t le_set_event_mask_opcode         = 0x2001;
+        static constexpr std::uint16_t le_read_buffer_size_opcode       = 0x2002;
+        static constexpr std::uint16_t le_set_advertising_params_opcode = 0x2006;
+        static constexpr std::uint16_t le_set_advertising_data_opcode   = 0x2008;
+        static constexpr std::uint16_t le_set_advertise_enable_opcode   = 0x200A;
+        static constexpr std::uint16_t le_connection_update_opcode      = 0x2013;
+
+        // event masks after power on or HCI_Reset
+        static constexpr std::uint64_t default_event_mask               = 0x00001FFFFFFFFFFFull;
+        static constexpr std::uint64_t default_le_event_mask            = 0x000000000000001Full;
+
+        transport()
+            : event_mask_( default_event_mask )
+            , le_event_mask_( default_le_event_mask )
+            , advertising_enabled_( false )
+            , command_credits_( 1 )
+            , connection_handle_( 0 )
+            , le_acl_length_( 27 )
+            , le_acl_buffers_( 4 )
+            , acl_length_( 0 )
+            , acl_buffers_( 0 )
+            , auto_complete_( true )
+            , answer_commands_( true )
+            , buffers_in_use_( 0 )
+            , buffer_overflow_( false )
+            , failing_opcode_( 0 )
+            , failures_( 0 )
+            , rejected_opcode_( 0 )
+            , rejections_( 0 )
+        {
+        }
+
+        // transport interface
+        void write( const std::uint8_t* buffer, std::size_t size )
+        {
+            input_.insert( input_.end(), buffer, buffer + size );
+
+            const std::size_t acl_packets = acl_output_.size();
+
+            while ( consume_packet() )
+                ;
+
+            if ( acl_output_.size() != acl_packets )
+                acl_packets_per_write_.push_back( acl_output_.size() - acl_packets );
+
+            if ( auto_complete_ )
+                complete_packets();
+        }
+
+        std::size_t read( std::uint8_t* buffer, std::size_t size )
+        {
+            size = std::min( size, output_.size() );
+
+            std::copy( output_.begin(), output_.begin() + size, buffer );
+            output_.erase( output_.begin(), output_.begin() + size );
+
+            return size;
+        }
+
+        // test interface
+        const std::vector< command >& commands() const
+        {
+            return commands_;
+        }
+
+        std::vector< std::uint16_t > command_opcodes() const
+        {
+            std::vector< std::uint16_t > result;
+
+            for ( const auto& c : commands_ )
+                result.push_back( c.opcode );
+
+            return result;
+        }
+
+        std::uint64_t event_mask() const
+        {
+            return event_mask_;
+        }
+
+        std::uint64_t le_event_mask() const
+        {
+            return le_event_mask_;
+        }
+
+        bool advertising() const
+        {
+            return advertising_enabled_;
+        }
+
+        const packet_t& advertising_data() const
+        {
+            return advertising_data_;
+        }
+
+        /*
+         * ACL data packets send by the host
+         */
+        const std::vector< acl_packet >& acl_output() const
+        {
+            return acl_output_;
+        }
+
+        /*
+         * configures the LE ACL data buffers, reported by HCI_LE_Read_Buffer_Size. If the number of buffers
+         * is 0, the controller reports the ACL buffers with HCI_Read_Buffer_Size.
+         */
+        void le_buffer_size( std::uint16_t length, std::uint8_t buffers )
+        {
+            le_acl_length_  = length;
+            le_acl_buffers_ = buffers;
+        }
+
+        void buffer_size( std::uint16_t length, std::uint16_t buffers )
+        {
+            acl_length_  = length;
+            acl_buffers_ = buffers;
+        }
+
+        /*
+         * the next times commands with the given opcode are answered with an Unspecified Error status, followed
+         * by invalid return parameters
+         */
+        void fail_command( std::uint16_t opcode, std::size_t times )
+        {
+            failing_opcode_ = opcode;
+            failures_       = times;
+        }
+
+        /*
+         * the next times commands with the given opcode are answered with a command status event with
+         * Unknown HCI Command status
+         */
+        void reject_command( std::uint16_t opcode, std::size_t times )
+        {
+            rejected_opcode_ = opcode;
+            rejections_      = times;
+        }
+
+        /*
+         * number of commands, the controller reports to accept, with every command complete and command status event
+         */
+        void command_credits( std::uint8_t credits )
+        {
+            command_credits_ = credits;
+        }
+
+        /*
+         * by default, every command is answered right after it was received. Otherwise, received commands
+         * are answered by answer_commands().
+         */
+        void answer_commands_immediately( bool immediately )
+        {
+            answer_commands_ = immediately;
+        }
+
+        /*
+         * answers all commands, received so far and not answered yet
+         */
+        void answer_commands()
+        {
+            std::vector< command > unanswered;
+            unanswered.swap( unanswered_ );
+
+            for ( const auto& c : unanswered )
+                answer_command( c.opcode, c.parameters );
+        }
+
+        /*
+         * by default, every ACL data packet is reported as completed, right after it was received
+         */
+        void auto_complete_packets( bool complete )
+        {
+            auto_complete_ = complete;
+        }
+
+        /*
+         * reports all ACL data packets, received so far, as completed
+         */
+        void complete_packets()
+        {
+            if ( buffers_in_use_ == 0 )
+                return;
+
+            event( 0x13, { 0x01, low( connection_handle_ ), high( connection_handle_ ), low( buffers_in_use_ ), high( buffers_in_use_ ) } );
+            buffers_in_use_ = 0;
+        }
+
+        /*
+         * number of ACL data packets, that are received, but not completed
+         */
+        std::size_t buffers_in_use() const
+        {
+            return buffers_in_use_;
+        }
+
+        /*
+         * true, if the host send more ACL data packets than the controller has buffers
+         */
+        bool buffer_overflow() const
+        {
+            return buffer_overflow_;
+        }
+
+        /*
+         * the number of ACL data packets, received with every call to write(), that contained ACL data packets
+         */
+        const std::vector< std::size_t >& acl_packets_per_write() const
+        {
+            return acl_packets_per_write_;
+        }
+
+        /*
+         * L2CAP payloads send by the host on the given channel, reassembled from ACL data packets
+         */
+        std::vector< packet_t > l2cap_output( std::uint16_t channel ) const
+        {
+            std::vector< packet_t > result;
+            packet_t pdu;
+
+            for ( const auto& packet : acl_output_ )
+            {
+                if ( packet.packet_boundary != 0x01 )
+                    pdu.clear();
+
+                pdu.insert( pdu.end(), packet.data.begin(), packet.data.end() );
+
+                if ( pdu.size() >= 4 && pdu.size() == 4u + read_16( &pdu[ 0 ] ) && read_16( &pdu[ 2 ] ) == channel )
+                    result.push_back( packet_t( pdu.begin() + 4, pdu.end() ) );
+            }
+
+            return result;
+        }
+
+        /*
+         * a central establishes a connection
+         */
+        void connect( std::uint16_t handle )
+        {
+            advertising_enabled_ = false;
+            connection_handle_   = handle;
+
+            event( 0x3E, {
+                0x01,                               // LE Connection Complete
+                0x00,                               // Success
+                low( handle ), high( handle ),
+                0x01,                               // Peripheral
+                0x00,                               // public Peer_Address_Type
+                0x11, 0x22, 0x33, 0x44, 0x55, 0x66, // Peer_Address
+                0x18, 0x00,                         // Connection_Interval
+                0x00, 0x00,                         // Peripheral_Latency
+                0x48, 0x00,                         // Supervision_Timeout
+                0x00                                // Central_Clock_Accuracy
+            } );
+        }
+
+        /*
+         * the central closes the connection
+         */
+        void disconnected( std::uint16_t handle, std::uint8_t reason = 0x13 )
+        {
+            buffers_in_use_ = 0;
+            event( 0x05, { 0x00, low( handle ), high( handle ), reason } );
+        }
+
+        /*
+         * the central sends the given L2CAP payload; the L2CAP PDU is split into ACL packets of at max fragment_size bytes
+         */
+        void l2cap_input( std::uint16_t handle, std::uint16_t channel, std::initializer_list< std::uint8_t > payload, std::size_t fragment_size = 27 )
+        {
+            packet_t pdu = { low( payload.size() ), high( payload.size() ), low( channel ), high( channel ) };
+            pdu.insert( pdu.end(), payload.begin(), payload.end() );
+
+            for ( std::size_t pos = 0; pos < pdu.size(); pos += fragment_size )
+            {
+                const std::size_t   size = std::min( fragment_size, pdu.size() - pos );
+                const std::uint16_t flags_handle = handle | ( pos == 0 ? 0x2000 : 0x1000 );
+
+                output_.push_back( 0x02 );
+                output_.push_back( low( flags_handle ) );
+                output_.push_back( high( flags_handle ) );
+                output_.push_back( low( size ) );
+                output_.push_back( high( size ) );
+                output_.insert( output_.end(), pdu.begin() + pos, pdu.begin() + pos + size );
+            }
+        }
+
+        /*
+         * controller public address, as reported by HCI_Read_BD_ADDR
+         */
+        static packet_t public_address()
+        {
+            return { 0x47, 0x11, 0x08, 0x15, 0x0f, 0xc0 };
+        }
+
+    private:
+        static std::uint8_t low( std::size_t value )
+        {
+            return static_cast< std::uint8_t >( value & 0xff );
+        }
+
+        static std::uint8_t high( std::size_t value )
+        {
+            return static_cast< std::uint8_t >( ( value >> 8 ) & 0xff );
+        }
+
+        static std::uint16_t read_16( const std::uint8_t* p )
+        {
+            return static_cast< std::uint16_t >( p[ 0 ] | ( p[ 1 ] << 8 ) );
+        }
+
+        static std::uint64_t read_64( const std::uint8_t* p )
+        {
+            std::uint64_t result = 0;
+
+            for ( int i = 7; i >= 0; --i )
+                result = ( result << 8 ) | p[ i ];
 
+            return result;
+        }
+
+        // Command Complete, Command Status and Number Of Completed Packets can not be masked
+        bool masked( std::uint8_t code, const packet_t& parameters ) const
+        {
+            if ( code == 0x0E || code == 0x0F || code == 0x13 )
+                return false;
+
+            if ( ( event_mask_ & ( std::uint64_t( 1 ) << ( code - 1 ) ) ) == 0 )
+                return true;
+
+            return code == 0x3E && ( le_event_mask_ & ( std::uint64_t( 1 ) << ( parameters[ 0 ] - 1 ) ) ) == 0;
+        }
+
+        void event( std::uint8_t code, const packet_t& parameters )
+        {
+            if ( masked( code, parameters ) )
+                return;
+
+            output_.push_back( 0x04 );
+            output_.push_back( code );
+            output_.push_back( low( parameters.size() ) );
+            output_.insert( output_.end(), parameters.begin(), parameters.end() );
+        }
+
+        void command_complete( std::uint16_t opcode, packet_t return_parameters )
+        {
+            packet_t parameters = { command_credits_, low( opcode ), high( opcode ) };
+            parameters.insert( parameters.end(), return_parameters.begin(), return_parameters.end() );
+
+            event( 0x0E, parameters );
+        }
+
+        void command_status( std::uint16_t opcode, std::uint8_t status = 0x00 )
+        {
+            event( 0x0F, { status, command_credits_, low( opcode ), high( opcode ) } );
+        }
+
+        bool consume_packet()
+        {
+            if ( input_.empty() )
+                return false;
+
+            std::size_t header_size = 0;
+            std::size_t size        = 0;
+
+            if ( input_[ 0 ] == 0x01 && input_.size() >= 4 )
+            {
+                header_size = 4;
+                size        = input_[ 3 ];
+            }
+            else if ( input_[ 0 ] == 0x02 && input_.size() >= 5 )
+            {
+                header_size = 5;
+                size        = read_16( &input_[ 3 ] );
+            }
+            else
+            {
+                assert( input_[ 0 ] == 0x01 || input_[ 0 ] == 0x02 );
+                return false;
+            }
+
+            if ( input_.size() < header_size + size )
+                return false;
+
+            const packet_t packet( input_.begin(), input_.begin() + header_size + size );
+            input_.erase( input_.begin(), input_.begin() + header_size + size );
+
+            if ( packet[ 0 ] == 0x01 )
+            {
+                handle_command( read_16( &packet[ 1 ] ), packet_t( packet.begin() + header_size, packet.end() ) );
+            }
+            else
+            {
+                const std::uint16_t handle_flags = read_16( &packet[ 1 ] );
+
+                buffer_overflow_ = buffer_overflow_ || buffers_in_use_ == ( le_acl_buffers_ ? le_acl_buffers_ : acl_buffers_ );
+                buffer_overflow_ = buffer_overflow_ || size > ( le_acl_buffers_ ? le_acl_length_ : acl_length_ );
+                ++buffers_in_use_;
+
+                acl_output_.push_back( acl_packet{
+                    static_cast< std::uint16_t >( handle_flags & 0x0fff ),
+                    static_cast< std::uint8_t >( ( handle_flags >> 12 ) & 0x3 ),
+                    packet_t( packet.begin() + header_size, packet.end() ) } );
+            }
+
+            return true;
+        }
+
+        void handle_command( std::uint16_t opcode, const packet_t& parameters )
+        {
+            commands_.push_back( command{ opcode, parameters } );
+
+            if ( answer_commands_ )
+                answer_command( opcode, parameters );
+            else
+                unanswered_.push_back( command{ opcode, parameters } );
+        }
+
+        void answer_command( std::uint16_t opcode, const packet_t& parameters )
+        {
+            if ( opcode == failing_opcode_ && failures_ != 0 )
+            {
+                --failures_;
+                command_complete( opcode, { 0x1F, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff } );
+
+                return;
+            }
+
+            if ( opcode == rejected_opcode_ && rejections_ != 0 )
+            {
+                --rejections_;
+                command_status( opcode, 0x01 );
+
+                return;
+            }
+
+            switch ( opcode )
+            {
+            case reset_opcode:
+                event_mask_    = default_event_mask;
+                le_event_mask_ = default_le_event_mask;
+                command_complete( opcode, { 0x00 } );
+                break;
+            case set_event_mask_opcode:
+                event_mask_ = read_64( &parameters[ 0 ] );
+                command_complete( opcode, { 0x00 } );
+                break;
+            case le_set_event_mask_opcode:
+                le_event_mask_ = read_64( &parameters[ 0 ] );
+                command_complete( opcode, { 0x00 } );
+                break;
+            case le_read_buffer_size_opcode:
+                command_complete( opcode, { 0x00, low( le_acl_length_ ), high( le_acl_length_ ), le_acl_buffers_ } );
+                break;
+            case read_buffer_size_opcode:
+                command_complete( opcode, { 0x00, low( acl_length_ ), high( acl_length_ ), 0x00, low( acl_buffers_ ), high( acl_buffers_ ), 0x00, 0x00 } );
+                break;
+            case read_bd_addr_opcode:
+                {
+                    packet_t result = { 0x00 };
+                    const packet_t address = public_address();
+                    result.insert( result.end(), address.begin(), address.end() );
+
+                    command_complete( opcode, result );
+                }
+                break;
+            case le_set_advertising_data_opcode:
+                advertising_data_.assign( parameters.begin() + 1, parameters.begin() + 1 + parameters[ 0 ] );
+                command_complete( opcode, { 0x00 } );
+                break;
+            case le_set_advertise_enable_opcode:
+                advertising_enabled_ = parameters[ 0 ] != 0;
+                command_complete( opcode, { 0x00 } );
+                break;
+            case disconnect_opcode:
+                command_status( opcode );
+                disconnected( read_16( &parameters[ 0 ] ), 0x16 );
+                break;
+            case le_connection_update_opcode:
+                command_status( opcode );
+                event( 0x3E, {
+                    0x03, 0x00,                     // LE Connection Update Complete, Success
+                    parameters[ 0 ], parameters[ 1 ],
+                    parameters[ 4 ], parameters[ 5 ],
+                    parameters[ 6 ], parameters[ 7 ],
+                    parameters[ 8 ], parameters[ 9 ] } );
+                break;
+            default:
+                command_complete( opcode, { 0x00 } );
+                break;
+            }
+        }
+
+        std::deque< std::uint8_t >  input_;
+        std::deque< std::uint8_t >  output_;
+
+        std::vector< command >      commands_;
+        std::vector< command >      unanswered_;
+        std::vector< acl_packet >   acl_output_;
+        std::uint64_t               event_mask_;
+        std::uint64_t               le_event_mask_;
+        packet_t                    advertising_data_;
+        bool                        advertising_enabled_;
+        std::uint8_t                command_credits_;
+        std::uint16_t               connection_handle_;
+
+        std::uint16_t               le_acl_length_;
+        std::uint8_t                le_acl_buffers_;
+        std::uint16_t               acl_length_;
+        std::uint16_t               acl_buffers_;
+        bool                        auto_complete_;
+        bool                        answer_commands_;
+        std::size_t                 buffers_in_use_;
+        bool                        buffer_overflow_;
+        std::vector< std::size_t >  acl_packets_per_write_;
+        std::uint16_t               failing_opcode_;
+        std::size_t                 failures_;
+        std::uint16_t               rejected_opcode_;
+        std::size_t                 rejections_;
     };
+
+    // the opcodes are passed by reference to std::find() and the Boost.Test macros
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::disconnect_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::set_event_mask_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::reset_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::read_buffer_size_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::read_bd_addr_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::le_set_event_mask_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::le_read_buffer_size_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::le_set_advertising_params_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::le_set_advertising_data_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::le_set_advertise_enable_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint16_t transport< LinkLayer >::le_connection_update_opcode;
+
+    template < typename LinkLayer >
+    constexpr std::uint64_t transport< LinkLayer >::default_event_mask;
+
+    template < typename LinkLayer >
+    constexpr std::uint64_t transport< LinkLayer >::default_le_event_mask;
 }
 
 #endif
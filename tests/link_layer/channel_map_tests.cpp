@@ -199,3 +199,73 @@ BOOST_FIXTURE_TEST_CASE( real_life_example, all_channels_but_25 )
     BOOST_CHECK_EQUAL( data_channel( 30 ), 1u );
     BOOST_CHECK_EQUAL( data_channel( 35 ), 31u );
 }
+
+static constexpr std::uint32_t sample_access_address = 0x8E89BED6;
+
+/*
+ * Sample data from Vol 6, Part C, 3.1
+ */
+BOOST_FIXTURE_TEST_CASE( algorithm_2_all_channels, bluetoe::link_layer::channel_map )
+{
+    BOOST_REQUIRE( reset_algorithm_2( all_channel_map, sample_access_address ) );
+    BOOST_CHECK( algorithm_2() );
+
+    BOOST_CHECK_EQUAL( data_channel( 0, 0 ), 25u );
+    BOOST_CHECK_EQUAL( data_channel( 1, 1 ), 20u );
+    BOOST_CHECK_EQUAL( data_channel( 2, 2 ), 6u );
+    BOOST_CHECK_EQUAL( data_channel( 3, 3 ), 21u );
+}
+
+static constexpr std::uint8_t sample_data_2_map[] = { 0x00, 0x06, 0xE0, 0x00, 0x1E };
+
+/*
+ * Sample data from Vol 6, Part C, 3.2
+ */
+BOOST_FIXTURE_TEST_CASE( algorithm_2_a_few_channels, bluetoe::link_layer::channel_map )
+{
+    BOOST_REQUIRE( reset_algorithm_2( sample_data_2_map, sample_access_address ) );
+
+    BOOST_CHECK_EQUAL( data_channel( 6, 6 ), 23u );
+    BOOST_CHECK_EQUAL( data_channel( 7, 7 ), 9u );
+    BOOST_CHECK_EQUAL( data_channel( 8, 8 ), 34u );
+}
+
+/*
+ * A new map keeps the algorithm and the channel identifier
+ */
+BOOST_FIXTURE_TEST_CASE( algorithm_2_new_map, bluetoe::link_layer::channel_map )
+{
+    BOOST_REQUIRE( reset_algorithm_2( all_channel_map, sample_access_address ) );
+    BOOST_REQUIRE( reset( sample_data_2_map ) );
+    BOOST_CHECK( algorithm_2() );
+
+    BOOST_CHECK_EQUAL( data_channel( 6, 6 ), 23u );
+    BOOST_CHECK_EQUAL( data_channel( 7, 7 ), 9u );
+    BOOST_CHECK_EQUAL( data_channel( 8, 8 ), 34u );
+}
+
+BOOST_FIXTURE_TEST_CASE( algorithm_2_uses_only_channels_from_the_map, bluetoe::link_layer::channel_map )
+{
+    BOOST_REQUIRE( reset_algorithm_2( only_two_channels_map, sample_access_address ) );
+
+    for ( unsigned counter = 0; counter != 0x10000; ++counter )
+    {
+        const unsigned channel = data_channel( 0, static_cast< std::uint16_t >( counter ) );
+        BOOST_REQUIRE( channel == 0 || channel == 36 );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( algorithm_2_invalid_maps_are_recognized, bluetoe::link_layer::channel_map )
+{
+    BOOST_CHECK( !reset_algorithm_2( only_one_channel_and_some_rfu_bits_map, sample_access_address ) );
+    BOOST_CHECK( !algorithm_2() );
+}
+
+BOOST_FIXTURE_TEST_CASE( reset_with_hop_selects_algorithm_1, bluetoe::link_layer::channel_map )
+{
+    BOOST_REQUIRE( reset_algorithm_2( all_channel_map, sample_access_address ) );
+    BOOST_REQUIRE( reset( all_channel_map, 5 ) );
+
+    BOOST_CHECK( !algorithm_2() );
+    BOOST_CHECK_EQUAL( data_channel( 0, 0 ), 5u );
+}
@@ -133,6 +133,11 @@ public:
     }
 
     void ll_pdu( std::uint8_t llid, std::initializer_list< std::uint8_t > control )
+    {
+        ll_pdu( llid, std::vector< std::uint8_t >( control ) );
+    }
+
+    void ll_pdu( std::uint8_t llid, const std::vector< std::uint8_t >& control )
     {
         std::vector< std::uint8_t > pdu = {
             static_cast< std::uint8_t >( llid | sequence_ | next_expected_sequence_ ),
@@ -0,0 +1,314 @@
+#include <bluetoe/connection_event_scheduler.hpp>
+
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+using bluetoe::link_layer::delta_time;
+
+namespace {
+    struct scheduler : bluetoe::link_layer::details::connection_event_scheduler< 3 >
+    {
+        using type = activity_type;
+
+        void check_next( activity_type expected_type, std::size_t expected_connection, std::uint32_t expected_start )
+        {
+            const activity next = next_activity();
+
+            BOOST_CHECK( next.type == expected_type );
+            BOOST_CHECK_EQUAL( next.connection, expected_connection );
+            BOOST_CHECK_EQUAL( next.start.usec(), expected_start );
+        }
+
+        // schedules the next activity and simulates, that a connection event was received at the start of the window
+        void receive_next()
+        {
+            const activity next = next_activity();
+            BOOST_REQUIRE( next.type == activity_type::connection_event );
+
+            activity_scheduled( next );
+            connection_event_closed( delta_time() );
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( idle_by_default, scheduler )
+{
+    BOOST_CHECK( next_activity().type == type::idle );
+}
+
+BOOST_FIXTURE_TEST_CASE( earliest_connection_event_first, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_event( 0, delta_time( 20000 ), delta_time( 20100 ) );
+    connection_event( 1, delta_time( 10000 ), delta_time( 10100 ) );
+
+    check_next( type::connection_event, 1, 10000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( windows_are_relative_to_the_last_anchor_of_the_connection, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_event( 0, delta_time( 20000 ), delta_time( 20100 ) );
+    connection_event( 1, delta_time( 10000 ), delta_time( 10100 ) );
+
+    // T0 moves to the anchor of connection 1
+    receive_next();
+    check_next( type::connection_event, 0, 10000 );
+
+    connection_event( 1, delta_time( 30000 ), delta_time( 30100 ) );
+    receive_next();
+
+    // 10ms elapsed since the last anchor of connection 1
+    check_next( type::connection_event, 1, 20000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( timeout_keeps_the_anchor, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 20000 ), delta_time( 20100 ) );
+
+    activity_scheduled( next_activity() );
+    connection_event_timeout();
+
+    check_next( type::connection_event, 1, 20000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( overlapping_connection_event_is_missed, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 10500 ), delta_time( 10600 ) );
+
+    receive_next();
+
+    check_next( type::missed_connection_event, 1, 0 );
+    activity_scheduled( next_activity() );
+
+    BOOST_CHECK( next_activity().type == type::idle );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_fits_in_before_connection_event, scheduler )
+{
+    add_connection( 0 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    request_advertising( delta_time( 5000 ) );
+
+    check_next( type::advertising, 3, 5000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_is_delayed_after_connection_event, scheduler )
+{
+    add_connection( 0 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    request_advertising( delta_time( 9000 ) );
+
+    check_next( type::connection_event, 0, 10000 );
+    receive_next();
+
+    // T0 moved by 10ms, so advertising is due now, but the radio is busy with the connection event
+    check_next( type::advertising, 3, bluetoe::link_layer::details::connection_event_scheduler< 3 >::connection_event_slot_us );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_is_delayed_by_the_connection_event_length, scheduler )
+{
+    add_connection( 0 );
+    connection_event_length( 0, delta_time( 4540 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    request_advertising( delta_time( 9000 ) );
+
+    receive_next();
+
+    check_next( type::advertising, 3, 4540 );
+}
+
+BOOST_FIXTURE_TEST_CASE( connection_event_length_is_at_least_a_slot, scheduler )
+{
+    add_connection( 0 );
+    connection_event_length( 0, delta_time( 500 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    request_advertising( delta_time( 9000 ) );
+
+    receive_next();
+
+    check_next( type::advertising, 3, bluetoe::link_layer::details::connection_event_scheduler< 3 >::connection_event_slot_us );
+}
+
+BOOST_FIXTURE_TEST_CASE( long_connection_event_overlaps_the_next_connection_event, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_event_length( 0, delta_time( 4540 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 12000 ), delta_time( 12100 ) );
+
+    receive_next();
+
+    check_next( type::missed_connection_event, 1, 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_moves_the_anchor, scheduler )
+{
+    add_connection( 0 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    request_advertising( delta_time( 2000 ) );
+
+    activity_scheduled( next_activity() );
+    BOOST_CHECK( !advertising_requested() );
+
+    check_next( type::connection_event, 0, 8000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( removed_connection_is_not_scheduled, scheduler )
+{
+    add_connection( 0 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    remove_connection( 0 );
+
+    BOOST_CHECK( next_activity().type == type::idle );
+}
+
+BOOST_FIXTURE_TEST_CASE( predicts_anchors_from_the_connection_interval, scheduler )
+{
+    add_connection( 0 );
+    connection_parameters( 0, delta_time( 30000 ), 0, delta_time( 720000 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+
+    BOOST_CHECK_EQUAL( predicted_anchor( 0, 0 ).usec(), 10000u );
+    BOOST_CHECK_EQUAL( predicted_anchor( 0, 3 ).usec(), 100000u );
+
+    request_advertising( delta_time( 2000 ) );
+    activity_scheduled( next_activity() );
+
+    BOOST_CHECK_EQUAL( predicted_anchor( 0, 1 ).usec(), 38000u );
+}
+
+BOOST_FIXTURE_TEST_CASE( predicts_the_latest_anchor_from_the_slave_latency, scheduler )
+{
+    add_connection( 0 );
+    connection_parameters( 0, delta_time( 30000 ), 2, delta_time( 720000 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+
+    BOOST_CHECK_EQUAL( latest_anchor( 0 ).usec(), 70000u );
+
+    // after skipping an event, only one more event can be skipped
+    activity_scheduled( activity{ type::missed_connection_event, 0, delta_time(), delta_time() } );
+    connection_event( 0, delta_time( 40000 ), delta_time( 40100 ) );
+
+    BOOST_CHECK_EQUAL( latest_anchor( 0 ).usec(), 70000u );
+}
+
+BOOST_FIXTURE_TEST_CASE( colliding_connection_with_the_later_latest_anchor_is_skipped, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_parameters( 0, delta_time( 30000 ), 1, delta_time( 720000 ) );
+    connection_parameters( 1, delta_time( 30000 ), 3, delta_time( 100000 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 10500 ), delta_time( 10600 ) );
+
+    // both can skip, but connection 1 can wait longer, although it is closer to its supervision timeout
+    check_next( type::connection_event, 0, 10000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( colliding_connection_closer_to_supervision_timeout_wins, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_parameters( 0, delta_time( 30000 ), 0, delta_time( 720000 ) );
+    connection_parameters( 1, delta_time( 30000 ), 0, delta_time( 100000 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 10500 ), delta_time( 10600 ) );
+
+    // connection 0 has more time left and is skipped, although its window is earlier
+    check_next( type::missed_connection_event, 0, 0 );
+    activity_scheduled( next_activity() );
+
+    check_next( type::connection_event, 1, 10500 );
+}
+
+BOOST_FIXTURE_TEST_CASE( earliest_colliding_connection_wins_without_parameters, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 10500 ), delta_time( 10600 ) );
+
+    check_next( type::connection_event, 0, 10000 );
+}
+
+BOOST_FIXTURE_TEST_CASE( connection_with_slave_latency_is_skipped_first, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_parameters( 0, delta_time( 30000 ), 2, delta_time( 100000 ) );
+    connection_parameters( 1, delta_time( 30000 ), 0, delta_time( 720000 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+    connection_event( 1, delta_time( 10500 ), delta_time( 10600 ) );
+
+    check_next( type::missed_connection_event, 0, 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE( colliding_connections_take_turns, scheduler )
+{
+    add_connection( 0 );
+    add_connection( 1 );
+    connection_parameters( 0, delta_time( 30000 ), 0, delta_time( 300000 ) );
+    connection_parameters( 1, delta_time( 30000 ), 0, delta_time( 300000 ) );
+
+    // windows relative to the last anchor of the connection
+    std::uint32_t window_start[ 2 ] = { 10000, 10500 };
+    connection_event( 0, delta_time( window_start[ 0 ] ), delta_time( window_start[ 0 ] + 100 ) );
+    connection_event( 1, delta_time( window_start[ 1 ] ), delta_time( window_start[ 1 ] + 100 ) );
+
+    for ( int event = 0; event != 20; ++event )
+    {
+        const activity next = next_activity();
+        activity_scheduled( next );
+
+        if ( next.type == type::connection_event )
+        {
+            connection_event_closed( delta_time() );
+            window_start[ next.connection ] = 30000;
+        }
+        else
+        {
+            BOOST_REQUIRE( next.type == type::missed_connection_event );
+            window_start[ next.connection ] += 30000;
+        }
+
+        connection_event( next.connection, delta_time( window_start[ next.connection ] ), delta_time( window_start[ next.connection ] + 100 ) );
+    }
+
+    BOOST_CHECK_EQUAL( utilisation( 0 ).scheduled_events + utilisation( 0 ).skipped_events
+                     + utilisation( 1 ).scheduled_events + utilisation( 1 ).skipped_events, 20u );
+    BOOST_CHECK_GE( utilisation( 0 ).scheduled_events, 4u );
+    BOOST_CHECK_GE( utilisation( 1 ).scheduled_events, 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( reports_reserved_radio_time, scheduler )
+{
+    add_connection( 0 );
+    connection_parameters( 0, delta_time( 30000 ), 0, delta_time( 720000 ) );
+    connection_event( 0, delta_time( 10000 ), delta_time( 10100 ) );
+
+    BOOST_CHECK_EQUAL( utilisation( 0 ).reserved_per_mille, 42u );
+
+    receive_next();
+
+    BOOST_CHECK_EQUAL( utilisation( 0 ).scheduled_events, 1u );
+    BOOST_CHECK_EQUAL( utilisation( 0 ).skipped_events, 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( reserved_radio_time_follows_the_connection_event_length, scheduler )
+{
+    add_connection( 0 );
+    connection_parameters( 0, delta_time( 30000 ), 0, delta_time( 720000 ) );
+    connection_event_length( 0, delta_time( 4540 ) );
+
+    BOOST_CHECK_EQUAL( utilisation( 0 ).reserved_per_mille, 152u );
+}
@@ -0,0 +1,103 @@
+#include <bluetoe/l2cap_reassembly_buffer.hpp>
+
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+    struct buffer : bluetoe::link_layer::details::l2cap_reassembly_buffer< 4 + 10 >
+    {
+        void start( std::initializer_list< std::uint8_t > fragment )
+        {
+            const std::vector< std::uint8_t > data( fragment );
+            l2cap_reassembly_buffer::start( data.data(), data.data() + data.size() );
+        }
+
+        bool add( std::initializer_list< std::uint8_t > fragment )
+        {
+            const std::vector< std::uint8_t > data( fragment );
+            return l2cap_reassembly_buffer::add( data.data(), data.data() + data.size() );
+        }
+
+        void check_pdu( std::initializer_list< std::uint8_t > expected )
+        {
+            BOOST_REQUIRE( complete() );
+            BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), pdu(), pdu() + expected.size() );
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_buffer_is_not_complete, buffer )
+{
+    BOOST_CHECK( !complete() );
+}
+
+BOOST_FIXTURE_TEST_CASE( start_fragment_is_not_complete, buffer )
+{
+    start( { 0x05, 0x00, 0x04, 0x00, 0x12, 0x03 } );
+    BOOST_CHECK( !complete() );
+}
+
+BOOST_FIXTURE_TEST_CASE( reassemble_two_fragments, buffer )
+{
+    start( { 0x05, 0x00, 0x04, 0x00, 0x12, 0x03 } );
+    BOOST_CHECK( add( { 0x00, 0x01, 0x02 } ) );
+
+    check_pdu( { 0x05, 0x00, 0x04, 0x00, 0x12, 0x03, 0x00, 0x01, 0x02 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( reassemble_three_fragments, buffer )
+{
+    start( { 0x05, 0x00, 0x04, 0x00 } );
+    BOOST_CHECK( add( { 0x12, 0x03 } ) );
+    BOOST_CHECK( !complete() );
+    BOOST_CHECK( add( { 0x00, 0x01, 0x02 } ) );
+
+    check_pdu( { 0x05, 0x00, 0x04, 0x00, 0x12, 0x03, 0x00, 0x01, 0x02 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( largest_pdu, buffer )
+{
+    start( { 0x0A, 0x00, 0x04, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04 } );
+    BOOST_CHECK( add( { 0x05, 0x06, 0x07, 0x08, 0x09 } ) );
+
+    check_pdu( { 0x0A, 0x00, 0x04, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( too_large_pdu_is_dropped, buffer )
+{
+    start( { 0x0B, 0x00, 0x04, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04 } );
+    BOOST_CHECK( add( { 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A } ) );
+    BOOST_CHECK( !complete() );
+}
+
+BOOST_FIXTURE_TEST_CASE( continuation_without_start_is_ignored, buffer )
+{
+    BOOST_CHECK( add( { 0x05, 0x06 } ) );
+    BOOST_CHECK( !complete() );
+}
+
+BOOST_FIXTURE_TEST_CASE( fragment_exceeding_the_announced_size, buffer )
+{
+    start( { 0x03, 0x00, 0x04, 0x00, 0x02 } );
+    BOOST_CHECK( !add( { 0x17, 0x00, 0x00 } ) );
+    BOOST_CHECK( !complete() );
+}
+
+BOOST_FIXTURE_TEST_CASE( new_start_discards_the_current_pdu, buffer )
+{
+    start( { 0x05, 0x00, 0x04, 0x00, 0x12, 0x03 } );
+    start( { 0x03, 0x00, 0x04, 0x00, 0x02 } );
+    BOOST_CHECK( add( { 0x17, 0x00 } ) );
+
+    check_pdu( { 0x03, 0x00, 0x04, 0x00, 0x02, 0x17, 0x00 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( reset_discards_the_current_pdu, buffer )
+{
+    start( { 0x03, 0x00, 0x04, 0x00, 0x02 } );
+    reset();
+    BOOST_CHECK( add( { 0x17, 0x00 } ) );
+    BOOST_CHECK( !complete() );
+}
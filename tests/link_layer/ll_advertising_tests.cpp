@@ -262,6 +262,18 @@ BOOST_FIXTURE_TEST_CASE( txadd_and_rxadd_bits_are_set_corretly_for_random_addres
     );
 }
 
+BOOST_FIXTURE_TEST_CASE( chsel_bit_is_set, advertising )
+{
+    check_scheduling(
+        [&]( const test::advertising_data& data )
+        {
+            const auto& pdu = data.transmitted_data;
+            return pdu.size() >= 1 && ( pdu[ 0 ] & 0x20 ) != 0;
+        },
+        "chsel_bit_is_set"
+    );
+}
+
 BOOST_FIXTURE_TEST_CASE( length_field_is_set_corretly, advertising )
 {
     check_scheduling(
@@ -231,6 +231,135 @@ BOOST_FIXTURE_TEST_CASE( channel_map_request_within_timeout, channel_map_request
     }
 }
 
+void add_phy_update_indication( unconnected& c, std::uint8_t m_to_s_phy, std::uint8_t s_to_m_phy, std::uint16_t instance )
+{
+    c.ll_control_pdu( {
+        0x18,                                                   // opcode
+        m_to_s_phy,
+        s_to_m_phy,
+        static_cast< std::uint8_t >( instance >> 0 ),           // instance
+        static_cast< std::uint8_t >( instance >> 8 )
+    } );
+}
+
+template < std::uint8_t MasterToSlave, std::uint8_t SlaveToMaster, std::uint16_t Instance = 6, unsigned EmptyPDUs = Instance + 2 >
+struct connect_and_phy_update_base : unconnected
+{
+    connect_and_phy_update_base()
+    {
+        respond_to( 37, valid_connection_request_pdu );
+        add_phy_update_indication( *this, MasterToSlave, SlaveToMaster, Instance );
+        add_empty_pdus( *this, EmptyPDUs );
+
+        run();
+    }
+};
+
+using phy_update_to_2m = connect_and_phy_update_base< 0x02, 0x02 >;
+
+/*
+ * The new PHY is used, starting with the connection event with the given instance
+ */
+BOOST_FIXTURE_TEST_CASE( phy_update, phy_update_to_2m )
+{
+    for ( unsigned i = 0; i != 6; ++i )
+    {
+        BOOST_CHECK_EQUAL( connection_events().at( i ).receive_phy, bluetoe::link_layer::details::phy_ll_encoding::le_1m_phy );
+        BOOST_CHECK_EQUAL( connection_events().at( i ).transmit_phy, bluetoe::link_layer::details::phy_ll_encoding::le_1m_phy );
+    }
+
+    for ( unsigned i = 6; i != 8; ++i )
+    {
+        BOOST_CHECK_EQUAL( connection_events().at( i ).receive_phy, bluetoe::link_layer::details::phy_ll_encoding::le_2m_phy );
+        BOOST_CHECK_EQUAL( connection_events().at( i ).transmit_phy, bluetoe::link_layer::details::phy_ll_encoding::le_2m_phy );
+    }
+}
+
+/*
+ * Two empty PDUs and T_IFS: 2 * 80µs + 150µs on the LE 1M PHY and 2 * 44µs + 150µs on the LE 2M PHY
+ */
+BOOST_FIXTURE_TEST_CASE( phy_update_reduces_air_time, phy_update_to_2m )
+{
+    BOOST_CHECK_EQUAL( connection_events().at( 5 ).air_time, bluetoe::link_layer::delta_time( 310u ) );
+    BOOST_CHECK_EQUAL( connection_events().at( 6 ).air_time, bluetoe::link_layer::delta_time( 238u ) );
+}
+
+using asymmetric_phy_update = connect_and_phy_update_base< 0x02, 0x00 >;
+
+BOOST_FIXTURE_TEST_CASE( phy_update_in_one_direction, asymmetric_phy_update )
+{
+    BOOST_CHECK_EQUAL( connection_events().at( 6 ).receive_phy, bluetoe::link_layer::details::phy_ll_encoding::le_2m_phy );
+    BOOST_CHECK_EQUAL( connection_events().at( 6 ).transmit_phy, bluetoe::link_layer::details::phy_ll_encoding::le_1m_phy );
+}
+
+using phy_update_without_change = connect_and_phy_update_base< 0x00, 0x00, 0xffff, 20 >;
+
+/*
+ * If no PHY changes, the instant is not valid and thus not checked
+ */
+BOOST_FIXTURE_TEST_CASE( phy_update_without_change_ignores_the_instant, phy_update_without_change )
+{
+    BOOST_CHECK_GT( connection_events().size(), 20u );
+    BOOST_CHECK_EQUAL( connection_events().at( 10 ).receive_phy, bluetoe::link_layer::details::phy_ll_encoding::le_1m_phy );
+}
+
+using phy_update_instance_in_past = connect_and_phy_update_base< 0x02, 0x02, 0xffff, 20 >;
+
+BOOST_FIXTURE_TEST_CASE( phy_update_with_instance_in_past, phy_update_instance_in_past )
+{
+    BOOST_CHECK_EQUAL( connection_events().size(), 1u );
+}
+
+static const std::initializer_list< std::uint8_t > connection_request_with_chsel_pdu =
+{
+    0xe5, 0x22,                         // header with ChSel set
+    0x3c, 0x1c, 0x62, 0x92, 0xf0, 0x48, // InitA: 48:f0:92:62:1c:3c (random)
+    0x47, 0x11, 0x08, 0x15, 0x0f, 0xc0, // AdvA:  c0:0f:15:08:11:47 (random)
+    0x5a, 0xb3, 0x9a, 0xaf,             // Access Address
+    0x08, 0x81, 0xf6,                   // CRC Init
+    0x03,                               // transmit window size
+    0x0b, 0x00,                         // window offset
+    0x18, 0x00,                         // interval (30ms)
+    0x00, 0x00,                         // slave latency
+    0x48, 0x00,                         // connection timeout (720ms)
+    0xff, 0xff, 0xff, 0xff, 0x1f,       // used channel map
+    0xaa                                // hop increment and sleep clock accuracy (10 and 50ppm)
+};
+
+/*
+ * With ChSel set in the connection request, channel selection algorithm #2 is used
+ */
+BOOST_FIXTURE_TEST_CASE( channel_selection_algorithm_2, unconnected )
+{
+    respond_to( 37, connection_request_with_chsel_pdu );
+    add_empty_pdus( *this, 8 );
+    run();
+
+    static constexpr unsigned expected_hop_sequence[] = {
+        22, 2, 9, 13, 11, 34, 14, 6
+    };
+
+    for ( unsigned i = 0; i != sizeof( expected_hop_sequence ) / sizeof( expected_hop_sequence[ 0 ] ); ++i )
+    {
+        BOOST_CHECK_EQUAL( connection_events().at( i ).channel, expected_hop_sequence[ i ] );
+    }
+}
+
+/*
+ * Channel 34 is removed with the channel map request and remapped to channel 22 in connection event 5
+ */
+BOOST_FIXTURE_TEST_CASE( channel_selection_algorithm_2_and_channel_map_request, unconnected )
+{
+    respond_to( 37, connection_request_with_chsel_pdu );
+    add_channel_map_request( *this, 4, 0x1bffffffff );
+    add_empty_pdus( *this, 8 );
+    run();
+
+    BOOST_CHECK_EQUAL( connection_events().at( 4 ).channel, 11u );
+    BOOST_CHECK_EQUAL( connection_events().at( 5 ).channel, 22u );
+    BOOST_CHECK_EQUAL( connection_events().at( 6 ).channel, 14u );
+}
+
 struct channel_map_request_after_connection_count_wrap_fixture : unconnected
 {
     channel_map_request_after_connection_count_wrap_fixture()
@@ -400,6 +529,133 @@ BOOST_FIXTURE_TEST_CASE( connection_update_request_invalid_instance, unconnected
     BOOST_CHECK_EQUAL( connection_events().size(), 1u );
 }
 
+namespace {
+    // number of connection events from the event with the first L2CAP PDU from the master, till the first L2CAP PDU from the slave
+    std::size_t l2cap_response_delay( const std::vector< test::connection_event >& events )
+    {
+        const auto is_l2cap = []( const test::pdu_t& pdu ) {
+            return pdu.size() > 2 && ( pdu[ 0 ] & 0x03 ) == 0x02;
+        };
+
+        std::size_t request  = events.size();
+        std::size_t response = events.size();
+
+        for ( std::size_t event = 0; event != events.size() && response == events.size(); ++event )
+        {
+            for ( const auto& pdu : events[ event ].received_data )
+                request = is_l2cap( pdu ) && request == events.size() ? event : request;
+
+            if ( std::any_of( events[ event ].transmitted_data.begin(), events[ event ].transmitted_data.end(), is_l2cap ) )
+                response = event;
+        }
+
+        BOOST_REQUIRE_LT( response, events.size() );
+
+        return response - request;
+    }
+}
+
+/*
+ * While the connection update is pending until connection event 8, ATT requests are answered without delay
+ */
+BOOST_FIXTURE_TEST_CASE( data_is_handled_while_connection_update_is_pending, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    add_connection_update_request( 5, 6, 40, 1, 200, 8 );
+    ll_data_pdu( { 0x03, 0x00, 0x04, 0x00, 0x02, 0x17, 0x00 } );
+    add_empty_pdus( *this, 20 );
+
+    run();
+
+    BOOST_CHECK_EQUAL( l2cap_response_delay( connection_events() ), 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE( data_is_handled_while_channel_map_request_is_pending, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    add_channel_map_request( *this, 8, 0x1555555555 );
+    ll_data_pdu( { 0x03, 0x00, 0x04, 0x00, 0x02, 0x17, 0x00 } );
+    add_empty_pdus( *this, 20 );
+
+    run();
+
+    BOOST_CHECK_EQUAL( l2cap_response_delay( connection_events() ), 1u );
+}
+
+/*
+ * channel map request with instant 5 and connection update with instant 7 are pending at the same time
+ */
+BOOST_FIXTURE_TEST_CASE( channel_map_request_and_connection_update_pending, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    add_channel_map_request( *this, 5, 0x1555555555 );
+    add_connection_update_request( 5, 6, 40, 1, 200, 7 );
+    add_empty_pdus( *this, 20 );
+
+    run();
+
+    BOOST_REQUIRE_GT( connection_events().size(), 10u );
+
+    // only even channels are used from event 5 on
+    for ( std::size_t event = 5; event != 10; ++event )
+        BOOST_CHECK_EQUAL( connection_events()[ event ].channel % 2, 0u );
+
+    // new connection interval of 50ms after event 7
+    const bluetoe::link_layer::delta_time event_start( 50000 );
+
+    BOOST_CHECK_EQUAL( connection_events()[ 8 ].start_receive, event_start - event_start.ppm( 550 ) );
+}
+
+namespace {
+    // index of the first connection event, in which an LL control PDU with the given opcode was received / transmitted
+    std::size_t ll_control_event( const std::vector< test::connection_event >& events, std::uint8_t opcode, bool transmitted )
+    {
+        for ( std::size_t event = 0; event != events.size(); ++event )
+        {
+            const auto& pdus = transmitted ? events[ event ].transmitted_data : events[ event ].received_data;
+
+            if ( std::any_of( pdus.begin(), pdus.end(), [opcode]( const test::pdu_t& pdu ) {
+                    return pdu.size() > 2 && ( pdu[ 0 ] & 0x03 ) == 0x03 && pdu[ 2 ] == opcode;
+                } ) )
+                return event;
+        }
+
+        return events.size();
+    }
+}
+
+/*
+ * Channel map request (instant 8) and connection update (instant 10) are pending, while three LL control
+ * requests are received. Every request is answered in the connection event following the request, and not
+ * only after the instants.
+ */
+BOOST_FIXTURE_TEST_CASE( ll_control_requests_are_answered_while_procedures_are_pending, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    add_channel_map_request( *this, 8, 0x1555555555 );
+    add_connection_update_request( 5, 6, 40, 1, 200, 10 );
+    ll_control_pdu( { 0x12 } );                                                         // LL_PING_REQ
+    ll_control_pdu( { 0x08, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } );        // LL_FEATURE_REQ
+    ll_control_pdu( { 0x0C, 0x09, 0x69, 0x02, 0x00, 0x00 } );                           // LL_VERSION_IND
+    add_empty_pdus( *this, 20 );
+
+    run();
+
+    const auto& events = connection_events();
+
+    const std::size_t ping_req    = ll_control_event( events, 0x12, false );
+    const std::size_t feature_req = ll_control_event( events, 0x08, false );
+    const std::size_t version_ind = ll_control_event( events, 0x0C, false );
+
+    BOOST_REQUIRE_LT( version_ind, events.size() );
+    BOOST_CHECK_EQUAL( ll_control_event( events, 0x13, true ) - ping_req, 1u );
+    BOOST_CHECK_EQUAL( ll_control_event( events, 0x09, true ) - feature_req, 1u );
+    BOOST_CHECK_EQUAL( ll_control_event( events, 0x0C, true ) - version_ind, 1u );
+
+    // all requests are answered, 5 connection events after the first pending procedure was received
+    BOOST_CHECK_EQUAL( ll_control_event( events, 0x0C, true ) - ll_control_event( events, 0x01, false ), 5u );
+}
+
 BOOST_FIXTURE_TEST_CASE( response_to_an_feature_request, unconnected )
 {
     respond_to( 37, valid_connection_request_pdu );
@@ -417,7 +673,30 @@ BOOST_FIXTURE_TEST_CASE( response_to_an_feature_request, unconnected )
     static const std::uint8_t expected_response[] = {
         0x03, 0x09,
         0x09,
-        0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( std::begin( response ), std::end( response ), std::begin( expected_response ), std::end( expected_response ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( response_to_an_feature_request_with_2m_phy_and_csa_2, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_control_pdu({
+        0x08,
+        0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    });
+    ll_empty_pdu();
+
+    run();
+
+    auto response = connection_events().at( 1 ).transmitted_data.at( 0 );
+    response[ 0 ] &= 0x03;
+
+    static const std::uint8_t expected_response[] = {
+        0x03, 0x09,
+        0x09,
+        0x32, 0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
 
     BOOST_CHECK_EQUAL_COLLECTIONS( std::begin( response ), std::end( response ), std::begin( expected_response ), std::end( expected_response ) );
@@ -104,3 +104,114 @@ BOOST_FIXTURE_TEST_CASE( do_not_respond_to_UNKNOWN_RSP_even_if_broken, unconnect
         "do_not_respond_to_UNKNOWN_RSP"
     );
 }
+
+BOOST_FIXTURE_TEST_CASE( respond_to_a_length_request, unconnected )
+{
+    check_single_ll_control_pdu(
+        {
+            0x03, 0x09,
+            0x14,               // LL_LENGTH_REQ
+            0xFB, 0x00,         // MaxRxOctets
+            0x48, 0x08,         // MaxRxTime
+            0xFB, 0x00,         // MaxTxOctets
+            0x48, 0x08          // MaxTxTime
+        },
+        {
+            0x03, 0x09,
+            0x15,               // LL_LENGTH_RSP
+            0x1B, 0x00,         // MaxRxOctets: the default test buffers are too small for larger PDUs
+            0x48, 0x01,         // MaxRxTime
+            0x1B, 0x00,         // MaxTxOctets
+            0x48, 0x01          // MaxTxTime
+        },
+        "respond_to_a_length_request"
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE( do_not_respond_to_a_length_response, unconnected )
+{
+    check_single_ll_control_pdu(
+        {
+            0x03, 0x09,
+            0x15,               // LL_LENGTH_RSP
+            0xFB, 0x00,
+            0x48, 0x08,
+            0xFB, 0x00,
+            0x48, 0x08
+        },
+        {
+            0x01, 0x00
+        },
+        "do_not_respond_to_a_length_response"
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE( length_request_with_invalid_size, unconnected )
+{
+    check_single_ll_control_pdu(
+        {
+            0x03, 0x05,
+            0x14,               // LL_LENGTH_REQ
+            0xFB, 0x00,
+            0x48, 0x08
+        },
+        {
+            0x03, 0x02,
+            0x07, 0x14
+        },
+        "length_request_with_invalid_size"
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE( respond_to_a_phy_request, unconnected )
+{
+    check_single_ll_control_pdu(
+        {
+            0x03, 0x03,
+            0x16,               // LL_PHY_REQ
+            0x07,               // TX_PHYS: 1M, 2M, coded
+            0x07                // RX_PHYS: 1M, 2M, coded
+        },
+        {
+            0x03, 0x03,
+            0x17,               // LL_PHY_RSP
+            0x03,               // TX_PHYS: 1M, 2M
+            0x03                // RX_PHYS: 1M, 2M
+        },
+        "respond_to_a_phy_request"
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE( phy_request_with_invalid_size, unconnected )
+{
+    check_single_ll_control_pdu(
+        {
+            0x03, 0x02,
+            0x16,               // LL_PHY_REQ
+            0x03
+        },
+        {
+            0x03, 0x02,
+            0x07, 0x16
+        },
+        "phy_request_with_invalid_size"
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE( phy_update_to_an_unsupported_phy, unconnected )
+{
+    check_single_ll_control_pdu(
+        {
+            0x03, 0x05,
+            0x18,               // LL_PHY_UPDATE_IND
+            0x04,               // M_TO_S_PHY: coded
+            0x00,               // S_TO_M_PHY: unchanged
+            0x08, 0x00          // Instant
+        },
+        {
+            0x03, 0x02,
+            0x07, 0x18
+        },
+        "phy_update_to_an_unsupported_phy"
+    );
+}
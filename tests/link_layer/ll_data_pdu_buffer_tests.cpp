@@ -1,6 +1,7 @@
 #include <iostream>
 #include <buffer_io.hpp>
 #include <bluetoe/ll_data_pdu_buffer.hpp>
+#include <bluetoe/pdu_slab_storage.hpp>
 
 #define BOOST_TEST_MODULE
 #include <boost/test/included/unit_test.hpp>
@@ -10,6 +11,8 @@
 #include <random>
 #include <tuple>
 #include <type_traits>
+#include <thread>
+#include <atomic>
 
 #include "buffer_io.hpp"
 
@@ -101,6 +104,37 @@ struct running_mode_impl : Radio< TransmitSize, ReceiveSize >
         transmit_pdu( std::begin( pdu ), std::end( pdu ) );
     }
 
+    // transmits an L2CAP PDU of the given size, filled with ascending numbers
+    void transmit_l2cap_pdu( std::size_t size )
+    {
+        auto buffer = this->allocate_l2cap_transmit_buffer( size );
+        BOOST_REQUIRE( buffer.size );
+        BOOST_REQUIRE_GE( this->l2cap_transmit_size( buffer ), size );
+
+        std::uint8_t* const body = layout::body( buffer ).first;
+
+        for ( std::size_t i = 0; i != size; ++i )
+            body[ i ] = static_cast< std::uint8_t >( i );
+
+        this->commit_l2cap_transmit_buffer( buffer, size );
+    }
+
+    // checks the next PDU to be transmitted and acknowledges it
+    void check_and_acknowledge_fragment( std::uint8_t llid, std::size_t first, std::size_t size, bool sequence_number )
+    {
+        const auto pdu  = this->next_transmit();
+        const auto body = layout::body( pdu ).first;
+
+        BOOST_CHECK_EQUAL( layout::header( pdu ) & 0x03, llid );
+        BOOST_REQUIRE_EQUAL( std::size_t( layout::header( pdu ) >> 8 ), size );
+
+        for ( std::size_t i = 0; i != size; ++i )
+            BOOST_CHECK_EQUAL( body[ i ], static_cast< std::uint8_t >( first + i ) );
+
+        const std::vector< std::uint8_t > empty;
+        receive_pdu( empty.begin(), empty.end(), sequence_number, !sequence_number );
+    }
+
     template < class Iter >
     void receive_pdu( Iter begin, Iter end, bool sn, bool nesn )
     {
@@ -542,6 +576,75 @@ BOOST_FIXTURE_TEST_CASE( getting_an_empty_pdu_must_not_result_in_changing_alloca
     BOOST_CHECK( std::find_if( trans.buffer, trans.buffer + trans.size, []( std::uint8_t b ) { return b != 0x22; } ) == trans.buffer + trans.size );
 }
 
+BOOST_FIXTURE_TEST_CASE( small_l2cap_pdu_is_not_fragmented, running_mode )
+{
+    transmit_l2cap_pdu( 27 );
+
+    check_and_acknowledge_fragment( 0x02, 0, 27, false );
+    BOOST_CHECK_EQUAL( next_transmit().size, 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( large_l2cap_pdu_is_fragmented, running_mode )
+{
+    transmit_l2cap_pdu( 40 );
+
+    BOOST_CHECK_EQUAL( next_transmit().buffer[ 0 ] & 0x10, 0x10 );
+    check_and_acknowledge_fragment( 0x02, 0, 27, false );
+    check_and_acknowledge_fragment( 0x01, 27, 13, true );
+    BOOST_CHECK_EQUAL( next_transmit().size, 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( l2cap_pdu_fragments_use_max_tx_size, running_mode )
+{
+    max_tx_size( 40 );
+    transmit_l2cap_pdu( 45 );
+
+    check_and_acknowledge_fragment( 0x02, 0, 38, false );
+    check_and_acknowledge_fragment( 0x01, 38, 7, true );
+}
+
+BOOST_FIXTURE_TEST_CASE( l2cap_pdu_is_limited_to_half_the_transmit_buffer, running_mode )
+{
+    const auto buffer = allocate_l2cap_transmit_buffer( 200 );
+
+    BOOST_CHECK_EQUAL( buffer.size, 49u );
+    BOOST_CHECK_EQUAL( l2cap_transmit_size( buffer ), 27u + 18u );
+}
+
+using small_running_mode = running_mode_impl< 40, 40, mock_radio >;
+
+BOOST_FIXTURE_TEST_CASE( l2cap_pdu_of_max_tx_size_is_always_allocatable, small_running_mode )
+{
+    const auto buffer = allocate_l2cap_transmit_buffer( 200 );
+
+    BOOST_CHECK_EQUAL( buffer.size, 29u );
+    BOOST_CHECK_EQUAL( l2cap_transmit_size( buffer ), 27u );
+}
+
+BOOST_FIXTURE_TEST_CASE( guaranteed_l2cap_transmit_size_fits_with_every_max_tx_size, running_mode )
+{
+    BOOST_CHECK_EQUAL( std::size_t{ guaranteed_l2cap_transmit_size }, 27u + 18u );
+
+    for ( std::size_t size = min_buffer_size; size <= max_max_tx_size(); ++size )
+    {
+        max_tx_size( size );
+        BOOST_CHECK_GE( l2cap_transmit_size( allocate_l2cap_transmit_buffer( 200 ) ), std::size_t{ guaranteed_l2cap_transmit_size } );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( fragmented_l2cap_pdus_wrap_around, running_mode )
+{
+    transmit_l2cap_pdu( 28 );
+
+    for ( int i = 0; i != 10; ++i )
+    {
+        transmit_l2cap_pdu( 28 );
+
+        check_and_acknowledge_fragment( 0x02, 0, 27, false );
+        check_and_acknowledge_fragment( 0x01, 27, 1, true );
+    }
+}
+
 // buffer with default sizes.
 struct default_buffer : mock_radio< 3 * 29, 3 * 29 >
 {
@@ -819,6 +922,15 @@ BOOST_AUTO_TEST_SUITE( layout_tests )
         BOOST_CHECK_EQUAL( next_transmit().size, 2u + 2u );
     }
 
+    BOOST_FIXTURE_TEST_CASE( fragmenting_l2cap_pdus, large_buffer_under_test )
+    {
+        transmit_l2cap_pdu( 60 );
+
+        check_and_acknowledge_fragment( 0x02, 0, 27, false );
+        check_and_acknowledge_fragment( 0x01, 27, 27, true );
+        check_and_acknowledge_fragment( 0x01, 54, 6, false );
+    }
+
     BOOST_FIXTURE_TEST_CASE( not_acknowlage_send_data, buffer_under_test )
     {
         static const std::uint8_t pattern_a[] = { 'a', 'b', 'c', 'd', 'e' };
@@ -910,3 +1022,282 @@ BOOST_AUTO_TEST_SUITE( packet_counter_tests )
     }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+template < std::size_t TransmitSize, std::size_t ReceiveSize >
+struct mock_slab_radio : bluetoe::link_layer::ll_data_pdu_buffer< TransmitSize, ReceiveSize, mock_slab_radio< TransmitSize, ReceiveSize >, bluetoe::link_layer::pdu_slab_storage >
+{
+    using lock_guard = ::lock_guard;
+
+    void increment_receive_packet_counter() {}
+
+    void increment_transmit_packet_counter() {}
+};
+
+/**
+ * The protocol is independent from the storage used; the pdu_slab_storage shares 8 slots of 29 bytes between both sides
+ */
+BOOST_AUTO_TEST_SUITE( slab_storage_tests )
+
+    using slab_running_mode = running_mode_impl< 4 * 29, 4 * 29, mock_slab_radio >;
+
+    BOOST_FIXTURE_TEST_CASE( slab_buffer_sizes, slab_running_mode )
+    {
+        BOOST_CHECK_EQUAL( max_max_tx_size(), 29u );
+        BOOST_CHECK_EQUAL( max_max_rx_size(), 29u );
+        BOOST_CHECK_EQUAL( allocate_receive_buffer().size, 29u );
+        BOOST_CHECK_EQUAL( allocate_transmit_buffer().size, 29u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( transmit_pdus_use_the_whole_arena, slab_running_mode )
+    {
+        for ( std::uint8_t pdu = 0; pdu != 7; ++pdu )
+            transmit_pdu( { pdu } );
+
+        // the last slot is left for receiving
+        BOOST_CHECK_EQUAL( allocate_transmit_buffer().size, 0u );
+        BOOST_CHECK_EQUAL( allocate_receive_buffer().size, 29u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( a_new_pdu_will_be_transmitted_if_the_last_was_acknowladged, slab_running_mode )
+    {
+        transmit_pdu( { 1 } );
+        transmit_pdu( { 2 } );
+
+        BOOST_CHECK_EQUAL( next_transmit().buffer[ 2 ], 1u );
+        BOOST_CHECK_EQUAL( next_transmit().buffer[ 0 ] & 0x10, 0x10 );
+
+        receive_pdu( { 0x17 }, false, true );
+
+        BOOST_CHECK_EQUAL( next_transmit().buffer[ 2 ], 2u );
+        BOOST_CHECK_EQUAL( next_transmit().buffer[ 0 ] & 0x10, 0 );
+        BOOST_CHECK_EQUAL( next_received().buffer[ 2 ], 0x17u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( large_l2cap_pdu_is_fragmented, slab_running_mode )
+    {
+        transmit_l2cap_pdu( 60 );
+
+        BOOST_CHECK_EQUAL( next_transmit().buffer[ 0 ] & 0x10, 0x10 );
+        check_and_acknowledge_fragment( 0x02, 0, 27, false );
+        check_and_acknowledge_fragment( 0x01, 27, 27, true );
+        check_and_acknowledge_fragment( 0x01, 54, 6, false );
+        BOOST_CHECK_EQUAL( next_transmit().size, 2u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( l2cap_pdu_is_limited_to_half_the_slots, slab_running_mode )
+    {
+        const auto buffer = allocate_l2cap_transmit_buffer( 200 );
+
+        BOOST_CHECK_EQUAL( buffer.size, 4u * 29u );
+        BOOST_CHECK_EQUAL( l2cap_transmit_size( buffer ), 4u * 27u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( guaranteed_l2cap_transmit_size_of_the_slots, slab_running_mode )
+    {
+        BOOST_CHECK_EQUAL( std::size_t{ guaranteed_l2cap_transmit_size }, 4u * 27u );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( fragmented_l2cap_pdus_in_a_filled_arena, slab_running_mode )
+    {
+        transmit_l2cap_pdu( 28 );
+
+        for ( int i = 0; i != 50; ++i )
+        {
+            // a received PDU occupies a slot, while the next L2CAP PDU is allocated
+            receive_pdu( { static_cast< std::uint8_t >( i ) }, false, false );
+            transmit_l2cap_pdu( 28 );
+
+            check_and_acknowledge_fragment( 0x02, 0, 27, false );
+            check_and_acknowledge_fragment( 0x01, 27, 1, true );
+
+            BOOST_REQUIRE( next_received().size );
+            BOOST_CHECK_EQUAL( next_received().buffer[ 2 ], i );
+            free_received();
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+/*
+ * The link layer and the radio exchange PDUs concurrently, without locking the radio
+ */
+BOOST_AUTO_TEST_SUITE( concurrent_access_tests )
+
+    class counting_lock_guard
+    {
+    public:
+        counting_lock_guard()
+        {
+            ++locks;
+        }
+
+        ~counting_lock_guard()
+        {
+        }
+
+        static std::atomic< unsigned > locks;
+
+    private:
+        counting_lock_guard( const counting_lock_guard& ) = delete;
+        counting_lock_guard& operator=( const counting_lock_guard& ) = delete;
+    };
+
+    std::atomic< unsigned > counting_lock_guard::locks( 0 );
+
+    struct concurrent_radio : bluetoe::link_layer::ll_data_pdu_buffer< 64, 64, concurrent_radio >
+    {
+        using lock_guard = counting_lock_guard;
+
+        void increment_receive_packet_counter() {}
+
+        void increment_transmit_packet_counter() {}
+
+        using bluetoe::link_layer::ll_data_pdu_buffer< 64, 64, concurrent_radio >::allocate_receive_buffer;
+        using bluetoe::link_layer::ll_data_pdu_buffer< 64, 64, concurrent_radio >::received;
+    };
+
+    using layout = bluetoe::link_layer::default_pdu_layout;
+
+    // messages of varying sizes, so that the rings wrap at different positions
+    std::size_t message_size( unsigned message )
+    {
+        return 4 + message % 24;
+    }
+
+    void write_message( std::uint8_t* body, unsigned message )
+    {
+        for ( std::size_t i = 0; i != message_size( message ); ++i )
+            body[ i ] = static_cast< std::uint8_t >( message + i );
+    }
+
+    bool check_message( const std::uint8_t* body, std::size_t size, unsigned message )
+    {
+        if ( size != message_size( message ) )
+            return false;
+
+        for ( std::size_t i = 0; i != size; ++i )
+        {
+            if ( body[ i ] != static_cast< std::uint8_t >( message + i ) )
+                return false;
+        }
+
+        return true;
+    }
+
+    /*
+     * A thread takes the place of the radio ISR and emulates a master, that sends a PDU and receives the
+     * response in every connection event. Both sides transmit a sequence of messages, that have to be received
+     * complete and in order. Only reset() is allowed to lock the radio.
+     */
+    BOOST_FIXTURE_TEST_CASE( link_layer_and_radio_exchange_pdus_without_locking, concurrent_radio )
+    {
+        static constexpr unsigned messages = 5000;
+
+        const unsigned locks = counting_lock_guard::locks;
+
+        std::atomic< bool > done( false );
+        unsigned            master_received = 0;
+        unsigned            master_errors   = 0;
+
+        std::thread radio( [&]{
+            bool     sn              = false;
+            bool     nesn            = false;
+            unsigned master_sent     = 0;
+
+            while ( !done || master_sent != messages || master_received != messages )
+            {
+                const auto pdu = allocate_receive_buffer();
+
+                // no room to receive, the master will retransmit
+                if ( pdu.empty() )
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                const bool        data = master_sent != messages;
+                const std::size_t size = data ? message_size( master_sent ) : 0;
+
+                layout::header( pdu, static_cast< std::uint16_t >( ( data ? 2 : 1 ) | ( sn ? 0x08 : 0 ) | ( nesn ? 0x04 : 0 ) | ( size << 8 ) ) );
+
+                if ( data )
+                    write_message( layout::body( pdu ).first, master_sent );
+
+                const auto response = received( pdu );
+                const std::uint16_t header = layout::header( response );
+
+                // PDU acknowledged?
+                if ( static_cast< bool >( header & 0x04 ) != sn )
+                {
+                    sn = !sn;
+
+                    if ( data )
+                        ++master_sent;
+                }
+
+                // new PDU from the slave?
+                if ( static_cast< bool >( header & 0x08 ) == nesn )
+                {
+                    nesn = !nesn;
+
+                    if ( header >> 8 )
+                    {
+                        if ( !check_message( layout::body( response ).first, header >> 8, master_received ) )
+                            ++master_errors;
+
+                        ++master_received;
+                    }
+                }
+            }
+        } );
+
+        unsigned slave_sent     = 0;
+        unsigned slave_received = 0;
+        unsigned slave_errors   = 0;
+
+        while ( slave_sent != messages || slave_received != messages )
+        {
+            bool idle = true;
+
+            if ( slave_sent != messages )
+            {
+                const std::size_t size = message_size( slave_sent );
+                const auto        pdu  = allocate_transmit_buffer( layout::data_channel_pdu_memory_size( size ) );
+
+                if ( !pdu.empty() )
+                {
+                    layout::header( pdu, static_cast< std::uint16_t >( 2 | ( size << 8 ) ) );
+                    write_message( layout::body( pdu ).first, slave_sent );
+                    commit_transmit_buffer( pdu );
+
+                    ++slave_sent;
+                    idle = false;
+                }
+            }
+
+            const auto pdu = next_received();
+
+            if ( !pdu.empty() )
+            {
+                if ( !check_message( layout::body( pdu ).first, layout::header( pdu ) >> 8, slave_received ) )
+                    ++slave_errors;
+
+                ++slave_received;
+                free_received();
+                idle = false;
+            }
+
+            if ( idle )
+                std::this_thread::yield();
+        }
+
+        done = true;
+        radio.join();
+
+        BOOST_CHECK_EQUAL( master_received, messages );
+        BOOST_CHECK_EQUAL( master_errors, 0u );
+        BOOST_CHECK_EQUAL( slave_errors, 0u );
+        BOOST_CHECK_EQUAL( counting_lock_guard::locks, locks );
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -31,3 +31,637 @@ BOOST_FIXTURE_TEST_CASE( response_to_att_request, unconnected )
 
     BOOST_CHECK_EQUAL_COLLECTIONS( std::begin( response ), std::end( response ), std::begin( expected_response ), std::end( expected_response ) );
 }
+
+namespace {
+    template < class LinkLayer >
+    std::vector< std::vector< std::uint8_t > > l2cap_output( const LinkLayer& link_layer )
+    {
+        std::vector< std::vector< std::uint8_t > > result;
+
+        for ( const auto& event : link_layer.connection_events() )
+        {
+            for ( auto pdu : event.transmitted_data )
+            {
+                if ( ( pdu[ 0 ] & 0x03 ) == 0x02 )
+                {
+                    pdu[ 0 ] &= 0x03;
+                    result.push_back( pdu.data );
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // all transmitted, not empty L2CAP fragments
+    template < class LinkLayer >
+    std::vector< std::vector< std::uint8_t > > l2cap_fragments( const LinkLayer& link_layer )
+    {
+        std::vector< std::vector< std::uint8_t > > result;
+
+        for ( const auto& event : link_layer.connection_events() )
+        {
+            for ( auto pdu : event.transmitted_data )
+            {
+                if ( ( pdu[ 0 ] & 0x03 ) != 0x03 && pdu[ 1 ] != 0 )
+                {
+                    pdu[ 0 ] &= 0x03;
+                    result.push_back( pdu.data );
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // concatenates the payload of the fragments and checks the fragment sizes
+    std::vector< std::uint8_t > reassemble( const std::vector< std::vector< std::uint8_t > >& fragments, std::size_t fragment_size )
+    {
+        std::vector< std::uint8_t > result;
+
+        for ( const auto& fragment : fragments )
+        {
+            BOOST_CHECK_EQUAL( fragment[ 0 ], result.empty() ? 0x02 : 0x01 );
+            BOOST_CHECK_LE( fragment[ 1 ], fragment_size );
+            BOOST_CHECK_EQUAL( fragment.size(), fragment[ 1 ] + 2u );
+
+            result.insert( result.end(), fragment.begin() + 2, fragment.end() );
+        }
+
+        return result;
+    }
+
+    std::uint8_t large_value[ 300 ];
+
+    using large_value_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x5678 >,
+                bluetoe::bind_characteristic_value< decltype( large_value ), &large_value >
+            >
+        >
+    >;
+
+    template < typename BufferSizes, std::size_t MTU = 517u >
+    struct large_mtu_base : unconnected_base_t< large_value_server, test::radio,
+        BufferSizes,
+        bluetoe::link_layer::max_mtu_size< MTU > >
+    {
+        large_mtu_base()
+        {
+            for ( std::size_t i = 0; i != sizeof( large_value ); ++i )
+                large_value[ i ] = static_cast< std::uint8_t >( i );
+        }
+
+        // exchanges an MTU of 517 and reads the large value
+        void read_large_value()
+        {
+            this->ll_data_pdu( { 0x03, 0x00, 0x04, 0x00, 0x02, 0x05, 0x02 } );
+            this->ll_data_pdu( { 0x03, 0x00, 0x04, 0x00, 0x0A, 0x03, 0x00 } );
+            this->ll_empty_pdus( 20 );
+
+            this->run();
+        }
+
+        void check_read_response( std::size_t fragment_size )
+        {
+            auto fragments = l2cap_fragments( *this );
+            BOOST_REQUIRE_GT( fragments.size(), 1u );
+
+            // skip the Exchange MTU Response
+            fragments.erase( fragments.begin() );
+
+            const auto l2cap_pdu = reassemble( fragments, fragment_size );
+
+            static const std::uint8_t expected_header[] = {
+                0x2D, 0x01, 0x04, 0x00, // l2cap header
+                0x0B                    // Read Response
+            };
+
+            BOOST_REQUIRE_EQUAL( l2cap_pdu.size(), sizeof( expected_header ) + sizeof( large_value ) );
+            BOOST_CHECK_EQUAL_COLLECTIONS( l2cap_pdu.begin(), l2cap_pdu.begin() + 5, std::begin( expected_header ), std::end( expected_header ) );
+            BOOST_CHECK_EQUAL_COLLECTIONS( l2cap_pdu.begin() + 5, l2cap_pdu.end(), std::begin( large_value ), std::end( large_value ) );
+        }
+    };
+
+    // the transmit buffer has to be large enough for an L2CAP PDU of 521 bytes
+    using large_mtu = large_mtu_base< bluetoe::link_layer::buffer_sizes< 1600u, 1000u > >;
+    using auto_sized_large_mtu = large_mtu_base< bluetoe::link_layer::auto_buffer_sizes >;
+    using auto_sized_medium_mtu = large_mtu_base< bluetoe::link_layer::auto_buffer_sizes, 100u >;
+}
+
+BOOST_FIXTURE_TEST_CASE( fragmented_att_request, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_data_pdu(
+        {
+            0x03, 0x00,         // length
+            0x04, 0x00,         // Channel
+            0x02                // Exchange MTU Request
+        } );
+    ll_pdu( 0x01, { 0x50, 0x00 } );
+    ll_empty_pdus( 2 );
+
+    run();
+
+    const auto output = l2cap_output( *this );
+    BOOST_REQUIRE_EQUAL( output.size(), 1u );
+
+    static const std::uint8_t expected_response[] = {
+        0x02, 0x07,             // ll header
+        0x03, 0x00, 0x04, 0x00, // l2cap header
+        0x03, 0x17, 0x00        // Exchange MTU Response
+    };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( output[ 0 ].begin(), output[ 0 ].end(), std::begin( expected_response ), std::end( expected_response ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( continuation_without_start_is_ignored, unconnected )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_pdu( 0x01, { 0x02, 0x50, 0x00 } );
+    ll_empty_pdus( 2 );
+
+    run();
+
+    BOOST_CHECK( l2cap_output( *this ).empty() );
+}
+
+BOOST_FIXTURE_TEST_CASE( mtu_larger_than_255, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_data_pdu(
+        {
+            0x03, 0x00,         // length
+            0x04, 0x00,         // Channel
+            0x02, 0x05, 0x02    // Exchange MTU Request
+        } );
+    ll_empty_pdus( 2 );
+
+    run();
+
+    const auto output = l2cap_output( *this );
+    BOOST_REQUIRE_EQUAL( output.size(), 1u );
+
+    static const std::uint8_t expected_response[] = {
+        0x02, 0x07,             // ll header
+        0x03, 0x00, 0x04, 0x00, // l2cap header
+        0x03, 0x05, 0x02        // Exchange MTU Response
+    };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( output[ 0 ].begin(), output[ 0 ].end(), std::begin( expected_response ), std::end( expected_response ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( large_write_request_in_many_fragments, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_data_pdu( { 0x03, 0x00, 0x04, 0x00, 0x02, 0x05, 0x02 } );
+
+    std::vector< std::uint8_t > l2cap_pdu = {
+        0x2F, 0x01,             // length 303
+        0x04, 0x00,             // Channel
+        0x12, 0x03, 0x00        // Write Request
+    };
+
+    for ( std::size_t i = 0; i != sizeof( large_value ); ++i )
+        l2cap_pdu.push_back( static_cast< std::uint8_t >( i ) );
+
+    // fragments with the minimum payload size of 27 bytes
+    for ( auto fragment = l2cap_pdu.begin(); fragment != l2cap_pdu.end(); )
+    {
+        const auto end = fragment + std::min< std::ptrdiff_t >( 27, l2cap_pdu.end() - fragment );
+        ll_pdu( fragment == l2cap_pdu.begin() ? 0x02 : 0x01, std::vector< std::uint8_t >( fragment, end ) );
+        fragment = end;
+    }
+
+    ll_empty_pdus( 2 );
+
+    run();
+
+    const auto output = l2cap_output( *this );
+    BOOST_REQUIRE_EQUAL( output.size(), 2u );
+
+    static const std::uint8_t expected_response[] = {
+        0x02, 0x05,             // ll header
+        0x01, 0x00, 0x04, 0x00, // l2cap header
+        0x13                    // Write Response
+    };
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( output[ 1 ].begin(), output[ 1 ].end(), std::begin( expected_response ), std::end( expected_response ) );
+    BOOST_CHECK_EQUAL_COLLECTIONS( std::begin( large_value ), std::end( large_value ), l2cap_pdu.begin() + 7, l2cap_pdu.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( large_read_response_is_fragmented, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    read_large_value();
+
+    // without data length update, every LL PDU carries 27 bytes at max
+    check_read_response( 27u );
+    BOOST_CHECK_EQUAL( l2cap_fragments( *this ).size(), 1u + 12u );
+}
+
+BOOST_FIXTURE_TEST_CASE( data_length_update_results_in_larger_fragments, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_control_pdu( { 0x14, 0xFB, 0x00, 0x48, 0x08, 0xFB, 0x00, 0x48, 0x08 } );
+    read_large_value();
+
+    // 1000 bytes buffers allow for the maximum of 251 bytes (header + payload)
+    check_read_response( 249u );
+    BOOST_CHECK_EQUAL( l2cap_fragments( *this ).size(), 1u + 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( data_length_limited_by_time, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+
+    // MaxRxTime of 1000µs limits the payload to 111 bytes
+    ll_control_pdu( { 0x14, 0xFB, 0x00, 0xE8, 0x03, 0xFB, 0x00, 0x48, 0x08 } );
+    read_large_value();
+
+    check_read_response( 111u );
+    BOOST_CHECK_EQUAL( l2cap_fragments( *this ).size(), 1u + 3u );
+}
+
+BOOST_FIXTURE_TEST_CASE( data_length_limited_by_time_on_2m_phy, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+
+    // on the LE 2M PHY, a MaxRxTime of 1000µs limits the payload to 235 bytes
+    ll_control_pdu( { 0x14, 0xFB, 0x00, 0xE8, 0x03, 0xFB, 0x00, 0x48, 0x08 } );
+    ll_control_pdu( { 0x18, 0x00, 0x02, 0x03, 0x00 } );
+    read_large_value();
+
+    check_read_response( 235u );
+    BOOST_CHECK_EQUAL( l2cap_fragments( *this ).size(), 1u + 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( data_length_limited_by_the_peer, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_control_pdu( { 0x14, 0x64, 0x00, 0x48, 0x08, 0xFB, 0x00, 0x48, 0x08 } );
+    read_large_value();
+
+    check_read_response( 100u );
+    BOOST_CHECK_EQUAL( l2cap_fragments( *this ).size(), 1u + 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( large_mtu_starts_a_data_length_update, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_empty_pdus( 3 );
+
+    run();
+
+    check_outgoing_ll_control_pdu( {
+        0x14,                       // LL_LENGTH_REQ
+        0xF9, 0x00,                 // MaxRxOctets
+        0x38, 0x08,                 // MaxRxTime
+        0xF9, 0x00,                 // MaxTxOctets
+        0x38, 0x08                  // MaxTxTime
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( length_response_reports_the_times_on_the_current_phy, large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_control_pdu( { 0x18, 0x00, 0x02, 0x03, 0x00 } );
+    ll_empty_pdus( 3 );
+    ll_control_pdu( { 0x14, 0xFB, 0x00, 0x48, 0x08, 0xFB, 0x00, 0x48, 0x08 } );
+    ll_empty_pdus( 3 );
+
+    run();
+
+    // receiving on the LE 1M PHY, transmitting on the LE 2M PHY
+    check_outgoing_ll_control_pdu( {
+        0x15,                       // LL_LENGTH_RSP
+        0xF9, 0x00,                 // MaxRxOctets
+        0x38, 0x08,                 // MaxRxTime
+        0xF9, 0x00,                 // MaxTxOctets
+        0x20, 0x04                  // MaxTxTime
+    } );
+}
+
+BOOST_AUTO_TEST_CASE( auto_buffer_sizes_for_the_minimum_mtu )
+{
+    using requirements = unconnected::buffer_requirements;
+
+    // the test radio's layout uses 4 bytes per PDU in addition to the payload
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::minimum_transmit_size }, 31u );
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::minimum_receive_size }, 31u );
+
+    // two PDUs with 27 bytes payload
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::recommended_transmit_size }, 2u * 31u + 1u );
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::recommended_receive_size }, 2u * 31u + 1u );
+}
+
+BOOST_AUTO_TEST_CASE( auto_buffer_sizes_for_a_large_mtu )
+{
+    using requirements = auto_sized_large_mtu::buffer_requirements;
+
+    // without an extended data length, an L2CAP PDU of 521 bytes is transmitted in 20 PDUs with 27 bytes payload,
+    // that have to fit into half of the buffer
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::minimum_transmit_size }, 2u * 20u * 31u + 1u );
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::minimum_receive_size }, 31u );
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::recommended_transmit_size }, 2u * 20u * 31u + 1u );
+    BOOST_CHECK_EQUAL( std::size_t{ requirements::recommended_receive_size }, 2u * 253u + 1u );
+
+    BOOST_CHECK_EQUAL( std::size_t{ auto_sized_large_mtu::radio_t::size }, std::size_t{ requirements::recommended_transmit_size + requirements::recommended_receive_size } );
+}
+
+BOOST_FIXTURE_TEST_CASE( auto_buffer_sizes_allow_for_the_maximum_data_length, auto_sized_large_mtu )
+{
+    respond_to( 37, valid_connection_request_pdu );
+    ll_control_pdu( { 0x14, 0xFB, 0x00, 0x48, 0x08, 0xFB, 0x00, 0x48, 0x08 } );
+    read_large_value();
+
+    check_read_response( 249u );
+    BOOST_CHECK_EQUAL( l2cap_fragments( *this ).size(), 1u + 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( auto_buffer_sizes_allow_for_the_default_data_length, auto_sized_medium_mtu )
+{
+    // the transmit buffer is not larger than required for a single L2CAP PDU of MTU size
+    BOOST_REQUIRE_EQUAL( std::size_t{ buffer_requirements::recommended_transmit_size }, std::size_t{ buffer_requirements::minimum_transmit_size } );
+
+    respond_to( 37, valid_connection_request_pdu );
+    ll_empty_pdus( 3 );
+    run();
+
+    // without an extended data length, the L2CAP PDU is fragmented into 4 PDUs with 27 bytes payload
+    const auto buffer = allocate_l2cap_transmit_buffer( 100u + 4u );
+    BOOST_CHECK_GE( l2cap_transmit_size( buffer ), 100u + 4u );
+}
+
+namespace {
+    template < std::size_t I >
+    struct notified_value {
+        static std::uint8_t value;
+    };
+
+    template < std::size_t I >
+    std::uint8_t notified_value< I >::value = I;
+
+    template < std::size_t I >
+    using notified_characteristic = bluetoe::characteristic<
+        bluetoe::characteristic_uuid16< 0x5670 + I >,
+        bluetoe::bind_characteristic_value< std::uint8_t, &notified_value< I >::value >,
+        bluetoe::notify
+    >;
+
+    // the CCCDs have the handles 4, 7, 10 and 13
+    using notifying_service = bluetoe::service<
+        bluetoe::service_uuid16< 0x1234 >,
+        notified_characteristic< 0 >,
+        notified_characteristic< 1 >,
+        notified_characteristic< 2 >,
+        notified_characteristic< 3 >
+    >;
+
+    using notifying_server = bluetoe::server< notifying_service >;
+
+    template < typename Server, typename ... Options >
+    struct notifications_base : unconnected_base_t< Server, test::radio,
+        Options..., bluetoe::link_layer::buffer_sizes< 200u, 61u > >
+    {
+        // subscribes to all characteristics
+        notifications_base()
+        {
+            this->respond_to( 37, valid_connection_request_pdu );
+
+            for ( std::uint8_t handle = 4; handle != 16; handle += 3 )
+                this->ll_data_pdu( { 0x05, 0x00, 0x04, 0x00, 0x12, handle, 0x00, 0x01, 0x00 } );
+
+            this->ll_empty_pdus( 2 );
+
+            // stop the simulation, before the connection times out
+            this->end_of_simulation( bluetoe::link_layer::delta_time::msec( 200 ) );
+            this->base::run( gatt_server_ );
+        }
+
+        // notifies all characteristics and returns the number of notifications in the following connection events
+        std::vector< std::size_t > notify_all( unsigned events )
+        {
+            gatt_server_.notify( notified_value< 0 >::value );
+            gatt_server_.notify( notified_value< 1 >::value );
+            gatt_server_.notify( notified_value< 2 >::value );
+            gatt_server_.notify( notified_value< 3 >::value );
+
+            const std::size_t first_event = this->connection_events().size();
+
+            this->ll_empty_pdus( events );
+
+            for ( ; events; --events )
+                this->base::run( gatt_server_ );
+
+            std::vector< std::size_t > result;
+
+            for ( auto event = this->connection_events().begin() + first_event; event != this->connection_events().end(); ++event )
+            {
+                result.push_back( std::count_if( event->transmitted_data.begin(), event->transmitted_data.end(),
+                    []( const test::pdu_t& pdu ) {
+                        return ( pdu[ 0 ] & 0x03 ) == 0x02 && pdu.size() > 6 && pdu[ 6 ] == 0x1B;
+                    } ) );
+            }
+
+            return result;
+        }
+
+        // runs the given number of connection events and returns the values of all notifications in the order of transmission
+        std::vector< std::uint8_t > notified_values( unsigned events )
+        {
+            const std::size_t first_event = this->connection_events().size();
+
+            this->ll_empty_pdus( events );
+
+            for ( ; events; --events )
+                this->base::run( gatt_server_ );
+
+            std::vector< std::uint8_t > result;
+
+            for ( auto event = this->connection_events().begin() + first_event; event != this->connection_events().end(); ++event )
+            {
+                for ( const auto& pdu : event->transmitted_data )
+                {
+                    if ( ( pdu[ 0 ] & 0x03 ) == 0x02 && pdu.size() == 10 && pdu[ 6 ] == 0x1B )
+                        result.push_back( pdu[ 9 ] );
+                }
+            }
+
+            return result;
+        }
+
+        Server gatt_server_;
+    };
+
+    using notifications = notifications_base< notifying_server >;
+    using limited_notifications = notifications_base< notifying_server, bluetoe::link_layer::max_notifications_per_event< 2 > >;
+    using auto_sized_notifications = notifications_base< notifying_server, bluetoe::link_layer::auto_buffer_sizes >;
+
+    // room for 4 notifications of a single byte value (4 * ( 2 + 1 + 2 + 1 ) bytes)
+    using snapshot_notifications = notifications_base< bluetoe::server< bluetoe::notification_snapshots< 24 >, notifying_service > >;
+}
+
+BOOST_FIXTURE_TEST_CASE( all_pending_notifications_are_send_in_one_event, notifications )
+{
+    const std::vector< std::size_t > expected = { 4, 0, 0 };
+    const std::vector< std::size_t > found    = notify_all( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( notifications_per_event_are_limited, limited_notifications )
+{
+    const std::vector< std::size_t > expected = { 2, 2, 0 };
+    const std::vector< std::size_t > found    = notify_all( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( auto_buffer_sizes_have_room_for_all_notifications, auto_sized_notifications )
+{
+    // 4 notifications with a maximum size of 27 bytes
+    BOOST_CHECK_EQUAL( std::size_t{ buffer_requirements::recommended_transmit_size }, 4u * 31u + 1u );
+
+    const std::vector< std::size_t > expected = { 4, 0, 0 };
+    const std::vector< std::size_t > found    = notify_all( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( notified_values_are_coalesced_without_snapshots, notifications )
+{
+    notified_value< 0 >::value = 10;
+    BOOST_CHECK( gatt_server_.notify( notified_value< 0 >::value ) );
+    notified_value< 0 >::value = 11;
+    BOOST_CHECK( !gatt_server_.notify( notified_value< 0 >::value ) );
+
+    const std::vector< std::uint8_t > expected = { 11 };
+    const std::vector< std::uint8_t > found    = notified_values( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( notified_values_are_snapshots, snapshot_notifications )
+{
+    notified_value< 0 >::value = 10;
+    BOOST_CHECK( gatt_server_.notify( notified_value< 0 >::value ) );
+    notified_value< 0 >::value = 11;
+    BOOST_CHECK( gatt_server_.notify( notified_value< 0 >::value ) );
+    notified_value< 1 >::value = 20;
+    BOOST_CHECK( gatt_server_.notify( notified_value< 1 >::value ) );
+
+    const std::vector< std::uint8_t > expected = { 10, 11, 20 };
+    const std::vector< std::uint8_t > found    = notified_values( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+}
+
+BOOST_FIXTURE_TEST_CASE( notify_reports_a_full_snapshot_buffer, snapshot_notifications )
+{
+    for ( std::uint8_t value = 0; value != 4; ++value )
+    {
+        notified_value< 2 >::value = value;
+        BOOST_CHECK( gatt_server_.notify( notified_value< 2 >::value ) );
+    }
+
+    notified_value< 2 >::value = 4;
+    BOOST_CHECK( !gatt_server_.notify( notified_value< 2 >::value ) );
+
+    const std::vector< std::uint8_t > expected = { 0, 1, 2, 3 };
+    const std::vector< std::uint8_t > found    = notified_values( 3 );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+
+    // room for new snapshots, once the notifications are send
+    BOOST_CHECK( gatt_server_.notify( notified_value< 2 >::value ) );
+}
+
+namespace {
+    template < std::size_t I >
+    struct notified_word {
+        static std::uint32_t value;
+    };
+
+    template < std::size_t I >
+    std::uint32_t notified_word< I >::value = I;
+
+    template < std::size_t I >
+    using notified_word_characteristic = bluetoe::characteristic<
+        bluetoe::characteristic_uuid16< 0x5670 + I >,
+        bluetoe::bind_characteristic_value< std::uint32_t, &notified_word< I >::value >,
+        bluetoe::notify
+    >;
+
+    // the values have the handles 3, 6, 9 and 12, the CCCDs 4, 7, 10 and 13 and the Client Supported Features 21;
+    // only two values fit into a Multiple Handle Value Notification with the default MTU
+    using multiple_notifications_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            notified_word_characteristic< 0 >,
+            notified_word_characteristic< 1 >,
+            notified_word_characteristic< 2 >,
+            notified_word_characteristic< 3 >
+        >,
+        bluetoe::robust_caching
+    >;
+
+    struct multiple_notifications : notifications_base< multiple_notifications_server >
+    {
+        multiple_notifications()
+        {
+            // enable Multiple Handle Value Notifications
+            ll_data_pdu( { 0x04, 0x00, 0x04, 0x00, 0x12, 0x15, 0x00, 0x04 } );
+            ll_empty_pdus( 2 );
+            base::run( gatt_server_ );
+        }
+
+        // runs the given number of connection events and returns the handles of all Multiple Handle Value Notifications
+        std::vector< std::vector< std::uint16_t > > notified_handles( unsigned events )
+        {
+            const std::size_t first_event = connection_events().size();
+
+            ll_empty_pdus( events );
+
+            for ( ; events; --events )
+                base::run( gatt_server_ );
+
+            std::vector< std::vector< std::uint16_t > > result;
+
+            for ( auto event = connection_events().begin() + first_event; event != connection_events().end(); ++event )
+            {
+                for ( const auto& pdu : event->transmitted_data )
+                {
+                    if ( ( pdu[ 0 ] & 0x03 ) != 0x02 || pdu.size() < 7 || pdu[ 6 ] != 0x23 )
+                        continue;
+
+                    result.push_back( std::vector< std::uint16_t >() );
+
+                    for ( auto tuple = pdu.begin() + 7; tuple + 4 <= pdu.end(); tuple += 4 + ( *( tuple + 2 ) | ( *( tuple + 3 ) << 8 ) ) )
+                        result.back().push_back( static_cast< std::uint16_t >( *tuple | ( *( tuple + 1 ) << 8 ) ) );
+                }
+            }
+
+            return result;
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( notification_that_does_not_fit_starts_the_next_multiple_notification, multiple_notifications )
+{
+    gatt_server_.notify( notified_word< 0 >::value );
+    gatt_server_.notify( notified_word< 1 >::value );
+    gatt_server_.notify( notified_word< 2 >::value );
+    gatt_server_.notify( notified_word< 3 >::value );
+
+    const auto found = notified_handles( 3 );
+
+    BOOST_REQUIRE_EQUAL( found.size(), 2u );
+
+    const std::vector< std::uint16_t > first  = { 3, 6 };
+    const std::vector< std::uint16_t > second = { 9, 12 };
+    BOOST_CHECK_EQUAL_COLLECTIONS( found[ 0 ].begin(), found[ 0 ].end(), first.begin(), first.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( found[ 1 ].begin(), found[ 1 ].end(), second.begin(), second.end() );
+}
@@ -3,6 +3,7 @@
 
 #include "connected.hpp"
 #include <bluetoe/pairing_status.hpp>
+#include <bluetoe/bond_store.hpp>
 
 namespace test {
     std::uint16_t secret_value;
@@ -46,12 +47,10 @@ namespace test {
                 : OtherConnectionData( args... )
             {}
 
-            std::pair< bool, bluetoe::details::uint128_t > find_key( std::uint16_t ediv, std::uint64_t rand ) const
+            template < class T >
+            bool outgoing_security_manager_data_available( const T& ) const
             {
-                ::test::ediv = ediv;
-                ::test::rand = rand;
-
-                return key_vault;
+                return false;
             }
 
             void remote_connection_created( const bluetoe::link_layer::device_address& )
@@ -69,6 +68,26 @@ namespace test {
         {
         }
 
+        template < class OtherConnectionData, class SecurityFunctions >
+        void l2cap_output( std::uint8_t*, std::size_t& out_size, connection_data< OtherConnectionData >&, SecurityFunctions& )
+        {
+            out_size = 0;
+        }
+
+        template < class OtherConnectionData, class SecurityFunctions >
+        std::pair< bool, bluetoe::details::uint128_t > find_key( std::uint16_t ediv, std::uint64_t rand, connection_data< OtherConnectionData >&, SecurityFunctions& )
+        {
+            ::test::ediv = ediv;
+            ::test::rand = rand;
+
+            return key_vault;
+        }
+
+        template < class OtherConnectionData, class SecurityFunctions >
+        void remote_connection_closed( connection_data< OtherConnectionData >&, SecurityFunctions& )
+        {
+        }
+
         struct meta_type :
             bluetoe::details::security_manager_meta_type,
             bluetoe::link_layer::details::valid_link_layer_option_meta_type {};
@@ -108,7 +127,7 @@ BOOST_FIXTURE_TEST_CASE( response_to_an_feature_request_with_security_enabled, l
     expected_response( {
         0x03, 0x09,
         0x09,
-        0x13, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+        0x33, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     } );
 }
 
@@ -403,3 +422,144 @@ BOOST_FIXTURE_TEST_CASE( pause_encryption, link_layer_with_encryption )
     BOOST_CHECK( !connection_events().at( 7 ).receive_encryption_at_start_of_event );
     BOOST_CHECK( !connection_events().at( 7 ).transmit_encryption_at_start_of_event );
 }
+
+namespace test {
+    using bonding_security_manager = bluetoe::bonding_security_manager< bluetoe::ram_bond_store< 2 > >;
+}
+
+// pairing and key distribution queue more PDUs per connection event, than the default test buffers can hold
+struct link_layer_with_bonding : unconnected_base_t< test::secret_service, test::radio_with_encryption, test::bonding_security_manager, bluetoe::link_layer::buffer_sizes< 200, 200 > >
+{
+    link_layer_with_bonding()
+    {
+        respond_to( 37, valid_connection_request_pdu );
+    }
+};
+
+struct link_layer_bonding_paired : link_layer_with_bonding
+{
+    link_layer_bonding_paired()
+    {
+        ll_data_pdu({
+            0x07, 0x00, 0x06, 0x00,                 // L2CAP header, SM channel
+            0x01,                                   // Pairing Request
+            0x03, 0x00,                             // NoInputNoOutput, no OOB data
+            0x01,                                   // AuthReq: Bonding
+            0x10,                                   // Maximum Encryption Key Size
+            0x07, 0x07                              // Initiator / Responder Key Distribution
+        });
+
+        // the test radios c1() returns the temporary key
+        ll_data_pdu({
+            0x11, 0x00, 0x06, 0x00,
+            0x03,                                   // Pairing Confirm
+            0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00
+        });
+
+        ll_data_pdu({
+            0x11, 0x00, 0x06, 0x00,
+            0x04,                                   // Pairing Random
+            0xE0, 0x2E, 0x70, 0xC6,
+            0x4E, 0x27, 0x88, 0x63,
+            0x0E, 0x6F, 0xAD, 0x56,
+            0x21, 0xD5, 0x83, 0x57
+        });
+
+        ll_control_pdu({
+            0x03,                                   // LL_ENC_REQ
+            0x00, 0x00, 0x00, 0x00,                 // Rand
+            0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00,                             // EDIV
+            0x00, 0x10, 0x20, 0x30,                 // SKDm
+            0x40, 0x50, 0x60, 0x70,
+            0xab, 0xbc, 0x12, 0x34,                 // IVm
+        });
+        ll_empty_pdu();
+
+        ll_control_pdu({
+            0x06                                    // LL_START_ENC_RSP
+        });
+        ll_empty_pdus( 3 );
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE( long_term_key_distributed_after_pairing, link_layer_bonding_paired )
+{
+    run();
+
+    check_outgoing_l2cap_pdu({
+        0x11, 0x00, 0x06, 0x00,
+        0x06,                                   // Encryption Information
+        0x00, 0x11, 0x22, 0x33,
+        0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb,
+        0xcc, 0xdd, 0xee, 0xff
+    });
+
+    check_outgoing_l2cap_pdu({
+        0x0b, 0x00, 0x06, 0x00,
+        0x07,                                   // Master Identification
+        0x34, 0x12,                             // EDIV
+        0x33, 0x22, 0x11, 0x00,                 // Rand
+        0xdd, 0xcc, 0xbb, 0xaa
+    });
+
+    BOOST_CHECK_EQUAL( bond_store().size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( bond_stored_after_identity_received, link_layer_bonding_paired )
+{
+    ll_data_pdu({
+        0x11, 0x00, 0x06, 0x00,
+        0x08,                                   // Identity Information
+        0x01, 0x02, 0x03, 0x04,
+        0x05, 0x06, 0x07, 0x08,
+        0x09, 0x0a, 0x0b, 0x0c,
+        0x0d, 0x0e, 0x0f, 0x10
+    });
+
+    ll_data_pdu({
+        0x08, 0x00, 0x06, 0x00,
+        0x09,                                   // Identity Address Information
+        0x01,                                   // random
+        0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6
+    });
+    ll_empty_pdus( 3 );
+
+    run();
+
+    BOOST_REQUIRE_EQUAL( bond_store().size(), 1u );
+    BOOST_CHECK_NE( bond_store().find_bond( 0x1234, 0xaabbccdd00112233 ), std::size_t{ bond_store().no_bond } );
+}
+
+BOOST_FIXTURE_TEST_CASE( reconnect_with_key_of_bond, link_layer_with_bonding )
+{
+    bond_store().add_bond( bluetoe::bond_data{
+        { test::example_key, 0x7766554433221100, 0x1234 },
+        { { 0x00 } },
+        bluetoe::link_layer::random_device_address( { 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6 } )
+    } );
+
+    ll_control_pdu({
+        0x03,                                   // LL_ENC_REQ
+        0x00, 0x11, 0x22, 0x33,                 // Rand
+        0x44, 0x55, 0x66, 0x77,
+        0x34, 0x12,                             // EDIV
+        0x00, 0x10, 0x20, 0x30,                 // SKDm
+        0x40, 0x50, 0x60, 0x70,
+        0xab, 0xbc, 0x12, 0x34,                 // IVm
+    });
+    ll_empty_pdu();
+
+    run();
+
+    const auto used_key = encryption_key();
+    BOOST_CHECK_EQUAL_COLLECTIONS( std::begin( used_key ), std::end( used_key ), std::begin( test::example_key ), std::end( test::example_key ) );
+
+    check_outgoing_ll_control_pdu({
+        0x05                                    // LL_START_ENC_REQ
+    });
+}
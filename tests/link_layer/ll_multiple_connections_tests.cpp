@@ -0,0 +1,420 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <bluetoe/link_layer.hpp>
+#include <bluetoe/server.hpp>
+
+#include "test_radio.hpp"
+#include "test_servers.hpp"
+
+#include <algorithm>
+
+namespace {
+
+    static constexpr std::uint32_t first_access_address  = 0xaf9ab35a;
+    static constexpr std::uint32_t second_access_address = 0x5a3b9faa;
+    static constexpr std::uint32_t third_access_address  = 0x3c5a9f71;
+
+    std::vector< std::uint8_t > connect_request_pdu( std::uint32_t access_address, std::uint8_t window_offset )
+    {
+        return {
+            0xc5, 0x22,                         // header
+            0x3c, 0x1c, 0x62, 0x92, 0xf0, 0x48, // InitA: 48:f0:92:62:1c:3c (random)
+            0x47, 0x11, 0x08, 0x15, 0x0f, 0xc0, // AdvA:  c0:0f:15:08:11:47 (random)
+            static_cast< std::uint8_t >( access_address ),
+            static_cast< std::uint8_t >( access_address >> 8 ),
+            static_cast< std::uint8_t >( access_address >> 16 ),
+            static_cast< std::uint8_t >( access_address >> 24 ),
+            0x08, 0x81, 0xf6,                   // CRC Init
+            0x03,                               // transmit window size
+            window_offset, 0x00,                // window offset
+            0x18, 0x00,                         // interval (30ms)
+            0x00, 0x00,                         // slave latency
+            0x48, 0x00,                         // connection timeout (720ms)
+            0xff, 0xff, 0xff, 0xff, 0x1f,       // used channel map
+            0xaa                                // hop increment and sleep clock accuracy (10 and 50ppm)
+        };
+    }
+
+    template < unsigned MaxConnections >
+    struct link_layer : bluetoe::link_layer::link_layer<
+        test::small_temperature_service, test::radio,
+        test::buffer_sizes, bluetoe::link_layer::max_connections< MaxConnections > >
+    {
+        using base = bluetoe::link_layer::link_layer<
+            test::small_temperature_service, test::radio,
+            test::buffer_sizes, bluetoe::link_layer::max_connections< MaxConnections > >;
+
+        link_layer()
+        {
+            this->end_of_simulation( bluetoe::link_layer::delta_time::seconds( 2 ) );
+        }
+
+        void run()
+        {
+            base::run( gatt_server_ );
+        }
+
+        void connect( std::uint32_t access_address, std::uint8_t window_offset )
+        {
+            this->respond_to( 37, connect_request_pdu( access_address, window_offset ) );
+        }
+
+        // all connections respond with empty PDUs
+        void respond_with_empty_pdus( unsigned count )
+        {
+            for ( ; count; --count )
+                this->add_connection_event_respond( { 0x01, 0x00 } );
+        }
+
+        std::vector< test::connection_event > events_of( std::uint32_t access_address ) const
+        {
+            std::vector< test::connection_event > result;
+
+            std::copy_if( this->connection_events().begin(), this->connection_events().end(), std::back_inserter( result ),
+                [access_address]( const test::connection_event& event ) {
+                    return event.access_address == access_address;
+                } );
+
+            return result;
+        }
+
+        bool is_advertising( const test::advertising_data& data ) const
+        {
+            return data.access_address == 0x8E89BED6;
+        }
+
+        test::small_temperature_service gatt_server_;
+    };
+
+    struct two_connections : link_layer< 2 >
+    {
+        two_connections()
+        {
+            connect( first_access_address, 0x0b );
+            connect( second_access_address, 0x05 );
+            respond_with_empty_pdus( 200 );
+
+            run();
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( accepts_two_connections, two_connections )
+{
+    BOOST_CHECK_GT( events_of( first_access_address ).size(), 10u );
+    BOOST_CHECK_GT( events_of( second_access_address ).size(), 10u );
+}
+
+BOOST_FIXTURE_TEST_CASE( connection_events_are_interleaved, two_connections )
+{
+    const auto& events = connection_events();
+    const auto  second = std::find_if( events.begin(), events.end(),
+        []( const test::connection_event& event ) { return event.access_address == second_access_address; } );
+
+    BOOST_REQUIRE( second != events.end() );
+
+    // after both connections are established, no connection is served twice in a row
+    for ( auto event = second; event + 1 != events.end(); ++event )
+        BOOST_CHECK_NE( event->access_address, ( event + 1 )->access_address );
+}
+
+BOOST_FIXTURE_TEST_CASE( connections_use_their_own_channel_sequence, two_connections )
+{
+    const auto first  = events_of( first_access_address );
+    const auto second = events_of( second_access_address );
+
+    // same hop increment and channel map, so both connections walk the same sequence independently
+    for ( std::size_t event = 0; event != 10; ++event )
+        BOOST_CHECK_EQUAL( first[ event ].channel, second[ event ].channel );
+}
+
+BOOST_FIXTURE_TEST_CASE( no_advertising_while_all_connections_are_in_use, two_connections )
+{
+    const auto second = events_of( second_access_address );
+    BOOST_REQUIRE( !second.empty() );
+
+    const auto connected = second.front().schedule_time;
+
+    for ( const auto& adv : advertisings() )
+        BOOST_CHECK( adv.schedule_time < connected );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_continues_while_connections_are_free, link_layer< 3 > )
+{
+    connect( first_access_address, 0x0b );
+    respond_with_empty_pdus( 100 );
+
+    run();
+
+    const auto first = events_of( first_access_address );
+    BOOST_REQUIRE( !first.empty() );
+
+    const auto connected = first.front().schedule_time;
+    const auto advertising_after_connect = std::count_if( advertisings().begin(), advertisings().end(),
+        [&]( const test::advertising_data& adv ) {
+            return adv.schedule_time > connected && is_advertising( adv );
+        } );
+
+    BOOST_CHECK_GT( advertising_after_connect, 3 );
+}
+
+BOOST_FIXTURE_TEST_CASE( three_connections, link_layer< 3 > )
+{
+    connect( first_access_address, 0x0b );
+    connect( second_access_address, 0x05 );
+    // anchors of the three connections are about 7ms apart
+    connect( third_access_address, 0x10 );
+    respond_with_empty_pdus( 300 );
+
+    run();
+
+    BOOST_CHECK_GT( events_of( first_access_address ).size(), 10u );
+    BOOST_CHECK_GT( events_of( second_access_address ).size(), 10u );
+    BOOST_CHECK_GT( events_of( third_access_address ).size(), 10u );
+}
+
+BOOST_FIXTURE_TEST_CASE( pdus_are_responded_on_the_right_connection, link_layer< 2 > )
+{
+    connect( first_access_address, 0x0b );
+    connect( second_access_address, 0x05 );
+
+    // LL_PING_REQ on the second connection only
+    add_connection_event_respond_to( second_access_address, { 0x01, 0x00 } );
+    add_connection_event_respond_to( second_access_address, { 0x03, 0x01, 0x12 } );
+    respond_with_empty_pdus( 200 );
+
+    run();
+
+    const auto is_ping_response = []( const test::connection_event& event ) {
+        return std::any_of( event.transmitted_data.begin(), event.transmitted_data.end(),
+            []( const test::pdu_t& pdu ) {
+                return pdu.size() == 3 && ( pdu[ 0 ] & 0x03 ) == 0x03 && pdu[ 1 ] == 1 && pdu[ 2 ] == 0x13;
+            } );
+    };
+
+    const auto first  = events_of( first_access_address );
+    const auto second = events_of( second_access_address );
+
+    BOOST_CHECK_EQUAL( std::count_if( first.begin(), first.end(), is_ping_response ), 0 );
+    BOOST_CHECK_EQUAL( std::count_if( second.begin(), second.end(), is_ping_response ), 1 );
+}
+
+BOOST_FIXTURE_TEST_CASE( terminating_one_connection_keeps_the_other, link_layer< 2 > )
+{
+    connect( first_access_address, 0x0b );
+    connect( second_access_address, 0x05 );
+
+    // LL_TERMINATE_IND on the first connection
+    add_connection_event_respond_to( first_access_address, { 0x01, 0x00 } );
+    add_connection_event_respond_to( first_access_address, { 0x01, 0x00 } );
+    add_connection_event_respond_to( first_access_address, { 0x03, 0x02, 0x02, 0x13 } );
+    respond_with_empty_pdus( 200 );
+
+    run();
+
+    BOOST_CHECK_EQUAL( events_of( first_access_address ).size(), 3u );
+    BOOST_CHECK_GT( events_of( second_access_address ).size(), 30u );
+}
+
+BOOST_FIXTURE_TEST_CASE( advertising_restarts_after_a_connection_was_closed, link_layer< 2 > )
+{
+    connect( first_access_address, 0x0b );
+    connect( second_access_address, 0x05 );
+
+    add_connection_event_respond_to( first_access_address, { 0x03, 0x02, 0x02, 0x13 } );
+    respond_with_empty_pdus( 200 );
+
+    run();
+
+    const auto first = events_of( first_access_address );
+    BOOST_REQUIRE_EQUAL( first.size(), 1u );
+
+    const auto closed = first.front().schedule_time;
+    const auto advertising_after_close = std::count_if( advertisings().begin(), advertisings().end(),
+        [&]( const test::advertising_data& adv ) {
+            return adv.schedule_time > closed && is_advertising( adv );
+        } );
+
+    BOOST_CHECK_GT( advertising_after_close, 0 );
+}
+
+namespace {
+    struct callbacks_t {
+        template < class ConnectionData >
+        void ll_connection_established( const bluetoe::link_layer::connection_details&, const bluetoe::link_layer::connection_addresses&, const ConnectionData& connection )
+        {
+            established.push_back( &connection );
+        }
+
+        std::vector< const void* > established;
+    } callbacks;
+
+    struct link_layer_with_callbacks : bluetoe::link_layer::link_layer<
+        test::small_temperature_service, test::radio,
+        test::buffer_sizes,
+        bluetoe::link_layer::max_connections< 2 >,
+        bluetoe::link_layer::connection_callbacks< callbacks_t, callbacks > >
+    {
+        link_layer_with_callbacks()
+        {
+            callbacks = callbacks_t();
+        }
+
+        static const test::small_temperature_service::connection_data& established( std::size_t connection )
+        {
+            return *static_cast< const test::small_temperature_service::connection_data* >( callbacks.established[ connection ] );
+        }
+
+        test::small_temperature_service gatt_server_;
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( disconnect_a_single_connection, link_layer_with_callbacks )
+{
+    respond_to( 37, connect_request_pdu( first_access_address, 0x0b ) );
+    respond_to( 37, connect_request_pdu( second_access_address, 0x05 ) );
+
+    for ( int count = 0; count != 100; ++count )
+        add_connection_event_respond( { 0x01, 0x00 } );
+
+    // returns, after the first connection was established
+    run( gatt_server_ );
+    BOOST_REQUIRE_EQUAL( callbacks.established.size(), 1u );
+
+    disconnect( established( 0 ) );
+
+    // the second connection being established, wakes up run() too
+    run( gatt_server_ );
+    run( gatt_server_ );
+
+    const auto terminate_ind = std::count_if( connection_events().begin(), connection_events().end(),
+        []( const test::connection_event& event ) {
+            return std::any_of( event.transmitted_data.begin(), event.transmitted_data.end(),
+                []( const test::pdu_t& pdu ) {
+                    return pdu.size() == 4 && ( pdu[ 0 ] & 0x03 ) == 0x03 && pdu[ 2 ] == 0x02;
+                } );
+        } );
+
+    BOOST_CHECK_EQUAL( terminate_ind, 1 );
+}
+
+BOOST_FIXTURE_TEST_CASE( connections_with_colliding_anchors_take_turns, link_layer_with_callbacks )
+{
+    // both connections have their anchors 15ms after the first advertising PDU
+    respond_to( 37, connect_request_pdu( first_access_address, 0x0b ) );
+    respond_to( 37, connect_request_pdu( second_access_address, 0x0a ) );
+
+    for ( int count = 0; count != 200; ++count )
+        add_connection_event_respond( { 0x01, 0x00 } );
+
+    end_of_simulation( bluetoe::link_layer::delta_time::seconds( 1 ) );
+
+    for ( int runs = 0; runs != 5; ++runs )
+        run( gatt_server_ );
+
+    BOOST_REQUIRE_EQUAL( callbacks.established.size(), 2u );
+
+    const auto first  = connection_utilisation( established( 0 ) );
+    const auto second = connection_utilisation( established( 1 ) );
+
+    BOOST_CHECK_GT( first.scheduled_events, 10u );
+    BOOST_CHECK_GT( second.scheduled_events, 10u );
+    BOOST_CHECK_GT( first.skipped_events + second.skipped_events, 10u );
+
+    // 1.25ms of every 30ms
+    BOOST_CHECK_EQUAL( first.reserved_per_mille, 42u );
+    BOOST_CHECK_EQUAL( second.reserved_per_mille, 42u );
+}
+
+namespace {
+    // called, when the notified value is read to be send out
+    std::function< void() > notification_read;
+
+    std::uint8_t read_notified_value( std::size_t, std::uint8_t* out_buffer, std::size_t& out_size )
+    {
+        if ( notification_read )
+            notification_read();
+
+        *out_buffer = 0x42;
+        out_size    = 1;
+
+        return bluetoe::error_codes::success;
+    }
+
+    // the CCCD has the handle 4
+    using notifying_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x5678 >,
+                bluetoe::free_read_handler< &read_notified_value >,
+                bluetoe::notify
+            >
+        >
+    >;
+
+    struct two_notifying_connections : bluetoe::link_layer::link_layer<
+        notifying_server, test::radio,
+        test::buffer_sizes, bluetoe::link_layer::max_connections< 2 > >
+    {
+        two_notifying_connections()
+        {
+            notification_read = nullptr;
+
+            respond_to( 37, connect_request_pdu( first_access_address, 0x0b ) );
+            respond_to( 37, connect_request_pdu( second_access_address, 0x05 ) );
+
+            for ( const auto access_address : { first_access_address, second_access_address } )
+                add_connection_event_respond_to( access_address, { 0x02, 0x09, 0x05, 0x00, 0x04, 0x00, 0x12, 0x04, 0x00, 0x01, 0x00 } );
+
+            for ( int count = 0; count != 200; ++count )
+                add_connection_event_respond( { 0x01, 0x00 } );
+
+            end_of_simulation( bluetoe::link_layer::delta_time::msec( 300 ) );
+            run( gatt_server_ );
+        }
+
+        ~two_notifying_connections()
+        {
+            notification_read = nullptr;
+        }
+
+        std::size_t notifications_of( std::uint32_t access_address ) const
+        {
+            std::size_t result = 0;
+
+            for ( const auto& event : connection_events() )
+            {
+                if ( event.access_address == access_address )
+                {
+                    result += std::count_if( event.transmitted_data.begin(), event.transmitted_data.end(),
+                        []( const test::pdu_t& pdu ) {
+                            return ( pdu[ 0 ] & 0x03 ) == 0x02 && pdu.size() == 10 && pdu[ 6 ] == 0x1B && pdu[ 9 ] == 0x42;
+                        } );
+                }
+            }
+
+            return result;
+        }
+
+        notifying_server gatt_server_;
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( connection_events_while_transmitting_notifications, two_notifying_connections )
+{
+    // every notification is interrupted by two connection events, so that the radio selects the other connection
+    notification_read = [this]() {
+        simulate_next_event();
+        simulate_next_event();
+    };
+
+    BOOST_REQUIRE( gatt_server_.notify< bluetoe::characteristic_uuid16< 0x5678 > >() );
+
+    for ( int runs = 0; runs != 10; ++runs )
+        run( gatt_server_ );
+
+    BOOST_CHECK_EQUAL( notifications_of( first_access_address ), 1u );
+    BOOST_CHECK_EQUAL( notifications_of( second_access_address ), 1u );
+}
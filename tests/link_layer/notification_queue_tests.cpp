@@ -1,4 +1,7 @@
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
 #include <bluetoe/notification_queue.hpp>
 
 #define BOOST_TEST_MODULE
@@ -118,6 +121,105 @@ BOOST_AUTO_TEST_SUITE( single_prio_indications )
         BOOST_CHECK( !queue_indication( 16u ) );
     }
 
+    BOOST_FIXTURE_TEST_CASE( dequeue_notification_keeps_indications, queue17 )
+    {
+        BOOST_CHECK( queue_indication( 2u ) );
+        BOOST_CHECK( queue_notification( 12u ) );
+
+        BOOST_CHECK( ( dequeue_notification()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 12u } ) );
+        BOOST_CHECK( dequeue_notification().first == entry_type::empty );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::indication, 2u } ) );
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+using queue100 = bluetoe::link_layer::notification_queue< std::tuple< std::integral_constant< int, 100u > >, empty_fixture >;
+
+BOOST_AUTO_TEST_SUITE( single_prio_large_queue )
+
+    BOOST_FIXTURE_TEST_CASE( empty_queue, queue100 )
+    {
+        BOOST_CHECK( dequeue_indication_or_confirmation().first == entry_type::empty );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( all_entries_in_order, queue100 )
+    {
+        for ( std::size_t index = 0; index != 100; ++index )
+            BOOST_CHECK( queue_notification( index ) );
+
+        for ( std::size_t index = 0; index != 100; ++index )
+            BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, index } ) );
+
+        BOOST_CHECK( dequeue_indication_or_confirmation().first == entry_type::empty );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( entries_in_different_words, queue100 )
+    {
+        BOOST_CHECK( queue_notification( 99u ) );
+        BOOST_CHECK( queue_notification( 3u ) );
+        BOOST_CHECK( queue_notification( 64u ) );
+
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 3u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 64u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 99u } ) );
+        BOOST_CHECK( dequeue_indication_or_confirmation().first == entry_type::empty );
+    }
+
+    /*
+     * an entry that is requeued after being served, has to wait for all other pending entries
+     */
+    BOOST_FIXTURE_TEST_CASE( round_robin, queue100 )
+    {
+        BOOST_CHECK( queue_notification( 40u ) );
+        BOOST_CHECK( queue_notification( 10u ) );
+        BOOST_CHECK( queue_notification( 70u ) );
+
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 10u } ) );
+        BOOST_CHECK( queue_notification( 10u ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 40u } ) );
+        BOOST_CHECK( queue_notification( 40u ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 70u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 10u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 40u } ) );
+        BOOST_CHECK( dequeue_indication_or_confirmation().first == entry_type::empty );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( wrap_around_within_a_word, queue100 )
+    {
+        BOOST_CHECK( queue_notification( 33u ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 33u } ) );
+
+        BOOST_CHECK( queue_notification( 32u ) );
+        BOOST_CHECK( queue_notification( 34u ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 34u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 32u } ) );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( wrap_around_at_the_last_entry, queue100 )
+    {
+        BOOST_CHECK( queue_notification( 99u ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 99u } ) );
+
+        BOOST_CHECK( queue_notification( 99u ) );
+        BOOST_CHECK( queue_notification( 50u ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 50u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 99u } ) );
+    }
+
+    BOOST_FIXTURE_TEST_CASE( outstanding_confirmation_skips_indications, queue100 )
+    {
+        BOOST_CHECK( queue_indication( 5u ) );
+        BOOST_CHECK( queue_indication( 60u ) );
+        BOOST_CHECK( queue_notification( 80u ) );
+
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::indication, 5u } ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 80u } ) );
+        BOOST_CHECK( dequeue_indication_or_confirmation().first == entry_type::empty );
+
+        indication_confirmed();
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::indication, 60u } ) );
+    }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE( single_prio_clearing )
@@ -263,6 +365,17 @@ BOOST_AUTO_TEST_SUITE( mixed_priorities )
         BOOST_CHECK( ( dequeue_indication_or_confirmation().first == entry_type::empty ) );
     }
 
+    BOOST_FIXTURE_TEST_CASE( dequeue_notification_by_priority, queue1_2 )
+    {
+        BOOST_CHECK( queue_indication( 0 ) );
+        BOOST_CHECK( queue_notification( 2 ) );
+        BOOST_CHECK( queue_indication( 1 ) );
+
+        BOOST_CHECK( ( dequeue_notification()  == std::pair< entry_type, std::size_t >{ entry_type::notification, 2 } ) );
+        BOOST_CHECK( ( dequeue_notification().first == entry_type::empty ) );
+        BOOST_CHECK( ( dequeue_indication_or_confirmation()  == std::pair< entry_type, std::size_t >{ entry_type::indication, 0 } ) );
+    }
+
     // there was a bug in the implementation, where a class derived from all the elements
     using queue1_1_2 = bluetoe::link_layer::notification_queue<
     std::tuple<
@@ -277,3 +390,83 @@ BOOST_AUTO_TEST_SUITE( mixed_priorities )
     }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( concurrent_producers )
+
+    using queue256 = bluetoe::link_layer::notification_queue<
+        std::tuple<
+            std::integral_constant< int, 1u >,
+            std::integral_constant< int, 255u >
+        >, empty_fixture >;
+
+    /*
+     * Producer threads queue notifications, while a consumer dequeues them. After the last queue_notification() of
+     * an entry, the consumer has to dequeue that entry at least once more, otherwise an update was lost.
+     */
+    BOOST_FIXTURE_TEST_CASE( no_update_is_lost, queue256 )
+    {
+        static constexpr std::size_t entries           = 256;
+        static constexpr std::size_t producers         = 4;
+        static constexpr std::size_t updates_per_entry = 2000;
+
+        std::vector< std::atomic< unsigned > > produced( entries );
+        std::vector< unsigned >                seen( entries, 0 );
+        std::vector< unsigned >                dequeued( entries, 0 );
+        std::atomic< std::size_t >             running_producers( producers );
+
+        for ( auto& p : produced )
+            p = 0;
+
+        std::vector< std::thread > threads;
+
+        for ( std::size_t producer = 0; producer != producers; ++producer )
+        {
+            threads.emplace_back( [&, producer]{
+                for ( unsigned update = 0; update != updates_per_entry; ++update )
+                {
+                    // the entries of all producers share bitmap words
+                    for ( std::size_t entry = producer; entry < entries; entry += producers )
+                    {
+                        ++produced[ entry ];
+                        queue_notification( entry );
+                    }
+                }
+
+                --running_producers;
+            } );
+        }
+
+        bool producers_done = false;
+
+        for ( ;; )
+        {
+            const auto next = dequeue_indication_or_confirmation();
+
+            if ( next.first == entry_type::empty )
+            {
+                if ( producers_done )
+                    break;
+
+                producers_done = running_producers == 0;
+                continue;
+            }
+
+            BOOST_REQUIRE( next.first == entry_type::notification );
+            BOOST_REQUIRE_LT( next.second, entries );
+
+            seen[ next.second ] = produced[ next.second ];
+            ++dequeued[ next.second ];
+        }
+
+        for ( auto& thread : threads )
+            thread.join();
+
+        for ( std::size_t entry = 0; entry != entries; ++entry )
+        {
+            BOOST_CHECK_EQUAL( seen[ entry ], updates_per_entry );
+            BOOST_CHECK_GE( dequeued[ entry ], 1u );
+            BOOST_CHECK_LE( dequeued[ entry ], updates_per_entry );
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,297 @@
+#include <bluetoe/pdu_slab_storage.hpp>
+#include <bluetoe/default_pdu_layout.hpp>
+
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+// 4 slots of 29 bytes
+struct slabs : bluetoe::link_layer::pdu_slab_storage< 60, 60, bluetoe::link_layer::default_pdu_layout >
+{
+    // stores a PDU with the given payload size, that carries the value in the first byte of the payload
+    bluetoe::link_layer::read_buffer transmit( std::uint8_t value, std::size_t payload = 1 )
+    {
+        const auto pdu = alloc_transmit( 29 );
+
+        if ( pdu.size )
+        {
+            pdu.buffer[ 0 ] = 0x02;
+            pdu.buffer[ 1 ] = static_cast< std::uint8_t >( payload );
+            pdu.buffer[ 2 ] = value;
+            push_transmit( pdu );
+        }
+
+        return pdu;
+    }
+
+    bluetoe::link_layer::read_buffer receive( std::uint8_t value )
+    {
+        const auto pdu = alloc_receive( 29 );
+
+        if ( pdu.size )
+        {
+            pdu.buffer[ 0 ] = 0x02;
+            pdu.buffer[ 1 ] = 1;
+            pdu.buffer[ 2 ] = value;
+            push_receive( pdu );
+        }
+
+        return pdu;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE( slots_of_the_arena, slabs )
+{
+    BOOST_CHECK_EQUAL( std::size_t{ slot_size }, 29u );
+    BOOST_CHECK_EQUAL( std::size_t{ slots }, 4u );
+    BOOST_CHECK_EQUAL( free_slots(), 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_after_construction, slabs )
+{
+    BOOST_CHECK_EQUAL( next_transmit().size, 0u );
+    BOOST_CHECK_EQUAL( next_received().size, 0u );
+    BOOST_CHECK( !more_than_one_transmit() );
+}
+
+BOOST_FIXTURE_TEST_CASE( stored_pdus_are_returned_in_order, slabs )
+{
+    transmit( 1, 3 );
+    transmit( 2 );
+
+    BOOST_CHECK( more_than_one_transmit() );
+    BOOST_CHECK_EQUAL( next_transmit().size, 5u );
+    BOOST_CHECK_EQUAL( next_transmit().buffer[ 2 ], 1u );
+    pop_transmit();
+
+    BOOST_CHECK( !more_than_one_transmit() );
+    BOOST_CHECK_EQUAL( next_transmit().buffer[ 2 ], 2u );
+    pop_transmit();
+
+    BOOST_CHECK_EQUAL( next_transmit().size, 0u );
+    BOOST_CHECK_EQUAL( free_slots(), 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( allocation_is_freed_by_the_next_allocation, slabs )
+{
+    const auto first = alloc_transmit( 29 );
+    BOOST_CHECK_EQUAL( free_slots(), 3u );
+
+    const auto second = alloc_transmit( 29 );
+    BOOST_CHECK( first.buffer == second.buffer );
+    BOOST_CHECK_EQUAL( free_slots(), 3u );
+
+    release_transmit_allocation();
+    BOOST_CHECK_EQUAL( free_slots(), 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( transmit_borrows_slots_from_the_receiving_side, slabs )
+{
+    BOOST_CHECK( transmit( 1 ).size );
+    BOOST_CHECK( transmit( 2 ).size );
+    BOOST_CHECK( transmit( 3 ).size );
+
+    // the last slot is left for the receiving side
+    BOOST_CHECK_EQUAL( transmit( 4 ).size, 0u );
+    BOOST_CHECK( receive( 5 ).size );
+}
+
+BOOST_FIXTURE_TEST_CASE( receive_borrows_slots_from_the_transmitting_side, slabs )
+{
+    BOOST_CHECK( receive( 1 ).size );
+    BOOST_CHECK( receive( 2 ).size );
+    BOOST_CHECK( receive( 3 ).size );
+
+    BOOST_CHECK_EQUAL( receive( 4 ).size, 0u );
+    BOOST_CHECK( transmit( 5 ).size );
+}
+
+BOOST_FIXTURE_TEST_CASE( last_slot_is_handed_out_if_the_other_side_owns_a_slot, slabs )
+{
+    transmit( 1 );
+    transmit( 2 );
+    receive( 3 );
+
+    BOOST_CHECK( transmit( 4 ).size );
+    BOOST_CHECK_EQUAL( free_slots(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( slots_are_freed_out_of_order, slabs )
+{
+    const auto waiting  = transmit( 1 );
+    const auto received = receive( 2 );
+    transmit( 3 );
+
+    // the slot of the received PDU is freed, while the slots in front and behind of it are still in use
+    pop_received();
+
+    BOOST_CHECK( alloc_receive( 29 ).buffer == received.buffer );
+    BOOST_CHECK( next_transmit().buffer == waiting.buffer );
+}
+
+/*
+ * PDUs, that wait for their acknowledgment, do not block the reuse of the remaining slots
+ */
+BOOST_FIXTURE_TEST_CASE( waiting_pdus_do_not_block_the_arena, slabs )
+{
+    transmit( 1 );
+    transmit( 2 );
+
+    for ( std::uint8_t round = 0; round != 100; ++round )
+    {
+        BOOST_REQUIRE( receive( round ).size );
+        BOOST_CHECK_EQUAL( next_received().buffer[ 2 ], round );
+        pop_received();
+    }
+
+    BOOST_CHECK_EQUAL( next_transmit().buffer[ 2 ], 1u );
+    BOOST_CHECK_EQUAL( free_slots(), 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( freed_slot_is_reused, slabs )
+{
+    const auto first = transmit( 1 );
+    transmit( 2 );
+    pop_transmit();
+
+    BOOST_CHECK( alloc_receive( 29 ).buffer == first.buffer );
+}
+
+BOOST_FIXTURE_TEST_CASE( receive_allocation_is_reused, slabs )
+{
+    const auto first = alloc_receive( 29 );
+
+    BOOST_CHECK( alloc_receive( 29 ).buffer == first.buffer );
+    BOOST_CHECK_EQUAL( free_slots(), 3u );
+}
+
+BOOST_FIXTURE_TEST_CASE( allocating_consecutive_slots, slabs )
+{
+    const auto pdu = alloc_transmit( 2 * 29 );
+
+    BOOST_CHECK_EQUAL( pdu.size, 2u * 29u );
+    BOOST_CHECK_EQUAL( free_slots(), 2u );
+
+    // every fragment is pushed separately
+    pdu.buffer[ 0 ] = 0x02;
+    pdu.buffer[ 1 ] = 27;
+    push_transmit( pdu );
+
+    pdu.buffer[ 29 ] = 0x01;
+    pdu.buffer[ 30 ] = 1;
+    push_transmit( bluetoe::link_layer::read_buffer{ pdu.buffer + 29, 29 } );
+
+    BOOST_CHECK( more_than_one_transmit() );
+    BOOST_CHECK_EQUAL( free_slots(), 2u );
+}
+
+BOOST_FIXTURE_TEST_CASE( unused_slots_of_an_allocation_are_released, slabs )
+{
+    const auto pdu = alloc_transmit( 3 * 29 );
+    BOOST_REQUIRE_EQUAL( pdu.size, 3u * 29u );
+
+    pdu.buffer[ 0 ] = 0x02;
+    pdu.buffer[ 1 ] = 10;
+    push_transmit( pdu );
+    release_transmit_allocation();
+
+    BOOST_CHECK_EQUAL( free_slots(), 3u );
+}
+
+BOOST_FIXTURE_TEST_CASE( consecutive_slots_are_found_between_used_slots, slabs )
+{
+    transmit( 1 );
+    transmit( 2 );
+    transmit( 3 );
+
+    // slot 0 and slot 2 are free now, but not consecutive
+    pop_transmit();
+    receive( 4 );
+    pop_transmit();
+
+    BOOST_CHECK_EQUAL( alloc_transmit( 2 * 29 ).size, 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( reset_frees_all_slots, slabs )
+{
+    transmit( 1 );
+    receive( 2 );
+    alloc_transmit( 29 );
+
+    reset();
+
+    BOOST_CHECK_EQUAL( free_slots(), 4u );
+    BOOST_CHECK_EQUAL( next_transmit().size, 0u );
+    BOOST_CHECK_EQUAL( next_received().size, 0u );
+}
+
+// more than 32 slots need more than one word in the bitmap
+struct many_slabs : bluetoe::link_layer::pdu_slab_storage< 29 * 20, 29 * 20, bluetoe::link_layer::default_pdu_layout > {};
+
+BOOST_FIXTURE_TEST_CASE( more_than_32_slots, many_slabs )
+{
+    std::vector< std::uint8_t* > pdus;
+
+    for ( auto pdu = alloc_transmit( 29 ); pdu.size; pdu = alloc_transmit( 29 ) )
+    {
+        pdu.buffer[ 0 ] = 0x02;
+        pdu.buffer[ 1 ] = 0x01;
+        push_transmit( pdu );
+        pdus.push_back( pdu.buffer );
+    }
+
+    BOOST_CHECK_EQUAL( pdus.size(), 39u );
+
+    for ( std::size_t i = 1; i != pdus.size(); ++i )
+        BOOST_CHECK_EQUAL( pdus[ i ] - pdus[ i - 1 ], 29 );
+}
+
+BOOST_FIXTURE_TEST_CASE( consecutive_slots_across_bitmap_words, many_slabs )
+{
+    const auto transmit = [this]()
+    {
+        const auto pdu = alloc_transmit( 29 );
+        BOOST_REQUIRE( pdu.size );
+
+        pdu.buffer[ 0 ] = 0x02;
+        pdu.buffer[ 1 ] = 0x01;
+        push_transmit( pdu );
+
+        return pdu.buffer;
+    };
+
+    // slots 0 - 27 for transmitting, slot 28 for receiving, slots 29 - 39 for transmitting
+    for ( std::size_t i = 0; i != 28; ++i )
+        transmit();
+
+    const auto received = alloc_receive( 29 );
+    received.buffer[ 0 ] = 0x02;
+    received.buffer[ 1 ] = 0x01;
+    push_receive( received );
+
+    std::uint8_t* first = nullptr;
+
+    for ( std::size_t i = 0; i != 11; ++i )
+    {
+        const auto pdu = transmit();
+        first = first ? first : pdu;
+    }
+
+    BOOST_CHECK_EQUAL( free_slots(), 0u );
+
+    // reuse slots 0 - 27, so that slots 29 - 34 are the only free slots after popping 6 PDUs
+    for ( std::size_t i = 0; i != 28; ++i )
+        pop_transmit();
+
+    for ( std::size_t i = 0; i != 28; ++i )
+        transmit();
+
+    for ( std::size_t i = 0; i != 6; ++i )
+        pop_transmit();
+
+    BOOST_CHECK_EQUAL( free_slots(), 6u );
+    BOOST_CHECK_EQUAL( alloc_transmit( 7 * 29 ).size, 0u );
+    BOOST_CHECK( alloc_transmit( 6 * 29 ).buffer == first );
+    BOOST_CHECK_EQUAL( free_slots(), 0u );
+}
@@ -0,0 +1,95 @@
+#include <bluetoe/pending_procedures.hpp>
+
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+    struct procedures : bluetoe::link_layer::details::pending_procedures< 2 >
+    {
+        bool add( std::uint16_t instant, std::initializer_list< std::uint8_t > body )
+        {
+            const std::vector< std::uint8_t > data( body );
+            return pending_procedures::add( instant, data.data(), data.size() );
+        }
+
+        void check_due( std::uint16_t counter, std::initializer_list< std::uint8_t > expected )
+        {
+            const std::uint8_t* const body = take_due( counter );
+
+            BOOST_REQUIRE( body );
+            BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), body, body + expected.size() );
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_by_default, procedures )
+{
+    BOOST_CHECK( empty() );
+    BOOST_CHECK( take_due( 0 ) == nullptr );
+}
+
+BOOST_FIXTURE_TEST_CASE( procedure_is_due_at_its_instant, procedures )
+{
+    BOOST_CHECK( add( 6, { 0x01, 0xff, 0xff, 0xff, 0xff, 0x1f, 0x06, 0x00 } ) );
+    BOOST_CHECK( !empty() );
+
+    BOOST_CHECK( take_due( 5 ) == nullptr );
+    check_due( 6, { 0x01, 0xff, 0xff, 0xff, 0xff, 0x1f, 0x06, 0x00 } );
+
+    BOOST_CHECK( empty() );
+    BOOST_CHECK( take_due( 6 ) == nullptr );
+}
+
+BOOST_FIXTURE_TEST_CASE( more_than_one_procedure_can_be_pending, procedures )
+{
+    BOOST_CHECK( add( 8, { 0x00, 0x05 } ) );
+    BOOST_CHECK( add( 6, { 0x01, 0x07 } ) );
+
+    check_due( 6, { 0x01, 0x07 } );
+    BOOST_CHECK( !empty() );
+    check_due( 8, { 0x00, 0x05 } );
+    BOOST_CHECK( empty() );
+}
+
+BOOST_FIXTURE_TEST_CASE( procedures_with_the_same_instant, procedures )
+{
+    BOOST_CHECK( add( 6, { 0x00, 0x05 } ) );
+    BOOST_CHECK( add( 6, { 0x01, 0x07 } ) );
+
+    BOOST_CHECK( take_due( 6 ) != nullptr );
+    BOOST_CHECK( take_due( 6 ) != nullptr );
+    BOOST_CHECK( take_due( 6 ) == nullptr );
+}
+
+BOOST_FIXTURE_TEST_CASE( procedure_with_the_same_opcode_is_replaced, procedures )
+{
+    BOOST_CHECK( add( 6, { 0x01, 0x07 } ) );
+    BOOST_CHECK( add( 9, { 0x01, 0x08 } ) );
+
+    BOOST_CHECK( take_due( 6 ) == nullptr );
+    check_due( 9, { 0x01, 0x08 } );
+    BOOST_CHECK( empty() );
+}
+
+BOOST_FIXTURE_TEST_CASE( no_room_for_more_procedures, procedures )
+{
+    BOOST_CHECK( add( 6, { 0x00, 0x05 } ) );
+    BOOST_CHECK( add( 7, { 0x01, 0x07 } ) );
+    BOOST_CHECK( !add( 8, { 0x18, 0x02 } ) );
+
+    take_due( 6 );
+    BOOST_CHECK( add( 8, { 0x18, 0x02 } ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( reset_discards_all_procedures, procedures )
+{
+    add( 6, { 0x00, 0x05 } );
+    add( 7, { 0x01, 0x07 } );
+
+    reset();
+
+    BOOST_CHECK( empty() );
+    BOOST_CHECK( take_due( 6 ) == nullptr );
+}
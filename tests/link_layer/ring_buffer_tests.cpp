@@ -14,12 +14,12 @@ struct small_ring : bluetoe::link_layer::pdu_ring_buffer< 50 >
 
 BOOST_FIXTURE_TEST_CASE( newly_constructed_is_empty, small_ring )
 {
-    BOOST_CHECK_EQUAL( next_end().size, 0u );
+    BOOST_CHECK_EQUAL( next_end( buffer ).size, 0u );
 }
 
 BOOST_FIXTURE_TEST_CASE( newly_contructed_contains_not_more_than_one, small_ring )
 {
-    BOOST_CHECK( !more_than_one() );
+    BOOST_CHECK( !more_than_one( buffer ) );
 }
 
 BOOST_FIXTURE_TEST_CASE( allocating_from_empty, small_ring )
@@ -102,7 +102,7 @@ BOOST_FIXTURE_TEST_CASE( after_freeing_at_the_end_of_a_full_ring_there_is_room_a
 
 BOOST_FIXTURE_TEST_CASE( full_ring_contains_more_than_one, full_ring )
 {
-    BOOST_CHECK( more_than_one() );
+    BOOST_CHECK( more_than_one( buffer ) );
 }
 
 /*
@@ -119,7 +119,7 @@ struct empty_split_ring : full_ring
 
 BOOST_FIXTURE_TEST_CASE( splited_empty, empty_split_ring )
 {
-    BOOST_CHECK_EQUAL( next_end().size, 0u );
+    BOOST_CHECK_EQUAL( next_end( buffer ).size, 0u );
 }
 
 BOOST_FIXTURE_TEST_CASE( when_splitted_full_allocation_not_possible, empty_split_ring )
@@ -130,7 +130,7 @@ BOOST_FIXTURE_TEST_CASE( when_splitted_full_allocation_not_possible, empty_split
 
 BOOST_FIXTURE_TEST_CASE( empty_split_ring_contains_not_more_than_one, empty_split_ring )
 {
-    BOOST_CHECK( !more_than_one() );
+    BOOST_CHECK( !more_than_one( buffer ) );
 }
 
 /*
@@ -147,21 +147,40 @@ struct one_block_at_the_end : empty_split_ring
     }
 };
 
+/*
+ * As long as the consumer did not look at the ring, the end of the ring still points to the wrap mark at pos 36,
+ * so that mark can not be overwritten
+ */
+BOOST_FIXTURE_TEST_CASE( wrap_mark_is_not_overwritten, one_block_at_the_end )
+{
+    BOOST_CHECK_EQUAL( alloc_front( buffer, 3 ).size, 0u );
+}
+
 BOOST_FIXTURE_TEST_CASE( max_alloc_front_after_split, one_block_at_the_end )
 {
+    next_end( buffer );
+
     BOOST_CHECK_EQUAL( alloc_front( buffer, 16 ).size, 0u );
     BOOST_CHECK_EQUAL( alloc_front( buffer, 15 ).size, 15u );
 }
 
+BOOST_FIXTURE_TEST_CASE( more_than_one_follows_the_wrap_mark, one_block_at_the_end )
+{
+    more_than_one( buffer );
+
+    BOOST_CHECK_EQUAL( alloc_front( buffer, 15 ).size, 15u );
+    BOOST_CHECK_EQUAL( alloc_front( buffer, 15 ).buffer, &buffer[ 35 ] );
+}
+
 BOOST_FIXTURE_TEST_CASE( access_to_allocated_block_at_the_beginning, one_block_at_the_end )
 {
-    BOOST_CHECK_EQUAL( next_end().size, 35u );
-    BOOST_CHECK_EQUAL( next_end().buffer - &buffer[ 0 ], 0 );
+    BOOST_CHECK_EQUAL( next_end( buffer ).size, 35u );
+    BOOST_CHECK_EQUAL( next_end( buffer ).buffer - &buffer[ 0 ], 0 );
 }
 
 BOOST_FIXTURE_TEST_CASE( one_block_at_the_end_contains_not_more_than_one, one_block_at_the_end )
 {
-    BOOST_CHECK( !more_than_one() );
+    BOOST_CHECK( !more_than_one( buffer ) );
 }
 
 /*
@@ -179,8 +198,8 @@ struct one_small_block_at_the_end : empty_split_ring
 
 BOOST_FIXTURE_TEST_CASE( access_to_allocated_small_block_at_the_end, one_small_block_at_the_end )
 {
-    BOOST_CHECK_EQUAL( next_end().size, 3u );
-    BOOST_CHECK_EQUAL( next_end().buffer - &buffer[ 0 ], 36u );
+    BOOST_CHECK_EQUAL( next_end( buffer ).size, 3u );
+    BOOST_CHECK_EQUAL( next_end( buffer ).buffer - &buffer[ 0 ], 36u );
 }
 
 /*
@@ -191,6 +210,8 @@ struct splitted_at_end : one_block_at_the_end
 {
     splitted_at_end()
     {
+        next_end( buffer );
+
         auto p = alloc_front( buffer, 15 );
         p.buffer[ 1 ] = 13;
         push_front( buffer, p );
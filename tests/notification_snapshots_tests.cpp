@@ -0,0 +1,282 @@
+#include <bluetoe/notification_snapshots.hpp>
+
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+namespace {
+    struct ring : bluetoe::details::notification_snapshot_ring< 20 >
+    {
+        bool push( std::initializer_list< std::uint8_t > snapshot )
+        {
+            std::size_t         size   = snapshot.size();
+            std::uint8_t* const output = reserve_snapshot( size );
+
+            if ( output == nullptr )
+                return false;
+
+            if ( size != snapshot.size() )
+            {
+                commit_snapshot( output, 0 );
+                return false;
+            }
+
+            std::copy( snapshot.begin(), snapshot.end(), output );
+            commit_snapshot( output, size );
+
+            return true;
+        }
+
+        void check_next( std::initializer_list< std::uint8_t > expected )
+        {
+            BOOST_REQUIRE_EQUAL( next_snapshot_size(), expected.size() );
+
+            std::vector< std::uint8_t > snapshot( expected.size() );
+            pop_snapshot( snapshot.data() );
+
+            BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), snapshot.begin(), snapshot.end() );
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_ring, ring )
+{
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( snapshots_are_returned_in_order, ring )
+{
+    BOOST_CHECK( push( { 1, 2, 3 } ) );
+    BOOST_CHECK( push( { 4 } ) );
+    BOOST_CHECK( push( { 5, 6 } ) );
+
+    check_next( { 1, 2, 3 } );
+    check_next( { 4 } );
+    check_next( { 5, 6 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( largest_snapshot, ring )
+{
+    BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18 } ) );
+    check_next( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( snapshot_exceeding_the_buffer, ring )
+{
+    BOOST_CHECK( !push( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 } ) );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( full_ring, ring )
+{
+    BOOST_CHECK( push( { 1, 1, 1, 1, 1, 1, 1, 1 } ) );
+    BOOST_CHECK( push( { 2, 2, 2, 2, 2, 2, 2, 2 } ) );
+    BOOST_CHECK( !push( { 3 } ) );
+
+    check_next( { 1, 1, 1, 1, 1, 1, 1, 1 } );
+    check_next( { 2, 2, 2, 2, 2, 2, 2, 2 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( room_is_available_after_pop, ring )
+{
+    BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, 8 } ) );
+    BOOST_CHECK( push( { 9, 10, 11, 12, 13, 14, 15 } ) );
+    BOOST_CHECK( !push( { 16, 17 } ) );
+
+    check_next( { 1, 2, 3, 4, 5, 6, 7, 8 } );
+    BOOST_CHECK( push( { 16, 17, 18, 19, 20, 21, 22, 23 } ) );
+
+    check_next( { 9, 10, 11, 12, 13, 14, 15 } );
+    check_next( { 16, 17, 18, 19, 20, 21, 22, 23 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+/*
+ * snapshots are stored contiguously; an empty ring has room for half of the buffer at least in front of the end or in
+ * front of the read position
+ */
+BOOST_FIXTURE_TEST_CASE( empty_ring_can_store_half_the_buffer_at_every_position, ring )
+{
+    for ( std::uint8_t start = 0; start != 45; ++start )
+    {
+        BOOST_CHECK( push( { start } ) );
+        check_next( { start } );
+
+        BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, start } ) );
+        check_next( { 1, 2, 3, 4, 5, 6, 7, start } );
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( end_of_buffer_is_skipped, ring )
+{
+    BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } ) );
+    check_next( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } );
+
+    // room for 6 bytes in front of the end, for 10 bytes after skipping the end
+    BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } ) );
+    check_next( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( reservation_is_limited_to_the_remaining_room, ring )
+{
+    BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } ) );
+
+    std::size_t size = 10;
+    std::uint8_t* const output = reserve_snapshot( size );
+    BOOST_REQUIRE( output != nullptr );
+    BOOST_CHECK_EQUAL( size, 6u );
+
+    commit_snapshot( output, 0 );
+    check_next( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( uncommitted_snapshots_are_not_returned, ring )
+{
+    std::size_t first_size = 3;
+    std::uint8_t* const first = reserve_snapshot( first_size );
+
+    BOOST_CHECK( push( { 4, 5 } ) );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+
+    first[ 0 ] = 1;
+    first[ 1 ] = 2;
+    commit_snapshot( first, 2 );
+
+    check_next( { 1, 2 } );
+    check_next( { 4, 5 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( discarded_reservation_frees_the_room, ring )
+{
+    std::size_t size = 18;
+    std::uint8_t* const output = reserve_snapshot( size );
+    BOOST_REQUIRE( output != nullptr );
+    commit_snapshot( output, 0 );
+
+    BOOST_CHECK( push( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18 } ) );
+    check_next( { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( wrap_around_with_a_filled_ring, ring )
+{
+    BOOST_CHECK( push( { 0, 0, 0 } ) );
+
+    for ( std::uint8_t value = 1; value != 100; ++value )
+    {
+        BOOST_CHECK( push( { value, value, value } ) );
+        check_next( { static_cast< std::uint8_t >( value - 1 ), static_cast< std::uint8_t >( value - 1 ), static_cast< std::uint8_t >( value - 1 ) } );
+    }
+
+    check_next( { 99, 99, 99 } );
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( clear_removes_all_snapshots, ring )
+{
+    BOOST_CHECK( push( { 1, 2, 3 } ) );
+    BOOST_CHECK( push( { 4 } ) );
+
+    clear_snapshots();
+    BOOST_CHECK_EQUAL( next_snapshot_size(), 0u );
+
+    BOOST_CHECK( push( { 5 } ) );
+    check_next( { 5 } );
+}
+
+namespace {
+    struct large_ring : bluetoe::details::notification_snapshot_ring< 256 > {};
+}
+
+/*
+ * Producer threads push numbered snapshots of different sizes, while a consumer pops them. Every snapshot has to be
+ * popped exactly once, unchanged, and in the order in which its producer pushed it.
+ */
+BOOST_FIXTURE_TEST_CASE( concurrent_producers, large_ring )
+{
+    static constexpr std::size_t producers              = 4;
+    static constexpr unsigned    snapshots_per_producer = 20000;
+
+    std::atomic< std::size_t > running_producers( producers );
+    std::vector< std::thread > threads;
+
+    for ( std::size_t producer = 0; producer != producers; ++producer )
+    {
+        threads.emplace_back( [&, producer]{
+            for ( unsigned count = 0; count != snapshots_per_producer; )
+            {
+                std::size_t         size   = 3 + ( count + producer ) % 20;
+                const std::size_t   wanted = size;
+                std::uint8_t* const output = reserve_snapshot( size );
+
+                if ( output == nullptr || size != wanted )
+                {
+                    if ( output )
+                        commit_snapshot( output, 0 );
+
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                output[ 0 ] = static_cast< std::uint8_t >( producer );
+                output[ 1 ] = static_cast< std::uint8_t >( count & 0xff );
+                output[ 2 ] = static_cast< std::uint8_t >( count >> 8 );
+
+                for ( std::size_t i = 3; i != size; ++i )
+                    output[ i ] = static_cast< std::uint8_t >( count + i );
+
+                commit_snapshot( output, size );
+                ++count;
+            }
+
+            --running_producers;
+        } );
+    }
+
+    std::vector< unsigned > next_count( producers, 0 );
+    bool producers_done = false;
+
+    for ( ;; )
+    {
+        const std::size_t size = next_snapshot_size();
+
+        if ( size == 0 )
+        {
+            if ( producers_done )
+                break;
+
+            producers_done = running_producers == 0;
+            continue;
+        }
+
+        std::uint8_t snapshot[ 22 ];
+        BOOST_REQUIRE_GE( size, 3u );
+        BOOST_REQUIRE_LE( size, sizeof( snapshot ) );
+        pop_snapshot( snapshot );
+
+        const std::size_t producer = snapshot[ 0 ];
+        BOOST_REQUIRE_LT( producer, producers );
+
+        const unsigned count = snapshot[ 1 ] | ( snapshot[ 2 ] << 8 );
+        BOOST_REQUIRE_EQUAL( count, next_count[ producer ] & 0xffff );
+        BOOST_REQUIRE_EQUAL( size, 3 + ( next_count[ producer ] + producer ) % 20 );
+
+        for ( std::size_t i = 3; i != size; ++i )
+            BOOST_REQUIRE_EQUAL( snapshot[ i ], static_cast< std::uint8_t >( count + i ) );
+
+        ++next_count[ producer ];
+    }
+
+    for ( auto& thread : threads )
+        thread.join();
+
+    for ( std::size_t producer = 0; producer != producers; ++producer )
+        BOOST_CHECK_EQUAL( next_count[ producer ], snapshots_per_producer );
+}
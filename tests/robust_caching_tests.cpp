@@ -0,0 +1,321 @@
+#include <iostream>
+#include <bluetoe/server.hpp>
+#include <bluetoe/aes_cmac.hpp>
+
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include "test_servers.hpp"
+
+namespace {
+    const std::uint8_t rfc4493_key[ 16 ] = {
+        0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+    };
+
+    const std::uint8_t rfc4493_message[ 64 ] = {
+        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+        0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+    };
+
+    std::vector< std::uint8_t > cmac( const std::uint8_t* key, const std::uint8_t* begin, const std::uint8_t* end, std::size_t chunk_size = 64 )
+    {
+        bluetoe::details::aes_cmac mac( key );
+
+        for ( ; static_cast< std::size_t >( end - begin ) > chunk_size; begin += chunk_size )
+            mac.update( begin, begin + chunk_size );
+
+        mac.update( begin, end );
+
+        std::vector< std::uint8_t > result( 16 );
+        mac.finish( result.data() );
+
+        return result;
+    }
+
+    void check_cmac( std::size_t message_size, std::initializer_list< std::uint8_t > expected )
+    {
+        for ( std::size_t chunk_size = 1; chunk_size != 20; ++chunk_size )
+        {
+            const auto result = cmac( rfc4493_key, &rfc4493_message[ 0 ], &rfc4493_message[ message_size ], chunk_size );
+            BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), result.begin(), result.end() );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( aes_cmac )
+
+BOOST_AUTO_TEST_CASE( fips_197_example_vector )
+{
+    const std::uint8_t key[ 16 ] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+    };
+
+    std::uint8_t block[ 16 ] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    };
+
+    const std::uint8_t expected[ 16 ] = {
+        0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+    };
+
+    bluetoe::details::aes_cmac( key ).encrypt( block );
+
+    BOOST_CHECK_EQUAL_COLLECTIONS( std::begin( expected ), std::end( expected ), std::begin( block ), std::end( block ) );
+}
+
+BOOST_AUTO_TEST_CASE( rfc4493_empty_message )
+{
+    check_cmac( 0, { 0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46 } );
+}
+
+BOOST_AUTO_TEST_CASE( rfc4493_one_block )
+{
+    check_cmac( 16, { 0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c } );
+}
+
+BOOST_AUTO_TEST_CASE( rfc4493_incomplete_last_block )
+{
+    check_cmac( 40, { 0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27 } );
+}
+
+BOOST_AUTO_TEST_CASE( rfc4493_four_blocks )
+{
+    check_cmac( 64, { 0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe } );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+    std::uint8_t value = 0;
+
+    using caching_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0101 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value >
+            >
+        >,
+        bluetoe::no_gap_service_for_gatt_servers,
+        bluetoe::robust_caching
+    >;
+
+    using caching_fixture = test::request_with_reponse< caching_server >;
+
+    struct change_unaware_client : caching_fixture
+    {
+        change_unaware_client()
+        {
+            // enable robust caching
+            l2cap_input( { 0x12, 0x06, 0x00, 0x01 } );
+            expected_result( { 0x13 } );
+
+            connection.change_aware( false );
+        }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE( gatt_service )
+
+BOOST_AUTO_TEST_CASE( not_added_by_default )
+{
+    BOOST_CHECK_EQUAL( std::size_t{ test::small_temperature_service::number_of_attributes }, 3u );
+    BOOST_CHECK_EQUAL( std::size_t{ caching_server::number_of_attributes }, 3u + 5u );
+}
+
+BOOST_FIXTURE_TEST_CASE( gatt_service_discovered, caching_fixture )
+{
+    l2cap_input( { 0x10, 0x01, 0x00, 0xff, 0xff, 0x00, 0x28 } );
+    expected_result( {
+        0x11, 0x06,
+        0x01, 0x00, 0x03, 0x00, 0x34, 0x12,
+        0x04, 0x00, 0x08, 0x00, 0x01, 0x18
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( characteristics_discovered, caching_fixture )
+{
+    l2cap_input( { 0x08, 0x04, 0x00, 0x08, 0x00, 0x03, 0x28 } );
+    expected_result( {
+        0x09, 0x07,
+        0x05, 0x00, 0x0A, 0x06, 0x00, 0x29, 0x2B,
+        0x07, 0x00, 0x02, 0x08, 0x00, 0x2A, 0x2B
+    } );
+}
+
+namespace {
+    using server_with_gatt_service = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1801 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x2A05 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value >
+            >
+        >,
+        bluetoe::no_gap_service_for_gatt_servers,
+        bluetoe::robust_caching
+    >;
+}
+
+BOOST_AUTO_TEST_CASE( no_second_gatt_service )
+{
+    BOOST_CHECK_EQUAL( std::tuple_size< server_with_gatt_service::services >::value, 1u );
+    BOOST_CHECK_EQUAL( std::size_t{ server_with_gatt_service::number_of_attributes }, 3u + 4u );
+}
+
+BOOST_FIXTURE_TEST_CASE( characteristics_added_to_the_existing_gatt_service, test::request_with_reponse< server_with_gatt_service > )
+{
+    l2cap_input( { 0x08, 0x01, 0x00, 0xff, 0xff, 0x03, 0x28 } );
+    expected_result( {
+        0x09, 0x07,
+        0x02, 0x00, 0x0A, 0x03, 0x00, 0x05, 0x2A,
+        0x04, 0x00, 0x0A, 0x05, 0x00, 0x29, 0x2B,
+        0x06, 0x00, 0x02, 0x07, 0x00, 0x2A, 0x2B
+    } );
+}
+
+BOOST_FIXTURE_TEST_CASE( database_hash, caching_fixture )
+{
+    static const std::uint8_t message[] = {
+        0x01, 0x00, 0x00, 0x28, 0x34, 0x12,
+        0x02, 0x00, 0x03, 0x28, 0x0A, 0x03, 0x00, 0x01, 0x01,
+        0x04, 0x00, 0x00, 0x28, 0x01, 0x18,
+        0x05, 0x00, 0x03, 0x28, 0x0A, 0x06, 0x00, 0x29, 0x2B,
+        0x07, 0x00, 0x03, 0x28, 0x02, 0x08, 0x00, 0x2A, 0x2B
+    };
+
+    static const std::uint8_t zero_key[ 16 ] = { 0 };
+    auto expected = cmac( zero_key, std::begin( message ), std::end( message ) );
+    std::reverse( expected.begin(), expected.end() );
+    expected.insert( expected.begin(), 0x0B );
+
+    l2cap_input( { 0x0A, 0x08, 0x00 } );
+    BOOST_CHECK_EQUAL_COLLECTIONS( expected.begin(), expected.end(), &response[ 0 ], &response[ response_size ] );
+}
+
+BOOST_FIXTURE_TEST_CASE( database_hash_is_read_only, caching_fixture )
+{
+    BOOST_CHECK( check_error_response( { 0x12, 0x08, 0x00, 0x01 }, 0x12, 0x0008, 0x03 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_supported_features_default_to_zero, caching_fixture )
+{
+    l2cap_input( { 0x0A, 0x06, 0x00 } );
+    expected_result( { 0x0B, 0x00 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_supported_features_are_stored_per_connection, caching_fixture )
+{
+    l2cap_input( { 0x12, 0x06, 0x00, 0x01 } );
+    expected_result( { 0x13 } );
+
+    l2cap_input( { 0x0A, 0x06, 0x00 } );
+    expected_result( { 0x0B, 0x01 } );
+
+    BOOST_CHECK_EQUAL( connection.client_supported_features(), 0x01 );
+
+    caching_server::connection_data other_connection( 23 );
+    l2cap_input( { 0x0A, 0x06, 0x00 }, other_connection );
+    expected_result( { 0x0B, 0x00 } );
+}
+
+BOOST_AUTO_TEST_CASE( client_supported_features_are_not_stored_without_robust_caching )
+{
+    using server_without_caching = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            bluetoe::characteristic<
+                bluetoe::characteristic_uuid16< 0x0101 >,
+                bluetoe::bind_characteristic_value< std::uint8_t, &value >
+            >
+        >,
+        bluetoe::no_gap_service_for_gatt_servers
+    >;
+
+    BOOST_CHECK( std::is_empty< bluetoe::details::client_characteristic_configurations< 0 > >::value );
+    BOOST_CHECK_LT(
+        sizeof( bluetoe::details::client_characteristic_configurations< 4 > ),
+        sizeof( bluetoe::details::client_characteristic_configurations< 4, true > ) );
+
+    server_without_caching::connection_data connection( 23 );
+    BOOST_CHECK_EQUAL( connection.client_supported_features(), 0 );
+}
+
+BOOST_FIXTURE_TEST_CASE( unsupported_features_are_ignored, caching_fixture )
+{
+    l2cap_input( { 0x12, 0x06, 0x00, 0xF0 } );
+    expected_result( { 0x13 } );
+
+    l2cap_input( { 0x0A, 0x06, 0x00 } );
+    expected_result( { 0x0B, 0x00 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( features_can_not_be_cleared, caching_fixture )
+{
+    l2cap_input( { 0x12, 0x06, 0x00, 0x01 } );
+    expected_result( { 0x13 } );
+
+    BOOST_CHECK( check_error_response( { 0x12, 0x06, 0x00, 0x00 }, 0x12, 0x0006, 0x13 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE( change_awareness )
+
+BOOST_FIXTURE_TEST_CASE( clients_start_change_aware, caching_fixture )
+{
+    BOOST_CHECK( connection.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( change_unaware_client_gets_database_out_of_sync, change_unaware_client )
+{
+    BOOST_CHECK( check_error_response( { 0x0A, 0x03, 0x00 }, 0x0A, 0x0000, 0x12 ) );
+    BOOST_CHECK( !connection.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( next_request_after_the_error_is_served, change_unaware_client )
+{
+    BOOST_CHECK( check_error_response( { 0x0A, 0x03, 0x00 }, 0x0A, 0x0000, 0x12 ) );
+
+    l2cap_input( { 0x0A, 0x03, 0x00 } );
+    expected_result( { 0x0B, 0x00 } );
+
+    BOOST_CHECK( connection.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( reading_the_hash_by_type_makes_the_client_change_aware, change_unaware_client )
+{
+    l2cap_input( { 0x08, 0x01, 0x00, 0xff, 0xff, 0x2A, 0x2B } );
+    BOOST_CHECK_EQUAL( response[ 0 ], 0x09 );
+    BOOST_CHECK_EQUAL( response[ 1 ], 2 + 16 );
+    BOOST_CHECK_EQUAL( response[ 2 ], 0x08 );
+
+    BOOST_CHECK( connection.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( commands_are_ignored, change_unaware_client )
+{
+    l2cap_input( { 0x52, 0x03, 0x00, 0x42 } );
+    BOOST_CHECK_EQUAL( response_size, 0u );
+    BOOST_CHECK_EQUAL( value, 0 );
+
+    BOOST_CHECK( check_error_response( { 0x0A, 0x03, 0x00 }, 0x0A, 0x0000, 0x12 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( mtu_exchange_is_not_affected, change_unaware_client )
+{
+    l2cap_input( { 0x02, 0x17, 0x00 } );
+    expected_result( { 0x03, 0x17, 0x00 } );
+}
+
+BOOST_FIXTURE_TEST_CASE( without_robust_caching_enabled_the_client_is_served, caching_fixture )
+{
+    connection.change_aware( false );
+
+    l2cap_input( { 0x0A, 0x03, 0x00 } );
+    expected_result( { 0x0B, 0x00 } );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
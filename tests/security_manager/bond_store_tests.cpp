@@ -0,0 +1,278 @@
+#define BOOST_TEST_MODULE
+#include <boost/test/included/unit_test.hpp>
+
+#include <bluetoe/bond_store.hpp>
+#include <bluetoe/file_bond_store.hpp>
+
+#include <cstdio>
+
+namespace {
+    bluetoe::bond_data make_bond( std::uint16_t ediv, std::uint8_t address )
+    {
+        return bluetoe::bond_data{
+            {
+                {{ 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, address }},
+                0xaabbccdd00112233,
+                ediv
+            },
+            {{ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10 }},
+            bluetoe::link_layer::random_device_address( { address, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6 } )
+        };
+    }
+
+    const bluetoe::details::uint128_t no_database    = {{ 0 }};
+    const bluetoe::details::uint128_t some_database  = {{ 0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xdb, 0xdc, 0xdd, 0xde, 0xdf }};
+    const bluetoe::details::uint128_t other_database = {{ 0xe0, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xeb, 0xec, 0xed, 0xee, 0xef }};
+
+    struct ram_store : bluetoe::ram_bond_store< 2, 4, true > {};
+
+    struct file_store
+    {
+        static constexpr const char* path = "bond_store_tests.bonds";
+
+        file_store()
+        {
+            std::remove( path );
+        }
+
+        ~file_store()
+        {
+            std::remove( path );
+        }
+
+        using store_t = bluetoe::file_bond_store< 2, 4, true >;
+    };
+
+    std::uint8_t configs[ 1 ];
+    std::uint8_t features = 0;
+}
+
+BOOST_FIXTURE_TEST_CASE( empty_by_default, ram_store )
+{
+    BOOST_CHECK_EQUAL( size(), 0u );
+    BOOST_CHECK_EQUAL( find_bond( 0x1234, 0xaabbccdd00112233 ), std::size_t{ no_bond } );
+}
+
+BOOST_FIXTURE_TEST_CASE( bonds_are_found_by_ediv_and_rand, ram_store )
+{
+    add_bond( make_bond( 0x1234, 1 ) );
+    const std::size_t index = add_bond( make_bond( 0x4321, 2 ) );
+
+    BOOST_CHECK_EQUAL( size(), 2u );
+    BOOST_REQUIRE_EQUAL( find_bond( 0x4321, 0xaabbccdd00112233 ), index );
+    BOOST_CHECK_EQUAL( long_term_key( index )[ 15 ], 2 );
+    BOOST_CHECK_EQUAL( find_bond( 0x4321, 0xaabbccdd00112234 ), std::size_t{ no_bond } );
+}
+
+BOOST_FIXTURE_TEST_CASE( bond_with_same_identity_is_replaced, ram_store )
+{
+    add_bond( make_bond( 0x1234, 1 ) );
+    add_bond( make_bond( 0x4321, 1 ) );
+
+    BOOST_CHECK_EQUAL( size(), 1u );
+    BOOST_CHECK_EQUAL( find_bond( 0x1234, 0xaabbccdd00112233 ), std::size_t{ no_bond } );
+    BOOST_CHECK_NE( find_bond( 0x4321, 0xaabbccdd00112233 ), std::size_t{ no_bond } );
+}
+
+BOOST_FIXTURE_TEST_CASE( oldest_bond_is_replaced, ram_store )
+{
+    add_bond( make_bond( 1, 1 ) );
+    add_bond( make_bond( 2, 2 ) );
+    add_bond( make_bond( 3, 3 ) );
+
+    BOOST_CHECK_EQUAL( size(), 2u );
+    BOOST_CHECK_EQUAL( find_bond( 1, 0xaabbccdd00112233 ), std::size_t{ no_bond } );
+    BOOST_CHECK_NE( find_bond( 2, 0xaabbccdd00112233 ), std::size_t{ no_bond } );
+    BOOST_CHECK_NE( find_bond( 3, 0xaabbccdd00112233 ), std::size_t{ no_bond } );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_configurations_are_stored_per_bond, ram_store )
+{
+    const std::size_t first  = add_bond( make_bond( 1, 1 ) );
+    const std::size_t second = add_bond( make_bond( 2, 2 ) );
+
+    bluetoe::details::client_characteristic_configuration config( &configs[ 0 ], 4 );
+    config.flags( 0, 0x01 );
+    config.flags( 3, 0x02 );
+    store_client_configurations( first, config, 4, some_database );
+
+    config.flags( 0, 0x00 );
+    config.flags( 3, 0x00 );
+    load_client_configurations( second, config, 4 );
+    BOOST_CHECK_EQUAL( config.flags( 3 ), 0x00 );
+
+    load_client_configurations( first, config, 4 );
+    BOOST_CHECK_EQUAL( config.flags( 0 ), 0x01 );
+    BOOST_CHECK_EQUAL( config.flags( 1 ), 0x00 );
+    BOOST_CHECK_EQUAL( config.flags( 3 ), 0x02 );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_supported_features_and_database_hash_are_stored_per_bond, ram_store )
+{
+    const std::size_t first  = add_bond( make_bond( 1, 1 ) );
+    const std::size_t second = add_bond( make_bond( 2, 2 ) );
+
+    BOOST_CHECK( database_hash( first ) == no_database );
+
+    bluetoe::details::client_characteristic_configuration config( &configs[ 0 ], 4, &features );
+    config.client_supported_features( 0x05 );
+    store_client_configurations( first, config, 4, other_database );
+
+    load_client_configurations( second, config, 4 );
+    BOOST_CHECK_EQUAL( config.client_supported_features(), 0x00 );
+    BOOST_CHECK( database_hash( second ) == no_database );
+
+    load_client_configurations( first, config, 4 );
+    BOOST_CHECK_EQUAL( config.client_supported_features(), 0x05 );
+    BOOST_CHECK( database_hash( first ) == other_database );
+}
+
+BOOST_FIXTURE_TEST_CASE( a_new_bond_resets_the_client_state, ram_store )
+{
+    const std::size_t index = add_bond( make_bond( 1, 1 ) );
+
+    bluetoe::details::client_characteristic_configuration config( &configs[ 0 ], 4, &features );
+    config.client_supported_features( 0x01 );
+    store_client_configurations( index, config, 4, other_database );
+
+    BOOST_REQUIRE_EQUAL( add_bond( make_bond( 1, 1 ) ), index );
+
+    load_client_configurations( index, config, 4 );
+    BOOST_CHECK_EQUAL( config.client_supported_features(), 0x00 );
+    BOOST_CHECK( database_hash( index ) == no_database );
+}
+
+BOOST_AUTO_TEST_CASE( database_hash_is_not_stored_by_default )
+{
+    BOOST_CHECK_LT( sizeof( bluetoe::ram_bond_store< 2, 4 > ), sizeof( bluetoe::ram_bond_store< 2, 4, true > ) );
+
+    bluetoe::ram_bond_store< 2, 4 > store;
+    const std::size_t index = store.add_bond( make_bond( 1, 1 ) );
+
+    bluetoe::details::client_characteristic_configuration config( &configs[ 0 ], 4, &features );
+    store.store_client_configurations( index, config, 4, other_database );
+
+    BOOST_CHECK( store.database_hash( index ) == no_database );
+}
+
+BOOST_FIXTURE_TEST_CASE( missing_file_is_an_empty_store, file_store )
+{
+    store_t store;
+
+    BOOST_CHECK( store.open( path ) );
+    BOOST_CHECK_EQUAL( store.size(), 0u );
+}
+
+BOOST_FIXTURE_TEST_CASE( bonds_are_loaded_from_file, file_store )
+{
+    std::size_t index;
+    {
+        store_t store;
+        BOOST_REQUIRE( store.open( path ) );
+        index = store.add_bond( make_bond( 0x1234, 1 ) );
+
+        bluetoe::details::client_characteristic_configuration config( &configs[ 0 ], 4, &features );
+        config.flags( 2, 0x03 );
+        config.client_supported_features( 0x01 );
+        BOOST_CHECK( store.store_client_configurations( index, config, 4, other_database ) );
+    }
+
+    store_t store;
+    BOOST_REQUIRE( store.open( path ) );
+    BOOST_CHECK_EQUAL( store.size(), 1u );
+    BOOST_REQUIRE_EQUAL( store.find_bond( 0x1234, 0xaabbccdd00112233 ), index );
+
+    const bluetoe::bond_data& loaded = store.bond( index );
+    const bluetoe::bond_data  expected = make_bond( 0x1234, 1 );
+
+    BOOST_CHECK( loaded.long_term_key.longterm_key == expected.long_term_key.longterm_key );
+    BOOST_CHECK( loaded.identity_resolving_key == expected.identity_resolving_key );
+    BOOST_CHECK_EQUAL( loaded.identity_address, expected.identity_address );
+
+    configs[ 0 ] = 0;
+    features     = 0;
+    bluetoe::details::client_characteristic_configuration config( &configs[ 0 ], 4, &features );
+    store.load_client_configurations( index, config, 4 );
+    BOOST_CHECK_EQUAL( config.flags( 2 ), 0x03 );
+    BOOST_CHECK_EQUAL( config.client_supported_features(), 0x01 );
+    BOOST_CHECK( store.database_hash( index ) == other_database );
+}
+
+BOOST_FIXTURE_TEST_CASE( bond_is_not_kept_if_the_file_can_not_be_written, file_store )
+{
+    store_t store;
+    BOOST_REQUIRE( store.open( "no_such_directory/bond_store_tests.bonds" ) );
+
+    BOOST_CHECK_EQUAL( store.add_bond( make_bond( 0x1234, 1 ) ), std::size_t{ store_t::no_bond } );
+    BOOST_CHECK_EQUAL( store.size(), 0u );
+    BOOST_CHECK_EQUAL( store.find_bond( 0x1234, 0xaabbccdd00112233 ), std::size_t{ store_t::no_bond } );
+}
+
+namespace {
+    // a file store, that can be made unwritable after bonds were added; opening a missing file keeps the bonds in RAM
+    struct unwritable_file_store : file_store
+    {
+        static constexpr const char* other_path = "bond_store_tests_other.bonds";
+
+        unwritable_file_store()
+        {
+            std::remove( other_path );
+            store.open( path );
+        }
+
+        ~unwritable_file_store()
+        {
+            std::remove( other_path );
+        }
+
+        void make_unwritable()
+        {
+            store.open( "no_such_directory/bond_store_tests.bonds" );
+        }
+
+        void make_writable()
+        {
+            store.open( other_path );
+        }
+
+        store_t store;
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( bond_with_same_identity_is_kept_if_the_file_can_not_be_written, unwritable_file_store )
+{
+    const std::size_t index = store.add_bond( make_bond( 0x1234, 1 ) );
+    make_unwritable();
+
+    BOOST_CHECK_EQUAL( store.add_bond( make_bond( 0x4321, 1 ) ), std::size_t{ store_t::no_bond } );
+    BOOST_CHECK_EQUAL( store.size(), 1u );
+    BOOST_CHECK_EQUAL( store.find_bond( 0x1234, 0xaabbccdd00112233 ), index );
+    BOOST_CHECK_EQUAL( store.find_bond( 0x4321, 0xaabbccdd00112233 ), std::size_t{ store_t::no_bond } );
+}
+
+BOOST_FIXTURE_TEST_CASE( oldest_bond_is_kept_if_the_file_can_not_be_written, unwritable_file_store )
+{
+    const std::size_t first = store.add_bond( make_bond( 1, 1 ) );
+    store.add_bond( make_bond( 2, 2 ) );
+    make_unwritable();
+
+    BOOST_CHECK_EQUAL( store.add_bond( make_bond( 3, 3 ) ), std::size_t{ store_t::no_bond } );
+    BOOST_CHECK_EQUAL( store.size(), 2u );
+    BOOST_CHECK_EQUAL( store.find_bond( 1, 0xaabbccdd00112233 ), first );
+
+    // the oldest bond is still the next to be replaced
+    make_writable();
+    BOOST_CHECK_EQUAL( store.add_bond( make_bond( 3, 3 ) ), first );
+}
+
+BOOST_FIXTURE_TEST_CASE( file_of_a_different_store_is_rejected, file_store )
+{
+    {
+        bluetoe::file_bond_store< 3, 4 > store;
+        BOOST_REQUIRE( store.open( path ) );
+        store.add_bond( make_bond( 0x1234, 1 ) );
+    }
+
+    store_t store;
+    BOOST_CHECK( !store.open( path ) );
+}
@@ -2,6 +2,8 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include <bluetoe/security_manager.hpp>
+#include <bluetoe/bond_store.hpp>
+#include <bluetoe/server.hpp>
 
 #include "test_sm.hpp"
 
@@ -13,16 +15,343 @@ BOOST_FIXTURE_TEST_CASE( no_distribution_over_unsecure_connection, test::pairing
     BOOST_CHECK( !connection_data().outgoing_security_manager_data_available( link ) );
 }
 
-#if 0
 BOOST_FIXTURE_TEST_CASE( no_distribution_when_in_wrong_state, test::pairing_confirm_exchanged )
 {
-    bluetoe::details::link_state< void_ > link( 23, true );
+    bluetoe::details::link_state< void_ > link( 23 );
+    link.is_encrypted( true );
+
     BOOST_CHECK( !connection_data().outgoing_security_manager_data_available( link ) );
 }
 
 BOOST_FIXTURE_TEST_CASE( no_distribution_when_no_key_was_being_asked_for, test::pairing_random_exchanged )
 {
-    bluetoe::details::link_state< void_ > link( 23, true );
+    bluetoe::details::link_state< void_ > link( 23 );
+    link.is_encrypted( true );
+
     BOOST_CHECK( !connection_data().outgoing_security_manager_data_available( link ) );
 }
-#endif
+
+BOOST_FIXTURE_TEST_CASE( no_bonding_without_bond_store, test::security_manager< bluetoe::security_manager > )
+{
+    expected(
+        {
+            0x01,           // Pairing Request
+            0x03,           // IO Capability NoInputNoOutput
+            0x00,           // OOB data flag (data not present)
+            0x01,           // AuthReq: Bonding
+            0x10,           // Maximum Encryption Key Size (16)
+            0x07,           // Initiator Key Distribution
+            0x07,           // Responder Key Distribution
+        },
+        {
+            0x02,           // response
+            0x03,           // NoInputNoOutput
+            0x00,           // OOB Authentication data not present
+            0x00,           // No Bonding
+            0x10,           // Maximum Encryption Key Size
+            0x00,           // no keys
+            0x00            // no keys
+        }
+    );
+}
+
+namespace {
+    using bond_store = bluetoe::ram_bond_store< 2, 8, true >;
+    using bonding_manager = bluetoe::bonding_security_manager< bond_store >;
+
+    const bluetoe::details::uint128_t mrand = {{
+        0xE0, 0x2E, 0x70, 0xC6,
+        0x4E, 0x27, 0x88, 0x63,
+        0x0E, 0x6F, 0xAD, 0x56,
+        0x21, 0xD5, 0x83, 0x57
+    }};
+
+    struct bonding_requested : test::security_manager< bonding_manager >
+    {
+        bonding_requested()
+        {
+            expected(
+                {
+                    0x01,           // Pairing Request
+                    0x03,           // IO Capability NoInputNoOutput
+                    0x00,           // OOB data flag (data not present)
+                    0x01,           // AuthReq: Bonding
+                    0x10,           // Maximum Encryption Key Size (16)
+                    0x07,           // Initiator Key Distribution: EncKey, IdKey, SignKey
+                    0x07,           // Responder Key Distribution: EncKey, IdKey, SignKey
+                },
+                {
+                    0x02,           // response
+                    0x03,           // NoInputNoOutput
+                    0x00,           // OOB Authentication data not present
+                    0x01,           // Bonding
+                    0x10,           // Maximum Encryption Key Size
+                    0x02,           // Initiator Key Distribution: IdKey
+                    0x01            // Responder Key Distribution: EncKey
+                }
+            );
+        }
+    };
+
+    struct bonding_paired : bonding_requested
+    {
+        bonding_paired()
+        {
+            pair( mrand );
+        }
+    };
+
+    struct bonding_encrypted : bonding_paired
+    {
+        bonding_encrypted()
+        {
+            connection_data_.is_encrypted( true );
+        }
+
+        void distribute_local_keys()
+        {
+            output();
+            output();
+        }
+
+        void distribute_remote_keys()
+        {
+            expected(
+                {
+                    0x08,                   // Identity Information
+                    0x01, 0x02, 0x03, 0x04,
+                    0x05, 0x06, 0x07, 0x08,
+                    0x09, 0x0a, 0x0b, 0x0c,
+                    0x0d, 0x0e, 0x0f, 0x10
+                },
+                {}
+            );
+
+            expected(
+                {
+                    0x09,                   // Identity Address Information
+                    0x00,                   // public
+                    0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6
+                },
+                {}
+            );
+        }
+    };
+
+    struct bonded : bonding_encrypted
+    {
+        bonded()
+        {
+            distribute_local_keys();
+            distribute_remote_keys();
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( no_distribution_before_encryption, bonding_paired )
+{
+    BOOST_CHECK( !connection_data().outgoing_security_manager_data_available( connection_data() ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( long_term_key_distributed, bonding_encrypted )
+{
+    BOOST_CHECK( connection_data().outgoing_security_manager_data_available( connection_data() ) );
+
+    expected_output( {
+        0x06,                   // Encryption Information
+        0x00, 0x11, 0x22, 0x33,
+        0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb,
+        0xcc, 0xdd, 0xee, 0xff
+    } );
+
+    expected_output( {
+        0x07,                   // Master Identification
+        0x34, 0x12,             // EDIV
+        0x33, 0x22, 0x11, 0x00, // Rand
+        0xdd, 0xcc, 0xbb, 0xaa
+    } );
+
+    BOOST_CHECK( !connection_data().outgoing_security_manager_data_available( connection_data() ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( no_bond_before_all_keys_are_exchanged, bonding_encrypted )
+{
+    distribute_local_keys();
+
+    BOOST_CHECK_EQUAL( bond_store().size(), 0u );
+
+    distribute_remote_keys();
+
+    BOOST_CHECK_EQUAL( bond_store().size(), 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE( bond_stored, bonded )
+{
+    BOOST_REQUIRE_EQUAL( bond_store().size(), 1u );
+    const bluetoe::bond_data& bond = bond_store().bond( connection_data().bond() );
+
+    BOOST_CHECK_EQUAL( bond.long_term_key.ediv, 0x1234u );
+    BOOST_CHECK_EQUAL( bond.long_term_key.rand, 0xaabbccdd00112233u );
+    BOOST_CHECK_EQUAL( bond.identity_resolving_key[ 0 ], 0x01 );
+    BOOST_CHECK_EQUAL( bond.identity_resolving_key[ 15 ], 0x10 );
+    BOOST_CHECK_EQUAL( bond.identity_address, bluetoe::link_layer::public_device_address( { 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6 } ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( unrequested_keys_are_rejected, bonded )
+{
+    expected(
+        {
+            0x09,                   // Identity Address Information
+            0x00,                   // public
+            0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6
+        },
+        {
+            0x05,                   // Pairing Failed
+            0x07                    // Command Not Supported
+        }
+    );
+}
+
+BOOST_FIXTURE_TEST_CASE( reconnect_with_long_term_key_of_bond, bonded )
+{
+    connection_data_t reconnected( 23 );
+
+    const auto key = find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+    const bluetoe::details::uint128_t expected_key = {{
+        0x00, 0x11, 0x22, 0x33,
+        0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb,
+        0xcc, 0xdd, 0xee, 0xff
+    }};
+
+    BOOST_CHECK( key.first );
+    BOOST_CHECK( key.second == expected_key );
+    BOOST_CHECK( reconnected.local_device_pairing_status() == bluetoe::device_pairing_status::unauthenticated_key );
+    BOOST_CHECK( !reconnected.outgoing_security_manager_data_available( reconnected ) );
+}
+
+BOOST_FIXTURE_TEST_CASE( reconnect_with_unknown_key, bonded )
+{
+    connection_data_t reconnected( 23 );
+
+    BOOST_CHECK( !find_key( 0x1235, 0xaabbccdd00112233, reconnected ).first );
+    BOOST_CHECK( reconnected.local_device_pairing_status() == bluetoe::device_pairing_status::no_key );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_configurations_are_restored, bonded )
+{
+    connection_data_.client_configurations().flags( 1, 0x02 );
+    remote_connection_closed( connection_data_ );
+
+    connection_data_t reconnected( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+
+    BOOST_CHECK_EQUAL( reconnected.client_configurations().flags( 0 ), 0x00 );
+    BOOST_CHECK_EQUAL( reconnected.client_configurations().flags( 1 ), 0x02 );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_supported_features_are_restored, bonded )
+{
+    connection_data_.client_configurations().client_supported_features( 0x01 );
+    remote_connection_closed( connection_data_ );
+
+    connection_data_t reconnected( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+
+    BOOST_CHECK_EQUAL( reconnected.client_supported_features(), 0x01 );
+    BOOST_CHECK( reconnected.change_aware() );
+}
+
+namespace {
+    std::uint8_t value = 0;
+
+    template < class ... Characteristics >
+    using caching_server = bluetoe::server<
+        bluetoe::service<
+            bluetoe::service_uuid16< 0x1234 >,
+            Characteristics...
+        >,
+        bluetoe::robust_caching
+    >;
+
+    using old_database = caching_server<
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x0101 >,
+            bluetoe::bind_characteristic_value< std::uint8_t, &value >
+        >
+    >;
+
+    using new_database = caching_server<
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x0101 >,
+            bluetoe::bind_characteristic_value< std::uint8_t, &value >
+        >,
+        bluetoe::characteristic<
+            bluetoe::characteristic_uuid16< 0x0102 >,
+            bluetoe::bind_characteristic_value< std::uint8_t, &value >
+        >
+    >;
+
+    // the servers calculate their database hashes, when constructed
+    old_database old_server;
+    new_database new_server;
+
+    struct bonded_with_old_database : bonding_encrypted
+    {
+        bonded_with_old_database()
+        {
+            database_hash( old_database::database_hash() );
+            distribute_local_keys();
+            distribute_remote_keys();
+            remote_connection_closed( connection_data_ );
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_CASE( client_is_change_aware_if_the_database_did_not_change, bonded_with_old_database )
+{
+    connection_data_t reconnected( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+
+    BOOST_CHECK( reconnected.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_is_change_unaware_after_the_database_changed, bonded_with_old_database )
+{
+    database_hash( new_database::database_hash() );
+
+    connection_data_t reconnected( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+
+    BOOST_CHECK( !reconnected.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( client_that_became_change_aware_stays_change_aware, bonded_with_old_database )
+{
+    database_hash( new_database::database_hash() );
+
+    connection_data_t reconnected( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+    reconnected.change_aware( true );
+    remote_connection_closed( reconnected );
+
+    connection_data_t second_reconnect( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, second_reconnect );
+
+    BOOST_CHECK( second_reconnect.change_aware() );
+}
+
+BOOST_FIXTURE_TEST_CASE( change_unaware_client_stays_change_unaware, bonded_with_old_database )
+{
+    database_hash( new_database::database_hash() );
+
+    connection_data_t reconnected( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, reconnected );
+    remote_connection_closed( reconnected );
+
+    connection_data_t second_reconnect( 23 );
+    find_key( 0x1234, 0xaabbccdd00112233, second_reconnect );
+
+    BOOST_CHECK( !second_reconnect.change_aware() );
+}
@@ -6,6 +6,8 @@
 #include <bluetoe/security_manager.hpp>
 #include <bluetoe/address.hpp>
 
+#include <vector>
+
 namespace test {
 
     struct security_functions {
@@ -19,6 +21,17 @@ namespace test {
             local_addr_ = addr;
         }
 
+        // GATT Database Hash of the emulated server
+        bluetoe::details::uint128_t database_hash() const
+        {
+            return database_hash_;
+        }
+
+        void database_hash( const bluetoe::details::uint128_t& hash )
+        {
+            database_hash_ = hash;
+        }
+
         bluetoe::details::uint128_t create_srand()
         {
             const bluetoe::details::uint128_t r{{
@@ -114,6 +127,7 @@ namespace test {
         }
 
         bluetoe::link_layer::device_address local_addr_;
+        bluetoe::details::uint128_t         database_hash_ = {{ 0 }};
     };
 
     template < class Manager, std::size_t MTU = 27 >
@@ -155,9 +169,52 @@ namespace test {
                 &buffer[ 0 ], &buffer[ size ] );
         }
 
-        struct gatt_connection_details {};
-        using connection_data_t = bluetoe::details::link_state<
-            typename Manager::template connection_data< gatt_connection_details > >;
+        using gatt_connection_details = bluetoe::details::link_state<
+            bluetoe::details::client_characteristic_configurations< 2, true > >;
+        using connection_data_t = typename Manager::template connection_data< gatt_connection_details >;
+
+        // key distributed by the security manager, if there is one
+        std::vector< std::uint8_t > output()
+        {
+            std::uint8_t buffer[ MTU ];
+            std::size_t  size = MTU;
+
+            this->l2cap_output( &buffer[ 0 ], size,
+                connection_data_, static_cast< security_functions& >( *this ) );
+
+            return std::vector< std::uint8_t >( &buffer[ 0 ], &buffer[ size ] );
+        }
+
+        void expected_output( std::initializer_list< std::uint8_t > expected_output )
+        {
+            const auto out = output();
+
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                expected_output.begin(), expected_output.end(),
+                out.begin(), out.end() );
+        }
+
+        // exchanges pairing confirm and pairing random, after the pairing features were exchanged
+        void pair( const bluetoe::details::uint128_t& mrand )
+        {
+            auto& functions = static_cast< security_functions& >( *this );
+            const auto mconfirm = functions.c1( { { 0 } }, mrand, connection_data_.c1_p1(), connection_data_.c1_p2() );
+
+            std::uint8_t input[ 17 ];
+            std::uint8_t buffer[ MTU ];
+            std::size_t  size = MTU;
+
+            input[ 0 ] = 0x03;
+            std::copy( mconfirm.begin(), mconfirm.end(), &input[ 1 ] );
+            this->l2cap_input( &input[ 0 ], sizeof( input ), &buffer[ 0 ], size, connection_data_, functions );
+            BOOST_REQUIRE_EQUAL( buffer[ 0 ], 0x03 );
+
+            size = MTU;
+            input[ 0 ] = 0x04;
+            std::copy( mrand.begin(), mrand.end(), &input[ 1 ] );
+            this->l2cap_input( &input[ 0 ], sizeof( input ), &buffer[ 0 ], size, connection_data_, functions );
+            BOOST_REQUIRE_EQUAL( buffer[ 0 ], 0x04 );
+        }
 
         void local_address( const bluetoe::link_layer::device_address& addr )
         {
@@ -169,6 +226,24 @@ namespace test {
             connection_data_.remote_connection_created( addr );
         }
 
+        void database_hash( const std::uint8_t* hash )
+        {
+            bluetoe::details::uint128_t value;
+            std::copy( hash, hash + value.size(), value.begin() );
+
+            static_cast< security_functions& >( *this ).database_hash( value );
+        }
+
+        std::pair< bool, bluetoe::details::uint128_t > find_key( std::uint16_t ediv, std::uint64_t rand, connection_data_t& connection )
+        {
+            return Manager::find_key( ediv, rand, connection, static_cast< security_functions& >( *this ) );
+        }
+
+        void remote_connection_closed( connection_data_t& connection )
+        {
+            Manager::remote_connection_closed( connection, static_cast< security_functions& >( *this ) );
+        }
+
         const connection_data_t& connection_data() const
         {
             return connection_data_;
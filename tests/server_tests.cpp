@@ -82,6 +82,42 @@ BOOST_FIXTURE_TEST_CASE( is_clearable, connection_data<> )
 
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE( attribute_table )
+
+using large_server_table = bluetoe::details::attribute_table<
+    bluetoe::details::attribute_generators_of_list<
+        characteristic_configuration::large_temperature_service::services,
+        characteristic_configuration::large_temperature_service::cccd_indices,
+        0,
+        characteristic_configuration::large_temperature_service::services,
+        characteristic_configuration::large_temperature_service >::type >;
+
+// the table is a constant expression
+static_assert( large_server_table::attributes[ 0 ].uuid == 0x2800, "first attribute is a primary service declaration" );
+static_assert( large_server_table::attributes[ 1 ].uuid == 0x2803, "followed by a characteristic declaration" );
+static_assert( large_server_table::attributes[ 2 ].uuid == 0x0001, "followed by the characteristic value declaration" );
+static_assert( large_server_table::attributes[ 3 ].uuid == 0x2902, "followed by the CCCD" );
+
+BOOST_AUTO_TEST_CASE( table_contains_all_attributes )
+{
+    // 1 service declaration, 9 * 3 characteristic attributes and 5 attributes of the GAP service
+    BOOST_CHECK_EQUAL( std::size_t{ large_server_table::number_of_attributes }, 1u + 9 * 3 + 5 );
+}
+
+BOOST_AUTO_TEST_CASE( table_equals_recursive_lookup )
+{
+    using server    = characteristic_configuration::large_temperature_service;
+    using recursive = bluetoe::details::attribute_from_service_list< server::services, server, server::cccd_indices >;
+
+    for ( std::size_t index = 0; index != large_server_table::number_of_attributes; ++index )
+    {
+        BOOST_CHECK_EQUAL( server::attribute_at( index ).uuid, recursive::attribute_at( index ).uuid );
+        BOOST_CHECK( server::attribute_at( index ).access == recursive::attribute_at( index ).access );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE( mixins )
 
 std::string tag_construction_order;
@@ -85,6 +85,7 @@ namespace test {
     {
         out << "schedule_time: " << data.schedule_time << "; channel: " << data.channel
             << "\nstart_receive: " << data.start_receive << "; end_receive: " << data.end_receive << "; connection_interval: " << data.connection_interval
+            << "\nrx-phy: " << int( data.receive_phy ) << "; tx-phy: " << int( data.transmit_phy ) << "; air_time: " << data.air_time
             << "\nrx-encrypt: " << data.receive_encryption_at_start_of_event << "; tx-encrypt: " << data.transmit_encryption_at_start_of_event
             << "\nreceived_data:\n";
 
@@ -539,6 +540,49 @@ namespace test {
         add_connection_event_respond( connection_event_response() );
     }
 
+    void radio_base::add_connection_event_respond_to( std::uint32_t access_address, const connection_event_response& resp )
+    {
+        connection_events_response_by_access_address_[ access_address ].push_back( resp );
+    }
+
+    void radio_base::add_connection_event_respond_to( std::uint32_t access_address, std::initializer_list< std::uint8_t > pdu )
+    {
+        add_connection_event_respond_to( access_address,
+            connection_event_response( pdu_list_t( 1, pdu ) ) );
+    }
+
+    void radio_base::add_connection_event_respond_timeout_to( std::uint32_t access_address )
+    {
+        add_connection_event_respond_to( access_address, connection_event_response() );
+    }
+
+    connection_event_response radio_base::next_connection_event_response( std::uint32_t access_address )
+    {
+        const auto by_address = connection_events_response_by_access_address_.find( access_address );
+        connection_event_response_list& responses = by_address != connection_events_response_by_access_address_.end() && !by_address->second.empty()
+            ? by_address->second
+            : connection_events_response_;
+
+        if ( responses.empty() )
+            return connection_event_response();
+
+        const connection_event_response result = responses.front();
+        responses.erase( responses.begin() );
+
+        return result;
+    }
+
+    void radio_base::connection_request_received( const std::vector< std::uint8_t >& pdu )
+    {
+        static constexpr std::uint8_t connect_request_pdu_type = 0x05;
+        static constexpr std::size_t  access_address_offset    = ll_header_size + 12;
+
+        if ( pdu.size() < access_address_offset + 4 || ( pdu[ 0 ] & 0x0f ) != connect_request_pdu_type )
+            return;
+
+        master_sequence_numbers_.erase( bluetoe::details::read_32bit( &pdu[ access_address_offset ] ) );
+    }
+
     void radio_base::check_connection_events( const std::function< bool ( const connection_event& ) >& filter, const std::function< bool ( const connection_event& ) >& check, const char* message )
     {
         for ( const auto& event : connection_events_ )
@@ -648,6 +692,17 @@ namespace test {
 
     const bluetoe::link_layer::delta_time radio_base::T_IFS = bluetoe::link_layer::delta_time( 150u );
 
+    bluetoe::link_layer::delta_time radio_base::air_time( bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t phy, const pdu_t& pdu, bool encrypted )
+    {
+        static constexpr std::size_t mic_size = 4;
+
+        const std::size_t size = encrypted && pdu.size() > ll_header_size
+            ? pdu.size() + mic_size
+            : pdu.size();
+
+        return bluetoe::link_layer::delta_time( bluetoe::link_layer::details::air_time( phy, size ) );
+    }
+
     void radio_base::end_of_simulation( bluetoe::link_layer::delta_time eos )
     {
         eos_ = eos;
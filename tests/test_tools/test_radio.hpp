@@ -7,6 +7,7 @@
 #include <bluetoe/link_layer.hpp>
 
 #include <vector>
+#include <map>
 #include <functional>
 #include <iosfwd>
 #include <initializer_list>
@@ -118,6 +119,8 @@ namespace test {
         bluetoe::link_layer::delta_time     start_receive;
         bluetoe::link_layer::delta_time     end_receive;
         bluetoe::link_layer::delta_time     connection_interval;
+        bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t receive_phy;
+        bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t transmit_phy;
 
         std::uint32_t                       access_address;
         std::uint32_t                       crc_init;
@@ -127,6 +130,9 @@ namespace test {
 
         bool                                receive_encryption_at_start_of_event;
         bool                                transmit_encryption_at_start_of_event;
+
+        // simulated time from the start of the first received PDU to the end of the last transmitted PDU
+        bluetoe::link_layer::delta_time     air_time;
     };
 
     std::ostream& operator<<( std::ostream& out, const connection_event& );
@@ -266,6 +272,16 @@ namespace test {
         void add_connection_event_respond( std::function< void() > );
         void add_connection_event_respond_timeout();
 
+        /**
+         * @brief response to a connection event of the connection with the given access address
+         *
+         * Connection events of a connection without pending, connection specific responses are answered
+         * by the responses added with add_connection_event_respond().
+         */
+        void add_connection_event_respond_to( std::uint32_t access_address, const connection_event_response& );
+        void add_connection_event_respond_to( std::uint32_t access_address, std::initializer_list< std::uint8_t > );
+        void add_connection_event_respond_timeout_to( std::uint32_t access_address );
+
         void check_connection_events( const std::function< bool ( const connection_event& ) >& filter, const std::function< bool ( const connection_event& ) >& check, const char* message );
         void check_connection_events( const std::function< bool ( const connection_event& ) >& check, const char* message );
 
@@ -291,6 +307,13 @@ namespace test {
 
         static const bluetoe::link_layer::delta_time T_IFS;
 
+        /**
+         * @brief time it takes to transmit the given over the air PDU on the given PHY
+         *
+         * If encrypted is true, a non empty PDU is extended by the MIC.
+         */
+        static bluetoe::link_layer::delta_time air_time( bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t phy, const pdu_t& pdu, bool encrypted );
+
         void end_of_simulation( bluetoe::link_layer::delta_time );
 
         class lock_guard
@@ -323,11 +346,25 @@ namespace test {
         typedef std::vector< connection_event_response > connection_event_response_list;
         connection_event_response_list connection_events_response_;
 
+        std::map< std::uint32_t, connection_event_response_list > connection_events_response_by_access_address_;
+
         std::uint32_t   access_address_;
         std::uint32_t   crc_init_;
         bool            access_address_and_crc_valid_;
-        std::uint8_t    master_sequence_number_    = 0;
-        std::uint8_t    master_ne_sequence_number_ = 0;
+
+        struct sequence_numbers
+        {
+            std::uint8_t    sequence_number    = 0;
+            std::uint8_t    ne_sequence_number = 0;
+        };
+
+        // sequence numbers of the simulated master, by access address of the connection
+        std::map< std::uint32_t, sequence_numbers > master_sequence_numbers_;
+
+        connection_event_response next_connection_event_response( std::uint32_t access_address );
+
+        // a new connection starts with this response, if it is a valid connect request
+        void connection_request_received( const std::vector< std::uint8_t >& pdu );
 
         static constexpr std::size_t ll_header_size = 2;
 
@@ -368,7 +405,9 @@ namespace test {
             unsigned                                    channel,
             bluetoe::link_layer::delta_time             start_receive,
             bluetoe::link_layer::delta_time             end_receive,
-            bluetoe::link_layer::delta_time             connection_interval );
+            bluetoe::link_layer::delta_time             connection_interval,
+            bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t receive_phy,
+            bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t transmit_phy );
 
         void wake_up();
 
@@ -377,7 +416,26 @@ namespace test {
          */
         void run();
 
+        /**
+         * @brief simulates only the next scheduled radio event, as if the radio interrupt fires at this point
+         */
+        void simulate_next_event();
+
         static constexpr bool hardware_supports_encryption = false;
+        static constexpr bool hardware_supports_2mbit = true;
+        static constexpr bool hardware_supports_multiple_connections = true;
+
+        using connection_buffer_t = bluetoe::link_layer::connection_pdu_buffer< radio< TransmitSize, ReceiveSize, CallBack >, TransmitSize, ReceiveSize >;
+
+        /**
+         * @brief the buffer used for the next connection events, instead of the radio's own buffer
+         */
+        void select_connection_buffer( connection_buffer_t& buffer );
+
+        /**
+         * @brief the test radio simulates the first PDU of a connection event at the start of the receive window
+         */
+        bluetoe::link_layer::delta_time connection_event_anchor() const;
 
     private:
         // converts from in memory layout to over the air layout
@@ -393,12 +451,18 @@ namespace test {
         void simulate_advertising_response();
         void simulate_connection_event_response();
 
+        template < class Buffer >
+        void simulate_connection_event_response( Buffer& buffer );
+
         // make sure, there is only one action scheduled
         bool idle_;
         bool advertising_response_;
         bool connection_event_response_;
         int  wake_ups_;
 
+        // buffer of the connection of the next connection event, if selected
+        connection_buffer_t* connection_buffer_;
+
     protected:
         bool reception_encrypted_;
         bool transmition_encrypted_;
@@ -441,6 +505,22 @@ namespace test {
             return r;
         }
 
+        bluetoe::details::longterm_key_t create_long_term_key()
+        {
+            const bluetoe::details::longterm_key_t key = {
+                {{
+                    0x00, 0x11, 0x22, 0x33,
+                    0x44, 0x55, 0x66, 0x77,
+                    0x88, 0x99, 0xaa, 0xbb,
+                    0xcc, 0xdd, 0xee, 0xff
+                }},
+                0xaabbccdd00112233,
+                0x1234
+            };
+
+            return key;
+        }
+
         bluetoe::details::uint128_t c1(
             const bluetoe::details::uint128_t& temp_key,
             const bluetoe::details::uint128_t& /* srand */,
@@ -535,6 +615,7 @@ namespace test {
         , advertising_response_( false )
         , connection_event_response_( false )
         , wake_ups_( 0 )
+        , connection_buffer_( nullptr )
         , reception_encrypted_( false )
         , transmition_encrypted_( false )
     {
@@ -575,7 +656,9 @@ namespace test {
         unsigned                                    channel,
         bluetoe::link_layer::delta_time             start_receive,
         bluetoe::link_layer::delta_time             end_receive,
-        bluetoe::link_layer::delta_time             connection_interval )
+        bluetoe::link_layer::delta_time             connection_interval,
+        bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t receive_phy,
+        bluetoe::link_layer::details::phy_ll_encoding::phy_ll_encoding_t transmit_phy )
     {
         advertising_response_ = false;
         connection_event_response_ = true;
@@ -586,12 +669,15 @@ namespace test {
             start_receive,
             end_receive,
             connection_interval,
+            receive_phy,
+            transmit_phy,
             access_address_,
             crc_init_,
             pdu_list_t(),
             pdu_list_t(),
             reception_encrypted_,
-            transmition_encrypted_
+            transmition_encrypted_,
+            bluetoe::link_layer::delta_time()
         };
 
         connection_events_.push_back( data );
@@ -609,23 +695,12 @@ namespace test {
     void radio< TransmitSize, ReceiveSize, CallBack >::run()
     {
         bool new_scheduling_added = false;
-        master_sequence_number_    = 0;
-        master_ne_sequence_number_ = 0;
 
         do
         {
             unsigned count = advertised_data_.size() + connection_events_.size();;
 
-            if ( advertising_response_ )
-            {
-                advertising_response_ = false;
-                simulate_advertising_response();
-            }
-            else if ( connection_event_response_ )
-            {
-                connection_event_response_ = false;
-                simulate_connection_event_response();
-            }
+            simulate_next_event();
 
             // there should be at max one call to a schedule function
             assert( count + 1 >= advertised_data_.size() + connection_events_.size() );
@@ -637,6 +712,21 @@ namespace test {
             --wake_ups_;
     }
 
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
+    void radio< TransmitSize, ReceiveSize, CallBack >::simulate_next_event()
+    {
+        if ( advertising_response_ )
+        {
+            advertising_response_ = false;
+            simulate_advertising_response();
+        }
+        else if ( connection_event_response_ )
+        {
+            connection_event_response_ = false;
+            simulate_connection_event_response();
+        }
+    }
+
     template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
     void radio< TransmitSize, ReceiveSize, CallBack >::simulate_advertising_response()
     {
@@ -659,6 +749,8 @@ namespace test {
                 if ( current.receive_buffer.size > 0 )
                     copy_air_to_memory( response.second.received_data, current.receive_buffer );
 
+                connection_request_received( response.second.received_data );
+
                 idle_ = true;
                 static_cast< CallBack* >( this )->adv_received( current.receive_buffer );
             }
@@ -671,22 +763,42 @@ namespace test {
         }
     }
 
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
+    void radio< TransmitSize, ReceiveSize, CallBack >::select_connection_buffer( connection_buffer_t& buffer )
+    {
+        connection_buffer_ = &buffer;
+    }
+
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
+    bluetoe::link_layer::delta_time radio< TransmitSize, ReceiveSize, CallBack >::connection_event_anchor() const
+    {
+        return bluetoe::link_layer::delta_time();
+    }
+
     template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
     void radio< TransmitSize, ReceiveSize, CallBack >::simulate_connection_event_response()
     {
-        using layout = typename bluetoe::link_layer::pdu_layout_by_radio< radio< TransmitSize, ReceiveSize, CallBack > >::pdu_layout;
+        if ( connection_buffer_ )
+        {
+            simulate_connection_event_response( *connection_buffer_ );
+        }
+        else
+        {
+            simulate_connection_event_response( *this );
+        }
+    }
 
-        connection_event_response response = connection_events_response_.empty()
-            ? connection_event_response()
-            : connection_events_response_.front();
+    template < std::size_t TransmitSize, std::size_t ReceiveSize, typename CallBack >
+    template < class Buffer >
+    void radio< TransmitSize, ReceiveSize, CallBack >::simulate_connection_event_response( Buffer& buffer )
+    {
+        using layout = typename bluetoe::link_layer::pdu_layout_by_radio< radio< TransmitSize, ReceiveSize, CallBack > >::pdu_layout;
 
         assert( !connection_events_.empty() );
         auto& event = connection_events_.back();
 
-        if ( !connection_events_response_.empty() )
-        {
-            connection_events_response_.erase( connection_events_response_.begin() );
-        }
+        const connection_event_response response = next_connection_event_response( event.access_address );
+        sequence_numbers&               master   = master_sequence_numbers_[ event.access_address ];
 
         if ( response.timeout )
         {
@@ -710,7 +822,7 @@ namespace test {
 
             do
             {
-                auto receive_buffer = this->allocate_receive_buffer();
+                auto receive_buffer = buffer.allocate_receive_buffer();
 
                 more_data = false;
 
@@ -733,10 +845,10 @@ namespace test {
 
                     std::uint16_t header = layout::header( receive_buffer );
                     header &= ~( sn_flag | nesn_flag );
-                    header |= master_sequence_number_ | master_ne_sequence_number_;
+                    header |= master.sequence_number | master.ne_sequence_number;
                     layout::header( receive_buffer, header );
 
-                    master_sequence_number_    ^= sn_flag;
+                    master.sequence_number ^= sn_flag;
                 }
 
                 if ( more_data && receive_buffer.size )
@@ -745,10 +857,10 @@ namespace test {
                     layout::header( receive_buffer, header );
                 }
 
-                auto response = this->received( receive_buffer );
+                auto response = buffer.received( receive_buffer );
 
                 more_data = more_data || ( layout::header( response ) & more_data_flag );
-                master_ne_sequence_number_ ^= nesn_flag;
+                master.ne_sequence_number ^= nesn_flag;
 
                 event.received_data.push_back(
                     memory_to_air( bluetoe::link_layer::write_buffer( receive_buffer ) ) );
@@ -756,6 +868,13 @@ namespace test {
                 event.transmitted_data.push_back(
                     pdu_t( memory_to_air( response ), transmition_encrypted_ ) );
 
+                if ( event.received_data.size() > 1 )
+                    event.air_time += T_IFS;
+
+                event.air_time += air_time( event.receive_phy, event.received_data.back(), reception_encrypted_ )
+                    + T_IFS
+                    + air_time( event.transmit_phy, event.transmitted_data.back(), transmition_encrypted_ );
+
             } while ( more_data );
 
             static_cast< CallBack* >( this )->end_event();